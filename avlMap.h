@@ -81,8 +81,11 @@
 #include <sstream>
 #include <string>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include "memoryFootprint.h"
+
 /*
  * The avlMap class defines the root of the AVL map and provides the
  * lli, lri, rli, rri, lle, lre, rle, and rre rotation counters
@@ -95,6 +98,8 @@ class avlMap {
 
     class avlNode {
 
+        friend class avlMap;
+
     private:
         K key;          /* the key stored in this avlNode */
         V value;        /* the value stored in this avlNode */
@@ -104,18 +109,21 @@ class avlMap {
         avlNode *left, *right;
         
         /*
-         * Here is the constructor for the avlNode class.
+         * Here is the constructor for the avlNode class, which
+         * constructs the key and the value in place from arguments
+         * that are copied or moved as the caller supplies them.
          *
          * Calling parameters:
          * 
-         * @param x (IN) the key to store in the avlNode
          * @param h (MODIFIED) specifies that the map height has changed
+         * @param x (IN) the argument from which to construct the key
+         * @param y (IN) the arguments from which to construct the value
          */
     public:
-        avlNode( K const& x, V const& y, bool& h ) {
+        template <typename KK, typename... Args>
+        avlNode( bool& h, KK&& x, Args&&... y )
+            : key( std::forward<KK>(x) ), value( std::forward<Args>(y)... ) {
             h = true;
-            key = x;
-            value = y;
             bal = 0;
             left = right = nullptr;
         }
@@ -173,8 +181,9 @@ class avlMap {
         
         /*
          * This method searches the map recursively for the existence
-         * of a key, and either inserts the (key, value) as a new avlNode
-         * or updates the value. Then the map is rebalanced if necessary.
+         * of a key, and either inserts a new avlNode or updates the
+         * value. Then the map is rebalanced if necessary. A pointer
+         * to the value that was added or found is stored in m->w.
          * 
          * The "this" pointer is copied to the "p" pointer that is
          * possibly modified and is returned to represent the root of
@@ -184,18 +193,21 @@ class avlMap {
          *
          * @param m (IN) a pointer to the avlMap instance
          * @param x (IN) the key to add to the map
-         * @param y (IN) the value to add to the map
+         * @param make (IN) a function that creates the avlNode from m->h
+         * @param update (IN) a function that updates the value of the key if present
          */
     public:
-        avlNode* insert( avlMap* const m, K const& x, V const& y ) {
+        template <typename F, typename G>
+        avlNode* insert( avlMap* const m, K const& x, F& make, G& update ) {
             
             avlNode* p = this;
             
             if ( x < p->key ) {                         /* search the left branch? */
                 if ( p->left != nullptr ) {
-                    p->left = left->insert( m, x, y );
+                    p->left = left->insert( m, x, make, update );
                 } else {
-                    p->left = new avlNode( x, y, m->h );
+                    p->left = make( m->h );
+                    m->w = &(p->left->value);
                     m->a = false;                       /* the present value is overwritten */
                 }
                 if ( m->h == true ) {                   /* left branch has grown higher */
@@ -241,9 +253,10 @@ class avlMap {
                 }
             } else if ( x > p->key ) {                  /* search the right branch? */
                 if ( p->right != nullptr ) {
-                    p->right = right->insert( m, x, y );
+                    p->right = right->insert( m, x, make, update );
                 } else {
-                    p->right = new avlNode( x, y, m->h );
+                    p->right = make( m->h );
+                    m->w = &(p->right->value);
                     m->a = false;                       /* the present value is overwritten */
                 }
                 if ( m->h == true ) {                   /* right branch has grown higher */
@@ -288,7 +301,8 @@ class avlMap {
                     }
                 }
             } else {  /* the key is already in map, so update its value */
-                p->value = y;
+                update( p->value );
+                m->w = &(p->value);
                 m->h = false;
                 m->a = true;
             }
@@ -431,8 +445,9 @@ class avlMap {
         
         /*
          * This method replaces the avlNode to be deleted with the
-         * leftmost avlNode of the right sub-map. Then the map is
-         * rebalanced if necessary.
+         * leftmost avlNode of the right sub-map, which it unlinks
+         * from the sub-map instead of copying its key and value.
+         * Then the map is rebalanced if necessary.
          * 
          * The "this" pointer is copied to the "p" pointer that is
          * possibly modified and is returned to represent the root of
@@ -441,7 +456,8 @@ class avlMap {
          * Calling parameters:
          * 
          * @param m (IN) a pointer to the avlMap instance
-         * @param q (MODIFIED) the avlNode to be deleted
+         * @param q (MODIFIED) the avlNode to be deleted, which is
+         *                     redefined as the unlinked avlNode
          * 
          * @return the root of the rebalanced sub-map
          */
@@ -454,9 +470,7 @@ class avlMap {
                 p->left = left->eraseLeft( m, q );
                 if ( m->h == true ) p = balanceLeft( m );
             } else {
-                q->key = p->key;                /* copy avlNode contents from p to q */
-                q->value = p->value;
-                q = p;                          /* redefine q as avlNode to be deleted */
+                q = p;                          /* redefine q as the unlinked avlNode */
                 p = p->right;                   /* replace avlNode with right branch */
                 m->h = true;
             }
@@ -465,8 +479,9 @@ class avlMap {
         
         /*
          * This method replaces the avlNode to be deleted with the
-         * rightmost avlNode of the left sub-map. Then the map is
-         * rebalanced if necessary.
+         * rightmost avlNode of the left sub-map, which it unlinks
+         * from the sub-map instead of copying its key and value.
+         * Then the map is rebalanced if necessary.
          * 
          * The "this" pointer is copied to the "p" pointer that is
          * possibly modified and is returned to represent the root of
@@ -475,7 +490,8 @@ class avlMap {
          * Calling parameters:
          * 
          * @param m (IN) a pointer to the avlMap instance
-         * @param q (MODIFIED) the avlNode to be deleted
+         * @param q (MODIFIED) the avlNode to be deleted, which is
+         *                     redefined as the unlinked avlNode
          * 
          * @return the root of the rebalanced sub-map
          */
@@ -488,15 +504,37 @@ class avlMap {
                 p->right = p->right->eraseRight( m, q );
                 if ( m->h == true ) p = balanceRight( m );
             } else {
-                q->key = p->key;                /* copy avlNode contents from p to q */
-                q->value = p->value;
-                q = p;                          /* redefine q as avlNode to be deleted  */
+                q = p;                          /* redefine q as the unlinked avlNode */
                 p = p->left;                    /* replace avlNode with left branch */
                 m->h = true;
             }
             return p;  /* the root of the rebalanced sub-map */
         }
         
+        /*
+         * This method substitutes an avlNode that eraseLeft or
+         * eraseRight has unlinked for the "this" avlNode, which
+         * is to be deleted, by copying the child pointers and
+         * balance of the "this" avlNode to the unlinked avlNode.
+         *
+         * Calling parameter:
+         *
+         * @param q (MODIFIED) the unlinked avlNode, which is
+         *                     redefined as the avlNode to be deleted
+         *
+         * @return the unlinked avlNode
+         */
+    private:
+        avlNode* replace( avlNode*& q ) {
+
+            avlNode* const p = q;
+            p->left = left;
+            p->right = right;
+            p->bal = bal;
+            q = this;
+            return p;
+        }
+
         /*
          * This method removes an avlNode from the map. Then
          * the map is rebalanced if necessary.
@@ -549,14 +587,16 @@ class avlMap {
                     switch ( p->bal ) {             /* otherwise find an avlNode to remove */
                         case 0: case -1:            /* left or neither submap is deeper */
                             p->left = p->left->eraseRight( m, q );
+                            p = replace( q );
                             if ( m->h == true ) {
-                                p = balanceLeft( m );
+                                p = p->balanceLeft( m );
                             }
                             break;
                         case 1:                     /* right submap is deeper */
                             p->right = p->right->eraseLeft( m, q );
+                            p = replace( q );
                             if ( m->h == true ) {
-                                p = balanceRight( m );
+                                p = p->balanceRight( m );
                             }
                             break;
                         default:
@@ -567,7 +607,11 @@ class avlMap {
                             }
                     }
                 }
-                delete q;
+                if ( m->keep == true ) {
+                    m->kept = q;                    /* extract retains the avlNode */
+                } else {
+                    delete q;
+                }
                 m->r = true;
             }
             return p;  /* the root of the rebalanced sub-map */
@@ -616,6 +660,27 @@ class avlMap {
             delete this;
         }
 
+        /*
+         * This method adds the heap memory that the keys
+         * and values of this subtree own to a footprint.
+         *
+         * Calling parameter:
+         *
+         * @param m (MODIFIED) the memory footprint
+         */
+    public:
+        void addPayload( memoryFootprint& m ) {
+
+            if ( left != nullptr ) {
+                left->addPayload( m );
+            }
+            m.addPayload( key );
+            m.addPayload( value );
+            if ( right != nullptr ){
+                right->addPayload( m );
+            }
+        }
+
         /*
          * This method walks the map in order and stores each key in a vector.
          *
@@ -635,12 +700,95 @@ class avlMap {
                 right->getKeys( v, i );
             }
         }
+
+        /*
+         * This method walks the map in order and stores each value in a vector.
+         *
+         * Calling parameters:
+         *
+         * @param v (MODIFIED) vector of the values
+         * @param i (MODIFIED) index to the next unoccupied vector element
+         */
+    public:
+        void getValues( std::vector<V>& v, size_t& i ) {
+
+            if ( left != nullptr ) {
+                left->getValues( v, i );
+            }
+            v[i++] = this->value;
+            if ( right != nullptr ){
+                right->getValues( v, i );
+            }
+        }
+
+        /*
+         * This method builds a balanced sub-map from a sorted range of
+         * keys and values without any comparisons or rotations. The
+         * middle element becomes the root of the sub-map, so the left
+         * sub-map is never shorter than the right sub-map, and the
+         * balance of each avlNode is the difference of those heights.
+         *
+         * Calling parameters:
+         *
+         * @param k (IN) vector of keys sorted in increasing order
+         * @param v (IN) vector of values that correspond to the keys
+         * @param lo (IN) index of the first element of the range
+         * @param hi (IN) index one past the last element of the range
+         * @param height (MODIFIED) the height of the sub-map
+         *
+         * @return the root of the sub-map
+         */
+    public:
+        static avlNode* build( std::vector<K> const& k, std::vector<V> const& v,
+                               size_t const lo, size_t const hi, int& height ) {
+
+            if ( lo >= hi ) {
+                height = 0;
+                return nullptr;
+            }
+            size_t const mid = lo + ( (hi - lo) >> 1 );
+            int leftHeight, rightHeight;
+            bool h;
+            avlNode* p = new avlNode( h, k[mid], v[mid] );
+            p->left = build( k, v, lo, mid, leftHeight );
+            p->right = build( k, v, mid + 1, hi, rightHeight );
+            p->bal = rightHeight - leftHeight;
+            height = std::max( leftHeight, rightHeight ) + 1;
+            return p;
+        }
+
+        /*
+         * This method copies a sub-map, including the balance of each
+         * avlNode, without any comparisons or rotations.
+         *
+         * Calling parameter:
+         *
+         * @param p (IN) the root of the sub-map
+         *
+         * @return the root of the copy of the sub-map
+         */
+    public:
+        static avlNode* copy( avlNode const* const p ) {
+
+            if ( p == nullptr ) {
+                return nullptr;
+            }
+            bool h;
+            avlNode* q = new avlNode( h, p->key, p->value );
+            q->bal = p->bal;
+            q->left = copy( p->left );
+            q->right = copy( p->right );
+            return q;
+        }
     };
 
 private:
     avlNode* root;  /* the root of the map */
     size_t count;   /* the number of nodes in the map */
     bool h, a, r;   /* record modification of the map */
+    V* w;           /* the value that insertion added or found */
+    bool keep;      /* erase retains, rather than deletes, the removed avlNode */
+    avlNode* kept;  /* the avlNode that erase retained */
 
 public:
     size_t lle, lre, rle, rre, lli, lri, rli, rri;  /* the rotation counters */
@@ -648,6 +796,9 @@ public:
 public:
     avlMap() {
         root = nullptr;
+        w = nullptr;
+        keep = false;
+        kept = nullptr;
         lle = lre = rle = rre = lli = lri = rli = rri = count = 0;
         h = a = r = false;
     }
@@ -659,6 +810,80 @@ public:
         }
     }
 
+    /* The map owns its avlNodes, so it is not copied; call clone instead. */
+public:
+    avlMap( avlMap const& ) = delete;
+
+public:
+    avlMap& operator=( avlMap const& ) = delete;
+
+    /*
+     * This constructor moves a map in O(1) time, which leaves
+     * the other map empty.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the map to move
+     */
+public:
+    avlMap( avlMap&& t ) noexcept : avlMap() {
+        swap( t );
+    }
+
+    /*
+     * This method moves a map in O(1) time by exchanging it with this
+     * map, so that the avlNodes of this map are deleted when the other
+     * map is destroyed.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the map to move
+     */
+public:
+    avlMap& operator=( avlMap&& t ) noexcept {
+        swap( t );
+        return *this;
+    }
+
+    /*
+     * This method exchanges the avlNodes and the rotation counters
+     * of two maps in O(1) time.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the other map
+     */
+public:
+    void swap( avlMap& t ) noexcept {
+        std::swap( root, t.root );
+        std::swap( count, t.count );
+        std::swap( lle, t.lle );
+        std::swap( lre, t.lre );
+        std::swap( rle, t.rle );
+        std::swap( rre, t.rre );
+        std::swap( lli, t.lli );
+        std::swap( lri, t.lri );
+        std::swap( rli, t.rli );
+        std::swap( rri, t.rri );
+    }
+
+    /*
+     * This method copies the shape, keys, values and balances of the map
+     * in one linear pass without any comparisons or rotations. Because an
+     * avlNode constructs its key and value in place, the key and value
+     * types need not be default-constructible, so each avlNode of the copy
+     * is allocated individually rather than from a block of avlNodes.
+     *
+     * @return the copy
+     */
+public:
+    avlMap clone() const {
+        avlMap t;
+        t.root = avlNode::copy( root );
+        t.count = count;
+        return t;
+    }
+
     /* This method returns the number of avlNodes in the map. */
 public:
     size_t size() {
@@ -707,30 +932,155 @@ public:
     
     /*
      * This method searches the map recursively for the existence
-     * of a key, and either inserts the (key, value) as a new avlNode
-     * or updates the value. Then the map is rebalanced if necessary.
+     * of a key, and either inserts a new avlNode or updates the value.
+     * Then the map is rebalanced if necessary. The avlNode is created
+     * only if the key is absent, so the arguments from which the key
+     * and value are constructed are neither copied nor moved otherwise.
      *
-     * Calling parameter:
+     * Calling parameters:
      *
      * @param x (IN) the key to add to the map
-     * 
-     * @return true if update, false if insertion
+     * @param make (IN) a function that creates the avlNode from a height flag
+     * @param update (IN) a function that updates the value of the key if present
+     *
+     * @return a pointer to the value that was added or found
      */
-public:
-    bool insert( K const& x, V const& y ) {
+private:
+    template <typename F, typename G>
+    V* insertKey( K const& x, F make, G update ) {
         h = false, a = false;
         if ( root != nullptr ) {
-            root = root->insert( this, x, y );
+            root = root->insert( this, x, make, update );
             if ( a == false ) {
                 ++count;
             }
         } else {
-            root = new avlNode( x, y, h );
+            root = make( h );
+            w = &(root->value);
             ++count;
         }
+        return w;
+    }
+
+    /*
+     * This method searches the map recursively for the existence
+     * of a key, and either inserts the (key, value) as a new avlNode
+     * or updates the value. Then the map is rebalanced if necessary.
+     * The rvalue overload moves the key and the value into the map.
+     *
+     * Calling parameters:
+     *
+     * @param x (IN) the key to add to the map
+     * @param y (IN) the value to add to the map
+     * 
+     * @return true if update, false if insertion
+     */
+public:
+    bool insert( K const& x, V const& y ) {
+        insertKey( x,
+                   [&]( bool& ht ) { return new avlNode( ht, x, y ); },
+                   [&]( V& v ) { v = y; } );
+        return a;
+    }
+
+public:
+    bool insert( K&& x, V&& y ) {
+        insertKey( x,
+                   [&]( bool& ht ) { return new avlNode( ht, std::move(x), std::move(y) ); },
+                   [&]( V& v ) { v = std::move(y); } );
         return a;
     }
 
+    /*
+     * This method adds a key and a value to the map or, if the key
+     * is present, assigns the value to it, as insert does, but returns
+     * a pointer to the value so that no subsequent find is required.
+     *
+     * Calling parameters:
+     *
+     * @param x (IN) the key to add to the map
+     * @param y (IN) the value to add or assign
+     *
+     * @return a pointer to the value, and true if insertion, false if update
+     */
+public:
+    template <typename M>
+    std::pair<V*, bool> insert_or_assign( K const& x, M&& y ) {
+        V* const p = insertKey( x,
+                                [&]( bool& ht ) { return new avlNode( ht, x, std::forward<M>(y) ); },
+                                [&]( V& v ) { v = std::forward<M>(y); } );
+        return std::make_pair( p, !a );
+    }
+
+public:
+    template <typename M>
+    std::pair<V*, bool> insert_or_assign( K&& x, M&& y ) {
+        V* const p = insertKey( x,
+                                [&]( bool& ht ) { return new avlNode( ht, std::move(x), std::forward<M>(y) ); },
+                                [&]( V& v ) { v = std::forward<M>(y); } );
+        return std::make_pair( p, !a );
+    }
+
+    /*
+     * This method adds a key to the map and constructs its value in
+     * place from the remaining arguments, but only if the key is absent.
+     * If the key is present, neither the key nor the arguments are moved
+     * and the value is unchanged.
+     *
+     * Calling parameters:
+     *
+     * @param x (IN) the key to add to the map
+     * @param y (IN) the arguments from which to construct the value
+     *
+     * @return a pointer to the value, and true if insertion, false if the key was present
+     */
+public:
+    template <typename... Args>
+    std::pair<V*, bool> try_emplace( K const& x, Args&&... y ) {
+        V* const p = insertKey( x,
+                                [&]( bool& ht ) { return new avlNode( ht, x, std::forward<Args>(y)... ); },
+                                []( V& ) {} );
+        return std::make_pair( p, !a );
+    }
+
+public:
+    template <typename... Args>
+    std::pair<V*, bool> try_emplace( K&& x, Args&&... y ) {
+        V* const p = insertKey( x,
+                                [&]( bool& ht ) { return new avlNode( ht, std::move(x), std::forward<Args>(y)... ); },
+                                []( V& ) {} );
+        return std::make_pair( p, !a );
+    }
+
+    /*
+     * This method constructs an avlNode in place, whose key is constructed
+     * from the first argument and whose value is constructed from the
+     * remaining arguments, and then adds the avlNode to the map if its key
+     * is absent. Otherwise, the avlNode is deleted and the map is unchanged.
+     * Unlike try_emplace, the key need not be of type K, but the avlNode is
+     * created even if the key is present.
+     *
+     * Calling parameters:
+     *
+     * @param x (IN) the argument from which to construct the key
+     * @param y (IN) the arguments from which to construct the value
+     *
+     * @return a pointer to the value, and true if insertion, false if the key was present
+     */
+public:
+    template <typename KK, typename... Args>
+    std::pair<V*, bool> emplace( KK&& x, Args&&... y ) {
+        bool ht;
+        avlNode* const n = new avlNode( ht, std::forward<KK>(x), std::forward<Args>(y)... );
+        V* const p = insertKey( n->key,
+                                [&]( bool& hh ) { hh = true; return n; },
+                                []( V& ) {} );
+        if ( a == true ) {
+            delete n;
+        }
+        return std::make_pair( p, !a );
+    }
+
     /*
      * This method removes an avlNode from the map.
      * Then the map is rebalanced if necessary.
@@ -753,6 +1103,126 @@ public:
         return r;
     }
 
+    /*
+     * The node_type class owns an avlNode that extract has removed
+     * from a map, so that the avlNode may be inserted into the same
+     * or another map without deletion, allocation or copying of its
+     * key and value, as for the node handles of std::map. A node_type
+     * that still owns its avlNode when it is destroyed deletes it.
+     */
+public:
+    class node_type {
+
+        friend class avlMap;
+
+    private:
+        avlNode* node;
+
+        explicit node_type( avlNode* const p ) : node( p ) {}
+
+    public:
+        node_type() : node( nullptr ) {}
+
+        node_type( node_type&& n ) noexcept : node( n.node ) {
+            n.node = nullptr;
+        }
+
+        node_type& operator=( node_type&& n ) noexcept {
+            if ( this != &n ) {
+                delete node;
+                node = n.node;
+                n.node = nullptr;
+            }
+            return *this;
+        }
+
+        node_type( node_type const& ) = delete;
+        node_type& operator=( node_type const& ) = delete;
+
+        ~node_type() {
+            delete node;
+        }
+
+        /* This method returns true if the node_type owns no avlNode. */
+        bool empty() const {
+            return ( node == nullptr );
+        }
+
+        explicit operator bool() const {
+            return ( node != nullptr );
+        }
+
+        /*
+         * These methods return the key and the value of the owned
+         * avlNode. The key may be modified before the avlNode is
+         * inserted into a map.
+         */
+        K& key() const {
+            return node->key;
+        }
+
+        V& mapped() const {
+            return node->value;
+        }
+    };
+
+    /*
+     * This method removes an avlNode from the map and returns it
+     * instead of deleting it. Then the map is rebalanced if necessary.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to remove from the map
+     *
+     * @return a node_type that owns the avlNode if the key existed;
+     *         otherwise, an empty node_type
+     */
+public:
+    node_type extract( K const& x ) {
+        h = false, r = false;
+        keep = true, kept = nullptr;
+        if ( root != nullptr ) {
+            root = root->erase( this, x );
+            if ( r == true ) {
+                --count;
+            }
+        }
+        keep = false;
+        return node_type( kept );
+    }
+
+    /*
+     * This method adds the avlNode that a node_type owns to the map,
+     * unless the map contains its key, in which case the node_type
+     * retains the avlNode. Then the map is rebalanced if necessary.
+     *
+     * Calling parameter:
+     *
+     * @param n (MODIFIED) the node_type, which is emptied upon insertion
+     *
+     * @return a pointer to the value of the key, or nullptr if the node_type
+     *         is empty, and true if insertion, false if the key was present
+     */
+public:
+    std::pair<V*, bool> insert( node_type&& n ) {
+        if ( n.node == nullptr ) {
+            return std::make_pair( static_cast<V*>( nullptr ), false );
+        }
+        avlNode* const q = n.node;
+        V* const p = insertKey( q->key,
+                                [&]( bool& ht ) {
+                                    ht = true;
+                                    q->bal = 0;
+                                    q->left = q->right = nullptr;
+                                    return q;
+                                },
+                                []( V& ) {} );
+        if ( a == false ) {
+            n.node = nullptr;
+        }
+        return std::make_pair( p, !a );
+    }
+
     /*
      * This method prints the keys stored in the map, where the
      * key of the root of the map is at the left and the keys of
@@ -775,6 +1245,22 @@ public:
         count = 0;
     }
 
+    /*
+     * This method reports the memory that the AVL map occupies
+     * (see memoryFootprint.h). The map has no freed list.
+     *
+     * @return the live, payload and overhead bytes
+     */
+public:
+    memoryFootprint memoryUsage() {
+        memoryFootprint m;
+        m.addNodes( sizeof(avlNode), count, 0, 0, 0 );
+        if ( ( hasHeapPayload<K>::value || hasHeapPayload<V>::value ) && root != nullptr ) {
+            root->addPayload( m );
+        }
+        return m;
+    }
+
     /*
      * This method walks the map in order and stores each key in a vector.
      *
@@ -789,6 +1275,57 @@ public:
             root->getKeys( v, i );
         }
     }
+
+    /*
+     * This method walks the map in order and stores each value in a vector.
+     * The values are stored in the same order as the keys stored by getKeys().
+     *
+     * Calling parameter:
+     *
+     * @param v (MODIFIED) vector of the values
+     */
+public:
+    void getValues( std::vector<V>& v ) {
+        if ( root != nullptr ) {
+            size_t i = 0;
+            root->getValues( v, i );
+        }
+    }
+
+    /*
+     * This method builds the map in O(n) time from vectors of keys and
+     * values, such as those returned by getKeys() and getValues(), instead
+     * of inserting each (key, value) pair individually.
+     *
+     * Calling parameters:
+     *
+     * @param k (IN) vector of unique keys sorted in increasing order
+     * @param v (IN) vector of values that correspond to the keys
+     */
+public:
+    void bulkLoad( std::vector<K> const& k, std::vector<V> const& v ) {
+        if ( root != nullptr ) {
+            std::ostringstream buffer;
+            buffer << std::endl << "cannot bulk load a map that contains " << count << " keys" << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        if ( k.size() != v.size() ) {
+            std::ostringstream buffer;
+            buffer << std::endl << "number of keys = " << k.size()
+                   << " differs from number of values = " << v.size() << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        for ( size_t i = 1; i < k.size(); ++i ) {
+            if ( !( k[i-1] < k[i] ) ) {
+                std::ostringstream buffer;
+                buffer << std::endl << "keys are not unique and sorted at index " << i << std::endl;
+                throw std::runtime_error(buffer.str());
+            }
+        }
+        int height;
+        root = avlNode::build( k, v, 0, k.size(), height );
+        count = k.size();
+    }
 };
 
 #endif // ADELSON_VELSKII_LANDIS_WIRTH_AVL_MAP_RECURSE_H
@@ -0,0 +1,596 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Durable AVL map that records each insert and erase operation in an
+ * append-only write-ahead log (WAL) prior to applying the operation to
+ * an in-memory avlMap.
+ *
+ * The log records are accumulated in memory and written to the log file
+ * as a group, followed by a single fdatasync, after every groupSize
+ * operations or upon an explicit call to sync(). Hence an operation is
+ * durable only after the group that contains it has been committed, and
+ * a crash loses at most the last groupSize - 1 operations.
+ *
+ * A checkpoint writes a sorted snapshot of the map to a temporary file,
+ * renames that file to replace the prior checkpoint, and then truncates
+ * the log. Checkpoints are taken by calling checkpoint() or automatically
+ * after every checkpointInterval logged operations.
+ *
+ * Recovery bulk-loads the checkpoint via avlMap::bulkLoad() and then
+ * replays the log tail. Each log record carries its length and a checksum
+ * so that a record torn by a crash is detected and truncated. Replay is
+ * idempotent, so a crash between the rename of the checkpoint and the
+ * truncation of the log is harmless.
+ *
+ * Keys and values are serialized by the walCodec template, which copies
+ * the bytes of trivially copyable types and stores a length prefix for
+ * std::string. Specialize walCodec to store other types.
+ *
+ * Compile with a test program, for example, test_avlMapWal.cpp via:
+ *
+ * g++ -std=c++11 -O3 test_avlMapWal.cpp
+ */
+
+#ifndef AVL_MAP_WRITE_AHEAD_LOG_H
+#define AVL_MAP_WRITE_AHEAD_LOG_H
+
+#include "avlMap.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * The walCodec template appends an object to a byte buffer and
+ * extracts an object from a byte buffer. The primary template
+ * handles trivially copyable types such as integers.
+ */
+template <typename T>
+struct walCodec {
+
+    static void put( std::vector<char>& b, T const& x ) {
+        static_assert( std::is_trivially_copyable<T>::value,
+                       "specialize walCodec for a type that is not trivially copyable" );
+        char const* p = reinterpret_cast<char const*>( &x );
+        b.insert( b.end(), p, p + sizeof(T) );
+    }
+
+    static bool get( char const*& p, char const* const end, T& x ) {
+        if ( static_cast<size_t>(end - p) < sizeof(T) ) {
+            return false;
+        }
+        memcpy( &x, p, sizeof(T) );
+        p += sizeof(T);
+        return true;
+    }
+};
+
+/* This specialization stores a 32-bit length followed by the characters. */
+template <>
+struct walCodec<std::string> {
+
+    static void put( std::vector<char>& b, std::string const& x ) {
+        uint32_t const n = static_cast<uint32_t>( x.size() );
+        walCodec<uint32_t>::put( b, n );
+        b.insert( b.end(), x.begin(), x.end() );
+    }
+
+    static bool get( char const*& p, char const* const end, std::string& x ) {
+        uint32_t n;
+        if ( !walCodec<uint32_t>::get( p, end, n ) || static_cast<size_t>(end - p) < n ) {
+            return false;
+        }
+        x.assign( p, n );
+        p += n;
+        return true;
+    }
+};
+
+/*
+ * The avlMapWal class wraps an avlMap and provides the log file,
+ * the group-commit buffer and the checkpoint and recovery methods.
+ */
+template <typename K, typename V>
+class avlMapWal {
+
+private:
+    static uint8_t const INSERT = 1;  /* log record operation codes */
+    static uint8_t const ERASE = 2;
+
+    static size_t const HEADER = 2 * sizeof(uint32_t);  /* length and checksum of a log record */
+
+    avlMap<K, V> m;                   /* the in-memory map */
+    std::string walPath, ckptPath;    /* the log and checkpoint file names */
+    int fd;                           /* the log file descriptor */
+    std::vector<char> buffer;         /* log records that await group commit */
+    size_t groupSize;                 /* the number of operations per group commit */
+    size_t checkpointInterval;        /* the number of logged operations per checkpoint, or 0 */
+    size_t pending;                   /* the number of operations since the last group commit */
+    size_t logged;                    /* the number of operations since the last checkpoint */
+
+public:
+    size_t syncs, checkpoints, replayed;  /* the group commit, checkpoint and replay counters */
+
+    /*
+     * Here is the constructor for the avlMapWal class. It recovers the map
+     * from the checkpoint and log files, if they exist, and then opens the
+     * log file for appending.
+     *
+     * Calling parameters:
+     *
+     * @param path (IN) the prefix of the log (.wal) and checkpoint (.ckpt) file names
+     * @param group (IN) the number of operations per group commit
+     * @param interval (IN) the number of logged operations per checkpoint, or 0 to disable
+     */
+public:
+    avlMapWal( std::string const& path, size_t const group = 1024, size_t const interval = 0 ) {
+        walPath = path + ".wal";
+        ckptPath = path + ".ckpt";
+        groupSize = ( group > 0 ) ? group : 1;
+        checkpointInterval = interval;
+        pending = logged = syncs = checkpoints = replayed = 0;
+        fd = -1;
+        recover();
+        fd = open( walPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644 );
+        if ( fd < 0 ) {
+            fail( "open", walPath );
+        }
+    }
+
+    /* The destructor commits any pending log records. */
+public:
+    ~avlMapWal() {
+        if ( fd >= 0 ) {
+            try {
+                sync();
+            } catch ( std::exception const& e ) {
+                std::cerr << e.what();
+            }
+            close( fd );
+        }
+    }
+
+    /* This method returns the number of keys in the map. */
+public:
+    size_t size() {
+        return m.size();
+    }
+
+    /* This method returns true if there are no keys in the map. */
+public:
+    bool empty() {
+        return m.empty();
+    }
+
+    /*
+     * This method searches the map for the existence of a key.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to search for
+     *
+     * @return true if the key was found; otherwise, false
+     */
+public:
+    bool contains( K const& x ) {
+        return m.contains( x );
+    }
+
+    /*
+     * This method searches the map for the existence of a key
+     * and returns the associated value. Modifying the value via
+     * the returned pointer bypasses the log.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to search for
+     *
+     * @return a pointer to the value if the key was found; otherwise, nullptr
+     */
+public:
+    V* find( K const& x ) {
+        return m.find( x );
+    }
+
+    /*
+     * This method logs an insert operation and then either inserts
+     * the (key, value) into the map or updates the value.
+     *
+     * Calling parameters:
+     *
+     * @param x (IN) the key to add to the map
+     * @param y (IN) the value to add to the map
+     *
+     * @return true if update, false if insertion
+     */
+public:
+    bool insert( K const& x, V const& y ) {
+        size_t const start = beginRecord( INSERT );
+        walCodec<K>::put( buffer, x );
+        walCodec<V>::put( buffer, y );
+        endRecord( start );
+        bool const a = m.insert( x, y );
+        commitIfDue();
+        return a;
+    }
+
+    /*
+     * This method removes a key from the map and logs the erase
+     * operation if the key existed.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to remove from the map
+     *
+     * @return true if the key existed, false if not
+     */
+public:
+    bool erase( K const& x ) {
+        if ( !m.erase( x ) ) {
+            return false;
+        }
+        size_t const start = beginRecord( ERASE );
+        walCodec<K>::put( buffer, x );
+        endRecord( start );
+        commitIfDue();
+        return true;
+    }
+
+    /*
+     * This method writes the pending log records to the log file and
+     * waits for them to reach stable storage (group commit).
+     */
+public:
+    void sync() {
+        if ( !buffer.empty() ) {
+            writeAll( fd, buffer.data(), buffer.size(), walPath );
+            buffer.clear();
+            if ( fdatasync( fd ) != 0 ) {
+                fail( "fdatasync", walPath );
+            }
+            ++syncs;
+        }
+        pending = 0;
+    }
+
+    /*
+     * This method writes a sorted snapshot of the map to the checkpoint
+     * file and then truncates the log. The snapshot is written to a
+     * temporary file that is renamed only after it reaches stable storage,
+     * so the prior checkpoint remains valid if a crash occurs.
+     */
+public:
+    void checkpoint() {
+        sync();
+
+        std::vector<K> keys( m.size() );
+        std::vector<V> values( m.size() );
+        m.getKeys( keys );
+        m.getValues( values );
+
+        std::vector<char> b;
+        b.insert( b.end(), MAGIC, MAGIC + sizeof(MAGIC) );
+        walCodec<uint64_t>::put( b, static_cast<uint64_t>( keys.size() ) );
+        for ( size_t i = 0; i < keys.size(); ++i ) {
+            walCodec<K>::put( b, keys[i] );
+            walCodec<V>::put( b, values[i] );
+        }
+        walCodec<uint32_t>::put( b, checksum( b.data() + sizeof(MAGIC), b.size() - sizeof(MAGIC) ) );
+
+        std::string const tmpPath = ckptPath + ".tmp";
+        int const tfd = open( tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+        if ( tfd < 0 ) {
+            fail( "open", tmpPath );
+        }
+        writeAll( tfd, b.data(), b.size(), tmpPath );
+        if ( fsync( tfd ) != 0 ) {
+            fail( "fsync", tmpPath );
+        }
+        close( tfd );
+        if ( rename( tmpPath.c_str(), ckptPath.c_str() ) != 0 ) {
+            fail( "rename", tmpPath );
+        }
+        syncDirectory();
+
+        if ( ftruncate( fd, 0 ) != 0 ) {
+            fail( "ftruncate", walPath );
+        }
+        if ( fsync( fd ) != 0 ) {
+            fail( "fsync", walPath );
+        }
+        logged = 0;
+        ++checkpoints;
+    }
+
+    /*
+     * This method walks the map in order and stores each key in a vector.
+     *
+     * Calling parameter:
+     *
+     * @param v (MODIFIED) vector of the keys
+     */
+public:
+    void getKeys( std::vector<K>& v ) {
+        m.getKeys( v );
+    }
+
+    /* This method returns the in-memory map, for example, to read its rotation counters. */
+public:
+    avlMap<K, V>& map() {
+        return m;
+    }
+
+private:
+    static char const MAGIC[8];
+
+    /*
+     * This method reserves space for the length and checksum of a log
+     * record and appends the operation code.
+     *
+     * Calling parameter:
+     *
+     * @param op (IN) the operation code
+     *
+     * @return the offset of the record in the buffer
+     */
+private:
+    size_t beginRecord( uint8_t const op ) {
+        size_t const start = buffer.size();
+        buffer.resize( start + HEADER );
+        buffer.push_back( static_cast<char>( op ) );
+        return start;
+    }
+
+    /*
+     * This method fills in the length and checksum of a log record.
+     *
+     * Calling parameter:
+     *
+     * @param start (IN) the offset of the record in the buffer
+     */
+private:
+    void endRecord( size_t const start ) {
+        char* const p = buffer.data() + start;
+        uint32_t const length = static_cast<uint32_t>( buffer.size() - start - HEADER );
+        uint32_t const sum = checksum( p + HEADER, length );
+        memcpy( p, &length, sizeof(length) );
+        memcpy( p + sizeof(length), &sum, sizeof(sum) );
+    }
+
+    /* This method commits the group and takes a checkpoint when either is due. */
+private:
+    void commitIfDue() {
+        ++logged;
+        if ( ++pending >= groupSize ) {
+            sync();
+        }
+        if ( checkpointInterval != 0 && logged >= checkpointInterval ) {
+            checkpoint();
+        }
+    }
+
+    /*
+     * This method bulk-loads the checkpoint file, if it exists, and then
+     * replays the log file, if it exists. A torn record at the tail of
+     * the log is truncated.
+     */
+private:
+    void recover() {
+        std::vector<char> b;
+        if ( readAll( ckptPath, b ) ) {
+            char const* p = b.data();
+            char const* const end = b.data() + b.size();
+            uint64_t n = 0;
+            uint32_t sum;
+            if ( b.size() < sizeof(MAGIC) + sizeof(n) + sizeof(sum)
+                 || memcmp( p, MAGIC, sizeof(MAGIC) ) != 0 ) {
+                corrupt( ckptPath );
+            }
+            memcpy( &sum, end - sizeof(sum), sizeof(sum) );
+            if ( sum != checksum( p + sizeof(MAGIC), b.size() - sizeof(MAGIC) - sizeof(sum) ) ) {
+                corrupt( ckptPath );
+            }
+            p += sizeof(MAGIC);
+            walCodec<uint64_t>::get( p, end, n );
+            std::vector<K> keys( n );
+            std::vector<V> values( n );
+            for ( uint64_t i = 0; i < n; ++i ) {
+                if ( !walCodec<K>::get( p, end, keys[i] ) || !walCodec<V>::get( p, end, values[i] ) ) {
+                    corrupt( ckptPath );
+                }
+            }
+            m.bulkLoad( keys, values );
+        }
+
+        if ( readAll( walPath, b ) ) {
+            char const* p = b.data();
+            char const* const end = b.data() + b.size();
+            K x;
+            V y;
+            while ( static_cast<size_t>(end - p) >= HEADER ) {
+                uint32_t length, sum;
+                memcpy( &length, p, sizeof(length) );
+                memcpy( &sum, p + sizeof(length), sizeof(sum) );
+                if ( length == 0 || static_cast<size_t>(end - p) - HEADER < length
+                     || sum != checksum( p + HEADER, length ) ) {
+                    break;  /* torn record */
+                }
+                char const* q = p + HEADER;
+                char const* const next = q + length;
+                uint8_t const op = static_cast<uint8_t>( *q++ );
+                if ( op == INSERT && walCodec<K>::get( q, next, x ) && walCodec<V>::get( q, next, y ) ) {
+                    m.insert( x, y );
+                } else if ( op == ERASE && walCodec<K>::get( q, next, x ) ) {
+                    m.erase( x );
+                } else {
+                    corrupt( walPath );
+                }
+                ++replayed;
+                p = next;
+            }
+            if ( p != end ) {
+                if ( truncate( walPath.c_str(), p - b.data() ) != 0 ) {
+                    fail( "truncate", walPath );
+                }
+            }
+        }
+        logged = replayed;
+    }
+
+    /*
+     * This method reads an entire file into a buffer.
+     *
+     * Calling parameters:
+     *
+     * @param path (IN) the file name
+     * @param b (MODIFIED) the buffer
+     *
+     * @return true if the file exists; otherwise, false
+     */
+private:
+    static bool readAll( std::string const& path, std::vector<char>& b ) {
+        b.clear();
+        int const rfd = open( path.c_str(), O_RDONLY );
+        if ( rfd < 0 ) {
+            if ( errno == ENOENT ) {
+                return false;
+            }
+            fail( "open", path );
+        }
+        struct stat st;
+        if ( fstat( rfd, &st ) != 0 ) {
+            close( rfd );
+            fail( "fstat", path );
+        }
+        b.resize( st.st_size );
+        size_t done = 0;
+        while ( done < b.size() ) {
+            ssize_t const n = read( rfd, b.data() + done, b.size() - done );
+            if ( n < 0 && errno == EINTR ) {
+                continue;
+            }
+            if ( n <= 0 ) {
+                close( rfd );
+                fail( "read", path );
+            }
+            done += n;
+        }
+        close( rfd );
+        return true;
+    }
+
+    /*
+     * This method writes an entire buffer to a file descriptor.
+     *
+     * Calling parameters:
+     *
+     * @param wfd (IN) the file descriptor
+     * @param p (IN) the buffer
+     * @param n (IN) the number of bytes to write
+     * @param path (IN) the file name for error messages
+     */
+private:
+    static void writeAll( int const wfd, char const* p, size_t n, std::string const& path ) {
+        while ( n > 0 ) {
+            ssize_t const w = write( wfd, p, n );
+            if ( w < 0 ) {
+                if ( errno == EINTR ) {
+                    continue;
+                }
+                fail( "write", path );
+            }
+            p += w;
+            n -= w;
+        }
+    }
+
+    /* This method syncs the directory that contains the checkpoint so that the rename is durable. */
+private:
+    void syncDirectory() {
+        size_t const slash = ckptPath.find_last_of( '/' );
+        std::string const dir = ( slash == std::string::npos ) ? "." : ckptPath.substr( 0, slash + 1 );
+        int const dfd = open( dir.c_str(), O_RDONLY );
+        if ( dfd >= 0 ) {
+            fsync( dfd );
+            close( dfd );
+        }
+    }
+
+    /*
+     * This method computes the 32-bit FNV-1a checksum of a byte range.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the first byte
+     * @param n (IN) the number of bytes
+     *
+     * @return the checksum
+     */
+private:
+    static uint32_t checksum( char const* p, size_t n ) {
+        uint32_t h = 2166136261U;
+        for ( size_t i = 0; i < n; ++i ) {
+            h = ( h ^ static_cast<uint8_t>( p[i] ) ) * 16777619U;
+        }
+        return h;
+    }
+
+private:
+    static void fail( char const* what, std::string const& path ) {
+        std::ostringstream buffer;
+        buffer << std::endl << what << " failed for " << path << ": " << strerror( errno ) << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+
+private:
+    static void corrupt( std::string const& path ) {
+        std::ostringstream buffer;
+        buffer << std::endl << path << " is corrupt" << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+};
+
+template <typename K, typename V>
+char const avlMapWal<K, V>::MAGIC[8] = { 'A', 'V', 'L', 'C', 'K', 'P', 'T', '1' };
+
+#endif // AVL_MAP_WRITE_AHEAD_LOG_H
@@ -64,6 +64,20 @@
  * To preallocate the freed list as a vector of avl tree nodes, compile via:
  * 
  * g++ -std=c++11 -O3 -D PREALLOCATE test_avlTree.cpp
+ *
+ * By default, a node that is erased remains on the freed list until
+ * clear() is called. The freedPolicy function limits the freed list
+ * to the larger of a number of nodes and a fraction of the number of
+ * nodes in the tree, beyond which an erased node is deleted, and the
+ * shrinkToFit function deletes the freed nodes in excess of that limit.
+ * A node that occupies the arena of freedPreallocate or clone is retained
+ * on the freed list regardless of the limit until the tree is empty,
+ * whereupon shrinkToFit releases the arena.
+ *
+ * To count comparisons, search path lengths and rebalancing steps
+ * (see treeStats.h), compile via:
+ *
+ * g++ -std=c++11 -O3 -D ENABLE_TREE_STATS test_avlTree.cpp
  */
 
 #ifndef ADELSON_VELSKII_LANDIS_WIRTH_AVL_TREE_RECURSE_H
@@ -71,9 +85,16 @@
 
 #include <iostream>
 #include <exception>
+#include <functional>
+#include <limits>
 #include <sstream>
+#include <utility>
 #include <vector>
 
+#include "memoryFootprint.h"
+#include "nodeArena.h"
+#include "treeStats.h"
+
 /*
  * The avlTree class defines the root of the AVL tree and stores the
  * lli, lri, rli, rri, lle, lre, rle, and rre rotation counters
@@ -124,14 +145,18 @@ private:
     bool h, a, r;   // record modification of the tree
 
 #ifndef DISABLE_FREED_LIST
-    Node* freed;    // the freed list
-#ifdef PREALLOCATE
-    std::vector<Node> nodes;
-#endif
+    Node* freed;            // the freed list
+    size_t freedCount;      // the number of nodes on the freed list
+    size_t freedMax;        // the number of freed nodes to retain regardless of tree size
+    double freedFraction;   // the fraction of the tree size to retain as freed nodes
 #endif
+    nodeArena<Node> arena;  // the nodes of freedPreallocate and clone
   
 public:
     size_t lle, lre, rle, rre, lli, lri, rli, rri;  // the rotation counters
+#ifdef ENABLE_TREE_STATS
+    treeStats stats;                                // the comparisons and histograms
+#endif
    
 public:
     avlTree() {
@@ -140,6 +165,9 @@ public:
         h = a = r = false;
 #ifndef DISABLE_FREED_LIST
         freed = nullptr;
+        freedCount = 0;
+        freedMax = std::numeric_limits<size_t>::max();
+        freedFraction = 0.;
 #endif
     }
     
@@ -148,6 +176,119 @@ public:
         clear();
     }
 
+    /* The tree owns its nodes, so it is not copied; call clone instead. */
+public:
+    avlTree(avlTree const&) = delete;
+
+public:
+    avlTree& operator=(avlTree const&) = delete;
+
+    /*
+     * Move a tree in O(1) time, which leaves the other tree empty.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    avlTree(avlTree&& t) noexcept : avlTree() {
+        swap(t);
+    }
+
+    /*
+     * Move a tree in O(1) time by exchanging it with this tree, so that
+     * the nodes of this tree are deleted when the other tree is destroyed.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    avlTree& operator=(avlTree&& t) noexcept {
+        swap(t);
+        return *this;
+    }
+
+    /*
+     * Exchange the nodes, freed list, arena and counters of two trees
+     * in O(1) time.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the other tree
+     */
+public:
+    void swap(avlTree& t) noexcept {
+        std::swap(root, t.root);
+        std::swap(count, t.count);
+#ifndef DISABLE_FREED_LIST
+        std::swap(freed, t.freed);
+        std::swap(freedCount, t.freedCount);
+        std::swap(freedMax, t.freedMax);
+        std::swap(freedFraction, t.freedFraction);
+#endif
+        arena.swap(t.arena);
+        std::swap(lle, t.lle);
+        std::swap(lre, t.lre);
+        std::swap(rle, t.rle);
+        std::swap(rre, t.rre);
+        std::swap(lli, t.lli);
+        std::swap(lri, t.lri);
+        std::swap(rli, t.rli);
+        std::swap(rri, t.rri);
+#ifdef ENABLE_TREE_STATS
+        std::swap(stats, t.stats);
+#endif
+    }
+
+    /*
+     * Copy the shape, keys and balances of the tree in one linear pass
+     * that performs no comparisons or rebalancing. The nodes of the copy
+     * are allocated as one block of the arena of the copy.
+     *
+     * @return the copy
+     */
+public:
+    avlTree clone() const {
+        avlTree t;
+        size_t i = 0;
+        t.root = cloneNode(root, t.arena.allocate(count), i);
+        t.count = count;
+        return t;
+    }
+
+    /*
+     * Copy a subtree in pre-order to consecutive nodes of a block.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param block (MODIFIED) the block of nodes
+     * @param i (MODIFIED) the index of the next unused node of the block
+     *
+     * @return the root of the copy of the subtree
+     */
+private:
+    static Node* cloneNode(Node const* const p, Node* const block, size_t& i) {
+        if (p == nullptr) {
+            return nullptr;
+        }
+        Node* const q = block + i++;
+        q->key = p->key;
+        q->bal = p->bal;
+        q->left = cloneNode(p->left, block, i);
+        q->right = cloneNode(p->right, block, i);
+#ifdef PARENT
+        if (q->left != nullptr) {
+            q->left->parent = q;
+        }
+        if (q->right != nullptr) {
+            q->right->parent = q;
+        }
+#endif
+        return q;
+    }
+
     /*
      * Delete every node in the AVL tree.  If the tree has been
      * completely deleted via prior calls to the erase function,
@@ -164,7 +305,9 @@ public:
         }
         clear(p->left);
         clear(p->right);
-        delete p;
+        if ( !inArena(p) ) {
+            delete p;
+        }
     }
     
     /* Delete every node in the AVL tree and on the freed list. */
@@ -176,25 +319,40 @@ public:
 #ifndef DISABLE_FREED_LIST
 	    clearFreed();
 #endif
+        arena.release();
     }
 
     /* Delete every node from the freed list. */
 private:
     void clearFreed() {
 #ifndef DISABLE_FREED_LIST
-#ifndef PREALLOCATE
         while ( freed != nullptr ) {
             Node* next = freed->left;
-            delete freed;
+            if ( !inArena(freed) ) {
+                delete freed;
+            }
             freed = next;
         }
-#else
-        nodes.clear();
-#endif
         freed = nullptr;
+        freedCount = 0;
 #endif
     }
 
+    /*
+     * Determine whether a node occupies the arena of freedPreallocate
+     * or clone, and hence must not be deleted.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node
+     *
+     * @return true if the node occupies the arena; otherwise, false
+     */
+private:
+    inline bool inArena( Node const* const p ) {
+        return arena.contains(p);
+    }
+
     /*
      * Attempt to obtain a node from the freed list instead of
      * creating a new node.
@@ -214,6 +372,7 @@ private:
          {
             Node* p = freed;
             freed = freed->left;
+            --freedCount;
             h = true;    // the height has changed
             p->bal = 0;  // the subtree is balanced at this node
             p->key = x;
@@ -230,7 +389,8 @@ private:
     }
 
     /*
-     * Prepend a node to the freed list instead of deleting it.
+     * Prepend a node to the freed list instead of deleting it,
+     * unless the freed list has reached the limit of freedPolicy.
      *
      * Calling parameter:
      *
@@ -239,25 +399,85 @@ private:
 private:
     inline void deleteNode( Node* q ) {
 #ifndef DISABLE_FREED_LIST
-        q->left = freed;
-        freed = q;
+        if ( freedCount < freedMax || freedCount < freedFraction * count || inArena(q) ) {
+            q->left = freed;
+            freed = q;
+            ++freedCount;
+        } else {
+            delete q;
+        }
 #else
-        delete q;
+        if ( !inArena(q) ) {
+            delete q;
+        }
 #endif
     }
     
     /* Report the number of nodes on the freed list. */
 public:
     size_t freedSize() {
-        size_t count = 0;
- #ifndef DISABLE_FREED_LIST
-       Node* p = freed;
-        while(p != nullptr) {
-            ++count;
-            p = p->left;
+#ifndef DISABLE_FREED_LIST
+        return freedCount;
+#else
+        return 0;
+#endif
+    }
+
+    /*
+     * Limit the number of nodes that the freed list retains to the larger
+     * of a number of nodes and a fraction of the number of nodes in the tree.
+     * The default policy retains every freed node.
+     *
+     * Calling parameters:
+     *
+     * @param maxNodes (IN) the number of nodes to retain regardless of tree size
+     * @param fraction (IN) the fraction of the tree size to retain
+     */
+public:
+    void freedPolicy( size_t const maxNodes, double const fraction ) {
+#ifndef DISABLE_FREED_LIST
+        freedMax = maxNodes;
+        freedFraction = fraction;
+#else
+        (void) maxNodes;
+        (void) fraction;
+#endif
+    }
+
+    /*
+     * Delete the nodes on the freed list in excess of the limit of
+     * freedPolicy. A node that occupies the arena is retained unless
+     * the tree is empty, in which case the arena is released.
+     */
+public:
+    void shrinkToFit() {
+#ifndef DISABLE_FREED_LIST
+        size_t const fraction = static_cast<size_t>(freedFraction * count);
+        size_t const limit = (freedMax > fraction) ? freedMax : fraction;
+        Node* p = freed;
+        freed = nullptr;
+        freedCount = 0;
+        while ( p != nullptr ) {
+            Node* next = p->left;
+            if ( inArena(p) ) {
+                if ( count != 0 ) {
+                    p->left = freed;
+                    freed = p;
+                    ++freedCount;
+                }
+            } else if ( freedCount < limit ) {
+                p->left = freed;
+                freed = p;
+                ++freedCount;
+            } else {
+                delete p;
+            }
+            p = next;
+        }
+        if ( count == 0 ) {
+            arena.release();
         }
 #endif
-        return count;
     }
 
     /*
@@ -276,15 +496,36 @@ public:
             p->left = freed;
             freed = p;
         }
+        freedCount += n;
 #else
-        nodes.resize(n);
+        Node* const block = arena.allocate(n);
         for (size_t i = 0; i < n; ++i) {
-            Node* p = &nodes[i];
+            Node* p = block + i;
             p->left = freed;
             freed = p;
         }
+        freedCount += n;
+#endif
 #endif
+    }
+
+    /*
+     * Report the memory that the AVL tree occupies (see memoryFootprint.h).
+     *
+     * @return the live, freed, reserved, payload and overhead bytes
+     */
+public:
+    memoryFootprint memoryUsage() {
+        memoryFootprint m;
+        size_t const vectorSize = arena.size(), vectorCapacity = arena.capacity();
+        m.addNodes(sizeof(Node), count, freedSize(), vectorSize, vectorCapacity);
+        if (hasHeapPayload<K>::value) {
+            m.addSubtree(root, static_cast<Node*>(nullptr));
+#ifndef DISABLE_FREED_LIST
+            m.addFreed(freed, static_cast<Node*>(nullptr));
 #endif
+        }
+        return m;
     }
 
     /* Return the number of nodes in the AVL tree. */
@@ -326,15 +567,21 @@ private:
     inline bool contains( Node* const p, K const& x) {
 
         Node* q = p;
+        TREE_STATS(size_t length = 0;)
         while ( q != nullptr ) {                    // iterate; don't use recursion
+            TREE_STATS(++length;)
             if ( x < q->key ) {
+                TREE_STATS(++stats.comparisons;)
                 q = q->left;                        // follow the left branch
             } else if ( x > q->key ) {
+                TREE_STATS(stats.comparisons += 2;)
                 q = q->right;                       // follow the right branch
             } else {
+                TREE_STATS(stats.comparisons += 2; treeStats::record(stats.searchLength, length);)
                 return true;                        // found the key, so return true
             }
         }
+        TREE_STATS(treeStats::record(stats.searchLength, length);)
         return false;                               // didn't find the key, so return false
     }
     
@@ -355,6 +602,7 @@ public:
 #ifdef PARENT
     inline bool insert( K const& x ) {
         h = false, a = true;
+        TREE_STATS(stats.steps = 0;)
         if ( root != nullptr ) {
             root = insert( nullptr, root, x );
             if ( a == true ) {
@@ -365,11 +613,13 @@ public:
             root->parent = nullptr;
             ++count;
         }
+        TREE_STATS(if ( a == true ) treeStats::record(stats.insertPropagation, stats.steps);)
         return a;
     }
 #else
     inline bool insert( K const& x ) {
         h = false, a = true;
+        TREE_STATS(stats.steps = 0;)
         if ( root != nullptr ) {
             root = insert( root, x );
             if ( a == true ) {
@@ -379,6 +629,7 @@ public:
             root = newNode( x, h );
             ++count;
         }
+        TREE_STATS(if ( a == true ) treeStats::record(stats.insertPropagation, stats.steps);)
         return a;
     }
 #endif
@@ -396,12 +647,14 @@ public:
 public:
     inline bool erase( K const& x ) {
         h = false, r = false;
+        TREE_STATS(stats.steps = 0;)
         if ( root != nullptr ) {
             root = erase( root, x );
             if ( r == true ) {
                 --count;
             }
         }
+        TREE_STATS(if ( r == true ) treeStats::record(stats.erasePropagation, stats.steps);)
         return r;
     }
 
@@ -416,6 +669,7 @@ public:
      */
 private:
     inline Node* balanceInsertLeft( Node* p ) {
+        TREE_STATS(++stats.steps;)
         switch ( p->bal ) {
             case 1:                         // balance restored
                 p->bal = 0;
@@ -428,6 +682,7 @@ private:
                 Node* p1 = p->left;
                 if ( p1->bal == -1 ) {		// single LL rotation
                     lli++;
+                    TREE_STATS(++stats.rotations;)
                     p->left = p1->right;
 #ifdef PARENT
                     if ( p->left != nullptr ) {
@@ -441,6 +696,7 @@ private:
                     p = p1;
                 } else {			        // double LR rotation
                     lri++;
+                    TREE_STATS(stats.rotations += 2;)
                     Node* p2 = p1->right;
                     p1->right = p2->left;
 #ifdef PARENT
@@ -488,6 +744,7 @@ private:
      */
 private:
     inline Node* balanceInsertRight( Node* p ) {
+        TREE_STATS(++stats.steps;)
         switch ( p->bal ) {
             case -1:                        // balance restored
                 p->bal = 0;
@@ -500,6 +757,7 @@ private:
                 Node* p1 = p->right;
                 if ( p1->bal == 1 ) {       // single RR rotation
                     rri++;
+                    TREE_STATS(++stats.rotations;)
                     p->right = p1->left;
 #ifdef PARENT
                     if ( p->right != nullptr ) {
@@ -513,6 +771,7 @@ private:
                     p = p1;
                 } else {                    // double RL rotation
                     rli++;
+                    TREE_STATS(stats.rotations += 2;)
                     Node* p2 = p1->left;
                     p1->left = p2->right;
 #ifdef PARENT
@@ -569,6 +828,7 @@ public:
     Node* insert( Node* q, Node* p,  K const& x ) {
         
         if ( x < p->key ) {                         // search the left branch?
+            TREE_STATS(++stats.comparisons;)
             if ( p->left != nullptr ) {
                 p->left = insert( p, p->left, x );
             } else {
@@ -581,6 +841,7 @@ public:
                 p = balanceInsertLeft( p );
             }
         } else if ( x > p->key ) {                  // search the right branch?
+            TREE_STATS(stats.comparisons += 2;)
             if ( p->right != nullptr ) {
                 p->right = insert( p, p->right, x );
             } else {
@@ -596,6 +857,7 @@ public:
             // The key is already in the tree.
             // For a tree, don't insert the key twice.
             // For a map, overwrite the value.
+            TREE_STATS(stats.comparisons += 2;)
             h = false;
             a = false;
         }
@@ -606,6 +868,7 @@ public:
     Node* insert( Node* p,  K const& x ) {
         
         if ( x < p->key ) {                         // search the left branch?
+            TREE_STATS(++stats.comparisons;)
             if ( p->left != nullptr ) {
                 p->left = insert( p->left, x );
             } else {
@@ -616,6 +879,7 @@ public:
                 p = balanceInsertLeft( p );
             }
         } else if ( x > p->key ) {                  // search the right branch?
+            TREE_STATS(stats.comparisons += 2;)
             if ( p->right != nullptr ) {
                 p->right = insert( p->right, x );
             } else {
@@ -629,6 +893,7 @@ public:
             // The key is already in the tree.
             // For a tree, don't insert the key twice.
             // For a map, overwrite the value.
+            TREE_STATS(stats.comparisons += 2;)
             h = false;
             a = false;
         }
@@ -649,6 +914,7 @@ public:
 private:
     inline Node* balanceEraseLeft( Node* p ) {
         
+        TREE_STATS(++stats.steps;)
         switch ( p->bal ) {
             case -1:                    // balance restored
                 p->bal = 0;
@@ -661,6 +927,7 @@ private:
                 Node* p1 = p->right;
                 if ( p1->bal >= 0 ) {   // single RR rotation
                     rre++;
+                    TREE_STATS(++stats.rotations;)
                     p->right = p1->left;
 #ifdef PARENT
                     if ( p->right != nullptr ) {
@@ -681,6 +948,7 @@ private:
                     p = p1;
                 } else {				  // double RL rotation
                     rle++;
+                    TREE_STATS(stats.rotations += 2;)
                     Node* p2 = p1->left;
                     p1->left = p2->right;
 #ifdef PARENT
@@ -728,6 +996,7 @@ private:
 private:
     inline Node* balanceEraseRight( Node* p ) {
         
+        TREE_STATS(++stats.steps;)
         switch ( p->bal ) {
             case 1:                     // balance restored
                 p->bal = 0;
@@ -740,6 +1009,7 @@ private:
                 Node* p1 = p->left;
                 if ( p1->bal <= 0 ) {   // single LL rotation
                     lle++;
+                    TREE_STATS(++stats.rotations;)
                     p->left = p1->right;
 #ifdef PARENT
                     if ( p->left != nullptr ) {
@@ -760,6 +1030,7 @@ private:
                     p = p1;
                 } else {				  // double LR rotation
                     lre++;
+                    TREE_STATS(stats.rotations += 2;)
                     Node* p2 = p1->right;
                     p1->right = p2->left;
 #ifdef PARENT
@@ -874,6 +1145,7 @@ public:
     Node* erase( Node* p, K const& x ) {
         
         if ( x < p->key ) {                     // search left branch?
+            TREE_STATS(++stats.comparisons;)
             if ( p->left != nullptr ) {
                 p->left = erase( p->left, x );
                 if ( h ) {
@@ -884,6 +1156,7 @@ public:
                 r = false;
             }
         } else if ( x > p->key ) {              // search right branch?
+            TREE_STATS(stats.comparisons += 2;)
             if ( p->right != nullptr ) {
                 p->right = erase( p->right, x );
                 if ( h ) {
@@ -894,6 +1167,7 @@ public:
                 r = false;
             }
         } else {                                // x == key, so...
+            TREE_STATS(stats.comparisons += 2;)
             Node* q = p;                        // ...select this node for removal
             if ( p->right == nullptr ) {        // if one branch is nullptr...
                 p = p->left;
@@ -0,0 +1,1312 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * In-memory B+ tree that stores many keys per node, so that a search
+ * visits a few nodes of one to four cache lines each instead of one
+ * node per level of a binary tree. It provides the interface of the
+ * AVL and red-black trees so that it may be tested by the same programs.
+ *
+ * Each leaf stores between LEAF_MAX/2 and LEAF_MAX keys in sorted order
+ * and points to the next leaf, and each inner node stores between
+ * INNER_MAX/2 and INNER_MAX separator keys and one more child pointer
+ * than keys, except that the root may store fewer keys. The keys of
+ * child i of an inner node are less than separator i, and the keys of
+ * child i+1 are greater than or equal to separator i. A separator is
+ * not removed when its key is erased from a leaf, because it continues
+ * to separate the keys of the two children.
+ *
+ * Insertion splits a full node into two nodes and inserts a separator
+ * into the parent, which may split in turn. Erasure that leaves a node
+ * with fewer than the minimum number of keys borrows a key from a
+ * sibling via the parent or, if neither sibling can spare a key,
+ * merges the node with a sibling and removes a separator from the
+ * parent, which may merge in turn. The splits, merges and borrows are
+ * counted in lieu of rotations.
+ *
+ * Compile with a test program, for example, test_bplusTree.cpp via:
+ * 
+ * g++ -std=c++11 -O3 test_bplusTree.cpp
+ * 
+ * The size of a node is approximately BPLUS_NODE_SIZE bytes, which is
+ * 256 (4 cache lines of 64 bytes) by default. To select another size,
+ * for example, 1 cache line, compile via:
+ *
+ * g++ -std=c++11 -O3 -D BPLUS_NODE_SIZE=64 test_bplusTree.cpp
+ *
+ * The number of keys per node is derived from the node size and the size
+ * of the key and is at least 4.
+ *
+ * To disable the freed list that avoids re-use of new and delete, compile via:
+ * 
+ * g++ -std=c++11 -O3 -D DISABLE_FREED_LIST test_bplusTree.cpp
+ *
+ * By default, a node that is erased remains on the freed list until
+ * clear() is called. The freedPolicy function limits the freed list
+ * to the larger of a number of nodes and a fraction of the number of
+ * nodes in the tree, beyond which an erased node is deleted, and the
+ * shrinkToFit function deletes the freed nodes in excess of that limit.
+ * A node that occupies the arena of clone is retained on the freed list
+ * regardless of the limit until the tree is empty, whereupon shrinkToFit
+ * releases the arena.
+ *
+ * To count comparisons, search path lengths and rebalancing steps
+ * (see treeStats.h), compile via:
+ *
+ * g++ -std=c++11 -O3 -D ENABLE_TREE_STATS test_bplusTree.cpp
+ */
+
+#ifndef BAYER_MCCREIGHT_BPLUS_TREE_H
+#define BAYER_MCCREIGHT_BPLUS_TREE_H
+
+#include <cstdint>
+#include <iostream>
+#include <exception>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "memoryFootprint.h"
+#include "nodeArena.h"
+#include "treeStats.h"
+
+#ifndef BPLUS_NODE_SIZE
+#define BPLUS_NODE_SIZE 256
+#endif
+
+/*
+ * The bplusTree class defines the root of the B+ tree and stores
+ * the split, merge and borrow counters.
+ */
+template <typename K>
+class bplusTree
+{
+private:
+    enum : size_t {
+        // A leaf comprises a header of 16 bytes and its keys.
+        LEAF_KEYS = (BPLUS_NODE_SIZE - 16) / sizeof(K),
+        LEAF_MAX = (LEAF_KEYS < 4) ? 4 : LEAF_KEYS,
+        LEAF_MIN = LEAF_MAX / 2,
+        // An inner node comprises a header of 8 bytes, one child pointer,
+        // and a key and another child pointer per separator.
+        INNER_KEYS = (BPLUS_NODE_SIZE - 8 - sizeof(void*)) / (sizeof(K) + sizeof(void*)),
+        INNER_MAX = (INNER_KEYS < 4) ? 4 : INNER_KEYS,
+        INNER_MIN = INNER_MAX / 2
+    };
+
+private:
+    struct Node {
+        uint16_t n;     // the number of keys
+        bool leaf;      // true for a leaf, false for an inner node
+    };
+
+    struct Leaf : Node {
+        Leaf* next;             // the next leaf in key order
+        K keys[LEAF_MAX];       // the keys in increasing order
+
+        Leaf() {
+            this->n = 0;
+            this->leaf = true;
+            next = nullptr;
+        }
+    };
+
+    struct Inner : Node {
+        K keys[INNER_MAX];              // the separators in increasing order
+        Node* child[INNER_MAX + 1];     // the children
+
+        Inner() {
+            this->n = 0;
+            this->leaf = false;
+        }
+    };
+
+    /* Return the size of a leaf, which stores the keys. */
+public:
+    size_t nodeSize() {
+        return sizeof(Leaf);
+    }
+
+    /* Return the size of an inner node. */
+public:
+    size_t innerSize() {
+        return sizeof(Inner);
+    }
+
+private:
+    Node* root;         // the root of the tree
+    size_t count;       // the number of keys in the tree
+    size_t leafCount;   // the number of leaves in the tree
+    size_t innerCount;  // the number of inner nodes in the tree
+
+#ifndef DISABLE_FREED_LIST
+    Leaf* freedLeaves;      // the freed list of leaves, linked via next
+    Inner* freedInners;     // the freed list of inner nodes, linked via child[0]
+    size_t freedCount;      // the number of nodes on the freed lists
+    size_t freedMax;        // the number of freed nodes to retain regardless of tree size
+    double freedFraction;   // the fraction of the tree size to retain as freed nodes
+#endif
+    nodeArena<Leaf> leafArena;      // the leaves of clone
+    nodeArena<Inner> innerArena;    // the inner nodes of clone
+
+public:
+    size_t splits, merges, borrows;     // the restructuring counters
+#ifdef ENABLE_TREE_STATS
+    treeStats stats;                    // the comparisons and histograms
+#endif
+
+public:
+    bplusTree() {
+        root = nullptr;
+        count = leafCount = innerCount = 0;
+        splits = merges = borrows = 0;
+#ifndef DISABLE_FREED_LIST
+        freedLeaves = nullptr;
+        freedInners = nullptr;
+        freedCount = 0;
+        freedMax = std::numeric_limits<size_t>::max();
+        freedFraction = 0.;
+#endif
+    }
+
+public:
+    ~bplusTree() {
+        clear();
+    }
+
+    /* The tree owns its nodes, so it is not copied; call clone instead. */
+public:
+    bplusTree(bplusTree const&) = delete;
+
+public:
+    bplusTree& operator=(bplusTree const&) = delete;
+
+    /*
+     * Move a tree in O(1) time, which leaves the other tree empty.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    bplusTree(bplusTree&& t) noexcept : bplusTree() {
+        swap(t);
+    }
+
+    /*
+     * Move a tree in O(1) time by exchanging it with this tree, so that
+     * the nodes of this tree are deleted when the other tree is destroyed.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    bplusTree& operator=(bplusTree&& t) noexcept {
+        swap(t);
+        return *this;
+    }
+
+    /*
+     * Exchange the nodes, freed lists, arenas and counters of two trees
+     * in O(1) time.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the other tree
+     */
+public:
+    void swap(bplusTree& t) noexcept {
+        std::swap(root, t.root);
+        std::swap(count, t.count);
+        std::swap(leafCount, t.leafCount);
+        std::swap(innerCount, t.innerCount);
+#ifndef DISABLE_FREED_LIST
+        std::swap(freedLeaves, t.freedLeaves);
+        std::swap(freedInners, t.freedInners);
+        std::swap(freedCount, t.freedCount);
+        std::swap(freedMax, t.freedMax);
+        std::swap(freedFraction, t.freedFraction);
+#endif
+        leafArena.swap(t.leafArena);
+        innerArena.swap(t.innerArena);
+        std::swap(splits, t.splits);
+        std::swap(merges, t.merges);
+        std::swap(borrows, t.borrows);
+#ifdef ENABLE_TREE_STATS
+        std::swap(stats, t.stats);
+#endif
+    }
+
+    /*
+     * Copy the shape and keys of the tree in one linear pass that performs
+     * no comparisons, splits or merges. The leaves and the inner nodes of
+     * the copy are allocated as one block of each arena of the copy, and
+     * because the leaves are copied in key order, each leaf of the copy
+     * is followed by the next leaf of its block.
+     *
+     * @return the copy
+     */
+public:
+    bplusTree clone() const {
+        bplusTree t;
+        if ( root != nullptr ) {
+            Leaf* const leaves = t.leafArena.allocate(leafCount);
+            Inner* const inners = t.innerArena.allocate(innerCount);
+            size_t l = 0, i = 0;
+            t.root = cloneNode(root, leaves, l, inners, i);
+            for ( size_t j = 1; j < leafCount; ++j ) {
+                leaves[j - 1].next = leaves + j;
+            }
+        }
+        t.count = count;
+        t.leafCount = leafCount;
+        t.innerCount = innerCount;
+        return t;
+    }
+
+    /*
+     * Copy a subtree in pre-order to consecutive leaves and inner nodes
+     * of two blocks.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param leaves (MODIFIED) the block of leaves
+     * @param l (MODIFIED) the index of the next unused leaf of the block
+     * @param inners (MODIFIED) the block of inner nodes
+     * @param i (MODIFIED) the index of the next unused inner node of the block
+     *
+     * @return the root of the copy of the subtree
+     */
+private:
+    static Node* cloneNode( Node const* const p, Leaf* const leaves, size_t& l,
+                            Inner* const inners, size_t& i ) {
+        if ( p->leaf ) {
+            Leaf const* const r = static_cast<Leaf const*>(p);
+            Leaf* const q = leaves + l++;
+            q->n = r->n;
+            for ( size_t j = 0; j < r->n; ++j ) {
+                q->keys[j] = r->keys[j];
+            }
+            return q;
+        }
+        Inner const* const r = static_cast<Inner const*>(p);
+        Inner* const q = inners + i++;
+        q->n = r->n;
+        for ( size_t j = 0; j < r->n; ++j ) {
+            q->keys[j] = r->keys[j];
+        }
+        for ( size_t j = 0; j <= r->n; ++j ) {
+            q->child[j] = cloneNode( r->child[j], leaves, l, inners, i );
+        }
+        return q;
+    }
+
+    /*
+     * Delete every node in a subtree.
+     * 
+     * Calling parameter:
+     * 
+     * @param p (IN) the root of the subtree at this level of recursion
+     */
+private:
+    void clear( Node* const p ) {
+        if ( p->leaf ) {
+            Leaf* const q = static_cast<Leaf*>(p);
+            if ( !inArena(q) ) {
+                delete q;
+            }
+        } else {
+            Inner* const q = static_cast<Inner*>(p);
+            for ( size_t i = 0; i <= q->n; ++i ) {
+                clear( q->child[i] );
+            }
+            if ( !inArena(q) ) {
+                delete q;
+            }
+        }
+    }
+
+    /* Delete every node in the B+ tree and on the freed lists. */
+public:
+    void clear() {
+        if ( root != nullptr ) {
+            clear( root );
+        }
+        root = nullptr;
+        count = leafCount = innerCount = 0;
+#ifndef DISABLE_FREED_LIST
+        clearFreed();
+#endif
+        leafArena.release();
+        innerArena.release();
+    }
+
+    /* Delete every node from the freed lists. */
+private:
+    void clearFreed() {
+#ifndef DISABLE_FREED_LIST
+        while ( freedLeaves != nullptr ) {
+            Leaf* next = freedLeaves->next;
+            if ( !inArena(freedLeaves) ) {
+                delete freedLeaves;
+            }
+            freedLeaves = next;
+        }
+        while ( freedInners != nullptr ) {
+            Inner* next = static_cast<Inner*>(freedInners->child[0]);
+            if ( !inArena(freedInners) ) {
+                delete freedInners;
+            }
+            freedInners = next;
+        }
+        freedCount = 0;
+#endif
+    }
+
+    /*
+     * Determine whether a leaf occupies the arena of clone,
+     * and hence must not be deleted.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the leaf
+     *
+     * @return true if the leaf occupies the arena; otherwise, false
+     */
+private:
+    inline bool inArena( Leaf const* const p ) {
+        return leafArena.contains(p);
+    }
+
+    /*
+     * Determine whether an inner node occupies the arena of clone,
+     * and hence must not be deleted.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the inner node
+     *
+     * @return true if the inner node occupies the arena; otherwise, false
+     */
+private:
+    inline bool inArena( Inner const* const p ) {
+        return innerArena.contains(p);
+    }
+
+    /* Obtain a leaf from the freed list instead of creating a new leaf. */
+private:
+    inline Leaf* newLeaf() {
+#ifndef DISABLE_FREED_LIST
+        if ( freedLeaves != nullptr ) {
+            Leaf* p = freedLeaves;
+            freedLeaves = p->next;
+            --freedCount;
+            p->n = 0;
+            p->next = nullptr;
+            ++leafCount;
+            return p;
+        }
+#endif
+        ++leafCount;
+        return new Leaf();
+    }
+
+    /* Obtain an inner node from the freed list instead of creating a new one. */
+private:
+    inline Inner* newInner() {
+#ifndef DISABLE_FREED_LIST
+        if ( freedInners != nullptr ) {
+            Inner* p = freedInners;
+            freedInners = static_cast<Inner*>(p->child[0]);
+            --freedCount;
+            p->n = 0;
+            ++innerCount;
+            return p;
+        }
+#endif
+        ++innerCount;
+        return new Inner();
+    }
+
+    /* Return true if the freed lists may retain another node. */
+private:
+    inline bool retainFreed() {
+#ifndef DISABLE_FREED_LIST
+        return freedCount < freedMax || freedCount < freedFraction * (leafCount + innerCount);
+#else
+        return false;
+#endif
+    }
+
+    /*
+     * Prepend a leaf to the freed list instead of deleting it,
+     * unless the freed lists have reached the limit of freedPolicy
+     * and the leaf does not occupy the arena.
+     *
+     * Calling parameter:
+     *
+     * @param q (IN) pointer to the leaf
+     */
+private:
+    inline void deleteNode( Leaf* q ) {
+        --leafCount;
+#ifndef DISABLE_FREED_LIST
+        if ( retainFreed() || inArena(q) ) {
+            q->next = freedLeaves;
+            freedLeaves = q;
+            ++freedCount;
+            return;
+        }
+#endif
+        if ( !inArena(q) ) {
+            delete q;
+        }
+    }
+
+    /*
+     * Prepend an inner node to the freed list instead of deleting it,
+     * unless the freed lists have reached the limit of freedPolicy
+     * and the inner node does not occupy the arena.
+     *
+     * Calling parameter:
+     *
+     * @param q (IN) pointer to the inner node
+     */
+private:
+    inline void deleteNode( Inner* q ) {
+        --innerCount;
+#ifndef DISABLE_FREED_LIST
+        if ( retainFreed() || inArena(q) ) {
+            q->child[0] = freedInners;
+            freedInners = q;
+            ++freedCount;
+            return;
+        }
+#endif
+        if ( !inArena(q) ) {
+            delete q;
+        }
+    }
+
+    /* Report the number of nodes on the freed lists. */
+public:
+    size_t freedSize() {
+#ifndef DISABLE_FREED_LIST
+        return freedCount;
+#else
+        return 0;
+#endif
+    }
+
+    /*
+     * Prepend to the freed lists the leaves and inner nodes that
+     * suffice to store the specified number of keys at the minimum
+     * occupancy, so that no node is created while the tree grows
+     * to that number of keys.
+     *
+     * Calling parameters:
+     *
+     * @param n (IN) the number of keys
+     */
+public:
+    void freedPreallocate( size_t const n ) {
+#ifndef DISABLE_FREED_LIST
+        size_t nodes = n / LEAF_MIN + 1;
+        for (size_t i = 0; i < nodes; ++i) {
+            Leaf* p = new Leaf();
+            p->next = freedLeaves;
+            freedLeaves = p;
+        }
+        freedCount += nodes;
+        while ( nodes > 1 ) {
+            nodes = nodes / (INNER_MIN + 1) + 1;
+            for (size_t i = 0; i < nodes; ++i) {
+                Inner* p = new Inner();
+                p->child[0] = freedInners;
+                freedInners = p;
+            }
+            freedCount += nodes;
+        }
+#endif
+    }
+
+    /*
+     * Limit the number of nodes that the freed lists retain to the larger
+     * of a number of nodes and a fraction of the number of nodes in the tree.
+     * The default policy retains every freed node.
+     *
+     * Calling parameters:
+     *
+     * @param maxNodes (IN) the number of nodes to retain regardless of tree size
+     * @param fraction (IN) the fraction of the tree size to retain
+     */
+public:
+    void freedPolicy( size_t const maxNodes, double const fraction ) {
+#ifndef DISABLE_FREED_LIST
+        freedMax = maxNodes;
+        freedFraction = fraction;
+#else
+        (void) maxNodes;
+        (void) fraction;
+#endif
+    }
+
+    /*
+     * Delete the nodes on the freed lists in excess of the limit of
+     * freedPolicy, deleting inner nodes before leaves. A node that
+     * occupies an arena is retained unless the tree is empty, in which
+     * case the arenas are released.
+     */
+public:
+    void shrinkToFit() {
+#ifndef DISABLE_FREED_LIST
+        size_t const fraction = static_cast<size_t>(freedFraction * (leafCount + innerCount));
+        size_t const limit = (freedMax > fraction) ? freedMax : fraction;
+        Leaf* p = freedLeaves;
+        Inner* q = freedInners;
+        freedLeaves = nullptr;
+        freedInners = nullptr;
+        freedCount = 0;
+        while ( p != nullptr ) {
+            Leaf* next = p->next;
+            if ( inArena(p) ) {
+                if ( count != 0 ) {
+                    p->next = freedLeaves;
+                    freedLeaves = p;
+                    ++freedCount;
+                }
+            } else if ( freedCount < limit ) {
+                p->next = freedLeaves;
+                freedLeaves = p;
+                ++freedCount;
+            } else {
+                delete p;
+            }
+            p = next;
+        }
+        while ( q != nullptr ) {
+            Inner* next = static_cast<Inner*>(q->child[0]);
+            if ( inArena(q) ) {
+                if ( count != 0 ) {
+                    q->child[0] = freedInners;
+                    freedInners = q;
+                    ++freedCount;
+                }
+            } else if ( freedCount < limit ) {
+                q->child[0] = freedInners;
+                freedInners = q;
+                ++freedCount;
+            } else {
+                delete q;
+            }
+            q = next;
+        }
+        if ( count == 0 ) {
+            leafArena.release();
+            innerArena.release();
+        }
+#endif
+    }
+
+    /*
+     * Add the heap memory that the keys of a subtree own.
+     *
+     * Calling parameters:
+     *
+     * @param m (MODIFIED) the memory footprint
+     * @param p (IN) the root of the subtree at this level of recursion
+     */
+private:
+    void addPayload( memoryFootprint& m, Node const* const p ) {
+        if ( p->leaf ) {
+            Leaf const* const q = static_cast<Leaf const*>(p);
+            for ( size_t i = 0; i < q->n; ++i ) {
+                m.addPayload( q->keys[i] );
+            }
+        } else {
+            Inner const* const q = static_cast<Inner const*>(p);
+            for ( size_t i = 0; i < q->n; ++i ) {
+                m.addPayload( q->keys[i] );
+            }
+            for ( size_t i = 0; i <= q->n; ++i ) {
+                addPayload( m, q->child[i] );
+            }
+        }
+    }
+
+    /*
+     * Report the memory that the B+ tree occupies (see memoryFootprint.h),
+     * where the unused key slots of a node are included in its size.
+     * Keys that remain in freed nodes are not included in the payload.
+     *
+     * @return the live, freed, reserved, payload and overhead bytes
+     */
+public:
+    memoryFootprint memoryUsage() {
+        memoryFootprint m;
+        size_t freedLeafCount = 0, freedInnerCount = 0;
+#ifndef DISABLE_FREED_LIST
+        for ( Leaf const* p = freedLeaves; p != nullptr; p = p->next ) {
+            ++freedLeafCount;
+        }
+        freedInnerCount = freedCount - freedLeafCount;
+#endif
+        m.addNodes(sizeof(Leaf), leafCount, freedLeafCount, leafArena.size(), leafArena.capacity());
+        m.addNodes(sizeof(Inner), innerCount, freedInnerCount, innerArena.size(), innerArena.capacity());
+        if ( hasHeapPayload<K>::value && root != nullptr ) {
+            addPayload( m, root );
+        }
+        return m;
+    }
+
+    /* Return the number of keys in the B+ tree. */
+public:
+    size_t size() {
+        return count;
+    }
+
+    /* Return true if there are no keys in the B+ tree. */
+public:
+    bool empty() {
+        return ( count == 0 );
+    }
+
+    /*
+     * Find the first key of a node that is greater than or equal to
+     * a key via binary search.
+     *
+     * Calling parameters:
+     *
+     * @param keys (IN) the keys of the node
+     * @param n (IN) the number of keys
+     * @param x (IN) the key to search for
+     *
+     * @return the index of the first key >= x, or n if there is none
+     */
+private:
+    inline size_t lowerBound( K const* const keys, size_t const n, K const& x ) {
+        size_t lo = 0, hi = n;
+        while ( lo < hi ) {
+            size_t const mid = (lo + hi) >> 1;
+            TREE_STATS(++stats.comparisons;)
+            if ( keys[mid] < x ) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    /*
+     * Find the first key of a node that is greater than a key via
+     * binary search, which is the index of the child to descend to.
+     *
+     * Calling parameters:
+     *
+     * @param keys (IN) the keys of the node
+     * @param n (IN) the number of keys
+     * @param x (IN) the key to search for
+     *
+     * @return the index of the first key > x, or n if there is none
+     */
+private:
+    inline size_t upperBound( K const* const keys, size_t const n, K const& x ) {
+        size_t lo = 0, hi = n;
+        while ( lo < hi ) {
+            size_t const mid = (lo + hi) >> 1;
+            TREE_STATS(++stats.comparisons;)
+            if ( x < keys[mid] ) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        return lo;
+    }
+
+    /*
+     * Search the tree for the existence of a key.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to search for
+     * 
+     * @return true if the key was found; otherwise, false
+     */
+public:
+    inline bool contains( K const& x ) {
+        Node* p = root;
+        if ( p == nullptr ) {
+            TREE_STATS(treeStats::record(stats.searchLength, 0);)
+            return false;
+        }
+        TREE_STATS(size_t length = 1;)
+        while ( !p->leaf ) {                        // iterate; don't use recursion
+            Inner* const q = static_cast<Inner*>(p);
+            p = q->child[ upperBound( q->keys, q->n, x ) ];
+            TREE_STATS(++length;)
+        }
+        Leaf* const q = static_cast<Leaf*>(p);
+        size_t const i = lowerBound( q->keys, q->n, x );
+        TREE_STATS(if ( i < q->n ) ++stats.comparisons; treeStats::record(stats.searchLength, length);)
+        return ( i < q->n && !(x < q->keys[i]) );
+    }
+
+    /*
+     * Insert a key into a subtree, splitting the nodes that overflow.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param x (IN) the key to add to the tree
+     * @param up (MODIFIED) the separator for the parent if p was split
+     * @param right (MODIFIED) the new right sibling if p was split, or nullptr
+     *
+     * @return true if the key was added; otherwise, false
+     */
+private:
+    bool insert( Node* const p, K const& x, K& up, Node*& right ) {
+
+        right = nullptr;
+        if ( p->leaf ) {
+            Leaf* const q = static_cast<Leaf*>(p);
+            size_t const i = lowerBound( q->keys, q->n, x );
+            TREE_STATS(if ( i < q->n ) ++stats.comparisons;)
+            if ( i < q->n && !(x < q->keys[i]) ) {
+                return false;                       // the key is already in the tree
+            }
+            if ( q->n < LEAF_MAX ) {
+                for ( size_t j = q->n; j > i; --j ) {
+                    q->keys[j] = q->keys[j - 1];
+                }
+                q->keys[i] = x;
+                ++q->n;
+                return true;
+            }
+
+            // Split the full leaf, leaving the lower half in q.
+            TREE_STATS(++stats.steps;)
+            ++splits;
+            Leaf* const r = newLeaf();
+            size_t const half = (LEAF_MAX + 1) / 2;
+            if ( i < half ) {
+                for ( size_t j = half - 1; j < LEAF_MAX; ++j ) {
+                    r->keys[j - (half - 1)] = q->keys[j];
+                }
+                for ( size_t j = half - 1; j > i; --j ) {
+                    q->keys[j] = q->keys[j - 1];
+                }
+                q->keys[i] = x;
+            } else {
+                size_t k = 0;
+                for ( size_t j = half; j < LEAF_MAX; ++j ) {
+                    if ( j == i ) {
+                        r->keys[k++] = x;
+                    }
+                    r->keys[k++] = q->keys[j];
+                }
+                if ( i == LEAF_MAX ) {
+                    r->keys[k++] = x;
+                }
+            }
+            q->n = half;
+            r->n = LEAF_MAX + 1 - half;
+            r->next = q->next;
+            q->next = r;
+            up = r->keys[0];
+            right = r;
+            return true;
+        }
+
+        Inner* const q = static_cast<Inner*>(p);
+        size_t const i = upperBound( q->keys, q->n, x );
+        K childUp;
+        Node* childRight;
+        if ( !insert( q->child[i], x, childUp, childRight ) ) {
+            return false;
+        }
+        if ( childRight == nullptr ) {
+            return true;
+        }
+
+        // Insert the separator and the new child, splitting q if it is full.
+        if ( q->n < INNER_MAX ) {
+            for ( size_t j = q->n; j > i; --j ) {
+                q->keys[j] = q->keys[j - 1];
+                q->child[j + 1] = q->child[j];
+            }
+            q->keys[i] = childUp;
+            q->child[i + 1] = childRight;
+            ++q->n;
+            return true;
+        }
+        TREE_STATS(++stats.steps;)
+        ++splits;
+        K keys[INNER_MAX + 1];
+        Node* child[INNER_MAX + 2];
+        for ( size_t j = 0, k = 0; j <= INNER_MAX; ++j ) {
+            if ( j == i ) {
+                keys[j] = childUp;
+            } else {
+                keys[j] = q->keys[k++];
+            }
+        }
+        for ( size_t j = 0, k = 0; j <= INNER_MAX + 1; ++j ) {
+            if ( j == i + 1 ) {
+                child[j] = childRight;
+            } else {
+                child[j] = q->child[k++];
+            }
+        }
+        Inner* const r = newInner();
+        size_t const half = INNER_MAX / 2;
+        for ( size_t j = 0; j < half; ++j ) {
+            q->keys[j] = keys[j];
+            q->child[j] = child[j];
+        }
+        q->child[half] = child[half];
+        q->n = half;
+        up = keys[half];
+        for ( size_t j = half + 1; j <= INNER_MAX; ++j ) {
+            r->keys[j - half - 1] = keys[j];
+            r->child[j - half - 1] = child[j];
+        }
+        r->child[INNER_MAX - half] = child[INNER_MAX + 1];
+        r->n = INNER_MAX - half;
+        right = r;
+        return true;
+    }
+
+    /*
+     * Search the tree for the existence of a key.
+     * If the key is not found, it is is added to
+     * the tree. If the key is found, it is ignored.
+     * Then the tree is rebalanced if necessary.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to add to the tree
+     * 
+     * @return true if the key was added; otherwise, false
+     */
+public:
+    inline bool insert( K const& x ) {
+        TREE_STATS(stats.steps = 0;)
+        if ( root == nullptr ) {
+            Leaf* const q = newLeaf();
+            q->keys[0] = x;
+            q->n = 1;
+            root = q;
+            ++count;
+            TREE_STATS(treeStats::record(stats.insertPropagation, stats.steps);)
+            return true;
+        }
+        K up;
+        Node* right;
+        if ( !insert( root, x, up, right ) ) {
+            return false;
+        }
+        if ( right != nullptr ) {                   // the root was split, so grow the tree
+            Inner* const q = newInner();
+            q->keys[0] = up;
+            q->child[0] = root;
+            q->child[1] = right;
+            q->n = 1;
+            root = q;
+        }
+        ++count;
+        TREE_STATS(treeStats::record(stats.insertPropagation, stats.steps);)
+        return true;
+    }
+
+    /*
+     * Restore the minimum occupancy of a child of an inner node by
+     * borrowing a key from a sibling or by merging with a sibling.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the parent
+     * @param i (IN) the index of the child that has too few keys
+     */
+private:
+    void rebalance( Inner* const p, size_t const i ) {
+
+        TREE_STATS(++stats.steps;)
+        if ( p->child[i]->leaf ) {
+            Leaf* const c = static_cast<Leaf*>(p->child[i]);
+            Leaf* const left = (i > 0) ? static_cast<Leaf*>(p->child[i - 1]) : nullptr;
+            Leaf* const right = (i < p->n) ? static_cast<Leaf*>(p->child[i + 1]) : nullptr;
+            if ( left != nullptr && left->n > LEAF_MIN ) {          // borrow from the left
+                ++borrows;
+                for ( size_t j = c->n; j > 0; --j ) {
+                    c->keys[j] = c->keys[j - 1];
+                }
+                c->keys[0] = left->keys[--left->n];
+                ++c->n;
+                p->keys[i - 1] = c->keys[0];
+            } else if ( right != nullptr && right->n > LEAF_MIN ) { // borrow from the right
+                ++borrows;
+                c->keys[c->n++] = right->keys[0];
+                --right->n;
+                for ( size_t j = 0; j < right->n; ++j ) {
+                    right->keys[j] = right->keys[j + 1];
+                }
+                p->keys[i] = right->keys[0];
+            } else {                                                // merge
+                ++merges;
+                Leaf* const l = (left != nullptr) ? left : c;
+                Leaf* const r = (left != nullptr) ? c : right;
+                size_t const k = (left != nullptr) ? i - 1 : i;     // the separator of l and r
+                for ( size_t j = 0; j < r->n; ++j ) {
+                    l->keys[l->n + j] = r->keys[j];
+                }
+                l->n += r->n;
+                l->next = r->next;
+                removeSeparator( p, k );
+                deleteNode( r );
+            }
+        } else {
+            Inner* const c = static_cast<Inner*>(p->child[i]);
+            Inner* const left = (i > 0) ? static_cast<Inner*>(p->child[i - 1]) : nullptr;
+            Inner* const right = (i < p->n) ? static_cast<Inner*>(p->child[i + 1]) : nullptr;
+            if ( left != nullptr && left->n > INNER_MIN ) {         // borrow from the left
+                ++borrows;
+                c->child[c->n + 1] = c->child[c->n];
+                for ( size_t j = c->n; j > 0; --j ) {
+                    c->keys[j] = c->keys[j - 1];
+                    c->child[j] = c->child[j - 1];
+                }
+                c->keys[0] = p->keys[i - 1];
+                c->child[0] = left->child[left->n];
+                ++c->n;
+                p->keys[i - 1] = left->keys[--left->n];
+            } else if ( right != nullptr && right->n > INNER_MIN ) { // borrow from the right
+                ++borrows;
+                c->keys[c->n] = p->keys[i];
+                c->child[++c->n] = right->child[0];
+                p->keys[i] = right->keys[0];
+                --right->n;
+                for ( size_t j = 0; j < right->n; ++j ) {
+                    right->keys[j] = right->keys[j + 1];
+                    right->child[j] = right->child[j + 1];
+                }
+                right->child[right->n] = right->child[right->n + 1];
+            } else {                                                // merge
+                ++merges;
+                Inner* const l = (left != nullptr) ? left : c;
+                Inner* const r = (left != nullptr) ? c : right;
+                size_t const k = (left != nullptr) ? i - 1 : i;     // the separator of l and r
+                l->keys[l->n] = p->keys[k];
+                for ( size_t j = 0; j < r->n; ++j ) {
+                    l->keys[l->n + 1 + j] = r->keys[j];
+                    l->child[l->n + 1 + j] = r->child[j];
+                }
+                l->child[l->n + 1 + r->n] = r->child[r->n];
+                l->n += 1 + r->n;
+                removeSeparator( p, k );
+                deleteNode( r );
+            }
+        }
+    }
+
+    /*
+     * Remove a separator and the child to its right from an inner node.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the inner node
+     * @param k (IN) the index of the separator
+     */
+private:
+    inline void removeSeparator( Inner* const p, size_t const k ) {
+        for ( size_t j = k; j + 1 < p->n; ++j ) {
+            p->keys[j] = p->keys[j + 1];
+            p->child[j + 1] = p->child[j + 2];
+        }
+        --p->n;
+    }
+
+    /*
+     * Remove a key from a subtree, restoring the minimum occupancy
+     * of the children of each inner node along the path.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param x (IN) the key to remove from the tree
+     *
+     * @return true if the key was removed; otherwise, false
+     */
+private:
+    bool erase( Node* const p, K const& x ) {
+
+        if ( p->leaf ) {
+            Leaf* const q = static_cast<Leaf*>(p);
+            size_t const i = lowerBound( q->keys, q->n, x );
+            TREE_STATS(if ( i < q->n ) ++stats.comparisons;)
+            if ( i == q->n || x < q->keys[i] ) {
+                return false;                       // the key is not in the tree
+            }
+            --q->n;
+            for ( size_t j = i; j < q->n; ++j ) {
+                q->keys[j] = q->keys[j + 1];
+            }
+            return true;
+        }
+
+        Inner* const q = static_cast<Inner*>(p);
+        size_t const i = upperBound( q->keys, q->n, x );
+        if ( !erase( q->child[i], x ) ) {
+            return false;
+        }
+        Node* const c = q->child[i];
+        if ( c->n < (c->leaf ? LEAF_MIN : INNER_MIN) ) {
+            rebalance( q, i );
+        }
+        return true;
+    }
+
+    /*
+     * Removes a key from the tree. Then the tree
+     * is rebalanced if necessary.
+     * 
+     * Calling parameter:
+     * 
+     * @param x (IN) the key to remove from the tree
+     * 
+     * @return true if the key was removed from the tree; otherwise, false
+     */
+public:
+    inline bool erase( K const& x ) {
+        TREE_STATS(stats.steps = 0;)
+        if ( root == nullptr || !erase( root, x ) ) {
+            return false;
+        }
+        --count;
+        if ( root->n == 0 ) {                       // shrink the tree
+            if ( root->leaf ) {
+                deleteNode( static_cast<Leaf*>(root) );
+                root = nullptr;
+            } else {
+                Inner* const q = static_cast<Inner*>(root);
+                root = q->child[0];
+                deleteNode( q );
+            }
+        }
+        TREE_STATS(treeStats::record(stats.erasePropagation, stats.steps);)
+        return true;
+    }
+
+    /*
+     * Throw an exception that describes a node that violates the B+ tree.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the node
+     * @param what (IN) the violation
+     */
+private:
+    void fail( Node const* const p, char const* const what ) {
+        std::ostringstream buffer;
+        buffer << std::endl << std::endl << (p->leaf ? "leaf" : "inner node")
+               << " with " << p->n << " keys";
+        if ( p->n != 0 ) {
+            buffer << " beginning with "
+                   << (p->leaf ? static_cast<Leaf const*>(p)->keys[0]
+                               : static_cast<Inner const*>(p)->keys[0]);
+        }
+        buffer << " " << what << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+
+    /*
+     * Check a subtree of the B+ tree for correctness, i.e.,
+     * (1) correct sorted order of keys within each node
+     * (2) each key within the bounds of the separators of its ancestors
+     * (3) at least the minimum number of keys in each node except the root
+     * (4) every leaf at the same depth
+     * 
+     * Calling parameters:
+     * 
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param lo (IN) the lower bound (inclusive) of the keys, or nullptr
+     * @param hi (IN) the upper bound (exclusive) of the keys, or nullptr
+     * @param depth (IN) the depth of p
+     * @param leafDepth (MODIFIED) the depth of the leaves, or -1 if unknown
+     * @param keys (MODIFIED) the number of keys in the leaves
+     */
+private:
+    void checkTree( Node const* const p, K const* const lo, K const* const hi,
+                    int const depth, int& leafDepth, size_t& keys ) {
+
+        if ( p != root && p->n < (p->leaf ? LEAF_MIN : INNER_MIN) ) {
+            fail( p, "has too few keys" );
+        }
+        K const* const k = p->leaf ? static_cast<Leaf const*>(p)->keys
+                                   : static_cast<Inner const*>(p)->keys;
+        for ( size_t i = 0; i < p->n; ++i ) {
+            if ( i > 0 && !(k[i - 1] < k[i]) ) {
+                fail( p, "has keys out of order" );
+            }
+            if ( (lo != nullptr && k[i] < *lo) || (hi != nullptr && !(k[i] < *hi)) ) {
+                fail( p, "has a key outside the bounds of its separators" );
+            }
+        }
+        if ( p->leaf ) {
+            if ( leafDepth < 0 ) {
+                leafDepth = depth;
+            } else if ( leafDepth != depth ) {
+                fail( p, "has a different depth than another leaf" );
+            }
+            keys += p->n;
+            return;
+        }
+        Inner const* const q = static_cast<Inner const*>(p);
+        for ( size_t i = 0; i <= q->n; ++i ) {
+            checkTree( q->child[i], (i == 0) ? lo : &q->keys[i - 1], (i == q->n) ? hi : &q->keys[i],
+                       depth + 1, leafDepth, keys );
+        }
+    }
+
+    /*
+     * Check the B+ tree for correctness, including the number of keys
+     * and the order of the keys along the list of leaves.
+     */
+public:
+    void checkTree() {
+
+        if ( root == nullptr ) {
+            return;
+        }
+        int leafDepth = -1;
+        size_t keys = 0;
+        checkTree( root, nullptr, nullptr, 0, leafDepth, keys );
+        if ( keys != count ) {
+            std::ostringstream buffer;
+            buffer << std::endl << std::endl << "leaves contain " << keys
+                   << " keys but tree size = " << count << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        Node const* p = root;
+        while ( !p->leaf ) {
+            p = static_cast<Inner const*>(p)->child[0];
+        }
+        keys = 0;
+        for ( Leaf const* q = static_cast<Leaf const*>(p); q != nullptr; q = q->next ) {
+            if ( q->next != nullptr && !(q->keys[q->n - 1] < q->next->keys[0]) ) {
+                fail( q, "precedes a leaf that has a smaller key" );
+            }
+            keys += q->n;
+        }
+        if ( keys != count ) {
+            std::ostringstream buffer;
+            buffer << std::endl << std::endl << "list of leaves contains " << keys
+                   << " keys but tree size = " << count << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+    }
+
+    /*
+     * Print the keys stored in the tree, one node per line, where the
+     * root of the tree is at the left and the leaves are at the right.
+     * 
+     * Calling parameters:
+     * 
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param d (IN) the depth in the tree
+     */
+private:
+    void printTree( Node const* const p, int const d ) {
+        if ( !p->leaf ) {
+            Inner const* const q = static_cast<Inner const*>(p);
+            for ( size_t i = q->n + 1; i > 0; --i ) {
+                if ( i <= q->n ) {
+                    for ( int j = 0; j < d; ++j ) {
+                        std::cout << "    ";
+                    }
+                    std::cout << q->keys[i - 1] << std::endl;
+                }
+                printTree( q->child[i - 1], d + 1 );
+            }
+            return;
+        }
+        Leaf const* const q = static_cast<Leaf const*>(p);
+        for ( int j = 0; j < d; ++j ) {
+            std::cout << "    ";
+        }
+        for ( size_t i = 0; i < q->n; ++i ) {
+            std::cout << (i == 0 ? "" : " ") << q->keys[i];
+        }
+        std::cout << std::endl;
+    }
+
+    /*
+     * Print the keys stored in the tree, where the root
+     * of the tree is at the left and the leaves are at
+     * the right.
+     */
+public:
+    void printTree() {
+        if ( root != nullptr ) {
+            printTree( root, 0 );
+        }
+    }
+
+    /*
+     * Walk the list of leaves in order and store each key in a vector.
+     *
+     * Calling parameter:
+     * 
+     * @param v (MODIFIED) vector of the keys
+     */
+public:
+    void getKeys( std::vector<K>& v ) {
+        if ( root == nullptr ) {
+            return;
+        }
+        Node const* p = root;
+        while ( !p->leaf ) {
+            p = static_cast<Inner const*>(p)->child[0];
+        }
+        size_t i = 0;
+        for ( Leaf const* q = static_cast<Leaf const*>(p); q != nullptr; q = q->next ) {
+            for ( size_t j = 0; j < q->n; ++j ) {
+                v[i++] = q->keys[j];
+            }
+        }
+    }
+};
+
+#endif // BAYER_MCCREIGHT_BPLUS_TREE_H
@@ -72,6 +72,17 @@
  * To preallocate the freed list as a vector of red-black tree nodes, compile via:
  * 
  * g++ -std=c++11 -O3 -D PREALLOCATE test_burbTree.cpp
+ *
+ * By default, a node that is erased remains on the freed list until
+ * clear() is called. The freedPolicy function limits the freed list
+ * to the larger of a number of nodes and a fraction of the number of
+ * nodes in the tree, beyond which an erased node is deleted, and the
+ * shrinkToFit function deletes the freed nodes in excess of that limit.
+ * A node that occupies the arena of freedPreallocate or clone is retained
+ * on the freed list regardless of the limit until the tree is empty,
+ * whereupon shrinkToFit releases the arena.
+ * OPTIMISTIC_READS ignores the limit when a node is erased, and
+ * shrinkToFit is not safe to call concurrently with readers.
  * 
  * To use a non-static sentinel node nullnode instead of nullptr, compile via:
  * 
@@ -81,6 +92,29 @@
  * NOTE that C++17 is required and compile via:
  * 
  * g++ -std=c++17 -O3 -D STATIC_NULL_NODE test_burbTree.cpp
+ *
+ * To allow threads to call the contains function concurrently with
+ * the insert and erase functions, compile via:
+ *
+ * g++ -std=c++11 -O3 -pthread -D OPTIMISTIC_READS test_burbTreeOptimistic.cpp
+ *
+ * OPTIMISTIC_READS serializes writers via a mutex and adds a version
+ * counter to each node. A writer increments the version to an odd value
+ * before it modifies a node's key or child pointers and increments it
+ * to an even value afterward. A reader acquires no lock but instead
+ * validates the version of each node that it visits, and restarts its
+ * search from the root upon detecting an odd or a changed version.
+ * Recoloring does not change the search path and hence does not change
+ * a version. Because a reader may hold a pointer to an erased node, that
+ * node must remain valid memory, so OPTIMISTIC_READS requires the freed
+ * list and iteration (not RECURSION), and the key type must be trivially
+ * copyable. The clear function and the destructor are not safe to call
+ * concurrently with readers.
+ *
+ * To count comparisons, search path lengths and rebalancing steps
+ * (see treeStats.h), compile via:
+ *
+ * g++ -std=c++11 -O3 -D ENABLE_TREE_STATS test_burbTree.cpp
  */
 
 #ifndef BAYER_GUIBAS_SEDGEWICK_ANANDA_BU_RB_TREE_H
@@ -90,11 +124,27 @@
 #include <cstdlib>
 #include <cstring>
 #include <exception>
+#include <functional>
+#include <limits>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include "memoryFootprint.h"
+#include "nodeArena.h"
+#include "treeStats.h"
+
+#ifdef OPTIMISTIC_READS
+#if defined(DISABLE_FREED_LIST) || defined(RECURSION)
+#error "OPTIMISTIC_READS requires the freed list and iteration"
+#endif
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+#endif
+
 /*
  * The rbTree class defines the root of the hybrid red-black tree
  * and provides the RED, BLACK, and DOUBLE_BLACK uint8_t constants.
@@ -138,6 +188,10 @@ private:
         size_t taille; // the number of nodes in the subtree
 #endif
 
+#ifdef OPTIMISTIC_READS
+        std::atomic<uint32_t> version; // odd while a writer modifies the node
+#endif
+
 public:
         Node() {
             color = RED;
@@ -145,6 +199,9 @@ public:
             
 #ifdef ENABLE_PREFERRED_TEST
             taille = 1;
+#endif
+#ifdef OPTIMISTIC_READS
+            version = 0;
 #endif
         }
 
@@ -156,6 +213,9 @@ public:
             
 #ifdef ENABLE_PREFERRED_TEST
             taille = 1;
+#endif
+#ifdef OPTIMISTIC_READS
+            version = 0;
 #endif
         }
     };
@@ -209,14 +269,27 @@ private:
     size_t count;   // the number of nodes in the tree
 
 #ifndef DISABLE_FREED_LIST
-    Node* freed;    // the freed list
-#ifdef PREALLOCATE
-    std::vector<Node> nodes;
+    Node* freed;            // the freed list
+    size_t freedCount;      // the number of nodes on the freed list
+    size_t freedMax;        // the number of freed nodes to retain regardless of tree size
+    double freedFraction;   // the fraction of the tree size to retain as freed nodes
 #endif
+    nodeArena<Node> arena;  // the nodes of freedPreallocate and clone
+
+#ifdef OPTIMISTIC_READS
+private:
+    std::atomic<uint32_t> rootVersion;  // the version of the root pointer
+    std::mutex writer;                  // serializes insert and erase
+
+public:
+    std::atomic<size_t> retries;        // the number of restarted searches
 #endif
 
 public:
     size_t rotateL, rotateR; // rotation counters
+#ifdef ENABLE_TREE_STATS
+    treeStats stats;         // the comparisons and histograms
+#endif
 
     /* Here is the hyrbTree constructor, which must
      * initialize nullnode first so that root and freed
@@ -252,22 +325,175 @@ public:
         root = nulle;
         count = rotateL = rotateR = 0;
 
+#ifdef OPTIMISTIC_READS
+        static_assert(std::is_trivially_copyable<K>::value,
+                      "OPTIMISTIC_READS requires a trivially copyable key");
+        rootVersion = 0;
+        retries = 0;
+#endif
+
 #ifndef DISABLE_FREED_LIST
         freed = nulle;
+        freedCount = 0;
+        freedMax = std::numeric_limits<size_t>::max();
+        freedFraction = 0.;
 #endif
     }
     
 public:
     ~burbTree() {
-        if ( root != nulle ) {
-            clear();
-        }
+        clear();
 
 #if defined(NULL_NODE) && !defined(STATIC_NULL_NODE)
         delete nullnode;
 #endif
     }
 
+    /* The tree owns its nodes, so it is not copied; call clone instead. */
+public:
+    burbTree(burbTree const&) = delete;
+
+public:
+    burbTree& operator=(burbTree const&) = delete;
+
+    /*
+     * Move a tree in O(1) time, which leaves the other tree empty.
+     * Under NULL_NODE, the other tree receives a new nullnode.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    burbTree(burbTree&& t) noexcept(nothrowMove) : burbTree() {
+        swap(t);
+    }
+
+    /*
+     * Move a tree in O(1) time by exchanging it with this tree, so that
+     * the nodes of this tree are deleted when the other tree is destroyed.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    burbTree& operator=(burbTree&& t) noexcept {
+        swap(t);
+        return *this;
+    }
+
+    /*
+     * Exchange the nodes, freed list, arena and counters of two trees
+     * in O(1) time.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the other tree
+     */
+public:
+    void swap(burbTree& t) noexcept {
+        std::swap(root, t.root);
+        std::swap(count, t.count);
+#if defined(NULL_NODE) && !defined(STATIC_NULL_NODE)
+        std::swap(nullnode, t.nullnode);
+#endif
+#ifndef DISABLE_FREED_LIST
+        std::swap(freed, t.freed);
+        std::swap(freedCount, t.freedCount);
+        std::swap(freedMax, t.freedMax);
+        std::swap(freedFraction, t.freedFraction);
+#endif
+        arena.swap(t.arena);
+#ifdef OPTIMISTIC_READS
+        swapAtomic(rootVersion, t.rootVersion);
+        swapAtomic(retries, t.retries);
+#endif
+        std::swap(rotateL, t.rotateL);
+        std::swap(rotateR, t.rotateR);
+#ifdef ENABLE_TREE_STATS
+        std::swap(stats, t.stats);
+#endif
+    }
+
+    /*
+     * Copy the shape, keys and colors of the tree in one linear pass
+     * that performs no comparisons or rebalancing. The nodes of the copy
+     * are allocated as one block of the arena of the copy.
+     *
+     * @return the copy
+     */
+public:
+    burbTree clone() const {
+        burbTree t;
+        size_t i = 0;
+        // The root of the empty tree t is the nulle of t.
+        t.root = t.cloneNode(root, nulle, t.root, t.arena.allocate(count), i);
+        t.count = count;
+        return t;
+    }
+
+    /*
+     * Copy a subtree in pre-order to consecutive nodes of a block.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param n (IN) the nulle of the tree that contains the subtree
+     * @param parent (IN) the parent of the copy of the subtree
+     * @param block (MODIFIED) the block of nodes
+     * @param i (MODIFIED) the index of the next unused node of the block
+     *
+     * @return the root of the copy of the subtree
+     */
+private:
+    Node* cloneNode(Node const* const p, Node const* const n, Node* const parent,
+                    Node* const block, size_t& i) {
+        if (p == n) {
+            return nulle;
+        }
+        Node* const q = block + i++;
+        q->key = p->key;
+        q->color = p->color;
+#ifdef ENABLE_PREFERRED_TEST
+        q->taille = p->taille;
+#endif
+        q->parent = parent;
+        q->left = cloneNode(p->left, n, q, block, i);
+        q->right = cloneNode(p->right, n, q, block, i);
+        return q;
+    }
+
+    /*
+     * Move construction cannot throw unless NULL_NODE requires that
+     * the default constructor allocate nullnode.
+     */
+private:
+#if defined(NULL_NODE) && !defined(STATIC_NULL_NODE)
+    static constexpr bool nothrowMove = false;
+#else
+    static constexpr bool nothrowMove = true;
+#endif
+
+#ifdef OPTIMISTIC_READS
+    /*
+     * Exchange two atomic counters. The exchange is not atomic, so swap
+     * must not run concurrently with insert, erase or contains.
+     *
+     * Calling parameters:
+     *
+     * @param x (MODIFIED) one counter
+     * @param y (MODIFIED) the other counter
+     */
+private:
+    template <typename T>
+    static inline void swapAtomic(std::atomic<T>& x, std::atomic<T>& y) noexcept {
+        T const z = x.load(std::memory_order_relaxed);
+        x.store(y.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        y.store(z, std::memory_order_relaxed);
+    }
+#endif
+
 public:
     size_t nodeSize() {
         return sizeof(Node);
@@ -289,7 +515,9 @@ private:
         }
         clear(node->left);
         clear(node->right);
-        delete node;
+        if ( !inArena(node) ) {
+            delete node;
+        }
     }
 
     /*
@@ -305,37 +533,105 @@ public:
 #ifndef DISABLE_FREED_LIST
 	    clearFreed();
 #endif
+        arena.release();
     }
 
     /* Delete every node from the freed list. */
 private:
     void clearFreed() {
 #ifndef DISABLE_FREED_LIST
-#ifndef PREALLOCATE
         while ( freed != nulle ) {
             Node* next = freed->left;
-            delete freed;
+            if ( !inArena(freed) ) {
+                delete freed;
+            }
             freed = next;
         }
-#else
-        nodes.clear();
-#endif
         freed = nulle;
+        freedCount = 0;
 #endif
     }
 
+    /*
+     * Determine whether a node occupies the arena of freedPreallocate
+     * or clone, and hence must not be deleted.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node
+     *
+     * @return true if the node occupies the arena; otherwise, false
+     */
+private:
+    inline bool inArena( Node const* const p ) {
+        return arena.contains(p);
+    }
+
     /* Report the number of nodes on the freed list. */
 public:
     size_t freedSize() {
-        size_t count = 0;
 #ifndef DISABLE_FREED_LIST
-        Node* ptr = freed;
-        while (ptr != nulle) {
-            ++count;
-            ptr = ptr->left;
+        return freedCount;
+#else
+        return 0;
+#endif
+    }
+
+    /*
+     * Limit the number of nodes that the freed list retains to the larger
+     * of a number of nodes and a fraction of the number of nodes in the tree.
+     * The default policy retains every freed node.
+     *
+     * Calling parameters:
+     *
+     * @param maxNodes (IN) the number of nodes to retain regardless of tree size
+     * @param fraction (IN) the fraction of the tree size to retain
+     */
+public:
+    void freedPolicy( size_t const maxNodes, double const fraction ) {
+#ifndef DISABLE_FREED_LIST
+        freedMax = maxNodes;
+        freedFraction = fraction;
+#else
+        (void) maxNodes;
+        (void) fraction;
+#endif
+    }
+
+    /*
+     * Delete the nodes on the freed list in excess of the limit of
+     * freedPolicy. A node that occupies the arena is retained unless
+     * the tree is empty, in which case the arena is released.
+     */
+public:
+    void shrinkToFit() {
+#ifndef DISABLE_FREED_LIST
+        size_t const fraction = static_cast<size_t>(freedFraction * count);
+        size_t const limit = (freedMax > fraction) ? freedMax : fraction;
+        Node* p = freed;
+        freed = nulle;
+        freedCount = 0;
+        while ( p != nulle ) {
+            Node* next = p->left;
+            if ( inArena(p) ) {
+                if ( count != 0 ) {
+                    p->left = freed;
+                    freed = p;
+                    ++freedCount;
+                }
+            } else if ( freedCount < limit ) {
+                p->left = freed;
+                freed = p;
+                ++freedCount;
+            } else {
+                delete p;
+            }
+            p = next;
+        }
+        if ( count == 0 ) {
+            arena.release();
         }
 #endif
-        return count;
     }
 
     /*
@@ -354,10 +650,11 @@ public:
             p->left = freed;
             freed = p;
         }
+        freedCount += n;
 #else
-        nodes.resize(n);
+        Node* const block = arena.allocate(n);
         for (size_t i = 0; i < n; ++i) {
-            Node* p = &nodes[i];
+            Node* p = block + i;
 #if defined(NULL_NODE) || defined(STATIC_NULL_NODE)
             // The Node() constructor does not recognize nullnode
             // when nullnode is defined as a Node pointer. See
@@ -367,12 +664,105 @@ public:
             p->left = freed;
             freed = p;
         }
+        freedCount += n;
+#endif
 #endif
+    }
+
+    /*
+     * Report the memory that the BURB tree occupies (see memoryFootprint.h).
+     *
+     * @return the live, freed, reserved, payload and overhead bytes
+     */
+public:
+    memoryFootprint memoryUsage() {
+        memoryFootprint m;
+        size_t const vectorSize = arena.size(), vectorCapacity = arena.capacity();
+        m.addNodes(sizeof(Node), count, freedSize(), vectorSize, vectorCapacity);
+#if defined(NULL_NODE) && !defined(STATIC_NULL_NODE)
+        m.addSentinel(sizeof(Node));
+#endif
+        if (hasHeapPayload<K>::value) {
+            m.addSubtree(root, static_cast<Node*>(nulle));
+#ifndef DISABLE_FREED_LIST
+            m.addFreed(freed, static_cast<Node*>(nulle));
 #endif
+        }
+        return m;
+    }
+
+#ifdef OPTIMISTIC_READS
+    /*
+     * Increment a version to an odd value before a writer
+     * modifies a node's key or child pointers. The release
+     * fence orders the increment before the modifications.
+     *
+     * Calling parameter:
+     *
+     * @param version (MODIFIED) the version to increment
+     */
+private:
+    inline void beginWrite(std::atomic<uint32_t>& version) {
+        version.store(version.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
     }
 
     /*
-     * Prepend the freed node to the freed list via its left pointer.
+     * Increment a version to an even value after a writer
+     * has modified a node's key or child pointers.
+     *
+     * Calling parameter:
+     *
+     * @param version (MODIFIED) the version to increment
+     */
+private:
+    inline void endWrite(std::atomic<uint32_t>& version) {
+        version.store(version.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_release);
+    }
+
+    /*
+     * Copy the key of the replacement node of a node that has two
+     * children into that node. A reader that has passed the node in
+     * search of the replacement key lies on the path from the node to
+     * the replacement node and would not find the key after fixErasure
+     * unlinks the replacement node, because validation never rechecks
+     * an ancestor. Hence the version of every node on that path is odd
+     * while the key is copied, so that such a reader restarts.
+     *
+     * Calling parameters:
+     *
+     * @param node (MODIFIED) the node that has two children
+     * @param replacement (IN) the successor or predecessor of the node
+     * @param successor (IN) true if the replacement is the successor
+     */
+private:
+    inline void replaceKey(Node* const node, Node* const replacement, bool const successor) {
+        beginWrite(node->version);
+        for (Node* p = successor ? node->right : node->left; ;
+             p = successor ? p->left : p->right) {
+            beginWrite(p->version);
+            if (p == replacement) {
+                break;
+            }
+        }
+        node->key = replacement->key;
+        for (Node* p = successor ? node->right : node->left; ;
+             p = successor ? p->left : p->right) {
+            endWrite(p->version);
+            if (p == replacement) {
+                break;
+            }
+        }
+        endWrite(node->version);
+    }
+#endif
+
+    /*
+     * Prepend the freed node to the freed list via its left pointer,
+     * unless the freed list has reached the limit of freedPolicy, which
+     * OPTIMISTIC_READS ignores because a reader may hold the node.
      *
      * Calling parameter:
      * 
@@ -381,10 +771,23 @@ public:
 private:
     inline void deleteNode( Node* q ) {
 #ifndef DISABLE_FREED_LIST
+#ifdef OPTIMISTIC_READS
+        beginWrite(q->version);
         q->left = freed;
+        endWrite(q->version);
+#else
+        if ( !(freedCount < freedMax || freedCount < freedFraction * count || inArena(q)) ) {
+            delete q;
+            return;
+        }
+        q->left = freed;
+#endif
         freed = q;
+        ++freedCount;
 #else
-        delete q;
+        if ( !inArena(q) ) {
+            delete q;
+        }
 #endif
     }
 
@@ -404,12 +807,19 @@ private:
         {
             Node* ptr = freed;
             freed = freed->left;
+            --freedCount;
+#ifdef OPTIMISTIC_READS
+            beginWrite(ptr->version);
+#endif
             ptr->key = key;
             ptr->color = RED;
             ptr->left = ptr->right = ptr->parent = nulle;
             
 #ifdef ENABLE_PREFERRED_TEST
             ptr->taille = 1;
+#endif
+#ifdef OPTIMISTIC_READS
+            endWrite(ptr->version);
 #endif
             return ptr;
         } else
@@ -451,6 +861,7 @@ private:
         // Increment the size of the inserted node's parent so that
         // the new size will propagate upward as recursion unwinds.
         if (ptr->key < node->key) {
+            TREE_STATS(++stats.comparisons;)
             node->left = insert(node->left, node, ptr, inserted);
 #ifdef ENABLE_PREFERRED_TEST
             if (inserted == true) {
@@ -458,6 +869,7 @@ private:
             }
 #endif
         } else if (ptr->key > node->key) {
+            TREE_STATS(stats.comparisons += 2;)
             node->right = insert(node->right, node, ptr, inserted);
 #ifdef ENABLE_PREFERRED_TEST
             if (inserted == true) {
@@ -467,40 +879,36 @@ private:
         } else {
             // For a tree, don't insert the key twice.
             // For a map, overwrite the value.
+            TREE_STATS(stats.comparisons += 2;)
         }
 
         return node;
     }
 
     /*
-     * Search the tree for the existence of a key.
-     * If the key is not found, it is is added to
-     * the tree as a new node and then the tree is
-     * rebalanced if necessary. If the key is found,
-     * it is ignored.
+     * Search the tree for the existence of the key of a node.
+     * If the key is not found, the node is added to the tree
+     * and then the tree is rebalanced if necessary. If the
+     * key is found, the node is ignored.
      *
      * Calling parameter:
      *
-     * @param key (IN) the key to add to the tree
+     * @param node (IN) a node that contains the key to add to the tree
      * 
-     * @return true if the key was added as a new node; otherwise, false
+     * @return true if the node was added to the tree; otherwise, false
      */
-public:
-    inline bool insert(K const& key) {
-        Node* node = newNode(key);
-        bool result, inserted = false;
+private:
+    inline bool link(Node* const node) {
+        TREE_STATS(stats.steps = 0;)
+        bool inserted = false;
         root = insert(root, nullptr, node, inserted);
-        if (inserted == false) {
-            // The node wasn't inserted, so put it back on freed list.
-            deleteNode(node);
-            result = false;
-        } else {
+        if (inserted == true) {
             // The node was inserted, so fix the tree.
             fixInsertion(node);
             ++count;
-            result = true;
+            TREE_STATS(treeStats::record(stats.insertPropagation, stats.steps);)
         }
-        return result;
+        return inserted;
     }
 #else   // RECURSION
 
@@ -525,25 +933,35 @@ private:
         Node* parent = nulle;
         while ( ptr != nulle ) {
             if ( node->key < ptr->key ) {
+                TREE_STATS(++stats.comparisons;)
                 parent = ptr;
                 ptr = ptr->left;
             } else if ( node->key > ptr->key ) {
+                TREE_STATS(stats.comparisons += 2;)
                 parent = ptr;
                 ptr = ptr->right;
             } else {
                 // Found the key.
                 // For a tree, don't insert the key twice.
                 // For a map, overwrite the value.
+                TREE_STATS(stats.comparisons += 2;)
                 return false;
             }
         }
 
         // Didn't find the key, so insert the new node.
+#ifdef OPTIMISTIC_READS
+        beginWrite(parent->version);
+#endif
+        TREE_STATS(++stats.comparisons;)
         if (node->key < parent->key) {
             parent->left = node;
         } else {
             parent->right = node;
         }
+#ifdef OPTIMISTIC_READS
+        endWrite(parent->version);
+#endif
         node->parent = parent;
 
         // Increment the size of each subtree along the path
@@ -560,26 +978,31 @@ private:
     }
 
     /*
-     * Search the tree for the existence of a key.
-     * If the key is not found, it is is added to
-     * the tree as a new node and then the tree
-     * is rebalanced if necessary. If the key is
-     * found, it is ignored.
+     * Search the tree for the existence of the key of a node.
+     * If the key is not found, the node is added to the tree
+     * and then the tree is rebalanced if necessary. If the
+     * key is found, the node is ignored.
      *
      * Calling parameter:
      *
-     * @param key (IN) the key to add to the tree
+     * @param node (IN) a node that contains the key to add to the tree
      * 
-     * @return true if the key was added as a new node; otherwise, false
+     * @return true if the node was added to the tree; otherwise, false
      */
-public:
-    inline bool insert(K const& key) {
+private:
+    inline bool link(Node* const node) {
 
+        TREE_STATS(stats.steps = 0;)
         bool result = false;
-        Node* node = newNode(key);
         if (root == nulle) {
             // Insertion always succeeds if the tree is empty.
+#ifdef OPTIMISTIC_READS
+            beginWrite(rootVersion);
+            root = node;
+            endWrite(rootVersion);
+#else
             root = node;
+#endif
             node->parent = nulle;
             node->color = BLACK;
             ++count;
@@ -590,15 +1013,41 @@ public:
                 // The node was inserted, so fix the tree.
                 fixInsertion(node);
                 ++count;
-            } else {
-                // The node wasn't inserted, so put it back on freed list.
-                deleteNode(node);
+                TREE_STATS(treeStats::record(stats.insertPropagation, stats.steps);)
             }
         }
         return result;
     }
 #endif  // RECURSION
 
+    /*
+     * Search the tree for the existence of a key.
+     * If the key is not found, it is is added to
+     * the tree as a new node and then the tree
+     * is rebalanced if necessary. If the key is
+     * found, it is ignored.
+     *
+     * Calling parameter:
+     *
+     * @param key (IN) the key to add to the tree
+     * 
+     * @return true if the key was added as a new node; otherwise, false
+     */
+public:
+    inline bool insert(K const& key) {
+
+#ifdef OPTIMISTIC_READS
+        std::lock_guard<std::mutex> lock(writer);
+#endif
+        Node* node = newNode(key);
+        bool const result = link(node);
+        if (result == false) {
+            // The node wasn't inserted, so put it back on freed list.
+            deleteNode(node);
+        }
+        return result;
+    }
+
     /*
      * Search the tree for the existence of a key.
      *
@@ -614,15 +1063,21 @@ private:
 
         // Search iteratively for the key.
         Node* ptr = node;
+        TREE_STATS(size_t length = 0;)
         while ( ptr != nulle ) {
+            TREE_STATS(++length;)
             if ( key < ptr->key ) {
+                TREE_STATS(++stats.comparisons;)
                 ptr = ptr->left;
             } else if ( key > ptr->key ) {
+                TREE_STATS(stats.comparisons += 2;)
                 ptr = ptr->right;
             } else {
+                TREE_STATS(stats.comparisons += 2; treeStats::record(stats.searchLength, length);)
                 return true; // found the key
             }
         }
+        TREE_STATS(treeStats::record(stats.searchLength, length);)
         return false; // didn't find the key
     }
 
@@ -635,18 +1090,96 @@ private:
      * 
      * @return true if the key was found; otherwise, false
      */
+#ifndef OPTIMISTIC_READS
 public:
     inline bool contains(K const& key) {
         if (root == nulle) {
+            TREE_STATS(treeStats::record(stats.searchLength, 0);)
             return false;
         }
         return contains(root, key);
     }
+#else
+    /*
+     * Search the tree for the existence of a key without acquiring
+     * a lock and concurrently with at most one writer.
+     *
+     * Validation proceeds hand over hand. A child pointer and a key
+     * that are read from a node are trusted only if that node's version
+     * is unchanged after they are read, and a child is trusted only if
+     * its parent's version is unchanged after the child's version is read.
+     * Because an erased node remains on the freed list, a stale pointer
+     * always addresses valid memory whose version detects reuse.
+     *
+     * Calling parameter:
+     *
+     * @param key (IN) the key to search for
+     *
+     * @return true if the key was found; otherwise, false
+     */
+public:
+    inline bool contains(K const& key) {
+
+    restart:
+        uint32_t const rv = rootVersion.load(std::memory_order_acquire);
+        if ((rv & 1) != 0) {
+            retries.fetch_add(1, std::memory_order_relaxed);
+            goto restart;
+        }
+        Node* ptr = __atomic_load_n(&root, __ATOMIC_RELAXED);
+        if (ptr == nulle) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (rootVersion.load(std::memory_order_relaxed) != rv) {
+                retries.fetch_add(1, std::memory_order_relaxed);
+                goto restart;
+            }
+            return false;
+        }
+        uint32_t version = ptr->version.load(std::memory_order_acquire);
+        if ((version & 1) != 0
+            || rootVersion.load(std::memory_order_relaxed) != rv) {
+            retries.fetch_add(1, std::memory_order_relaxed);
+            goto restart;
+        }
+
+        // Search iteratively for the key.
+        while (true) {
+            K const nodeKey = ptr->key;
+            Node* child;
+            if ( key < nodeKey ) {
+                child = __atomic_load_n(&ptr->left, __ATOMIC_RELAXED);
+            } else if ( key > nodeKey ) {
+                child = __atomic_load_n(&ptr->right, __ATOMIC_RELAXED);
+            } else {
+                child = ptr;
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (ptr->version.load(std::memory_order_relaxed) != version) {
+                retries.fetch_add(1, std::memory_order_relaxed);
+                goto restart;
+            }
+            if (child == ptr) {
+                return true; // found the key
+            }
+            if (child == nulle) {
+                return false; // didn't find the key
+            }
+            uint32_t const childVersion = child->version.load(std::memory_order_acquire);
+            if ((childVersion & 1) != 0
+                || ptr->version.load(std::memory_order_relaxed) != version) {
+                retries.fetch_add(1, std::memory_order_relaxed);
+                goto restart;
+            }
+            ptr = child;
+            version = childVersion;
+        }
+    }
+#endif
 
 #ifdef RECURSION
     /*
      * Find a node to erase from the tree but don't delete it
-     * because the fixErasure function will delete it.
+     * because erase or extract will remove it via fixErasure.
      * 
      * Calling parameters:
      * 
@@ -668,6 +1201,7 @@ private:
         // the size of each node along the path to the
         // the root of the subtree as recursion unwinds.
         if (key < node->key) {
+            TREE_STATS(++stats.comparisons;)
 #ifdef ENABLE_PREFERRED_TEST
             Node* const temp = erase(node->left, key);
             if (temp != nulle) {
@@ -679,6 +1213,7 @@ private:
 #endif
         }
         if (key > node->key) {
+            TREE_STATS(stats.comparisons += 2;)
 #ifdef ENABLE_PREFERRED_TEST
             Node* const temp = erase(node->right, key);
             if (temp != nulle) {
@@ -691,6 +1226,7 @@ private:
         }
 
         // Found the key. Does the node have one child or fewer?
+        TREE_STATS(stats.comparisons += 2;)
         if (node->left == nulle || node->right == nulle) {
             // Yes, so return the node.
 #ifdef ENABLE_PREFERRED_TEST
@@ -704,7 +1240,9 @@ private:
         // or by the rightmost node of the left subtree.
         // Select the preferred replacement node from the
         // larger of the two subtrees. That replacement
-        // node will be deleted by the fixErasure function.
+        // node will be removed by the fixErasure function.
+        // The keys are exchanged, not copied, so that the
+        // removed node contains the erased key for extract.
     	// Note: FORCE_SUCCESSOR and INVERT_PREFERRED_TEST
     	// are included only for diagnostic purposes.
 #ifdef ENABLE_PREFERRED_TEST
@@ -720,7 +1258,7 @@ private:
         {
             node->taille--;  // node exists, so no need for decSize(node).
             Node* predecessor = eraseMaxValue(node->left);
-            node->key = predecessor->key;
+            std::swap(node->key, predecessor->key);
             return predecessor;
         } else
 #endif
@@ -729,32 +1267,35 @@ private:
             node->taille--;  // node exists, so no need for decSize(node).
 #endif
             Node* successor = eraseMinValue(node->right);
-            node->key = successor->key;
+            std::swap(node->key, successor->key);
             return successor;
         }
     }
 
     /*
-     * Erase a key from the tree and fix the tree after erasure.
+     * Remove a key from the tree and fix the tree after removal.
      *
      * Calling parameter:
      * 
-     * @param key (IN) the key to erase
+     * @param key (IN) the key to remove
      * 
-     * @return true if the key was found; otherwise, false
+     * @return the node that was unlinked from the tree and that
+     *         contains the key if the key was found; otherwise, nulle
      */
-public:
-    inline bool erase(K const& key) {
+private:
+    inline Node* unlink(K const& key) {
 
+        TREE_STATS(stats.steps = 0;)
         Node* node = erase(root, key);
         if (node == nulle) {
-            return false;
+            return node;
         }
 
-        // Repair the tree and put the node back on the freed list.
+        // Repair the tree.
         --count;
         fixErasure(node);
-        return true;
+        TREE_STATS(treeStats::record(stats.erasePropagation, stats.steps);)
+        return node;
     }
 
     /*
@@ -812,7 +1353,7 @@ private:
 
     /*
      * Find a node to erase from the tree but don't delete it
-     * because the fixErasure function will delete it.
+     * because erase or extract will remove it via fixErasure.
      * 
      * Calling parameters:
      * 
@@ -820,7 +1361,7 @@ private:
      * @param key (IN) the key to erase
      * 
      * @return upon success, return a pointer to the node that contains the key
-     *         upon failure, return nullptr
+     *         upon failure, return nulle
      */
 private:
     inline Node* erase(Node* const node, K const& key) {
@@ -829,11 +1370,14 @@ private:
         Node* ptr = node;
         while ( ptr != nulle ) {
             if ( key < ptr->key ) {
+                TREE_STATS(++stats.comparisons;)
                 ptr = ptr->left;
             } else if ( key > ptr->key ) {
+                TREE_STATS(stats.comparisons += 2;)
                 ptr = ptr->right;
             } else {
                 // Found the key. Does the node have one child or fewer?
+                TREE_STATS(stats.comparisons += 2;)
                 if (ptr->left == nulle || ptr->right == nulle) {
                     return ptr; // Yes, so return the node.
                 }
@@ -843,7 +1387,9 @@ private:
                 // or by the rightmost node of the left subtree.
                 // Select the preferred replacement node from the
                 // larger of the two subtrees. That replacement
-                // node will be deleted by the fixErasure function.
+                // node will be removed by the fixErasure function.
+                // The keys are exchanged, not copied, so that the
+                // removed node contains the erased key for extract.
 		        // Note: FORCE_SUCCESSOR and INVERT_PREFERRED_TEST
 		        // are included only for diagnostic purposes.
 #ifdef ENABLE_PREFERRED_TEST
@@ -858,39 +1404,49 @@ private:
 #endif
 		        {
 		            Node* predecessor = eraseMaxValue(ptr->left);
-                    ptr->key = predecessor->key;
+#ifdef OPTIMISTIC_READS
+                    replaceKey(ptr, predecessor, false);
+#else
+                    std::swap(ptr->key, predecessor->key);
+#endif
                     ptr = predecessor;
 	            } else
 #endif
 		        {
 		            Node* successor = eraseMinValue(ptr->right);
-                    ptr->key = successor->key;
+#ifdef OPTIMISTIC_READS
+                    replaceKey(ptr, successor, true);
+#else
+                    std::swap(ptr->key, successor->key);
+#endif
                     ptr = successor;
 	            }
 		        return ptr;
 	        }
         }
 
-        // Didn't find the key, so return nullptr.
-        return nullptr;
+        // Didn't find the key, so return nulle.
+        return nulle;
     }
 
     /*
-     * Erase a key from the tree and fix the tree after erasure.
+     * Remove a key from the tree and fix the tree after removal.
      *
      * Calling parameter:
      * 
-     * @param key (IN) the key to erase
+     * @param key (IN) the key to remove
      * 
-     * @return true if the key was found; otherwise, false
+     * @return the node that was unlinked from the tree and that
+     *         contains the key if the key was found; otherwise, nulle
      */
-public:
-    inline bool erase(K const& key) {
+private:
+    inline Node* unlink(K const& key) {
 
+        TREE_STATS(stats.steps = 0;)
         Node* node = erase(root, key);
         if (node == nulle) {
             // No need to repair the tree because it hasn't changed.
-            return false;
+            return node;
        }
 
         // Decrement the size of each subtree along the path
@@ -902,10 +1458,11 @@ public:
             ptr = ptr->parent;
         }
 #endif
-        // Repair the tree and put the node back on the freed list.
+        // Repair the tree.
         --count;
         fixErasure(node);
-        return true;
+        TREE_STATS(treeStats::record(stats.erasePropagation, stats.steps);)
+        return node;
     }
 
     /*
@@ -948,6 +1505,148 @@ private:
     }
 #endif  // RECURSION
 
+    /*
+     * Erase a key from the tree and fix the tree after erasure.
+     *
+     * Calling parameter:
+     * 
+     * @param key (IN) the key to erase
+     * 
+     * @return true if the key was found; otherwise, false
+     */
+public:
+    inline bool erase(K const& key) {
+
+#ifdef OPTIMISTIC_READS
+        std::lock_guard<std::mutex> lock(writer);
+#endif
+        Node* node = unlink(key);
+        if (node == nulle) {
+            return false;
+        }
+
+        // Put the node back on the freed list.
+        deleteNode(node);
+        return true;
+    }
+
+#ifndef OPTIMISTIC_READS
+    /*
+     * The node_type class owns a node that extract has removed from
+     * a tree, so that the node may be inserted into the same or another
+     * tree without deletion, allocation or copying of its key, as for
+     * the node handles of std::set. A node_type that still owns its node
+     * when it is destroyed deletes the node. A node_type is not available
+     * with OPTIMISTIC_READS, because a reader may hold an erased node.
+     */
+public:
+    class node_type
+    {
+        friend class burbTree;
+
+    private:
+        Node* node;
+
+        explicit node_type(Node* const p) : node(p) {}
+
+    public:
+        node_type() : node(nullptr) {}
+
+        node_type(node_type&& h) noexcept : node(h.node) {
+            h.node = nullptr;
+        }
+
+        node_type& operator=(node_type&& h) noexcept {
+            if (this != &h) {
+                delete node;
+                node = h.node;
+                h.node = nullptr;
+            }
+            return *this;
+        }
+
+        node_type(node_type const&) = delete;
+        node_type& operator=(node_type const&) = delete;
+
+        ~node_type() {
+            delete node;
+        }
+
+        /* Return true if the node_type owns no node. */
+        bool empty() const {
+            return node == nullptr;
+        }
+
+        explicit operator bool() const {
+            return node != nullptr;
+        }
+
+        /*
+         * Return the key of the owned node, which may be modified
+         * before the node is inserted into a tree.
+         */
+        K& key() const {
+            return node->key;
+        }
+    };
+
+    /*
+     * Remove a key from the tree and return the node that contains it,
+     * instead of putting the node back on the freed list. A node that
+     * occupies the arena cannot leave the tree, so its
+     * key is moved to a new node and it is put back on the freed list.
+     *
+     * Calling parameter:
+     *
+     * @param key (IN) the key to remove
+     *
+     * @return a node_type that owns the node if the key was found;
+     *         otherwise, an empty node_type
+     */
+public:
+    node_type extract(K const& key) {
+        Node* node = unlink(key);
+        if (node == nulle) {
+            return node_type();
+        }
+        if (inArena(node)) {
+            Node* const p = createNode();
+            p->key = std::move(node->key);
+            deleteNode(node);
+            node = p;
+        }
+        return node_type(node);
+    }
+
+    /*
+     * Add the node that a node_type owns to the tree, unless the tree
+     * contains its key, in which case the node_type retains the node.
+     *
+     * Calling parameter:
+     *
+     * @param h (MODIFIED) the node_type, which is emptied upon insertion
+     *
+     * @return true if the node was added to the tree; otherwise, false
+     */
+public:
+    bool insert(node_type&& h) {
+        if (h.node == nullptr) {
+            return false;
+        }
+        Node* const node = h.node;
+        node->color = RED;
+        node->left = node->right = node->parent = nulle;
+#ifdef ENABLE_PREFERRED_TEST
+        node->taille = 1;
+#endif
+        if (link(node) == false) {
+            return false;
+        }
+        h.node = nullptr;
+        return true;
+    }
+#endif
+
     /*
      * Rotate left at a node, analogous to the RR rotation
      * of the AVL tree.
@@ -960,6 +1659,14 @@ private:
     inline void rotateLeft(Node* const node) {
 
         Node* right_child = node->right;
+#ifdef OPTIMISTIC_READS
+        // Invalidate the node, its child, and the pointer to the node.
+        std::atomic<uint32_t>& above =
+            (node == root) ? rootVersion : node->parent->version;
+        beginWrite(above);
+        beginWrite(node->version);
+        beginWrite(right_child->version);
+#endif
         node->right = right_child->left;
 
 #if defined(NULL_NODE) || defined(STATIC_NULL_NODE)
@@ -982,6 +1689,12 @@ private:
         right_child->left = node;
         node->parent = right_child;
 
+#ifdef OPTIMISTIC_READS
+        endWrite(right_child->version);
+        endWrite(node->version);
+        endWrite(above);
+#endif
+
         // Update the node's size. The child node inherits
         // the node's prior size.
 #ifdef ENABLE_PREFERRED_TEST
@@ -990,6 +1703,7 @@ private:
 #endif
         // Increment the rotation count.
         ++rotateL;
+        TREE_STATS(++stats.rotations;)
     }
 
     /*
@@ -1004,6 +1718,14 @@ private:
     inline void rotateRight(Node* const node) {
 
         Node* left_child = node->left;
+#ifdef OPTIMISTIC_READS
+        // Invalidate the node, its child, and the pointer to the node.
+        std::atomic<uint32_t>& above =
+            (node == root) ? rootVersion : node->parent->version;
+        beginWrite(above);
+        beginWrite(node->version);
+        beginWrite(left_child->version);
+#endif
         node->left = left_child->right;
 
 #if defined(NULL_NODE) || defined(STATIC_NULL_NODE)
@@ -1026,6 +1748,12 @@ private:
         left_child->right = node;
         node->parent = left_child;
 
+#ifdef OPTIMISTIC_READS
+        endWrite(left_child->version);
+        endWrite(node->version);
+        endWrite(above);
+#endif
+
         // Update the node's size. The child node inherits
         // the node's prior size.
 #ifdef ENABLE_PREFERRED_TEST
@@ -1034,6 +1762,7 @@ private:
 #endif
         // Increment the rotation count.
         ++rotateR;
+        TREE_STATS(++stats.rotations;)
     }
 
     /*
@@ -1058,6 +1787,7 @@ private:
         // Rule 1: repair is necessary only if the node and its parent are both RED.
         // Also, because ptr exists, there is no need to call getColor(ptr).
         while (ptr != root && ptr->color == RED && getColor(ptr->parent) == RED) {
+            TREE_STATS(++stats.steps;)
             parent = ptr->parent;
             grandparent = parent->parent;
             if (parent == grandparent->left) {
@@ -1080,6 +1810,7 @@ private:
                     // is RED, the parent is not the root and hence the grandparent
                     // exists, so there is no need for setColor(grandparent, RED)
                     // or setColor(parent, BLACK).
+                    TREE_STATS(++stats.colorFlips;)
                     setColor(uncle, BLACK);
                     parent->color = BLACK;
                     grandparent->color = RED;
@@ -1126,6 +1857,7 @@ private:
                     // is RED, the parent is not the root and hence the grandparent
                     // exists, so there is no need for setColor(grandparent, RED)
                     // or setColor(parent, BLACK).
+                    TREE_STATS(++stats.colorFlips;)
                     setColor(uncle, BLACK);
                     parent->color = BLACK;
                     grandparent->color = RED;
@@ -1161,7 +1893,8 @@ private:
 
     /*
      * Repair the red-black tree after erasure of a node
-     * and then delete the node from the tree.
+     * and then unlink the node from the tree. The caller
+     * either deletes the node or, for extract, retains it.
      *
      * The six different cases and their associated rules
      * for repair are discussed at:
@@ -1187,20 +1920,23 @@ private:
         // Rule 2: if the root has a single child, replace it with that child;
         // otherwise, if the root has no children, delete it.
         if (node == root) {
+#ifdef OPTIMISTIC_READS
+            beginWrite(rootVersion);
+#endif
             if (root->left == nulle && root->right == nulle) {
                 root = nulle;
-                deleteNode(node);
             } else if (root->left == nulle) {
                 root = root->right;
                 root->color = BLACK;  // No need to call setColor because root->right exists.
                 root->parent = nulle;
-                deleteNode(node);
             } else {
                 root = root->left;
                 root->color = BLACK;  // No need to call setColor because root->left exists.
                 root->parent = nulle;
-                deleteNode(node);
             }
+#ifdef OPTIMISTIC_READS
+            endWrite(rootVersion);
+#endif
             return;
         }
 
@@ -1212,6 +1948,9 @@ private:
             // child is either non-nulle node->left or non-nulle node->right or nulle node->right
             Node* child = node->left != nulle ? node->left : node->right;
 
+#ifdef OPTIMISTIC_READS
+            beginWrite(node->parent->version);
+#endif
             if (node == node->parent->left) {
                 node->parent->left = child;
 #if defined(NULL_NODE) || defined(STATIC_NULL_NODE)
@@ -1223,7 +1962,9 @@ private:
                     child->color = BLACK;
                 }
 #endif
-                deleteNode(node);
+#ifdef OPTIMISTIC_READS
+                endWrite(node->parent->version);
+#endif
             } else {
                 node->parent->right = child;
 #if defined(NULL_NODE) || defined(STATIC_NULL_NODE)
@@ -1235,7 +1976,9 @@ private:
                     child->color = BLACK;
                 }
 #endif
-               deleteNode(node);
+#ifdef OPTIMISTIC_READS
+                endWrite(node->parent->version);
+#endif
             }
         } else {
             // The node is BLACK
@@ -1245,6 +1988,7 @@ private:
             ptr->color = DOUBLE_BLACK; // DB is a shorthand for ptr below; ptr exists, so no need for setColor.
             // ptr can't retreat to the root, so no need for getColor(ptr).
             while (ptr != root && ptr->color == DOUBLE_BLACK) {//
+                TREE_STATS(++stats.steps;)
                 parent = ptr->parent;
                 if (ptr == parent->left) {
                     // DB is the left child of its parent.
@@ -1262,12 +2006,14 @@ private:
                             // So, remove DOUBLE_BLACK from DB and transfer it to DB's parent and change
                             // the sibling's color to RED.
                             ptr->color = BLACK;  // ptr can't retreat to the root, so no need for setColor(ptr).
+                            TREE_STATS(++stats.colorFlips;)
                             setColor(sibling, RED);
                             // ptr can't retreat to the root, so no need for getColor(parent) or setColor(parent, *).
                             if (parent->color == RED) {
                                 parent->color = BLACK;
                             } else {
                                 parent->color = DOUBLE_BLACK;
+                                TREE_STATS(++stats.doubleBlackSteps;)
                             }
                             ptr = parent;  // Here is where ptr retreats to its parent.
                         } else if (getColor(sibling->right) == BLACK) {
@@ -1332,12 +2078,14 @@ private:
                             // So, remove DOUBLE_BLACK from DB and transfer it to DB's parent and change
                             // the sibling's color to RED.
                             ptr->color = BLACK;  // ptr can't retreat to the root, so no need for setColor(ptr).
+                            TREE_STATS(++stats.colorFlips;)
                             setColor(sibling, RED);
                             // ptr can't retreat to the root, so no need for getColor(parent) or setColor(parent, *).
                             if (parent->color == RED) {
                                 parent->color = BLACK;
                             } else {
                                 parent->color = DOUBLE_BLACK;
+                                TREE_STATS(++stats.doubleBlackSteps;)
                             }
                             ptr = parent;  // Here is where ptr retreats to its parent.
                         } else if (getColor(sibling->left) == BLACK) {
@@ -1390,13 +2138,18 @@ private:
             }
 
             // This node is not the root because Rule 2 has been applied above.
-            // Set to nulle the parent's pointer to the node and delete the node.
+            // Set to nulle the parent's pointer to the node.
+#ifdef OPTIMISTIC_READS
+            beginWrite(node->parent->version);
+#endif
             if (node == node->parent->left) {
                 node->parent->left = nulle;
             } else {
                 node->parent->right = nulle;
             }
-            deleteNode(node);
+#ifdef OPTIMISTIC_READS
+            endWrite(node->parent->version);
+#endif
 
             // The root exists and it is always BLACK.
             root->color = BLACK;
@@ -0,0 +1,896 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Concurrent read-mostly AVL map whose readers never take a lock.
+ *
+ * Writers are serialized by a mutex. A writer never modifies a node that
+ * a reader can reach. Instead, insert and erase copy each node along the
+ * search path (and each sibling that a deletion rotates) as in pavlMap.h,
+ * modify the copies in place, and then publish the new root with a single
+ * atomic store. A reader loads the root once and searches an immutable
+ * version of the map.
+ *
+ * The nodes that a write replaces or removes are retired instead of deleted,
+ * and are reclaimed by epoch-based reclamation. Each reader announces the
+ * global epoch in its slot before it loads the root and clears the slot
+ * after its search. A node retired during epoch e is deleted only after
+ * every reader slot is either idle or announces an epoch later than e.
+ *
+ * A thread reads the map via a cavlMap::Reader, which occupies one of the
+ * reader slots for its lifetime:
+ *
+ *     cavlMap<uint32_t, uint32_t>::Reader reader( map );
+ *     uint32_t value;
+ *     if ( reader.find( key, value ) ) { ... }
+ *
+ * Compile with a test program, for example, test_cavlMap.cpp via:
+ *
+ * g++ -std=c++11 -O3 -pthread test_cavlMap.cpp
+ */
+
+#ifndef CONCURRENT_AVL_MAP_H
+#define CONCURRENT_AVL_MAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+ * The cavlMap class defines the published root of the concurrent AVL map,
+ * the reader slots and the retired list, and stores the rotation counters
+ * and the h, a, and r boolean variables of the writer.
+ */
+template <typename K, typename V>
+class cavlMap
+{
+private:
+    typedef int8_t bal_t;
+
+private:
+    struct Node {
+        K key;              // the key stored in this node
+        V value;            // the value stored in this node
+        bal_t bal;          // the left/right balance that assumes values of -1, 0, or +1
+        bool fresh;         // the node was created by the write in progress and is unpublished
+        Node *left, *right;
+
+        Node( K const& x, V const& y, bool& h ) : key( x ), value( y ) {
+            h = true;  // the height has changed
+            bal = 0;   // the subtree is balanced at this node
+            fresh = true;
+            left = right = nullptr;
+        }
+
+        Node( Node const* const p ) : key( p->key ), value( p->value ) {
+            bal = p->bal;
+            fresh = true;
+            left = p->left;
+            right = p->right;
+        }
+    };
+
+    /* A reader slot is padded to a cache line so that readers do not share lines. */
+    struct Slot {
+        std::atomic<uint64_t> active;   // the epoch announced by the reader, or 0 if idle
+        std::atomic<bool> used;         // the slot is occupied by a Reader
+        char pad[64 - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<bool>)];
+    };
+
+public:
+    size_t nodeSize() {
+        return sizeof(Node);
+    }
+
+private:
+    std::atomic<Node*> root;            // the published root of the map
+    std::atomic<size_t> count;          // the number of nodes in the published map
+    std::atomic<uint64_t> epoch;        // the global epoch
+    std::vector<Slot> slots;            // the reader slots
+    std::mutex writer;                  // serializes the writers
+    std::vector<Node*> fresh;           // the nodes created by the write in progress
+    std::vector<Node*> unlinked;        // the nodes replaced or removed by the write in progress
+    std::vector< std::pair<uint64_t, Node*> > retired;  // the retired nodes and their epochs
+    size_t threshold;                   // the number of retired nodes that triggers reclamation
+    bool h, a, r;                       // record modification of the map
+
+public:
+    size_t lle, lre, rle, rre, lli, lri, rli, rri;  // the rotation counters
+    size_t copies, reclaimed;                       // the numbers of copied and reclaimed nodes
+
+    /*
+     * Here is the constructor for the cavlMap class.
+     *
+     * Calling parameters:
+     *
+     * @param readers (IN) the maximum number of concurrent Readers
+     * @param batch (IN) the number of retired nodes that triggers reclamation
+     */
+public:
+    cavlMap( size_t const readers = 256, size_t const batch = 1024 ) : slots( readers ) {
+        root.store( nullptr );
+        count.store( 0 );
+        epoch.store( 1 );
+        for ( size_t i = 0; i < slots.size(); ++i ) {
+            slots[i].active.store( 0 );
+            slots[i].used.store( false );
+        }
+        threshold = batch;
+        lle = lre = rle = rre = lli = lri = rli = rri = copies = reclaimed = 0;
+        h = a = r = false;
+    }
+
+    /* The destructor requires that no Reader exists. */
+public:
+    ~cavlMap() {
+        for ( size_t i = 0; i < retired.size(); ++i ) {
+            delete retired[i].second;
+        }
+        clear( root.load() );
+    }
+
+private:
+    cavlMap( cavlMap const& );
+    cavlMap& operator=( cavlMap const& );
+
+private:
+    void clear( Node* const p ) {
+        if ( p != nullptr ) {
+            clear( p->left );
+            clear( p->right );
+            delete p;
+        }
+    }
+
+    /*
+     * The Reader class occupies a reader slot and searches the map
+     * without locks. A Reader must be used by only one thread at a time.
+     */
+public:
+    class Reader {
+
+    private:
+        cavlMap* m;     // the map
+        Slot* s;        // the reader slot
+
+    public:
+        Reader( cavlMap& map ) : m( &map ), s( nullptr ) {
+            for ( size_t i = 0; i < m->slots.size(); ++i ) {
+                bool expected = false;
+                if ( m->slots[i].used.compare_exchange_strong( expected, true ) ) {
+                    s = &m->slots[i];
+                    return;
+                }
+            }
+            std::ostringstream buffer;
+            buffer << std::endl << "all " << m->slots.size() << " reader slots are occupied" << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+
+        ~Reader() {
+            s->active.store( 0, std::memory_order_release );
+            s->used.store( false, std::memory_order_release );
+        }
+
+    private:
+        Reader( Reader const& );
+        Reader& operator=( Reader const& );
+
+        /*
+         * Search the map for the existence of a key and copy the
+         * associated value.
+         *
+         * Calling parameters:
+         *
+         * @param x (IN) the key to search for
+         * @param y (MODIFIED) the value if the key was found
+         *
+         * @return true if the key was found; otherwise, false
+         */
+    public:
+        bool find( K const& x, V& y ) {
+
+            // Acquire the epoch so that a reader that announces epoch e+1
+            // also loads the root that publish stored before advancing to e+1.
+            s->active.store( m->epoch.load( std::memory_order_acquire ), std::memory_order_seq_cst );
+            Node* q = m->root.load( std::memory_order_seq_cst );
+            bool found = false;
+            while ( q != nullptr ) {                    // iterate; don't use recursion
+                if ( x < q->key ) {
+                    q = q->left;                        // follow the left branch
+                } else if ( x > q->key ) {
+                    q = q->right;                       // follow the right branch
+                } else {
+                    y = q->value;                       // found the key, so copy the value
+                    found = true;
+                    break;
+                }
+            }
+            s->active.store( 0, std::memory_order_release );
+            return found;
+        }
+
+        /*
+         * Search the map for the existence of a key.
+         *
+         * Calling parameter:
+         *
+         * @param x (IN) the key to search for
+         *
+         * @return true if the key was found; otherwise, false
+         */
+    public:
+        bool contains( K const& x ) {
+
+            // Acquire the epoch as find does.
+            s->active.store( m->epoch.load( std::memory_order_acquire ), std::memory_order_seq_cst );
+            Node* q = m->root.load( std::memory_order_seq_cst );
+            bool found = false;
+            while ( q != nullptr ) {
+                if ( x < q->key ) {
+                    q = q->left;
+                } else if ( x > q->key ) {
+                    q = q->right;
+                } else {
+                    found = true;
+                    break;
+                }
+            }
+            s->active.store( 0, std::memory_order_release );
+            return found;
+        }
+    };
+
+    /* Return the number of nodes in the published map. */
+public:
+    size_t size() {
+        return count.load( std::memory_order_relaxed );
+    }
+
+    /* Return true if there are no nodes in the published map. */
+public:
+    bool empty() {
+        return ( size() == 0 );
+    }
+
+    /*
+     * Search the map for the existence of a key, and either insert
+     * the (key, value) as a new node or update the value, and then
+     * publish the new version of the map.
+     *
+     * Calling parameters:
+     *
+     * @param x (IN) the key to add to the map
+     * @param y (IN) the value to add to the map
+     *
+     * @return true if update, false if insertion
+     */
+public:
+    bool insert( K const& x, V const& y ) {
+        std::lock_guard<std::mutex> lock( writer );
+        h = false, a = false;
+        Node* p = root.load( std::memory_order_relaxed );
+        if ( p != nullptr ) {
+            p = insert( p, x, y );
+        } else {
+            p = new Node( x, y, h );
+            fresh.push_back( p );
+        }
+        publish( p, ( a == false ) ? 1 : 0 );
+        return a;
+    }
+
+    /*
+     * Remove a node from the map, and then publish the new
+     * version of the map.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to remove from the map
+     *
+     * @return true if the key existed, false if not
+     */
+public:
+    bool erase( K const& x ) {
+        std::lock_guard<std::mutex> lock( writer );
+        h = false, r = false;
+        Node* p = root.load( std::memory_order_relaxed );
+
+        // Search first so that the search path is not copied
+        // for a key that is not in the map.
+        Node* q = p;
+        while ( q != nullptr && ( x < q->key || x > q->key ) ) {
+            q = ( x < q->key ) ? q->left : q->right;
+        }
+        if ( q == nullptr ) {
+            return false;
+        }
+        p = erase( p, x );
+        publish( p, -1 );
+        return r;
+    }
+
+    /* Reclaim every retired node that no Reader can reach. */
+public:
+    void reclaim() {
+        std::lock_guard<std::mutex> lock( writer );
+        collect();
+    }
+
+    /*
+     * Publish the new root, advance the global epoch, retire the
+     * nodes that the write unlinked and reclaim retired nodes if
+     * enough have accumulated.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the new root
+     * @param delta (IN) the change in the number of nodes
+     */
+private:
+    void publish( Node* const p, int const delta ) {
+        for ( size_t i = 0; i < fresh.size(); ++i ) {
+            fresh[i]->fresh = false;
+        }
+        fresh.clear();
+        root.store( p, std::memory_order_seq_cst );
+        count.fetch_add( delta, std::memory_order_relaxed );
+        uint64_t const e = epoch.fetch_add( 1, std::memory_order_seq_cst );
+        for ( size_t i = 0; i < unlinked.size(); ++i ) {
+            retired.push_back( std::make_pair( e, unlinked[i] ) );
+        }
+        unlinked.clear();
+        if ( retired.size() >= threshold ) {
+            collect();
+        }
+    }
+
+    /*
+     * Delete each retired node whose epoch precedes the epoch
+     * announced by every active reader.
+     */
+private:
+    void collect() {
+        uint64_t oldest = UINT64_MAX;
+        for ( size_t i = 0; i < slots.size(); ++i ) {
+            uint64_t const e = slots[i].active.load( std::memory_order_seq_cst );
+            if ( e != 0 && e < oldest ) {
+                oldest = e;
+            }
+        }
+        size_t j = 0;
+        for ( size_t i = 0; i < retired.size(); ++i ) {
+            if ( retired[i].first < oldest ) {
+                delete retired[i].second;
+                ++reclaimed;
+            } else {
+                retired[j++] = retired[i];
+            }
+        }
+        retired.resize( j );
+    }
+
+    /*
+     * Return a node that may be modified in place. A published node is
+     * copied and unlinked, whereas an unpublished node is returned as is.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node
+     *
+     * @return pointer to an unpublished node that has the same contents
+     */
+private:
+    inline Node* copy( Node* const p ) {
+        if ( p->fresh ) {
+            return p;
+        }
+        Node* const q = new Node( p );
+        fresh.push_back( q );
+        unlinked.push_back( p );
+        ++copies;
+        return q;
+    }
+
+    /*
+     * Remove a node from the map. An unpublished node is deleted,
+     * whereas a published node is unlinked.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node
+     */
+private:
+    inline void remove( Node* const p ) {
+        if ( p->fresh ) {
+            fresh.erase( std::find( fresh.begin(), fresh.end(), p ) );
+            delete p;
+        } else {
+            unlinked.push_back( p );
+        }
+    }
+
+    /*
+     * Rebalance following insertion of a left node. The left
+     * child, and for a double rotation its right child, lie
+     * on the search path and hence are unpublished.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the unpublished root of the subtree at this level of recursion
+     *
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceInsertLeft( Node* p ) {
+        switch ( p->bal ) {
+            case 1:                         // balance restored
+                p->bal = 0;
+                h = false;
+                break;
+            case 0:                         // map has become more unbalanced
+                p->bal = -1;
+                break;
+            case -1:		                // map must be rebalanced
+                Node* p1 = p->left;
+                if ( p1->bal == -1 ) {		// single LL rotation
+                    lli++;
+                    p->left = p1->right;
+                    p1->right = p;
+                    p->bal = 0;
+                    p = p1;
+                } else {			        // double LR rotation
+                    lri++;
+                    Node* p2 = p1->right;
+                    p1->right = p2->left;
+                    p2->left = p1;
+                    p->left = p2->right;
+                    p2->right = p;
+                    if ( p2->bal == -1 ) {
+                        p->bal = 1;
+                    } else {
+                        p->bal = 0;
+                    }
+                    if ( p2->bal == 1 ) {
+                        p1->bal = -1;
+                    } else {
+                        p1->bal = 0;
+                    }
+                    p = p2;
+                }
+                p->bal = 0;
+                h = false;
+                break;
+        }
+        return p;
+    }
+
+    /*
+     * Rebalance following insertion of a right node. The right
+     * child, and for a double rotation its left child, lie
+     * on the search path and hence are unpublished.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the unpublished root of the subtree at this level of recursion
+     *
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceInsertRight( Node* p ) {
+        switch ( p->bal ) {
+            case -1:                        // balance restored
+                p->bal = 0;
+                h = false;
+                break;
+            case 0:                         // map has become more unbalanced
+                p->bal = 1;
+                break;
+            case 1:                         // map must be rebalanced
+                Node* p1 = p->right;
+                if ( p1->bal == 1 ) {       // single RR rotation
+                    rri++;
+                    p->right = p1->left;
+                    p1->left = p;
+                    p->bal = 0;
+                    p = p1;
+                } else {                    // double RL rotation
+                    rli++;
+                    Node* p2 = p1->left;
+                    p1->left = p2->right;
+                    p2->right = p1;
+                    p->right = p2->left;
+                    p2->left = p;
+                    if ( p2->bal == 1 ) {
+                        p->bal = -1;
+                    } else {
+                        p->bal = 0;
+                    }
+                    if ( p2->bal == -1 ) {
+                        p1->bal = 1;
+                    } else {
+                        p1->bal = 0;
+                    }
+                    p = p2;
+                }
+                p->bal = 0;
+                h = false;
+                break;
+        }
+        return p;
+    }
+
+    /*
+     * Search the map for the existence of a key, and either insert
+     * the (key, value) as a new node or update the value, after
+     * copying each node along the search path. Then the map is
+     * rebalanced if necessary.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param x (IN) the key to add to the map
+     * @param y (IN) the value to add to the map
+     *
+     * @return the unpublished root of the rebalanced subtree
+     */
+private:
+    Node* insert( Node* p, K const& x, V const& y ) {
+
+        p = copy( p );
+        if ( x < p->key ) {                         // search the left branch?
+            if ( p->left != nullptr ) {
+                p->left = insert( p->left, x, y );
+            } else {
+                p->left = new Node( x, y, h );
+                fresh.push_back( p->left );
+                a = false;
+            }
+            if ( h ) {                              // left branch has grown higher
+                p = balanceInsertLeft( p );
+            }
+        } else if ( x > p->key ) {                  // search the right branch?
+            if ( p->right != nullptr ) {
+                p->right = insert( p->right, x, y );
+            } else {
+                p->right = new Node( x, y, h );
+                fresh.push_back( p->right );
+                a = false;
+            }
+            if ( h ) {                              // right branch has grown higher
+                p = balanceInsertRight( p );
+            }
+        } else {                                    // the key is already in the map, so update its value
+            p->value = y;
+            h = false;
+            a = true;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Rebalance following deletion of a left node. The right
+     * child, and for a double rotation its left child, are
+     * not on the search path and hence must be copied.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the unpublished root of the subtree at this level of recursion
+     *
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceEraseLeft( Node* p ) {
+
+        switch ( p->bal ) {
+            case -1:                    // balance restored
+                p->bal = 0;
+                break;
+            case 0:                     // map has become more unbalanced
+                p->bal = 1;
+                h = false;
+                break;
+            case 1:                     // map must be rebalanced
+                Node* p1 = p->right = copy( p->right );
+                if ( p1->bal >= 0 ) {   // single RR rotation
+                    rre++;
+                    p->right = p1->left;
+                    p1->left = p;
+                    if ( p1->bal == 0 ) {
+                        p->bal = 1;
+                        p1->bal = -1;
+                        h = false;
+                    } else {
+                        p->bal = 0;
+                        p1->bal = 0;
+                    }
+                    p = p1;
+                } else {				  // double RL rotation
+                    rle++;
+                    Node* p2 = p1->left = copy( p1->left );
+                    p1->left = p2->right;
+                    p2->right = p1;
+                    p->right = p2->left;
+                    p2->left = p;
+                    if ( p2->bal == 1 ) {
+                        p->bal = -1;
+                    } else {
+                        p->bal = 0;
+                    }
+                    if ( p2->bal == -1 ) {
+                        p1->bal = 1;
+                    } else {
+                        p1->bal = 0;
+                    }
+                    p = p2;
+                    p->bal = 0;
+                }
+                break;
+        }
+        return p; // the root of the rebalanced subtree
+    }
+
+    /*
+     * Rebalance following deletion of a right node. The left
+     * child, and for a double rotation its right child, are
+     * not on the search path and hence must be copied.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the unpublished root of the subtree at this level of recursion
+     *
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceEraseRight( Node* p ) {
+
+        switch ( p->bal ) {
+            case 1:                     // balance restored
+                p->bal = 0;
+                break;
+            case 0:                     // map has become more unbalanced
+                p->bal = -1;
+                h = false;
+                break;
+            case -1:                    // map must be rebalanced
+                Node* p1 = p->left = copy( p->left );
+                if ( p1->bal <= 0 ) {   // single LL rotation
+                    lle++;
+                    p->left = p1->right;
+                    p1->right = p;
+                    if ( p1->bal == 0 ) {
+                        p->bal = -1;
+                        p1->bal = 1;
+                        h = false;
+                    } else {
+                        p->bal = 0;
+                        p1->bal = 0;
+                    }
+                    p = p1;
+                } else {				  // double LR rotation
+                    lre++;
+                    Node* p2 = p1->right = copy( p1->right );
+                    p1->right = p2->left;
+                    p2->left = p1;
+                    p->left = p2->right;
+                    p2->right = p;
+                    if ( p2->bal == -1 ) {
+                        p->bal = 1;
+                    } else {
+                        p->bal = 0;
+                    }
+                    if ( p2->bal == 1 ) {
+                        p1->bal = -1;
+                    } else {
+                        p1->bal = 0;
+                    }
+                    p = p2;
+                    p->bal = 0;
+                }
+                break;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Copy the key and value of the leftmost node of the right
+     * subtree to the node to be deleted. Then replace that leftmost
+     * node with its right child and rebalance the right subtree if
+     * necessary.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the right subtree at this level of recursion
+     * @param q (MODIFIED) the unpublished node to be deleted
+     *
+     * @return the unpublished root of the rebalanced subtree
+     */
+private:
+    Node* eraseLeft( Node* p, Node* const q ) {
+
+        if ( p->left != nullptr ) {
+            p = copy( p );
+            p->left = eraseLeft( p->left, q );
+            if ( h ) {
+                p = balanceEraseLeft( p );
+            }
+        } else {
+            q->key = p->key;                // copy node contents from p to q
+            q->value = p->value;
+            Node* const c = p->right;
+            remove( p );                    // remove the leftmost node
+            p = c;                          // replace node with right branch
+            h = true;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Copy the key and value of the rightmost node of the left
+     * subtree to the node to be deleted. Then replace that rightmost
+     * node with its left child and rebalance the left subtree if
+     * necessary.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the left subtree at this level of recursion
+     * @param q (MODIFIED) the unpublished node to be deleted
+     *
+     * @return the unpublished root of the rebalanced subtree
+     */
+private:
+    Node* eraseRight( Node* p, Node* const q ) {
+
+        if ( p->right != nullptr ) {
+            p = copy( p );
+            p->right = eraseRight( p->right, q );
+            if ( h ) {
+                p = balanceEraseRight( p );
+            }
+        } else {
+            q->key = p->key;                // copy node contents from p to q
+            q->value = p->value;
+            Node* const c = p->left;
+            remove( p );                    // remove the rightmost node
+            p = c;                          // replace node with left branch
+            h = true;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Remove a key that is known to be in the map after copying
+     * each node along the search path. Then the map is rebalanced
+     * if necessary.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param x (IN) the key to remove from the map
+     *
+     * @return the unpublished root of the rebalanced subtree
+     */
+private:
+    Node* erase( Node* p, K const& x ) {
+
+        if ( x < p->key ) {                     // search left branch
+            p = copy( p );
+            p->left = erase( p->left, x );
+            if ( h ) {
+                p = balanceEraseLeft( p );
+            }
+        } else if ( x > p->key ) {              // search right branch
+            p = copy( p );
+            p->right = erase( p->right, x );
+            if ( h ) {
+                p = balanceEraseRight( p );
+            }
+        } else if ( p->left == nullptr || p->right == nullptr ) {
+            // The node has at most one child, so replace it with that child.
+            Node* const c = ( p->left != nullptr ) ? p->left : p->right;
+            remove( p );
+            p = c;
+            h = true;
+            r = true;
+        } else {
+            // The node has two children, so replace its contents by
+            // those of the leftmost node of the right subtree or by
+            // those of the rightmost node of the left subtree, selected
+            // from the taller subtree as in avlTree.h.
+            p = copy( p );
+#ifdef ENABLE_PREFERRED_TEST
+            if ( p->bal <= 0 ) {                // left or neither subtree is deeper
+                p->left = eraseRight( p->left, p );
+                if ( h ) {
+                    p = balanceEraseLeft( p );
+                }
+            } else                              // right subtree is deeper
+#endif
+            {
+                p->right = eraseLeft( p->right, p );
+                if ( h ) {
+                    p = balanceEraseRight( p );
+                }
+            }
+            r = true;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Check the map for correctness, i.e.,
+     * (1) correct sorted order of keys
+     * (2) each node's balance field equal to the difference of subtree heights
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     *
+     * @return the height of the subtree
+     */
+private:
+    int checkTree( Node* const p ) {
+
+        if ( p == nullptr ) {
+            return 0;
+        }
+        if ( ( p->left != nullptr && !( p->left->key < p->key ) )
+             || ( p->right != nullptr && !( p->key < p->right->key ) ) ) {
+            std::ostringstream buffer;
+            buffer << std::endl << std::endl << "node " << p->key << " is out of order" << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        int const leftHeight = checkTree( p->left );
+        int const rightHeight = checkTree( p->right );
+        if ( p->bal != rightHeight - leftHeight || p->bal > 1 || p->bal < -1 ) {
+            std::ostringstream buffer;
+            buffer << std::endl << std::endl << "node " << p->key << " has bal = " << static_cast<int>(p->bal)
+                   << " but subtree heights = " << leftHeight << " and " << rightHeight << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        return std::max( leftHeight, rightHeight ) + 1;
+    }
+
+    /* Check the published map for correctness. */
+public:
+    void checkTree() {
+        std::lock_guard<std::mutex> lock( writer );
+        checkTree( root.load() );
+    }
+};
+
+#endif // CONCURRENT_AVL_MAP_H
@@ -67,6 +67,15 @@
  * To preallocate the freed list as a vector of red-black tree nodes, compile via:
  * 
  * g++ -std=c++11 -O3 -D PREALLOCATE test_hyrbTree.cpp
+ *
+ * By default, a node that is erased remains on the freed list until
+ * clear() is called. The freedPolicy function limits the freed list
+ * to the larger of a number of nodes and a fraction of the number of
+ * nodes in the tree, beyond which an erased node is deleted, and the
+ * shrinkToFit function deletes the freed nodes in excess of that limit.
+ * A node that occupies the arena of freedPreallocate or clone is retained
+ * on the freed list regardless of the limit until the tree is empty,
+ * whereupon shrinkToFit releases the arena.
  * 
  * To use a non-static sentinel node nullnode instead of nullptr, compile via:
  * 
@@ -76,6 +85,11 @@
  * NOTE that C++17 is required and compile via:
  * 
  * g++ -std=c++17 -O3 -D STATIC_NULL_NODE test_hyrbTree.cpp
+ *
+ * To count comparisons, search path lengths and rebalancing steps
+ * (see treeStats.h), compile via:
+ *
+ * g++ -std=c++11 -O3 -D ENABLE_TREE_STATS test_hyrbTree.cpp
  */
 
 #ifndef LAKEMPER_ANANDA_HYBRID_RB_TREE_H
@@ -84,9 +98,16 @@
 #include <cstdint>
 #include <iostream>
 #include <exception>
+#include <functional>
+#include <limits>
 #include <sstream>
+#include <utility>
 #include <vector>
 
+#include "memoryFootprint.h"
+#include "nodeArena.h"
+#include "treeStats.h"
+
 /*
  * The hyrbTree class defines the root of the hybrid red-black tree
  * and provides the RED, BLACK, and DOUBLE_BLACK uint8_t constants.
@@ -188,14 +209,18 @@ private:
     size_t count;   // the number of nodes in the tree
 
 #ifndef DISABLE_FREED_LIST
-    Node* freed;    // the freed list
-#ifdef PREALLOCATE
-    std::vector<Node> nodes;
-#endif
+    Node* freed;            // the freed list
+    size_t freedCount;      // the number of nodes on the freed list
+    size_t freedMax;        // the number of freed nodes to retain regardless of tree size
+    double freedFraction;   // the fraction of the tree size to retain as freed nodes
 #endif
+    nodeArena<Node> arena;  // the nodes of freedPreallocate and clone
 
 public:
     size_t singleRotationCount, doubleRotationCount, rotateL, rotateR;
+#ifdef ENABLE_TREE_STATS
+    treeStats stats;    // the comparisons and histograms
+#endif
 
     /* Here is the hyrbTree constructor, which must
      * initialize nullnode first so that root and freed
@@ -233,20 +258,142 @@ public:
 
 #ifndef DISABLE_FREED_LIST
         freed = nulle;
+        freedCount = 0;
+        freedMax = std::numeric_limits<size_t>::max();
+        freedFraction = 0.;
 #endif
     }
     
 public:
     ~hyrbTree() {
-        if ( root != nulle ) {
-            clear();
-        }
+        clear();
 
 #if defined(NULL_NODE) && !defined(STATIC_NULL_NODE)
         delete nullnode;
 #endif
     }
 
+    /* The tree owns its nodes, so it is not copied; call clone instead. */
+public:
+    hyrbTree(hyrbTree const&) = delete;
+
+public:
+    hyrbTree& operator=(hyrbTree const&) = delete;
+
+    /*
+     * Move a tree in O(1) time, which leaves the other tree empty.
+     * Under NULL_NODE, the other tree receives a new nullnode.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    hyrbTree(hyrbTree&& t) noexcept(nothrowMove) : hyrbTree() {
+        swap(t);
+    }
+
+    /*
+     * Move a tree in O(1) time by exchanging it with this tree, so that
+     * the nodes of this tree are deleted when the other tree is destroyed.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    hyrbTree& operator=(hyrbTree&& t) noexcept {
+        swap(t);
+        return *this;
+    }
+
+    /*
+     * Exchange the nodes, freed list, arena and counters of two trees
+     * in O(1) time.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the other tree
+     */
+public:
+    void swap(hyrbTree& t) noexcept {
+        std::swap(root, t.root);
+        std::swap(count, t.count);
+#if defined(NULL_NODE) && !defined(STATIC_NULL_NODE)
+        std::swap(nullnode, t.nullnode);
+#endif
+#ifndef DISABLE_FREED_LIST
+        std::swap(freed, t.freed);
+        std::swap(freedCount, t.freedCount);
+        std::swap(freedMax, t.freedMax);
+        std::swap(freedFraction, t.freedFraction);
+#endif
+        arena.swap(t.arena);
+        std::swap(singleRotationCount, t.singleRotationCount);
+        std::swap(doubleRotationCount, t.doubleRotationCount);
+        std::swap(rotateL, t.rotateL);
+        std::swap(rotateR, t.rotateR);
+#ifdef ENABLE_TREE_STATS
+        std::swap(stats, t.stats);
+#endif
+    }
+
+    /*
+     * Copy the shape, keys and colors of the tree in one linear pass
+     * that performs no comparisons or rebalancing. The nodes of the copy
+     * are allocated as one block of the arena of the copy.
+     *
+     * @return the copy
+     */
+public:
+    hyrbTree clone() const {
+        hyrbTree t;
+        size_t i = 0;
+        // The root of the empty tree t is the nulle of t.
+        t.root = t.cloneNode(root, nulle, t.root, t.arena.allocate(count), i);
+        t.count = count;
+        return t;
+    }
+
+    /*
+     * Copy a subtree in pre-order to consecutive nodes of a block.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param n (IN) the nulle of the tree that contains the subtree
+     * @param parent (IN) the parent of the copy of the subtree
+     * @param block (MODIFIED) the block of nodes
+     * @param i (MODIFIED) the index of the next unused node of the block
+     *
+     * @return the root of the copy of the subtree
+     */
+private:
+    Node* cloneNode(Node const* const p, Node const* const n, Node* const parent,
+                    Node* const block, size_t& i) {
+        if (p == n) {
+            return nulle;
+        }
+        Node* const q = block + i++;
+        q->key = p->key;
+        q->color = p->color;
+        q->parent = parent;
+        q->left = cloneNode(p->left, n, q, block, i);
+        q->right = cloneNode(p->right, n, q, block, i);
+        return q;
+    }
+
+    /*
+     * Move construction cannot throw unless NULL_NODE requires that
+     * the default constructor allocate nullnode.
+     */
+private:
+#if defined(NULL_NODE) && !defined(STATIC_NULL_NODE)
+    static constexpr bool nothrowMove = false;
+#else
+    static constexpr bool nothrowMove = true;
+#endif
+
 public:
     size_t nodeSize() {
         return sizeof(Node);
@@ -268,7 +415,9 @@ private:
         }
         clear(node->left);
         clear(node->right);
-        delete node;
+        if ( !inArena(node) ) {
+            delete node;
+        }
     }
 
     /*
@@ -284,37 +433,105 @@ public:
 #ifndef DISABLE_FREED_LIST
 	    clearFreed();
 #endif
+        arena.release();
     }
 
     /* Delete every node from the freed list. */
     private:
     void clearFreed() {
 #ifndef DISABLE_FREED_LIST
-#ifndef PREALLOCATE
         while ( freed != nulle ) {
             Node* next = freed->left;
-            delete freed;
+            if ( !inArena(freed) ) {
+                delete freed;
+            }
             freed = next;
         }
-#else
-        nodes.clear();
-#endif
         freed = nulle;
+        freedCount = 0;
 #endif
     }
 
+    /*
+     * Determine whether a node occupies the arena of freedPreallocate
+     * or clone, and hence must not be deleted.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node
+     *
+     * @return true if the node occupies the arena; otherwise, false
+     */
+private:
+    inline bool inArena( Node const* const p ) {
+        return arena.contains(p);
+    }
+
     /* Report the number of nodes on the freed list. */
 public:
     size_t freedSize() {
-        size_t count = 0;
 #ifndef DISABLE_FREED_LIST
-        Node* ptr = freed;
-        while(ptr != nulle) {
-            ++count;
-            ptr = ptr->left;
+        return freedCount;
+#else
+        return 0;
+#endif
+    }
+
+    /*
+     * Limit the number of nodes that the freed list retains to the larger
+     * of a number of nodes and a fraction of the number of nodes in the tree.
+     * The default policy retains every freed node.
+     *
+     * Calling parameters:
+     *
+     * @param maxNodes (IN) the number of nodes to retain regardless of tree size
+     * @param fraction (IN) the fraction of the tree size to retain
+     */
+public:
+    void freedPolicy( size_t const maxNodes, double const fraction ) {
+#ifndef DISABLE_FREED_LIST
+        freedMax = maxNodes;
+        freedFraction = fraction;
+#else
+        (void) maxNodes;
+        (void) fraction;
+#endif
+    }
+
+    /*
+     * Delete the nodes on the freed list in excess of the limit of
+     * freedPolicy. A node that occupies the arena is retained unless
+     * the tree is empty, in which case the arena is released.
+     */
+public:
+    void shrinkToFit() {
+#ifndef DISABLE_FREED_LIST
+        size_t const fraction = static_cast<size_t>(freedFraction * count);
+        size_t const limit = (freedMax > fraction) ? freedMax : fraction;
+        Node* p = freed;
+        freed = nulle;
+        freedCount = 0;
+        while ( p != nulle ) {
+            Node* next = p->left;
+            if ( inArena(p) ) {
+                if ( count != 0 ) {
+                    p->left = freed;
+                    freed = p;
+                    ++freedCount;
+                }
+            } else if ( freedCount < limit ) {
+                p->left = freed;
+                freed = p;
+                ++freedCount;
+            } else {
+                delete p;
+            }
+            p = next;
+        }
+        if ( count == 0 ) {
+            arena.release();
         }
 #endif
-        return count;
     }
 
     /*
@@ -333,10 +550,11 @@ public:
             p->left = freed;
             freed = p;
         }
+        freedCount += n;
 #else
-        nodes.resize(n);
+        Node* const block = arena.allocate(n);
         for (size_t i = 0; i < n; ++i) {
-            Node* p = &nodes[i];
+            Node* p = block + i;
 #if defined(NULL_NODE) || defined(STATIC_NULL_NODE)
             // The Node() constructor does not recognize nullnode
             // when nullnode is defined as a Node pointer. See
@@ -346,12 +564,36 @@ public:
             p->left = freed;
             freed = p;
         }
+        freedCount += n;
 #endif
 #endif
     }
 
     /*
-     * Prepend the freed node to the freed list via its left pointer.
+     * Report the memory that the hybrid RB tree occupies (see memoryFootprint.h).
+     *
+     * @return the live, freed, reserved, payload and overhead bytes
+     */
+public:
+    memoryFootprint memoryUsage() {
+        memoryFootprint m;
+        size_t const vectorSize = arena.size(), vectorCapacity = arena.capacity();
+        m.addNodes(sizeof(Node), count, freedSize(), vectorSize, vectorCapacity);
+#if defined(NULL_NODE) && !defined(STATIC_NULL_NODE)
+        m.addSentinel(sizeof(Node));
+#endif
+        if (hasHeapPayload<K>::value) {
+            m.addSubtree(root, static_cast<Node*>(nulle));
+#ifndef DISABLE_FREED_LIST
+            m.addFreed(freed, static_cast<Node*>(nulle));
+#endif
+        }
+        return m;
+    }
+
+    /*
+     * Prepend the freed node to the freed list via its left pointer,
+     * unless the freed list has reached the limit of freedPolicy.
      *
      * Calling parameter:
      * 
@@ -360,10 +602,17 @@ public:
 private:
     inline void deleteNode( Node* q ) {
 #ifndef DISABLE_FREED_LIST
-        q->left = freed;
-        freed = q;
+        if ( freedCount < freedMax || freedCount < freedFraction * count || inArena(q) ) {
+            q->left = freed;
+            freed = q;
+            ++freedCount;
+        } else {
+            delete q;
+        }
 #else
-        delete q;
+        if ( !inArena(q) ) {
+            delete q;
+        }
 #endif
     }
 
@@ -383,6 +632,7 @@ private:
         {
             Node* ptr = freed;
             freed = freed->left;
+            --freedCount;
             ptr->key = key;
             ptr->color = RED;
             ptr->left = ptr->right = ptr->parent = nulle;
@@ -420,15 +670,21 @@ public:
     inline bool contains( Node* const q, K const& x) {
         
         Node* p = q;            
+        TREE_STATS(size_t length = 0;)
         while ( p != nulle ) {                    /* iterate; don't use recursion */
+            TREE_STATS(++length;)
             if ( x < p->key ) {
+                TREE_STATS(++stats.comparisons;)
                 p = p->left;                        /* follow the left branch */
             } else if ( x > p->key ) {
+                TREE_STATS(stats.comparisons += 2;)
                 p = p->right;                       /* follow the right branch */
             } else {
+                TREE_STATS(stats.comparisons += 2; treeStats::record(stats.searchLength, length);)
                 return true;                        /* found the key, so return true */
             }
         }
+        TREE_STATS(treeStats::record(stats.searchLength, length);)
         return false;                               /* didn't find the key, so return false */
     }
     
@@ -462,6 +718,7 @@ public:
      */
 public:
     bool insert( K const& n ) {
+        TREE_STATS(stats.steps = 0;)
 		if (root == nulle) {
 			root = newNode(n);
 		} else {
@@ -514,16 +771,20 @@ public:
 		
 		root->color = BLACK;
 		++count;
+        TREE_STATS(treeStats::record(stats.insertPropagation, stats.steps);)
 		return true;
 	}
 
 private:
     inline int compareTo(K const& k1, K const& k2) {
         if (k1 < k2) {
+            TREE_STATS(++stats.comparisons;)
             return -1;
         } else if (k1 > k2) {
+            TREE_STATS(stats.comparisons += 2;)
             return 1;
         } else {
+            TREE_STATS(stats.comparisons += 2;)
             return 0;
         }
     }
@@ -535,6 +796,7 @@ private:
         }
 		if (m->right->color == RED && m->left->color == RED) {
             // flip colors
+            TREE_STATS(++stats.steps; ++stats.colorFlips;)
 			m->color = RED;
 			m->right->color = BLACK;
 			m->left->color = BLACK;
@@ -569,6 +831,7 @@ private:
 		m->left = newNode(n);
         m->left->parent = m;
 		if (m->color == RED && p != nulle) { 
+            TREE_STATS(++stats.steps;)
 			Node* x;
 			if (p->left == nulle) {
                 x = doubleLeftRotation(p);
@@ -590,6 +853,7 @@ private:
 		m->right = newNode(n);
         m->right->parent = m;
 		if (m->color == RED && p != nulle) { 
+            TREE_STATS(++stats.steps;)
 			Node* x;
             if (p->right == nulle) {
                 x = doubleRightRotation(p);
@@ -682,6 +946,7 @@ private:
         }
 
         ++singleRotationCount;
+        TREE_STATS(++stats.rotations;)
         return n;
     }
 
@@ -734,6 +999,7 @@ private:
         }
 
         ++singleRotationCount;
+        TREE_STATS(++stats.rotations;)
         return n;
     }
 
@@ -788,6 +1054,7 @@ private:
         n->left->color = RED;
 
         ++singleRotationCount;
+        TREE_STATS(++stats.rotations;)
         return n;
     }
 
@@ -838,6 +1105,7 @@ private:
         }
 
         ++singleRotationCount;
+        TREE_STATS(++stats.rotations;)
         return n;
     }
     
@@ -890,6 +1158,7 @@ private:
         }
 
         ++singleRotationCount;
+        TREE_STATS(++stats.rotations;)
         return n;
     }
     
@@ -944,6 +1213,7 @@ private:
         n->right->color = RED;
 
         ++singleRotationCount;
+        TREE_STATS(++stats.rotations;)
         return n;
     }
     
@@ -1012,10 +1282,13 @@ private:
         Node* ptr = node;
         while ( ptr != nulle ) {
             if ( key < ptr->key ) {
+                TREE_STATS(++stats.comparisons;)
                 ptr = ptr->left;
             } else if ( key > ptr->key ) {
+                TREE_STATS(stats.comparisons += 2;)
                 ptr = ptr->right;
             } else {
+                TREE_STATS(stats.comparisons += 2;)
                 // Found the key. Does the node have one child or fewer?
                 if (ptr->left == nulle || ptr->right == nulle) {
                     return ptr; // Yes, so return the node.
@@ -1075,7 +1348,9 @@ public:
 
         // Repair the tree and put the node back on the freed list.
         --count;
+        TREE_STATS(stats.steps = 0;)
         fixErasure(node);
+        TREE_STATS(treeStats::record(stats.erasePropagation, stats.steps);)
         return true;
     }
 
@@ -1165,6 +1440,7 @@ private:
             ptr->color = DOUBLE_BLACK; // DB is a shorthand for ptr below; ptr exists, so no need for setColor.
             // ptr can't retreat to the root, so no need for getColor(ptr).
             while (ptr != root && ptr->color == DOUBLE_BLACK) {//
+                TREE_STATS(++stats.steps;)
                 parent = ptr->parent;
                 if (ptr == parent->left) {
                     // DB is the left child of its parent.
@@ -1182,12 +1458,14 @@ private:
                             // So, remove DOUBLE_BLACK from DB and transfer it to DB's parent and change
                             // the sibling's color to RED.
                             ptr->color = BLACK;  // ptr can't retreat to the root, so no need for setColor(ptr).
+                            TREE_STATS(++stats.colorFlips;)
                             setColor(sibling, RED);
                             // ptr can't retreat to the root, so no need for getColor(parent) or setColor(parent, *).
                             if (parent->color == RED) {
                                 parent->color = BLACK;
                             } else {
                                 parent->color = DOUBLE_BLACK;
+                                TREE_STATS(++stats.doubleBlackSteps;)
                             }
                             ptr = parent;  // Here is where ptr retreats to its parent.
                         } else if (getColor(sibling->right) == BLACK) {
@@ -1252,12 +1530,14 @@ private:
                             // So, remove DOUBLE_BLACK from DB and transfer it to DB's parent and change
                             // the sibling's color to RED.
                             ptr->color = BLACK;  // ptr can't retreat to the root, so no need for setColor(ptr).
+                            TREE_STATS(++stats.colorFlips;)
                             setColor(sibling, RED);
                             // ptr can't retreat to the root, so no need for getColor(parent) or setColor(parent, *).
                             if (parent->color == RED) {
                                 parent->color = BLACK;
                             } else {
                                 parent->color = DOUBLE_BLACK;
+                                TREE_STATS(++stats.doubleBlackSteps;)
                             }
                             ptr = parent;  // Here is where ptr retreats to its parent.
                         } else if (getColor(sibling->left) == BLACK) {
@@ -1359,6 +1639,7 @@ private:
 
         // Increment the rotation count.
         ++rotateL;
+        TREE_STATS(++stats.rotations;)
     }
 
     /*
@@ -1397,6 +1678,7 @@ private:
 
         // Increment the rotation count.
         ++rotateR;
+        TREE_STATS(++stats.rotations;)
     }
 
     /*
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Log-linear latency histogram in the style of HdrHistogram, and a
+ * low-overhead timer for measuring the latency of individual operations.
+ *
+ * The histogram divides each power-of-two range of values [2^e, 2^(e+1))
+ * into 2^SUB_BITS linear sub-buckets, so that the width of a bucket is at
+ * most 1/2^SUB_BITS of its lowest value, and values below 2^SUB_BITS are
+ * recorded exactly. Recording a value requires only a count of leading
+ * zeros, a shift and an increment, and the histogram covers every 64-bit
+ * value in a fixed array of (65 - SUB_BITS) * 2^SUB_BITS counts.
+ *
+ * A percentile is reported as the highest value that is equivalent to the
+ * bucket that contains it, but not greater than the maximum recorded value,
+ * so that the reported percentile never understates the latency.
+ *
+ * The latencyTimer reads the time stamp counter via rdtsc on x86-64, which
+ * requires tens of cycles instead of the system call or vDSO overhead of
+ * std::chrono::steady_clock, and calibrates ticks to nanoseconds against
+ * steady_clock. On other architectures, it reads steady_clock directly.
+ * To force steady_clock on x86-64, compile via:
+ *
+ * g++ -std=c++11 -O3 -D LATENCY_STEADY_CLOCK test_allTrees.cpp
+ */
+
+#ifndef LOG_LINEAR_LATENCY_HISTOGRAM_H
+#define LOG_LINEAR_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) && !defined(LATENCY_STEADY_CLOCK)
+#include <x86intrin.h>
+#endif
+
+/*
+ * The latencyHistogram class records 64-bit values, typically durations
+ * in timer ticks, into log-linear buckets.
+ */
+class latencyHistogram
+{
+private:
+    static constexpr int SUB_BITS = 5;                      // 32 sub-buckets, at most 3.2% error
+    static constexpr uint64_t SUB_COUNT = uint64_t(1) << SUB_BITS;
+
+private:
+    std::vector<uint64_t> counts;   // the count of each bucket
+    uint64_t total;                 // the number of recorded values
+    uint64_t minimum, maximum;      // the minimum and maximum recorded values
+    double sum;                     // the sum of the recorded values
+
+public:
+    latencyHistogram() : counts( ( 65 - SUB_BITS ) * SUB_COUNT, 0 ) {
+        reset();
+    }
+
+    /* Discard every recorded value. */
+public:
+    void reset() {
+        std::fill( counts.begin(), counts.end(), 0 );
+        total = maximum = 0;
+        minimum = UINT64_MAX;
+        sum = 0.;
+    }
+
+    /*
+     * Find the bucket of a value.
+     *
+     * Calling parameter:
+     *
+     * @param v (IN) the value
+     *
+     * @return the index of the bucket
+     */
+private:
+    static inline size_t bucket( uint64_t const v ) {
+        if ( v < SUB_COUNT ) {
+            return static_cast<size_t>( v );
+        }
+        int const e = 63 - __builtin_clzll( v );  // e >= SUB_BITS
+        uint64_t const sub = ( v >> ( e - SUB_BITS ) ) & ( SUB_COUNT - 1 );
+        return static_cast<size_t>( ( e - SUB_BITS + 1 ) * SUB_COUNT + sub );
+    }
+
+    /*
+     * Find the highest value that is equivalent to a bucket.
+     *
+     * Calling parameter:
+     *
+     * @param i (IN) the index of the bucket
+     *
+     * @return the highest value that the bucket contains
+     */
+private:
+    static inline uint64_t highest( size_t const i ) {
+        if ( i < SUB_COUNT ) {
+            return i;
+        }
+        int const e = static_cast<int>( i / SUB_COUNT ) + SUB_BITS - 1;
+        uint64_t const sub = i % SUB_COUNT;
+        uint64_t const low = ( uint64_t(1) << e ) | ( sub << ( e - SUB_BITS ) );
+        return low + ( ( uint64_t(1) << ( e - SUB_BITS ) ) - 1 );
+    }
+
+    /*
+     * Record a value.
+     *
+     * Calling parameter:
+     *
+     * @param v (IN) the value
+     */
+public:
+    inline void record( uint64_t const v ) {
+        ++counts[bucket( v )];
+        ++total;
+        minimum = std::min( minimum, v );
+        maximum = std::max( maximum, v );
+        sum += static_cast<double>( v );
+    }
+
+    /*
+     * Add the values recorded by another histogram to this histogram.
+     *
+     * Calling parameter:
+     *
+     * @param h (IN) the other histogram
+     */
+public:
+    void merge( latencyHistogram const& h ) {
+        for ( size_t i = 0; i < counts.size(); ++i ) {
+            counts[i] += h.counts[i];
+        }
+        total += h.total;
+        minimum = std::min( minimum, h.minimum );
+        maximum = std::max( maximum, h.maximum );
+        sum += h.sum;
+    }
+
+    /* Return the number of recorded values. */
+public:
+    uint64_t count() const {
+        return total;
+    }
+
+    /* Return the minimum recorded value, or 0 if no value was recorded. */
+public:
+    uint64_t min() const {
+        return ( total == 0 ) ? 0 : minimum;
+    }
+
+    /* Return the maximum recorded value. */
+public:
+    uint64_t max() const {
+        return maximum;
+    }
+
+    /* Return the mean of the recorded values, or 0 if no value was recorded. */
+public:
+    double mean() const {
+        return ( total == 0 ) ? 0. : sum / static_cast<double>( total );
+    }
+
+    /*
+     * Find the value at a percentile.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the percentile in the range [0, 100]
+     *
+     * @return the highest value equivalent to the bucket that contains
+     *         the percentile, or 0 if no value was recorded
+     */
+public:
+    uint64_t percentile( double const p ) const {
+        if ( total == 0 ) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>( std::ceil( ( p / 100. ) * static_cast<double>( total ) ) );
+        rank = std::max( rank, uint64_t(1) );
+        uint64_t cumulative = 0;
+        for ( size_t i = 0; i < counts.size(); ++i ) {
+            cumulative += counts[i];
+            if ( cumulative >= rank ) {
+                return std::min( highest( i ), maximum );
+            }
+        }
+        return maximum;
+    }
+};
+
+/*
+ * The latencyTimer class reads a monotonic timer in ticks
+ * and converts ticks to nanoseconds.
+ */
+class latencyTimer
+{
+private:
+    double nanosPerTick;
+
+    /*
+     * Here is the constructor, which calibrates the time stamp counter
+     * against steady_clock by spinning for the specified duration.
+     *
+     * Calling parameter:
+     *
+     * @param calibrationMillis (IN) the calibration duration in milliseconds
+     */
+public:
+    latencyTimer( int const calibrationMillis = 20 ) {
+#if defined(__x86_64__) && !defined(LATENCY_STEADY_CLOCK)
+        auto const start = std::chrono::steady_clock::now();
+        uint64_t const startTicks = now();
+        auto end = start;
+        do {
+            end = std::chrono::steady_clock::now();
+        } while ( end - start < std::chrono::milliseconds( calibrationMillis ) );
+        uint64_t const endTicks = now();
+        double const nanos = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>( end - start ).count() );
+        nanosPerTick = nanos / static_cast<double>( endTicks - startTicks );
+#else
+        (void) calibrationMillis;
+        nanosPerTick = 1.;
+#endif
+    }
+
+    /*
+     * Read the timer. The lfence instructions prevent the processor
+     * from executing rdtsc before preceding instructions complete or
+     * following instructions before rdtsc completes.
+     *
+     * @return the time in ticks
+     */
+public:
+    static inline uint64_t now() {
+#if defined(__x86_64__) && !defined(LATENCY_STEADY_CLOCK)
+        _mm_lfence();
+        uint64_t const t = __rdtsc();
+        _mm_lfence();
+        return t;
+#else
+        return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch() ).count() );
+#endif
+    }
+
+    /*
+     * Convert ticks to nanoseconds.
+     *
+     * Calling parameter:
+     *
+     * @param ticks (IN) a duration in ticks
+     *
+     * @return the duration in nanoseconds
+     */
+public:
+    inline double nanos( uint64_t const ticks ) const {
+        return nanosPerTick * static_cast<double>( ticks );
+    }
+};
+
+#endif // LOG_LINEAR_LATENCY_HISTOGRAM_H
@@ -75,6 +75,27 @@
  * To preallocate the freed list as a vector of avl tree nodes, compile via:
  * 
  * g++ -std=c++11 -O3 -D PREALLOCATE test_llrbTree.cpp
+ *
+ * By default, a node that is erased remains on the freed list until
+ * clear() is called. The freedPolicy function limits the freed list
+ * to the larger of a number of nodes and a fraction of the number of
+ * nodes in the tree, beyond which an erased node is deleted, and the
+ * shrinkToFit function deletes the freed nodes in excess of that limit.
+ * A node that occupies the arena of freedPreallocate or clone is retained
+ * on the freed list regardless of the limit until the tree is empty,
+ * whereupon shrinkToFit releases the arena.
+ * 
+ * The insert and erase functions descend iteratively and record the
+ * path from the root, then retreat along the path and rebalance each
+ * node in the manner of the recursive functions of Sedgewick and Wayne.
+ * The retreat stops at a BLACK node that requires no rebalancing, above
+ * which the descent restructured no node, because no ancestor of that
+ * node requires rebalancing. Such a node is typically found near the
+ * bottom of the tree by insert but seldom by erase, which restructures
+ * the tree during descent. To use recursion instead of iteration,
+ * compile via:
+ * 
+ * g++ -std=c++11 -O3 -D RECURSION test_llrbTree.cpp
  * 
  * To enable parent pointers, compile via:
  * 
@@ -85,29 +106,32 @@
  * 
  * g++ -std=c++11 -O3 -D ENABLE_PREFERRED_TEST test_llrbTree.cpp
  * 
- * HOWEVER, selection of a preferred replacement node
- * does not work correctly because it is not possible
- * to find the in-order predecessor of a node. The
- * problem is that a search for the maximum node
- * begins with setting color of the root node of
- * the tree to RED, or in the case of a 2-child node,
- * setting the left child of that node to RED. Upon
- * conclusion of the search, the color of the root
- * node is reset to BLACK. But this approach does
- * not work with the left child of the 2-child node
- * because, upon conclusion of the search, the color
- * of the left child affects the BLACK node count to
- * the bottom of the tree, which MUST equal the BLACK
- * node count for the right child. The root has no
- * sibling but the left child has the right child as
- * a sibling.
+ * The taille field of each node records the size of the
+ * subtree rooted at the node. When a 2-child node is
+ * deleted, the in-order predecessor replaces the node
+ * if the left subtree is at least as large as the right
+ * subtree; otherwise, the in-order successor replaces
+ * the node. The predecessor is removed in the manner
+ * of the deletion of any key that is smaller than the
+ * key of the node, i.e., moveRedLeft ensures that the
+ * left child or its left child is RED prior to descent
+ * into the left subtree via deleteMax, so that the BLACK
+ * node count of the left subtree remains equal to that
+ * of the right subtree. Recoloring the left child of the
+ * node RED prior to descent and BLACK afterward, as the
+ * root is recolored by deleteMax(), does not preserve
+ * that equality, because the right child is a sibling
+ * of the left child, whereas the root has no sibling.
+ *
+ * To select the in-order predecessor only if the left
+ * subtree is smaller than the right subtree, compile via:
  *
- * For this reason, ENABLE_PREFERRED_TEST is overridden
- * by '#define FORCE_SUCCESSOR' in the erase function.
- * Hence, ENABLE_PREFERRED_TEST enables update of each
- * nodes taille field that represents the size of the
- * subtree rooted at the node but does not use that
- * size to select a preferred replacement node.
+ * g++ -std=c++11 -O3 -D ENABLE_PREFERRED_TEST -D INVERT_PREFERRED_TEST test_llrbTree.cpp
+ *
+ * To count comparisons, search path lengths and rebalancing steps
+ * (see treeStats.h), compile via:
+ *
+ * g++ -std=c++11 -O3 -D ENABLE_TREE_STATS test_llrbTree.cpp
  */
 
 #ifndef ANDERSSON_SEDGEWICK_WAYNE_ARGENTO_LLRB_TREE_H
@@ -115,9 +139,16 @@
 
 #include <iostream>
 #include <exception>
+#include <functional>
+#include <limits>
 #include <sstream>
+#include <utility>
 #include <vector>
 
+#include "memoryFootprint.h"
+#include "nodeArena.h"
+#include "treeStats.h"
+
 /*
  * The llrbTree class defines the root of the left-leaning red-black tree
  * and provides the RED and BLACK bool constants.
@@ -179,30 +210,152 @@ private:
     Node* root;     // the root of the tree
     size_t count;   // the number of nodes in the tree
     bool a, r;      // record modification of the tree
+    Node* minNode;  // the node that contains the minimum key
+    Node* maxNode;  // the node that contains the maximum key
 
 #ifndef DISABLE_FREED_LIST
-    Node* freed;    // the freed list
-#ifdef PREALLOCATE
-    std::vector<Node> nodes;
-#endif
+    Node* freed;            // the freed list
+    size_t freedCount;      // the number of nodes on the freed list
+    size_t freedMax;        // the number of freed nodes to retain regardless of tree size
+    double freedFraction;   // the fraction of the tree size to retain as freed nodes
 #endif
+    nodeArena<Node> arena;  // the nodes of freedPreallocate and clone
   
 public:
     size_t rotateL, rotateR; // rotation counters
+#ifdef ENABLE_TREE_STATS
+    treeStats stats;         // the comparisons and histograms
+#endif
 
 public:
     llrbTree() {
-        root = freed = nullptr;
-        count = 0;
+        root = minNode = maxNode = nullptr;
+#ifndef DISABLE_FREED_LIST
+        freed = nullptr;
+        freedCount = 0;
+        freedMax = std::numeric_limits<size_t>::max();
+        freedFraction = 0.;
+#endif
+        count = rotateL = rotateR = 0;
         a = r = false;
     }
     
 public:
     ~llrbTree() {
-        if ( root != nullptr ) {
-            clear();
-            clearFreed();
+        clear();
+    }
+
+    /* The tree owns its nodes, so it is not copied; call clone instead. */
+public:
+    llrbTree(llrbTree const&) = delete;
+
+public:
+    llrbTree& operator=(llrbTree const&) = delete;
+
+    /*
+     * Move a tree in O(1) time, which leaves the other tree empty.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    llrbTree(llrbTree&& t) noexcept : llrbTree() {
+        swap(t);
+    }
+
+    /*
+     * Move a tree in O(1) time by exchanging it with this tree, so that
+     * the nodes of this tree are deleted when the other tree is destroyed.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    llrbTree& operator=(llrbTree&& t) noexcept {
+        swap(t);
+        return *this;
+    }
+
+    /*
+     * Exchange the nodes, freed list, arena and counters of two trees
+     * in O(1) time.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the other tree
+     */
+public:
+    void swap(llrbTree& t) noexcept {
+        std::swap(root, t.root);
+        std::swap(count, t.count);
+        std::swap(minNode, t.minNode);
+        std::swap(maxNode, t.maxNode);
+#ifndef DISABLE_FREED_LIST
+        std::swap(freed, t.freed);
+        std::swap(freedCount, t.freedCount);
+        std::swap(freedMax, t.freedMax);
+        std::swap(freedFraction, t.freedFraction);
+#endif
+        arena.swap(t.arena);
+        std::swap(rotateL, t.rotateL);
+        std::swap(rotateR, t.rotateR);
+#ifdef ENABLE_TREE_STATS
+        std::swap(stats, t.stats);
+#endif
+    }
+
+    /*
+     * Copy the shape, keys and colors of the tree in one linear pass
+     * that performs no comparisons or rebalancing. The nodes of the copy
+     * are allocated as one block of the arena of the copy.
+     *
+     * @return the copy
+     */
+public:
+    llrbTree clone() const {
+        llrbTree t;
+        size_t i = 0;
+        t.root = cloneNode(root, t.arena.allocate(count), i);
+        t.count = count;
+        t.updateExtremes();
+        return t;
+    }
+
+    /*
+     * Copy a subtree in pre-order to consecutive nodes of a block.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param block (MODIFIED) the block of nodes
+     * @param i (MODIFIED) the index of the next unused node of the block
+     *
+     * @return the root of the copy of the subtree
+     */
+private:
+    static Node* cloneNode(Node const* const p, Node* const block, size_t& i) {
+        if (p == nullptr) {
+            return nullptr;
+        }
+        Node* const q = block + i++;
+        q->key = p->key;
+        q->color = p->color;
+#ifdef ENABLE_PREFERRED_TEST
+        q->taille = p->taille;
+#endif
+        q->left = cloneNode(p->left, block, i);
+        q->right = cloneNode(p->right, block, i);
+#ifdef PARENT
+        if (q->left != nullptr) {
+            q->left->parent = q;
+        }
+        if (q->right != nullptr) {
+            q->right->parent = q;
         }
+#endif
+        return q;
     }
 
     /*
@@ -221,7 +374,9 @@ private:
         }
         clear(node->left);
         clear(node->right);
-        delete node;
+        if ( !inArena(node) ) {
+            delete node;
+        }
     }
     /*
      * Attempt to obtain a node from the freed list instead of
@@ -235,42 +390,110 @@ private:
 public:
     void clear() {
 	    clear(root);
-        root = nullptr;
+        root = minNode = maxNode = nullptr;
         count = 0;
 #ifndef DISABLE_FREED_LIST
 	    clearFreed();
 #endif
+        arena.release();
     }
 
     /* Delete every node from the freed list. */
 private:
     void clearFreed() {
 #ifndef DISABLE_FREED_LIST
-#ifndef PREALLOCATE
         while ( freed != nullptr ) {
             Node* next = freed->left;
-            delete freed;
+            if ( !inArena(freed) ) {
+                delete freed;
+            }
             freed = next;
         }
-#else
-        nodes.clear();
-#endif
         freed = nullptr;
+        freedCount = 0;
 #endif
     }
 
+    /*
+     * Determine whether a node occupies the arena of freedPreallocate
+     * or clone, and hence must not be deleted.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node
+     *
+     * @return true if the node occupies the arena; otherwise, false
+     */
+private:
+    inline bool inArena( Node const* const p ) {
+        return arena.contains(p);
+    }
+
     /* Report the number of nodes on the freed list. */
 public:
     size_t freedSize() {
-        size_t count = 0;
 #ifndef DISABLE_FREED_LIST
-        Node* ptr = freed;
-        while(ptr != nullptr) {
-            ++count;
-            ptr = ptr->left;
+        return freedCount;
+#else
+        return 0;
+#endif
+    }
+
+    /*
+     * Limit the number of nodes that the freed list retains to the larger
+     * of a number of nodes and a fraction of the number of nodes in the tree.
+     * The default policy retains every freed node.
+     *
+     * Calling parameters:
+     *
+     * @param maxNodes (IN) the number of nodes to retain regardless of tree size
+     * @param fraction (IN) the fraction of the tree size to retain
+     */
+public:
+    void freedPolicy( size_t const maxNodes, double const fraction ) {
+#ifndef DISABLE_FREED_LIST
+        freedMax = maxNodes;
+        freedFraction = fraction;
+#else
+        (void) maxNodes;
+        (void) fraction;
+#endif
+    }
+
+    /*
+     * Delete the nodes on the freed list in excess of the limit of
+     * freedPolicy. A node that occupies the arena is retained unless
+     * the tree is empty, in which case the arena is released.
+     */
+public:
+    void shrinkToFit() {
+#ifndef DISABLE_FREED_LIST
+        size_t const fraction = static_cast<size_t>(freedFraction * count);
+        size_t const limit = (freedMax > fraction) ? freedMax : fraction;
+        Node* p = freed;
+        freed = nullptr;
+        freedCount = 0;
+        while ( p != nullptr ) {
+            Node* next = p->left;
+            if ( inArena(p) ) {
+                if ( count != 0 ) {
+                    p->left = freed;
+                    freed = p;
+                    ++freedCount;
+                }
+            } else if ( freedCount < limit ) {
+                p->left = freed;
+                freed = p;
+                ++freedCount;
+            } else {
+                delete p;
+            }
+            p = next;
+        }
+        if ( count == 0 ) {
+            arena.release();
         }
 #endif
-        return count;
     }
 
     /*
@@ -289,19 +512,43 @@ public:
             p->left = freed;
             freed = p;
         }
+        freedCount += n;
 #else
-        nodes.resize(n);
+        Node* const block = arena.allocate(n);
         for (size_t i = 0; i < n; ++i) {
-            Node* p = &nodes[i];
+            Node* p = block + i;
             p->left = freed;
             freed = p;
         }
+        freedCount += n;
 #endif
 #endif
     }
 
     /*
-     * Prepend the freed node to the freed list via its left pointer.
+     * Report the memory that the LL RB tree occupies (see memoryFootprint.h).
+     *
+     * @return the live, freed, reserved, payload and overhead bytes
+     */
+public:
+    memoryFootprint memoryUsage() {
+        memoryFootprint m;
+        size_t const vectorSize = arena.size(), vectorCapacity = arena.capacity();
+        m.addNodes(sizeof(Node), count, freedSize(), vectorSize, vectorCapacity);
+        if (hasHeapPayload<K>::value) {
+            m.addSubtree(root, static_cast<Node*>(nullptr));
+#ifndef DISABLE_FREED_LIST
+            m.addFreed(freed, static_cast<Node*>(nullptr));
+#endif
+        }
+        return m;
+    }
+
+    /*
+     * Prepend the freed node to the freed list via its left pointer,
+     * unless the freed list has reached the limit of freedPolicy.
+     * If the node is the cached minimum or maximum node, invalidate
+     * the cache so that the caller recomputes it via updateExtremes.
      *
      * Calling parameter:
      * 
@@ -309,11 +556,24 @@ public:
      */
 public:
     inline void deleteNode( Node* q ) {
+        if ( q == minNode ) {
+            minNode = nullptr;
+        }
+        if ( q == maxNode ) {
+            maxNode = nullptr;
+        }
 #ifndef DISABLE_FREED_LIST
-        q->left = freed;
-        freed = q;
+        if ( freedCount < freedMax || freedCount < freedFraction * count || inArena(q) ) {
+            q->left = freed;
+            freed = q;
+            ++freedCount;
+        } else {
+            delete q;
+        }
 #else
-        delete q;
+        if ( !inArena(q) ) {
+            delete q;
+        }
 #endif
     }
 
@@ -333,8 +593,9 @@ private:
         {
             Node* ptr = freed;
             freed = freed->left;
+            --freedCount;
             ptr->key = key;
-            ptr->color = RED;
+            ptr->color = c;
 #ifdef ENABLE_PREFERRED_TEST
             ptr->taille = 1;
 #endif
@@ -364,15 +625,21 @@ private:
     inline bool contains( Node* const q, K const& x) {
         
         Node* p = q;            
+        TREE_STATS(size_t length = 0;)
         while ( p != nullptr ) {                    /* iterate; don't use recursion */
+            TREE_STATS(++length;)
             if ( x < p->key ) {
+                TREE_STATS(++stats.comparisons;)
                 p = p->left;                        /* follow the left branch */
             } else if ( x > p->key ) {
+                TREE_STATS(stats.comparisons += 2;)
                 p = p->right;                       /* follow the right branch */
             } else {
+                TREE_STATS(stats.comparisons += 2; treeStats::record(stats.searchLength, length);)
                 return true;                        /* found the key, so return true */
             }
         }
+        TREE_STATS(treeStats::record(stats.searchLength, length);)
         return false;                               /* didn't find the key, so return false */
     }
     
@@ -411,6 +678,7 @@ private:
         }
 
         ++rotateL;
+        TREE_STATS(++stats.rotations;)
 
         Node* p1 = p->right;
 
@@ -438,6 +706,7 @@ private:
         }
 
         ++rotateL;
+        TREE_STATS(++stats.rotations;)
 
         Node* p1 = p->right;
 
@@ -473,6 +742,7 @@ private:
         }
 
         ++rotateR;
+        TREE_STATS(++stats.rotations;)
 
         Node* p1 = p->left;
 
@@ -500,6 +770,7 @@ private:
         }
 
         ++rotateR;
+        TREE_STATS(++stats.rotations;)
 
         Node* p1 = p->left;
 
@@ -535,12 +806,14 @@ private:
         // The root must have opposite color of its two children
         if ((isRed(p) && !isRed(p->left) && !isRed(p->right))
                 || (!isRed(p) && isRed(p->left) && isRed(p->right))) {
+            TREE_STATS(++stats.colorFlips;)
             p->color = !p->color;
             p->left->color = !p->left->color;
             p->right->color = !p->right->color;
         }
 #else
         if (p != nullptr) {
+            TREE_STATS(++stats.colorFlips;)
             p->color = !p->color;
 
             if (p->left != nullptr) {
@@ -584,24 +857,32 @@ private:
         }
 
         if (x < p->key) {
+            TREE_STATS(++stats.comparisons;)
             p->left = insert( p, p->left, x );
         } else if (x > p->key) {
+            TREE_STATS(stats.comparisons += 2;)
             p->right = insert( p, p->right, x );
         } else {
             // For a tree, don't insert the key twice.
             // For a map, overwrite the value.
+            TREE_STATS(stats.comparisons += 2;)
             a = false;
         }
 
+        TREE_STATS(bool fixed = false;)
         if (isRed(p->right) && !isRed(p->left)) {
+            TREE_STATS(fixed = true;)
             p = rotateLeft(p);
         }
         if (isRed(p->left) && isRed(p->left->left)) {
+            TREE_STATS(fixed = true;)
             p = rotateRight(p);
         }
         if (isRed(p->left) && isRed(p->right)) {
+            TREE_STATS(fixed = true;)
             flipColors(p);
         }
+        TREE_STATS(if ( fixed == true ) ++stats.steps;)
         
 #ifdef ENABLE_PREFERRED_TEST
         p->taille = updateSize(p);
@@ -618,24 +899,32 @@ private:
         }
 
         if (x < p->key) {
+            TREE_STATS(++stats.comparisons;)
             p->left = insert( p->left, x );
         } else if (x > p->key) {
+            TREE_STATS(stats.comparisons += 2;)
             p->right = insert(p->right, x );
         } else {
             // For a tree, don't insert the key twice.
             // For a map, overwrite the value.
+            TREE_STATS(stats.comparisons += 2;)
             a = false;
         }
 
+        TREE_STATS(bool fixed = false;)
         if (isRed(p->right) && !isRed(p->left)) {
+            TREE_STATS(fixed = true;)
             p = rotateLeft(p);
         }
         if (isRed(p->left) && isRed(p->left->left)) {
+            TREE_STATS(fixed = true;)
             p = rotateRight(p);
         }
         if (isRed(p->left) && isRed(p->right)) {
+            TREE_STATS(fixed = true;)
             flipColors(p);
         }
+        TREE_STATS(if ( fixed == true ) ++stats.steps;)
         
 #ifdef ENABLE_PREFERRED_TEST
         p->taille = updateSize(p);
@@ -650,17 +939,22 @@ private:
             return nullptr;
         }
 
+        TREE_STATS(bool fixed = false;)
         if (isRed(p->right) && !isRed(p->left)) {
+            TREE_STATS(fixed = true;)
             p = rotateLeft(p);
         }
 
         if (isRed(p->left) && p->left != nullptr && isRed(p->left->left)) {
+            TREE_STATS(fixed = true;)
             p = rotateRight(p);
         }
 
         if (isRed(p->left) && isRed(p->right)) {
+            TREE_STATS(fixed = true;)
             flipColors(p);
         }
+        TREE_STATS(if ( fixed == true ) ++stats.steps;)
 
 #ifdef ENABLE_PREFERRED_TEST
         p->taille = updateSize(p);
@@ -697,9 +991,14 @@ private:
         return min(p->left);
     }
 
+    /*
+     * Return the minimum key in O(1) time from the cached minimum node.
+     *
+     * @return a pointer to the minimum key, or nullptr if the tree is empty
+     */
 public:
     K* min() {
-        return &(min(root)->key);
+        return ( minNode == nullptr ) ? nullptr : &(minNode->key);
     }
 
 private:
@@ -730,10 +1029,15 @@ public:
             root->color = RED;
         }
         r = false;
+#ifdef RECURSION
         root = deleteMin(root);
+#else
+        eraseIteratively(nullptr, MINIMUM);
+#endif
         if ( !empty() ) {
             root->color = BLACK;
         }
+        updateExtremes();
      return r;
    }
 
@@ -745,9 +1049,14 @@ private:
         return max(p->right);
     }
 
+    /*
+     * Return the maximum key in O(1) time from the cached maximum node.
+     *
+     * @return a pointer to the maximum key, or nullptr if the tree is empty
+     */
 public:
     K* max() {
-        return &(max(root)->key);
+        return ( maxNode == nullptr ) ? nullptr : &(maxNode->key);
     }
 
 private:
@@ -771,31 +1080,6 @@ private:
         return balance(p);
     }
 
-#ifdef ENABLE_PREFERRED_TEST
-private:
-    Node* eraseMax( Node* p ) {
-        if ( p == nullptr ) {
-            return nullptr;
-        }
-
-        // If both children of the node are BLACK, set the node to RED.
-        if ( !isRed(p->left) && !isRed(p->right) ) {
-            p->color = RED;
-        }
-        p = deleteMax(p);
-
-        // This attempt to fix the red-red problem
-        // doesn't work in all cases because it can
-        // cause the left subtree to have a longer
-        // black path than the right subtree.
-        if ( p != nullptr ) {
-            p->color = BLACK;
-        }
-
-        return p;
-   }
-#endif
-
 public:
     inline bool deleteMax() {
         if ( empty() ) {
@@ -807,13 +1091,427 @@ public:
             root->color = RED;
         }
         r = false;
+#ifdef RECURSION
         root = deleteMax(root);
+#else
+        eraseIteratively(nullptr, MAXIMUM);
+#endif
         if ( !empty() ) {
             root->color = BLACK;
         }
+        updateExtremes();
         return r;
    }
 
+    /*
+     * Recompute the cached minimum and maximum nodes that deleteNode
+     * has invalidated. The spine of the tree is walked only if the
+     * minimum or maximum key has been removed.
+     */
+private:
+    inline void updateExtremes() {
+        if ( root == nullptr ) {
+            minNode = maxNode = nullptr;
+            return;
+        }
+        if ( minNode == nullptr ) {
+            minNode = min(root);
+        }
+        if ( maxNode == nullptr ) {
+            maxNode = max(root);
+        }
+    }
+
+    /*
+     * Replace the key of a node by the key of its in-order predecessor
+     * or successor, which erase will remove. If the predecessor or the
+     * successor is the cached minimum or maximum node, the cache then
+     * refers to the node that has received the key.
+     *
+     * Calling parameters:
+     *
+     * @param p (MODIFIED) the node whose key is replaced
+     * @param q (IN) the in-order predecessor or successor of the node
+     */
+private:
+    inline void copyKey( Node* const p, Node* const q ) {
+        p->key = q->key;
+        if ( q == minNode ) {
+            minNode = p;
+        }
+        if ( q == maxNode ) {
+            maxNode = p;
+        }
+    }
+
+    /*
+     * Find the node that contains the kth smallest key of a subtree
+     * via an in-order walk that stops at that node, so that only the
+     * left spine and k nodes are visited.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree
+     * @param k (MODIFIED) the rank of the key, which is decremented for each node visited
+     *
+     * @return the node, or nullptr if the subtree contains fewer than k nodes
+     */
+private:
+    Node* selectMin( Node* const p, size_t& k ) {
+        if ( p == nullptr ) {
+            return nullptr;
+        }
+        Node* const q = selectMin( p->left, k );
+        if ( q != nullptr ) {
+            return q;
+        }
+        if ( --k == 0 ) {
+            return p;
+        }
+        return selectMin( p->right, k );
+    }
+
+    /*
+     * Find the node that contains the kth largest key of a subtree.
+     * See selectMin.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree
+     * @param k (MODIFIED) the rank of the key, which is decremented for each node visited
+     *
+     * @return the node, or nullptr if the subtree contains fewer than k nodes
+     */
+private:
+    Node* selectMax( Node* const p, size_t& k ) {
+        if ( p == nullptr ) {
+            return nullptr;
+        }
+        Node* const q = selectMax( p->right, k );
+        if ( q != nullptr ) {
+            return q;
+        }
+        if ( --k == 0 ) {
+            return p;
+        }
+        return selectMax( p->left, k );
+    }
+
+    /*
+     * Append the keys of a subtree to a vector in increasing or decreasing
+     * order and return each node of the subtree to the freed list.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree
+     * @param v (MODIFIED) the vector of keys
+     * @param increasing (IN) append the keys in increasing order if true
+     */
+private:
+    void popSubtree( Node* const p, std::vector<K>& v, bool const increasing ) {
+        if ( p == nullptr ) {
+            return;
+        }
+        Node* const left = p->left;
+        Node* const right = p->right;
+        popSubtree( ( increasing ) ? left : right, v, increasing );
+        v.push_back( p->key );
+        deleteNode( p );
+        popSubtree( ( increasing ) ? right : left, v, increasing );
+    }
+
+    /*
+     * Return the number of BLACK nodes along the left spine of a
+     * subtree, which is the BLACK height of every path of the subtree.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the root of the subtree
+     */
+private:
+    inline size_t blackHeight( Node* p ) {
+        size_t h = 0;
+        while ( p != nullptr ) {
+            if ( !isRed(p) ) {
+                ++h;
+            }
+            p = p->left;
+        }
+        return h;
+    }
+
+    /*
+     * Return the BLACK height of a child from the BLACK height of its parent.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the parent
+     * @param h (IN) the BLACK height of the parent
+     */
+private:
+    inline size_t childHeight( Node* const p, size_t const h ) {
+        return ( isRed(p) ) ? h : h - 1;
+    }
+
+    /*
+     * Link a RED node m between a subtree whose BLACK height is h and the
+     * subtree q, then rebalance the path as insert does. Each key of the
+     * subtree p is smaller than the key of m, which is smaller than each
+     * key of q.
+     *
+     * joinRight descends the right spine of p, whose BLACK height is greater
+     * than hq, until the BLACK height equals hq, where m becomes the parent
+     * of the spine node and q. joinLeft descends the left spine of q, whose
+     * BLACK height is greater than hp, to a BLACK node whose BLACK height
+     * equals hp, where m becomes the parent of p and the spine node.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the left subtree, or a node of its right spine
+     * @param h (IN) the BLACK height of p or q
+     * @param m (IN) the node to link
+     * @param q (IN) the right subtree, or a node of its left spine
+     * @param hq (IN) the BLACK height of q
+     * @param hp (IN) the BLACK height of p
+     *
+     * @return the root of the rebalanced subtree
+     */
+private:
+    Node* joinRight( Node* const p, size_t const h, Node* const m, Node* const q, size_t const hq ) {
+        if ( h == hq ) {
+            return linkRed( p, m, q );
+        }
+        p->right = joinRight( p->right, h - 1, m, q, hq );
+#ifdef PARENT
+        p->right->parent = p;
+#endif
+        return balance(p);
+    }
+
+private:
+    Node* joinLeft( Node* const p, size_t const hp, Node* const m, Node* const q, size_t const h ) {
+        if ( !isRed(q) && h == hp ) {
+            return linkRed( p, m, q );
+        }
+        q->left = joinLeft( p, hp, m, q->left, ( isRed(q) ) ? h : h - 1 );
+#ifdef PARENT
+        q->left->parent = q;
+#endif
+        return balance(q);
+    }
+
+private:
+    inline Node* linkRed( Node* const p, Node* const m, Node* const q ) {
+        m->left = p;
+        m->right = q;
+        m->color = RED;
+#ifdef PARENT
+        if ( p != nullptr ) {
+            p->parent = m;
+        }
+        if ( q != nullptr ) {
+            q->parent = m;
+        }
+#endif
+        return balance(m);
+    }
+
+    /*
+     * Join two trees and a node whose key is larger than each key of the
+     * first tree and smaller than each key of the second tree into one
+     * tree, in time proportional to the difference in BLACK heights of
+     * the two trees. The BLACK heights are supplied by the caller so that
+     * no spine need be walked to find them.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the first tree
+     * @param hp (IN) the BLACK height of the first tree
+     * @param m (IN) the node
+     * @param q (IN) the root of the second tree
+     * @param hq (IN) the BLACK height of the second tree
+     * @param h (OUT) the BLACK height of the joined tree
+     *
+     * @return the root of the joined tree
+     */
+private:
+    Node* join( Node* const p, size_t hp, Node* const m, Node* const q, size_t hq, size_t& h ) {
+        if ( isRed(p) ) {
+            p->color = BLACK;
+            ++hp;
+        }
+        if ( isRed(q) ) {
+            q->color = BLACK;
+            ++hq;
+        }
+        h = ( hp > hq ) ? hp : hq;
+        Node* t;
+        if ( hp > hq ) {
+            t = joinRight( p, hp, m, q, hq );
+        } else if ( hp < hq ) {
+            t = joinLeft( p, hp, m, q, hq );
+        } else {
+            t = linkRed( p, m, q );
+        }
+        if ( isRed(t) ) {
+            t->color = BLACK;
+            ++h;
+        }
+#ifdef PARENT
+        t->parent = nullptr;
+#endif
+        return t;
+    }
+
+    /*
+     * Remove the k smallest keys from the tree, append them to a vector
+     * in increasing order, and return their nodes to the freed list in
+     * O(k + log n) time instead of calling deleteMin k times.
+     *
+     * The kth smallest key is found by an in-order walk. The tree is then
+     * split by a descent from the root toward that key. Each node whose key
+     * is not larger than that key is removed together with its left subtree,
+     * and the descent continues into its right subtree. Each node whose key
+     * is larger is retained and the descent continues into its left subtree.
+     * The retained nodes are joined bottom-up with their right subtrees, in
+     * total time proportional to the height of the tree.
+     *
+     * Calling parameters:
+     *
+     * @param k (IN) the number of keys to remove
+     * @param v (MODIFIED) the vector to which the keys are appended
+     *
+     * @return the number of keys removed, which is less than k if the tree
+     *         contains fewer than k keys
+     */
+public:
+    size_t popMin( size_t const k, std::vector<K>& v ) {
+        if ( k == 0 || root == nullptr ) {
+            return 0;
+        }
+        if ( k >= count ) {
+            return popAll( v, true );
+        }
+
+        size_t i = k;
+        K const x = selectMin( root, i )->key;
+        count -= k;
+
+        Node* path[MAX_PATH];   // the retained nodes from the root
+        size_t height[MAX_PATH];  // the BLACK height of the right subtree of each retained node
+        size_t n = 0;
+        Node* p = root;
+        size_t hp = blackHeight(root);
+        while ( p != nullptr ) {
+            if ( x < p->key ) {
+                TREE_STATS(++stats.comparisons;)
+                hp = childHeight( p, hp );
+                height[n] = hp;
+                path[n++] = p;
+                p = p->left;
+            } else {
+                TREE_STATS(++stats.comparisons;)
+                Node* const right = p->right;
+                hp = childHeight( p, hp );
+                popSubtree( p->left, v, true );
+                v.push_back( p->key );
+                deleteNode( p );
+                p = right;
+            }
+        }
+
+        // Join each retained node with the tree of smaller keys and its right subtree.
+        Node* t = nullptr;
+        size_t ht = 0;
+        while ( n > 0 ) {
+            --n;
+            t = join( t, ht, path[n], path[n]->right, height[n], ht );
+        }
+        root = t;
+        updateExtremes();
+        return k;
+    }
+
+    /*
+     * Remove the k largest keys from the tree, append them to a vector
+     * in decreasing order, and return their nodes to the freed list in
+     * O(k + log n) time instead of calling deleteMax k times. See popMin.
+     *
+     * Calling parameters:
+     *
+     * @param k (IN) the number of keys to remove
+     * @param v (MODIFIED) the vector to which the keys are appended
+     *
+     * @return the number of keys removed, which is less than k if the tree
+     *         contains fewer than k keys
+     */
+public:
+    size_t popMax( size_t const k, std::vector<K>& v ) {
+        if ( k == 0 || root == nullptr ) {
+            return 0;
+        }
+        if ( k >= count ) {
+            return popAll( v, false );
+        }
+
+        size_t i = k;
+        K const x = selectMax( root, i )->key;
+        count -= k;
+
+        Node* path[MAX_PATH];   // the retained nodes from the root
+        size_t height[MAX_PATH];  // the BLACK height of the left subtree of each retained node
+        size_t n = 0;
+        Node* p = root;
+        size_t hp = blackHeight(root);
+        while ( p != nullptr ) {
+            if ( p->key < x ) {
+                TREE_STATS(++stats.comparisons;)
+                hp = childHeight( p, hp );
+                height[n] = hp;
+                path[n++] = p;
+                p = p->right;
+            } else {
+                TREE_STATS(++stats.comparisons;)
+                Node* const left = p->left;
+                hp = childHeight( p, hp );
+                popSubtree( p->right, v, false );
+                v.push_back( p->key );
+                deleteNode( p );
+                p = left;
+            }
+        }
+
+        // Join each retained node with its left subtree and the tree of larger keys.
+        Node* t = nullptr;
+        size_t ht = 0;
+        while ( n > 0 ) {
+            --n;
+            t = join( path[n]->left, height[n], path[n], t, ht, ht );
+        }
+        root = t;
+        updateExtremes();
+        return k;
+    }
+
+    /*
+     * Remove every key from the tree and append the keys to a vector.
+     *
+     * Calling parameters:
+     *
+     * @param v (MODIFIED) the vector to which the keys are appended
+     * @param increasing (IN) append the keys in increasing order if true
+     *
+     * @return the number of keys removed
+     */
+private:
+    size_t popAll( std::vector<K>& v, bool const increasing ) {
+        size_t const n = count;
+        count = 0;
+        popSubtree( root, v, increasing );
+        root = minNode = maxNode = nullptr;
+        return n;
+    }
+
     /*
      * Remove a node from the tree
      * and then rebalance the tree.
@@ -834,11 +1532,54 @@ private:
         }
 
         if ( x < p->key ) {
+            TREE_STATS(++stats.comparisons;)
             if (!isRed(p->left) && p->left != nullptr && !isRed(p->left->left)) {
                 p = moveRedLeft(p);
             }
             p->left = erase( p->left, x );
         } else {
+            TREE_STATS(stats.comparisons += 2;)
+
+#ifdef ENABLE_PREFERRED_TEST
+            // If the node is a 2-child node whose left subtree is
+            // preferred, replace its key with the in-order predecessor.
+            // The node, its left child or its right child is RED. If
+            // only the right child is RED, which occurs after a call
+            // of moveRedRight for the parent of the node, rotate left
+            // so that the node becomes RED. Otherwise, if neither the
+            // left child nor its left child is RED, the node is RED,
+            // so moveRedLeft makes the left child RED via a flip of
+            // colors, or rotates the node into the left subtree.
+            TREE_STATS(++stats.comparisons;)
+            if ( x == p->key && p->left != nullptr && p->right != nullptr
+#ifdef INVERT_PREFERRED_TEST
+                 && getSize(p->left) < getSize(p->right) )
+#else
+                 && getSize(p->left) >= getSize(p->right) )
+#endif
+            {
+                Node* const q = p;
+                if (!isRed(p->left)) {
+                    if (isRed(p->right)) {
+                        p = rotateLeft(p);
+                    } else if (!isRed(p->left->left)) {
+                        p = moveRedLeft(p);
+                    }
+                }
+
+                // If the node was rotated into the left subtree,
+                // either the node or its left child is now RED,
+                // so continue the deletion from the node.
+                if ( p != q ) {
+                    p->left = erase( p->left, x );
+                } else {
+                    copyKey( p, max(p->left) );
+                    p->left = deleteMax(p->left);
+                }
+                return balance(p);
+            }
+#endif
+
             if (isRed(p->left)) {
                 p = rotateRight(p);
             }
@@ -856,54 +1597,281 @@ private:
                 p = moveRedRight(p);
             }
 
+            TREE_STATS(++stats.comparisons;)
             if ( x == p->key ) {
                 r = true;
+                copyKey( p, min(p->right) );
+                p->right = deleteMin(p->right);
+            } else {
+                p->right = erase( p->right, x );
+            }
+        }
+
+        return balance(p);
+    }
+
+    /*
+     * The capacity of the path that records the nodes from the root of
+     * the tree to the point of insertion or deletion, or the nodes that
+     * popMin or popMax retain. A path contains at most twice as many nodes
+     * as BLACK nodes, plus the RED nodes that the descent of the erase
+     * function rotates into the path.
+     */
+private:
+    static constexpr size_t MAX_PATH = 4 * std::numeric_limits<size_t>::digits;
+
+#ifndef RECURSION
+
+    /*
+     * The node that the descent of the erase function removes: the node
+     * that contains a key, the minimum node or the maximum node.
+     */
+private:
+    enum descent_t { SEARCH, MINIMUM, MAXIMUM };
+
+    /*
+     * Search the tree iteratively for a key and if absent, add the key
+     * as a new node, then retreat along the recorded path toward the
+     * root and rebalance each node as the recursive insert function does.
+     * The retreat stops at a BLACK node that is not restructured, because
+     * the parent of that node finds its children unchanged and hence
+     * requires no rebalancing, and likewise for each ancestor.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to add to the tree, which must not be empty
+     *
+     * @return true if the key was added as a new node; otherwise, false
+     */
+private:
+    inline bool insertIteratively( K const& x ) {
+
+        Node* path[MAX_PATH];   // the nodes from the root
+        bool right[MAX_PATH];   // the direction of descent from each node
+        size_t n = 0;
+
+        Node* p = root;
+        while ( p != nullptr ) {
+            if (x < p->key) {
+                TREE_STATS(++stats.comparisons;)
+                right[n] = false;
+                path[n++] = p;
+                p = p->left;
+            } else if (x > p->key) {
+                TREE_STATS(stats.comparisons += 2;)
+                right[n] = true;
+                path[n++] = p;
+                p = p->right;
+            } else {
+                // For a tree, don't insert the key twice.
+                // For a map, overwrite the value.
+                TREE_STATS(stats.comparisons += 2;)
+                return false;
+            }
+        }
 
-                // Define FORCE_SUCCESSOR to override
-                // ENABLE_PREFERRED_TEST so that the
-                // in-order predecessor will never
-                // be chosen because the eraseMax
-                // function can return a red left
-                // child that, in association with
-                // a red parent, cannot be resolved
-                // via rotations.
-#define FORCE_SUCCESSOR
+        a = true;
+        ++count;
+        p = newNode( x, RED ); // Add a RED node at a leaf.
+#ifdef PARENT
+        p->parent = path[n - 1];
+#endif
 
+        // Link each rebalanced subtree to its parent.
+        while ( n > 0 ) {
+            --n;
+            Node* const q = path[n];
+            if ( right[n] ) {
+                q->right = p;
+            } else {
+                q->left = p;
+            }
+            color_t const color = q->color;
+            p = balance(q);
+            if ( p == q && color == BLACK && q->color == BLACK ) {
 #ifdef ENABLE_PREFERRED_TEST
-#ifdef FORCE_SUCCESSOR
-		        if (false)
-#else
+                while ( n > 0 ) {
+                    ++path[--n]->taille;
+                }
+#endif
+                return true;
+            }
+        }
+        root = p;
+        return true;
+    }
+
+    /*
+     * Remove a node from the tree iteratively. The descent performs the
+     * rotations and flips of colors of the recursive erase, deleteMin
+     * and deleteMax functions and records the path, then the retreat
+     * toward the root links each rebalanced subtree to its parent. The
+     * retreat stops at a BLACK node that is not restructured, above which
+     * the descent restructured no node, because each ancestor of that
+     * node requires no rebalancing.
+     *
+     * Calling parameters:
+     *
+     * @param x (IN) pointer to the key to remove, or nullptr unless SEARCH
+     * @param mode (IN) SEARCH, MINIMUM or MAXIMUM
+     */
+private:
+    inline void eraseIteratively( K const* const x, descent_t mode ) {
+
+        Node* path[MAX_PATH];   // the nodes from the root
+        bool right[MAX_PATH];   // the direction of descent from each node
+        size_t n = 0;
+        size_t top = MAX_PATH;  // the shallowest level that is restructured
+
+        // Search for the key, then descend to the minimum node of
+        // the right subtree or the maximum node of the left subtree.
+        Node* p = root;
+        while ( p != nullptr && mode == SEARCH ) {
+            bool changed = false;
+            bool toRight;
+            if ( *x < p->key ) {
+                TREE_STATS(++stats.comparisons;)
+                if (!isRed(p->left) && p->left != nullptr && !isRed(p->left->left)) {
+                    p = moveRedLeft(p);
+                    changed = true;
+                }
+                toRight = false;
+            } else {
+                TREE_STATS(stats.comparisons += 2;)
+#ifdef ENABLE_PREFERRED_TEST
+                // See the recursive erase function.
+                TREE_STATS(++stats.comparisons;)
+                if ( *x == p->key && p->left != nullptr && p->right != nullptr
 #ifdef INVERT_PREFERRED_TEST
-                if ( getSize(p->left) < getSize(p->right) )
+                     && getSize(p->left) < getSize(p->right) )
 #else
-                if ( getSize(p->left) >= getSize(p->right) )
-#endif
+                     && getSize(p->left) >= getSize(p->right) )
 #endif
                 {
-                    Node* aux = max(p->left);
-                    p->key = aux->key;
-                    p->left = eraseMax(p->left);
-                    // This attempt to fix the red-red problem
-                    // doesn't work in all cases because it can
-                    // cause the left subtree to have a longer
-                    // black path than the right subtree.
-                    if (isRed(p) && isRed(p->left)) {
-                        p->left->color = BLACK;
+                    Node* const q = p;
+                    if (!isRed(p->left)) {
+                        if (isRed(p->right)) {
+                            p = rotateLeft(p);
+                            changed = true;
+                        } else if (!isRed(p->left->left)) {
+                            p = moveRedLeft(p);
+                            changed = true;
+                        }
+                    }
+                    if ( p == q ) {
+                        copyKey( p, max(p->left) );
+                        mode = MAXIMUM;
                     }
-               } else
+                    toRight = false;
+                } else
 #endif
                 {
-                    Node* aux = min(p->right);
-                    p->key = aux->key;
-                    p->right = deleteMin(p->right);
+                    if (isRed(p->left)) {
+                        p = rotateRight(p);
+                        changed = true;
+                    }
+
+                    // Left child only.
+                    if ( *x == p->key && p->right == nullptr ) {
+                        deleteNode(p);
+                        --count;
+                        r = true;
+                        p = nullptr;
+                        break;
+                    }
+
+                    if (!isRed(p->right) && p->right != nullptr && !isRed(p->right->left)) {
+                        p = moveRedRight(p);
+                        changed = true;
+                    }
+
+                    TREE_STATS(++stats.comparisons;)
+                    if ( *x == p->key ) {
+                        copyKey( p, min(p->right) );
+                        mode = MINIMUM;
+                    }
+                    toRight = true;
                 }
-            } else {
-                p->right = erase( p->right, x );
             }
+            if ( changed && top == MAX_PATH ) {
+                top = n;
+            }
+            right[n] = toRight;
+            path[n++] = p;
+            p = ( toRight ) ? p->right : p->left;
         }
 
-        return balance(p);
+        while ( p != nullptr && mode == MINIMUM ) {
+            if (p->left == nullptr) {
+                deleteNode(p);
+                --count;
+                r = true;
+                p = nullptr;
+                break;
+            }
+            if ( !isRed(p->left) && !isRed(p->left->left) ) {
+                p = moveRedLeft(p);
+                if ( top == MAX_PATH ) {
+                    top = n;
+                }
+            }
+            right[n] = false;
+            path[n++] = p;
+            p = p->left;
+        }
+
+        while ( p != nullptr && mode == MAXIMUM ) {
+            bool changed = false;
+            if (isRed(p->left)) {
+                p = rotateRight(p);
+                changed = true;
+            }
+            if (p->right == nullptr) {
+                deleteNode(p);
+                --count;
+                r = true;
+                p = nullptr;
+                break;
+            }
+            if (!isRed(p->right) && !isRed(p->right->left)) {
+                p = moveRedRight(p);
+                changed = true;
+            }
+            if ( changed && top == MAX_PATH ) {
+                top = n;
+            }
+            right[n] = true;
+            path[n++] = p;
+            p = p->right;
+        }
+
+        // Link each rebalanced subtree to its parent. The links
+        // from restructured nodes to their parents are also
+        // updated because every level at or below top is visited.
+        while ( n > 0 ) {
+            --n;
+            Node* const q = path[n];
+            if ( right[n] ) {
+                q->right = p;
+            } else {
+                q->left = p;
+            }
+            color_t const color = q->color;
+            p = balance(q);
+            if ( n < top && p == q && color == BLACK && q->color == BLACK ) {
+#ifdef ENABLE_PREFERRED_TEST
+                if ( r == true ) {
+                    while ( n > 0 ) {
+                        --path[--n]->taille;
+                    }
+                }
+#endif
+                return;
+            }
+        }
+        root = p;
     }
+#endif
 
     /*
      * Check the LL RB tree for correctness, i.e.,
@@ -1237,30 +2205,58 @@ public:
 #ifdef PARENT
     inline bool insert( K const& x ) {
         a = false;
+        TREE_STATS(stats.steps = 0;)
 
         if ( root != nullptr ) {
+#ifdef RECURSION
             root = insert( nullptr, root, x );
+#else
+            insertIteratively( x );
+#endif
             root->color = BLACK; // Enforce a BLACK root.
+            if ( a == true ) {
+                if ( x < minNode->key ) {
+                    minNode = min(root);
+                } else if ( maxNode->key < x ) {
+                    maxNode = max(root);
+                }
+            }
         } else {
             root = newNode( x, BLACK ); // Add a BLACK node at the root;
             root->parent = nullptr;
+            minNode = maxNode = root;
             a = true;
             ++count;
         }
+        TREE_STATS(if ( a == true ) treeStats::record(stats.insertPropagation, stats.steps);)
         return a;
     }
 #else
     inline bool insert( K const& x ) {
         a = false;
+        TREE_STATS(stats.steps = 0;)
 
         if ( root != nullptr ) {
+#ifdef RECURSION
             root = insert( root, x );
+#else
+            insertIteratively( x );
+#endif
             root->color = BLACK; // Enforce a BLACK root.
+            if ( a == true ) {
+                if ( x < minNode->key ) {
+                    minNode = min(root);
+                } else if ( maxNode->key < x ) {
+                    maxNode = max(root);
+                }
+            }
         } else {
             root = newNode( x, BLACK ); // Add a BLACK node at the root;
+            minNode = maxNode = root;
             a = true;
             ++count;
         }
+        TREE_STATS(if ( a == true ) treeStats::record(stats.insertPropagation, stats.steps);)
         return a;
     }
 #endif
@@ -1277,15 +2273,22 @@ public:
 public:
     inline bool erase( K const& x ) {
         r = false;
+        TREE_STATS(stats.steps = 0;)
         if ( root != nullptr ) {
             if ( !isRed(root->left) && !isRed(root->right) ) {
                 root->color = RED;
             }
+#ifdef RECURSION
             root = erase( root, x);
+#else
+            eraseIteratively( &x, SEARCH );
+#endif
             if ( root != nullptr ) {
                 root->color = BLACK;
             }
+            updateExtremes();
         }
+        TREE_STATS(if ( r == true ) treeStats::record(stats.erasePropagation, stats.steps);)
         return r;
     }
 
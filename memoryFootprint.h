@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Accounting of the memory that a tree or map occupies, which is reported
+ * by the memoryUsage function of each tree and map.
+ *
+ * The footprint comprises the following components.
+ *
+ * live - the nodes that are in the tree
+ * freed - the nodes that are on the freed list
+ * reserved - the unused capacity of the node arena that freedPreallocate
+ *            and clone allocate, and the sentinel node of NULL_NODE
+ * payload - the heap memory that is owned by the keys and values of the
+ *           nodes, for example, the characters of a std::string key that
+ *           is too long for the small-string optimization
+ * overhead - the bookkeeping of the memory allocator for each allocation
+ *            of a node, of the node arena, and of a payload
+ *
+ * The allocator overhead is estimated for the glibc allocator, which rounds
+ * each request, plus one size_t header, up to a multiple of two size_t with
+ * a minimum of four size_t. Other allocators differ, so overhead is an
+ * estimate whereas the other components are exact.
+ *
+ * The payload of a key or value type is reported by the heapBytes function,
+ * which returns 0 except for std::string. To account for the payload of
+ * another type, overload heapBytes for that type and specialize hasHeapPayload
+ * to derive from std::true_type. Because the payload is found by visiting
+ * every node, including the nodes of the freed list, the memoryUsage
+ * functions require O(n) time if hasHeapPayload is true.
+ */
+
+#ifndef MEMORY_FOOTPRINT_H
+#define MEMORY_FOOTPRINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/* Report whether a type may own heap memory. */
+template <typename T>
+struct hasHeapPayload : std::false_type {};
+
+template <>
+struct hasHeapPayload<std::string> : std::true_type {};
+
+/*
+ * Return the number of bytes of heap memory that a key or value owns.
+ *
+ * Calling parameter:
+ *
+ * @param x (IN) the key or value
+ */
+template <typename T>
+inline size_t heapBytes(T const&) {
+    return 0;
+}
+
+inline size_t heapBytes(std::string const& s) {
+    // A short string is stored within the std::string object.
+    uintptr_t const data = reinterpret_cast<uintptr_t>(s.data());
+    uintptr_t const object = reinterpret_cast<uintptr_t>(&s);
+    if (data >= object && data < object + sizeof(s)) {
+        return 0;
+    }
+    return s.capacity() + 1;
+}
+
+/*
+ * Estimate the number of bytes that the allocator reserves for a request.
+ *
+ * Calling parameter:
+ *
+ * @param n (IN) the number of bytes requested
+ */
+inline size_t allocationSize(size_t const n) {
+    size_t const alignment = 2 * sizeof(size_t);
+    size_t const size = (n + sizeof(size_t) + alignment - 1) & ~(alignment - 1);
+    return (size < 4 * sizeof(size_t)) ? 4 * sizeof(size_t) : size;
+}
+
+/*
+ * The memoryFootprint struct holds the components of the footprint in bytes.
+ */
+struct memoryFootprint
+{
+    size_t live, freed, reserved, payload, overhead;
+
+    memoryFootprint() : live(0), freed(0), reserved(0), payload(0), overhead(0) {}
+
+    /* Return the total of the components. */
+    size_t total() const {
+        return live + freed + reserved + payload + overhead;
+    }
+
+    /*
+     * Add the components of another footprint, for example, of a shard.
+     *
+     * Calling parameter:
+     *
+     * @param other (IN) the other footprint
+     */
+    void add(memoryFootprint const& other) {
+        live += other.live;
+        freed += other.freed;
+        reserved += other.reserved;
+        payload += other.payload;
+        overhead += other.overhead;
+    }
+
+    /*
+     * Add the nodes of a tree.
+     *
+     * Calling parameters:
+     *
+     * @param nodeSize (IN) the size of a node
+     * @param liveNodes (IN) the number of nodes in the tree
+     * @param freedNodes (IN) the number of nodes on the freed list
+     * @param vectorSize (IN) the size of the node arena, whose nodes are
+     *                        live or freed and are not allocated individually
+     * @param vectorCapacity (IN) the capacity of the node arena
+     */
+    void addNodes(size_t const nodeSize,
+                  size_t const liveNodes,
+                  size_t const freedNodes,
+                  size_t const vectorSize,
+                  size_t const vectorCapacity) {
+        live += liveNodes * nodeSize;
+        freed += freedNodes * nodeSize;
+        reserved += (vectorCapacity - vectorSize) * nodeSize;
+        size_t const nodes = liveNodes + freedNodes;
+        size_t const allocated = (nodes > vectorSize) ? nodes - vectorSize : 0;
+        overhead += allocated * (allocationSize(nodeSize) - nodeSize);
+        if (vectorCapacity != 0) {
+            overhead += allocationSize(vectorCapacity * nodeSize) - vectorCapacity * nodeSize;
+        }
+    }
+
+    /*
+     * Add a sentinel node that is allocated individually.
+     *
+     * Calling parameter:
+     *
+     * @param nodeSize (IN) the size of the node
+     */
+    void addSentinel(size_t const nodeSize) {
+        reserved += nodeSize;
+        overhead += allocationSize(nodeSize) - nodeSize;
+    }
+
+    /*
+     * Add the heap memory that a key or value owns.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key or value
+     */
+    template <typename T>
+    void addPayload(T const& x) {
+        size_t const bytes = heapBytes(x);
+        if (bytes != 0) {
+            payload += bytes;
+            overhead += allocationSize(bytes) - bytes;
+        }
+    }
+
+    /*
+     * Add the heap memory that the keys of a subtree own.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param nil (IN) the pointer that terminates a branch
+     */
+    template <typename N>
+    void addSubtree(N const* const p, N const* const nil) {
+        if (p == nil) {
+            return;
+        }
+        addPayload(p->key);
+        addSubtree(p->left, nil);
+        addSubtree(p->right, nil);
+    }
+
+    /*
+     * Add the heap memory that the keys of a freed list own, because
+     * a key that is not trivially destructible is not destroyed until
+     * its node is reused or deleted.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the first node of the freed list
+     * @param nil (IN) the pointer that terminates the freed list
+     */
+    template <typename N>
+    void addFreed(N const* p, N const* const nil) {
+        while (p != nil) {
+            addPayload(p->key);
+            p = p->left;
+        }
+    }
+};
+
+#endif // MEMORY_FOOTPRINT_H
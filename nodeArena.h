@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * A node arena that allocates nodes in blocks, each of which is one
+ * std::vector, for the PREALLOCATE freed list and for the clone function
+ * of each tree. A node that occupies a block must not be deleted, so each
+ * tree tests via contains whether a node occupies its arena before it
+ * deletes the node, and releases every block only when it no longer refers
+ * to any node of the arena.
+ *
+ * A block is never resized after it is allocated, so that a pointer to a
+ * node of the block remains valid until release is called. Adding a block
+ * may move the vector of blocks, but the nodes of each block remain in place
+ * because a std::vector that is moved retains its storage.
+ *
+ * The number of blocks is small, typically one for freedPreallocate plus
+ * one for clone, so contains searches the blocks linearly.
+ */
+
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class nodeArena
+{
+private:
+    std::vector< std::vector<T> > blocks;   // the blocks of nodes
+
+    /*
+     * Allocate a block of default-constructed nodes.
+     *
+     * Calling parameter:
+     *
+     * @param n (IN) the number of nodes
+     *
+     * @return a pointer to the first node of the block, or nullptr if n is 0
+     */
+public:
+    T* allocate(size_t const n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        blocks.push_back(std::vector<T>(n));
+        return blocks.back().data();
+    }
+
+    /*
+     * Determine whether a node occupies a block of the arena.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node
+     *
+     * @return true if the node occupies a block; otherwise, false
+     */
+public:
+    inline bool contains(T const* const p) const {
+        std::less<T const*> less;
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            T const* const data = blocks[i].data();
+            if (!less(p, data) && less(p, data + blocks[i].size())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Release every block. */
+public:
+    void release() {
+        std::vector< std::vector<T> >().swap(blocks);
+    }
+
+    /* Return true if the arena contains no blocks. */
+public:
+    bool empty() const {
+        return blocks.empty();
+    }
+
+    /* Return the number of nodes in every block. */
+public:
+    size_t size() const {
+        size_t n = 0;
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            n += blocks[i].size();
+        }
+        return n;
+    }
+
+    /* Return the number of nodes for which every block has capacity. */
+public:
+    size_t capacity() const {
+        size_t n = 0;
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            n += blocks[i].capacity();
+        }
+        return n;
+    }
+
+    /*
+     * Exchange the blocks of two arenas, which leaves every node in place.
+     *
+     * Calling parameter:
+     *
+     * @param a (MODIFIED) the other arena
+     */
+public:
+    void swap(nodeArena& a) noexcept {
+        blocks.swap(a.blocks);
+    }
+};
+
+#endif // NODE_ARENA_H
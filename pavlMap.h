@@ -0,0 +1,820 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Persistent AVL map that is modified from the insert and erase
+ * functions of avlTree.h by path copying: a node that is reachable
+ * from more than one version of the map is never modified. Instead,
+ * insert and erase copy each shared node along the search path and
+ * return the root of a new version of the map that shares every
+ * unchanged subtree with the prior version.
+ *
+ * Each node carries an atomic reference count of the versions and
+ * parent nodes that point to it. A node whose reference count is 1 is
+ * reachable only from the version being modified, so it is modified
+ * in place, exactly as in avlTree.h. Hence an update allocates nothing
+ * when no snapshot shares its search path and allocates O(log n)
+ * nodes otherwise. A node is deleted when its reference count falls
+ * to 0, which releases its children in turn.
+ *
+ * Copying a pavlMap, or calling snapshot(), creates a new version that
+ * shares the root in O(1) time. A version is immutable while another
+ * version shares its nodes, so a reader may search a snapshot without
+ * locks while a writer modifies the map from which the snapshot was
+ * taken. A single pavlMap object must not be modified by two threads
+ * at once, and a snapshot must be taken by the thread that modifies
+ * the map. Snapshots may be copied, searched and destroyed by any
+ * thread.
+ *
+ * Compile with a test program, for example, test_pavlMap.cpp via:
+ *
+ * g++ -std=c++11 -O3 test_pavlMap.cpp
+ */
+
+#ifndef PERSISTENT_AVL_MAP_H
+#define PERSISTENT_AVL_MAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * The pavlMap class defines the root of one version of the persistent
+ * AVL map and stores the lli, lri, rli, rri, lle, lre, rle, and rre
+ * rotation counters, the copies counter and the h, a, and r boolean
+ * variables.
+ */
+template <typename K, typename V>
+class pavlMap
+{
+private:
+    typedef int8_t bal_t;
+
+private:
+    struct Node {
+        K key;                          // the key stored in this node
+        V value;                        // the value stored in this node
+        bal_t bal;                      // the left/right balance that assumes values of -1, 0, or +1
+        std::atomic<uint32_t> refs;     // the number of versions and parents that point to this node
+        Node *left, *right;
+
+        Node( K const& x, V const& y, bool& h ) : key( x ), value( y ), refs( 1 ) {
+            h = true;  // the height has changed
+            bal = 0;   // the subtree is balanced at this node
+            left = right = nullptr;
+        }
+
+        Node( Node const* const p ) : key( p->key ), value( p->value ), refs( 1 ) {
+            bal = p->bal;
+            left = p->left;
+            right = p->right;
+        }
+    };
+
+public:
+    size_t nodeSize() {
+        return sizeof(Node);
+    }
+
+private:
+    Node* root;     // the root of this version of the map
+    size_t count;   // the number of nodes in this version of the map
+    bool h, a, r;   // record modification of the map
+
+public:
+    size_t lle, lre, rle, rre, lli, lri, rli, rri;  // the rotation counters
+    size_t copies;                                  // the number of nodes copied to unshare them
+
+public:
+    pavlMap() {
+        root = nullptr;
+        lle = lre = rle = rre = lli = lri = rli = rri = copies = count = 0;
+        h = a = r = false;
+    }
+
+    /*
+     * Create a new version of the map that shares the root of another
+     * version of the map.
+     *
+     * Calling parameter:
+     *
+     * @param m (IN) the other version of the map
+     */
+public:
+    pavlMap( pavlMap const& m ) {
+        root = acquire( m.root );
+        count = m.count;
+        lle = lre = rle = rre = lli = lri = rli = rri = copies = 0;
+        h = a = r = false;
+    }
+
+public:
+    pavlMap& operator=( pavlMap const& m ) {
+        Node* const p = acquire( m.root );
+        release( root );
+        root = p;
+        count = m.count;
+        return *this;
+    }
+
+public:
+    ~pavlMap() {
+        release( root );
+    }
+
+    /* Return a new version of the map that shares the root of this version. */
+public:
+    pavlMap snapshot() const {
+        return pavlMap( *this );
+    }
+
+    /* Release every node of this version of the map. */
+public:
+    void clear() {
+        release( root );
+        root = nullptr;
+        count = 0;
+    }
+
+    /* Return the number of nodes in this version of the map. */
+public:
+    size_t size() const {
+        return count;
+    }
+
+    /* Return true if there are no nodes in this version of the map. */
+public:
+    bool empty() const {
+        return ( count == 0 );
+    }
+
+    /*
+     * Increment the reference count of a node.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node, or nullptr
+     *
+     * @return the pointer to the node
+     */
+private:
+    static inline Node* acquire( Node* const p ) {
+        if ( p != nullptr ) {
+            p->refs.fetch_add( 1, std::memory_order_relaxed );
+        }
+        return p;
+    }
+
+    /*
+     * Decrement the reference count of a node. If the reference
+     * count falls to 0, release the children and delete the node.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node, or nullptr
+     */
+private:
+    static void release( Node* const p ) {
+        if ( p != nullptr && p->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+            release( p->left );
+            release( p->right );
+            delete p;
+        }
+    }
+
+    /*
+     * Return a node that may be modified in place. If the node is shared
+     * with another version of the map, copy it, acquire its children for
+     * the copy and release the reference to the node that the caller held.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to a node to which the caller holds a reference
+     *
+     * @return pointer to an unshared node that has the same contents
+     */
+private:
+    inline Node* unshare( Node* const p ) {
+        if ( p->refs.load( std::memory_order_acquire ) == 1 ) {
+            return p;
+        }
+        Node* const q = new Node( p );
+        acquire( q->left );
+        acquire( q->right );
+        release( p );
+        ++copies;
+        return q;
+    }
+
+    /*
+     * Search the map for the existence of a key.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to search for
+     *
+     * @return true if the key was found; otherwise, false
+     */
+public:
+    inline bool contains( K const& x ) const {
+        return ( find( x ) != nullptr );
+    }
+
+    /*
+     * Search the map for the existence of a key and return a pointer
+     * to the associated value. The pointer remains valid until this
+     * version of the map is modified or destroyed.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to search for
+     *
+     * @return a pointer to the value if the key was found; otherwise, nullptr
+     */
+public:
+    inline V const* find( K const& x ) const {
+
+        Node* q = root;
+        while ( q != nullptr ) {                    // iterate; don't use recursion
+            if ( x < q->key ) {
+                q = q->left;                        // follow the left branch
+            } else if ( x > q->key ) {
+                q = q->right;                       // follow the right branch
+            } else {
+                return &(q->value);                 // found the key, so return pointer to value
+            }
+        }
+        return nullptr;                             // didn't find the key, so return nullptr
+    }
+
+    /*
+     * Search the map for the existence of a key, and either insert
+     * the (key, value) as a new node or update the value. Then the
+     * map is rebalanced if necessary.
+     *
+     * Calling parameters:
+     *
+     * @param x (IN) the key to add to the map
+     * @param y (IN) the value to add to the map
+     *
+     * @return true if update, false if insertion
+     */
+public:
+    bool insert( K const& x, V const& y ) {
+        h = false, a = false;
+        if ( root != nullptr ) {
+            root = insert( root, x, y );
+            if ( a == false ) {
+                ++count;
+            }
+        } else {
+            root = new Node( x, y, h );
+            ++count;
+        }
+        return a;
+    }
+
+    /*
+     * Remove a node from the map. Then the map is rebalanced
+     * if necessary.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to remove from the map
+     *
+     * @return true if the key existed, false if not
+     */
+public:
+    bool erase( K const& x ) {
+        h = false, r = false;
+
+        // Search first so that the search path is not copied
+        // for a key that is not in the map.
+        if ( contains( x ) ) {
+            root = erase( root, x );
+            --count;
+        }
+        return r;
+    }
+
+    /*
+     * Rebalance following insertion of a left node. The left
+     * child, and for a double rotation its right child, lie
+     * on the search path and hence are unshared.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the unshared root of the subtree at this level of recursion
+     *
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceInsertLeft( Node* p ) {
+        switch ( p->bal ) {
+            case 1:                         // balance restored
+                p->bal = 0;
+                h = false;
+                break;
+            case 0:                         // map has become more unbalanced
+                p->bal = -1;
+                break;
+            case -1:		                // map must be rebalanced
+                Node* p1 = p->left;
+                if ( p1->bal == -1 ) {		// single LL rotation
+                    lli++;
+                    p->left = p1->right;
+                    p1->right = p;
+                    p->bal = 0;
+                    p = p1;
+                } else {			        // double LR rotation
+                    lri++;
+                    Node* p2 = p1->right;
+                    p1->right = p2->left;
+                    p2->left = p1;
+                    p->left = p2->right;
+                    p2->right = p;
+                    if ( p2->bal == -1 ) {
+                        p->bal = 1;
+                    } else {
+                        p->bal = 0;
+                    }
+                    if ( p2->bal == 1 ) {
+                        p1->bal = -1;
+                    } else {
+                        p1->bal = 0;
+                    }
+                    p = p2;
+                }
+                p->bal = 0;
+                h = false;
+                break;
+        }
+        return p;
+    }
+
+    /*
+     * Rebalance following insertion of a right node. The right
+     * child, and for a double rotation its left child, lie
+     * on the search path and hence are unshared.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the unshared root of the subtree at this level of recursion
+     *
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceInsertRight( Node* p ) {
+        switch ( p->bal ) {
+            case -1:                        // balance restored
+                p->bal = 0;
+                h = false;
+                break;
+            case 0:                         // map has become more unbalanced
+                p->bal = 1;
+                break;
+            case 1:                         // map must be rebalanced
+                Node* p1 = p->right;
+                if ( p1->bal == 1 ) {       // single RR rotation
+                    rri++;
+                    p->right = p1->left;
+                    p1->left = p;
+                    p->bal = 0;
+                    p = p1;
+                } else {                    // double RL rotation
+                    rli++;
+                    Node* p2 = p1->left;
+                    p1->left = p2->right;
+                    p2->right = p1;
+                    p->right = p2->left;
+                    p2->left = p;
+                    if ( p2->bal == 1 ) {
+                        p->bal = -1;
+                    } else {
+                        p->bal = 0;
+                    }
+                    if ( p2->bal == -1 ) {
+                        p1->bal = 1;
+                    } else {
+                        p1->bal = 0;
+                    }
+                    p = p2;
+                }
+                p->bal = 0;
+                h = false;
+                break;
+        }
+        return p;
+    }
+
+    /*
+     * Search the map for the existence of a key, and either insert
+     * the (key, value) as a new node or update the value, after
+     * unsharing each node along the search path. Then the map is
+     * rebalanced if necessary.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree, whose reference is consumed
+     * @param x (IN) the key to add to the map
+     * @param y (IN) the value to add to the map
+     *
+     * @return the root of the rebalanced subtree, to which the caller holds a reference
+     */
+private:
+    Node* insert( Node* p, K const& x, V const& y ) {
+
+        p = unshare( p );
+        if ( x < p->key ) {                         // search the left branch?
+            if ( p->left != nullptr ) {
+                p->left = insert( p->left, x, y );
+            } else {
+                p->left = new Node( x, y, h );
+                a = false;
+            }
+            if ( h ) {                              // left branch has grown higher
+                p = balanceInsertLeft( p );
+            }
+        } else if ( x > p->key ) {                  // search the right branch?
+            if ( p->right != nullptr ) {
+                p->right = insert( p->right, x, y );
+            } else {
+                p->right = new Node( x, y, h );
+                a = false;
+            }
+            if ( h ) {                              // right branch has grown higher
+                p = balanceInsertRight( p );
+            }
+        } else {                                    // the key is already in the map, so update its value
+            p->value = y;
+            h = false;
+            a = true;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Rebalance following deletion of a left node. The right
+     * child, and for a double rotation its left child, are
+     * not on the search path and hence must be unshared.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the unshared root of the subtree at this level of recursion
+     *
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceEraseLeft( Node* p ) {
+
+        switch ( p->bal ) {
+            case -1:                    // balance restored
+                p->bal = 0;
+                break;
+            case 0:                     // map has become more unbalanced
+                p->bal = 1;
+                h = false;
+                break;
+            case 1:                     // map must be rebalanced
+                Node* p1 = p->right = unshare( p->right );
+                if ( p1->bal >= 0 ) {   // single RR rotation
+                    rre++;
+                    p->right = p1->left;
+                    p1->left = p;
+                    if ( p1->bal == 0 ) {
+                        p->bal = 1;
+                        p1->bal = -1;
+                        h = false;
+                    } else {
+                        p->bal = 0;
+                        p1->bal = 0;
+                    }
+                    p = p1;
+                } else {				  // double RL rotation
+                    rle++;
+                    Node* p2 = p1->left = unshare( p1->left );
+                    p1->left = p2->right;
+                    p2->right = p1;
+                    p->right = p2->left;
+                    p2->left = p;
+                    if ( p2->bal == 1 ) {
+                        p->bal = -1;
+                    } else {
+                        p->bal = 0;
+                    }
+                    if ( p2->bal == -1 ) {
+                        p1->bal = 1;
+                    } else {
+                        p1->bal = 0;
+                    }
+                    p = p2;
+                    p->bal = 0;
+                }
+                break;
+        }
+        return p; // the root of the rebalanced subtree
+    }
+
+    /*
+     * Rebalance following deletion of a right node. The left
+     * child, and for a double rotation its right child, are
+     * not on the search path and hence must be unshared.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the unshared root of the subtree at this level of recursion
+     *
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceEraseRight( Node* p ) {
+
+        switch ( p->bal ) {
+            case 1:                     // balance restored
+                p->bal = 0;
+                break;
+            case 0:                     // map has become more unbalanced
+                p->bal = -1;
+                h = false;
+                break;
+            case -1:                    // map must be rebalanced
+                Node* p1 = p->left = unshare( p->left );
+                if ( p1->bal <= 0 ) {   // single LL rotation
+                    lle++;
+                    p->left = p1->right;
+                    p1->right = p;
+                    if ( p1->bal == 0 ) {
+                        p->bal = -1;
+                        p1->bal = 1;
+                        h = false;
+                    } else {
+                        p->bal = 0;
+                        p1->bal = 0;
+                    }
+                    p = p1;
+                } else {				  // double LR rotation
+                    lre++;
+                    Node* p2 = p1->right = unshare( p1->right );
+                    p1->right = p2->left;
+                    p2->left = p1;
+                    p->left = p2->right;
+                    p2->right = p;
+                    if ( p2->bal == -1 ) {
+                        p->bal = 1;
+                    } else {
+                        p->bal = 0;
+                    }
+                    if ( p2->bal == 1 ) {
+                        p1->bal = -1;
+                    } else {
+                        p1->bal = 0;
+                    }
+                    p = p2;
+                    p->bal = 0;
+                }
+                break;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Copy the key and value of the leftmost node of the right
+     * subtree to the node to be deleted. Then replace that leftmost
+     * node with its right child and rebalance the right subtree if
+     * necessary.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the right subtree, whose reference is consumed
+     * @param q (MODIFIED) the unshared node to be deleted
+     *
+     * @return the root of the rebalanced subtree, to which the caller holds a reference
+     */
+private:
+    Node* eraseLeft( Node* p, Node* const q ) {
+
+        if ( p->left != nullptr ) {
+            p = unshare( p );
+            p->left = eraseLeft( p->left, q );
+            if ( h ) {
+                p = balanceEraseLeft( p );
+            }
+        } else {
+            q->key = p->key;                // copy node contents from p to q
+            q->value = p->value;
+            Node* const c = acquire( p->right );
+            release( p );                   // release the leftmost node
+            p = c;                          // replace node with right branch
+            h = true;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Copy the key and value of the rightmost node of the left
+     * subtree to the node to be deleted. Then replace that rightmost
+     * node with its left child and rebalance the left subtree if
+     * necessary.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the left subtree, whose reference is consumed
+     * @param q (MODIFIED) the unshared node to be deleted
+     *
+     * @return the root of the rebalanced subtree, to which the caller holds a reference
+     */
+private:
+    Node* eraseRight( Node* p, Node* const q ) {
+
+        if ( p->right != nullptr ) {
+            p = unshare( p );
+            p->right = eraseRight( p->right, q );
+            if ( h ) {
+                p = balanceEraseRight( p );
+            }
+        } else {
+            q->key = p->key;                // copy node contents from p to q
+            q->value = p->value;
+            Node* const c = acquire( p->left );
+            release( p );                   // release the rightmost node
+            p = c;                          // replace node with left branch
+            h = true;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Remove a key that is known to be in the map after unsharing
+     * each node along the search path. Then the map is rebalanced
+     * if necessary.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree, whose reference is consumed
+     * @param x (IN) the key to remove from the map
+     *
+     * @return the root of the rebalanced subtree, to which the caller holds a reference
+     */
+private:
+    Node* erase( Node* p, K const& x ) {
+
+        if ( x < p->key ) {                     // search left branch
+            p = unshare( p );
+            p->left = erase( p->left, x );
+            if ( h ) {
+                p = balanceEraseLeft( p );
+            }
+        } else if ( x > p->key ) {              // search right branch
+            p = unshare( p );
+            p->right = erase( p->right, x );
+            if ( h ) {
+                p = balanceEraseRight( p );
+            }
+        } else if ( p->left == nullptr || p->right == nullptr ) {
+            // The node has at most one child, so replace it with that child.
+            Node* const c = acquire( ( p->left != nullptr ) ? p->left : p->right );
+            release( p );
+            p = c;
+            h = true;
+            r = true;
+        } else {
+            // The node has two children, so replace its contents by
+            // those of the leftmost node of the right subtree or by
+            // those of the rightmost node of the left subtree, selected
+            // from the taller subtree as in avlTree.h.
+            p = unshare( p );
+#ifdef ENABLE_PREFERRED_TEST
+            if ( p->bal <= 0 ) {                // left or neither subtree is deeper
+                p->left = eraseRight( p->left, p );
+                if ( h ) {
+                    p = balanceEraseLeft( p );
+                }
+            } else                              // right subtree is deeper
+#endif
+            {
+                p->right = eraseLeft( p->right, p );
+                if ( h ) {
+                    p = balanceEraseRight( p );
+                }
+            }
+            r = true;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Check the map for correctness, i.e.,
+     * (1) correct sorted order of keys
+     * (2) each node's balance field equal to the difference of subtree heights
+     * (3) each node's reference count greater than 0
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     *
+     * @return the height of the subtree
+     */
+private:
+    int checkTree( Node* const p ) const {
+
+        if ( p == nullptr ) {
+            return 0;
+        }
+        if ( ( p->left != nullptr && !( p->left->key < p->key ) )
+             || ( p->right != nullptr && !( p->key < p->right->key ) ) ) {
+            std::ostringstream buffer;
+            buffer << std::endl << std::endl << "node " << p->key << " is out of order" << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        if ( p->refs.load( std::memory_order_relaxed ) == 0 ) {
+            std::ostringstream buffer;
+            buffer << std::endl << std::endl << "node " << p->key << " has zero references" << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        int const leftHeight = checkTree( p->left );
+        int const rightHeight = checkTree( p->right );
+        if ( p->bal != rightHeight - leftHeight || p->bal > 1 || p->bal < -1 ) {
+            std::ostringstream buffer;
+            buffer << std::endl << std::endl << "node " << p->key << " has bal = " << static_cast<int>(p->bal)
+                   << " but subtree heights = " << leftHeight << " and " << rightHeight << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        return std::max( leftHeight, rightHeight ) + 1;
+    }
+
+    /* Check this version of the map for correctness. */
+public:
+    void checkTree() const {
+        checkTree( root );
+    }
+
+    /*
+     * Walk the map in order and store each key in a vector.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param v (MODIFIED) vector of the keys
+     * @param i (MODIFIED) index to the next unoccupied vector element
+     */
+private:
+    void getKeys( Node* const p, std::vector<K>& v, size_t& i ) const {
+
+        if ( p->left != nullptr ) {
+            getKeys( p->left, v, i );
+        }
+        v[i++] = p->key;
+        if ( p->right != nullptr ) {
+            getKeys( p->right, v, i );
+        }
+    }
+
+    /*
+     * Walk the map in order and store each key in a vector.
+     *
+     * Calling parameter:
+     *
+     * @param v (MODIFIED) vector of the keys
+     */
+public:
+    void getKeys( std::vector<K>& v ) const {
+        if ( root != nullptr ) {
+            size_t i = 0;
+            getKeys( root, v, i );
+        }
+    }
+};
+
+#endif // PERSISTENT_AVL_MAP_H
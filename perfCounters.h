@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Hardware performance counters for the benchmark driver, read via the
+ * Linux perf_event_open system call.
+ *
+ * Each event is opened as a separate counter of user-space execution by
+ * the calling thread, so that an event that the processor or the kernel
+ * does not support is omitted without disabling the others. If the kernel
+ * multiplexes the counters, each count is scaled by the ratio of the time
+ * that the counter was enabled to the time that it was running.
+ *
+ * Counters are commonly unavailable in containers and virtual machines,
+ * or when /proc/sys/kernel/perf_event_paranoid is 3 or greater. In that
+ * case, or on an operating system other than Linux, available() returns
+ * false, error() describes the reason, and start() and stop() do nothing.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class perfCounters
+{
+public:
+    enum event_t { CYCLES, INSTRUCTIONS, BRANCH_MISSES, CACHE_MISSES, DTLB_MISSES, EVENT_COUNT };
+
+private:
+    int fd[EVENT_COUNT];    // the file descriptor of each event, or -1 if it is unavailable
+    std::string reason;     // the reason why the first unavailable event could not be opened
+
+public:
+    perfCounters() {
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            fd[e] = -1;
+        }
+#ifdef __linux__
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            switch (e) {
+            case CYCLES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case INSTRUCTIONS:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case BRANCH_MISSES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case CACHE_MISSES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            default:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_DTLB
+                    | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            }
+            fd[e] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fd[e] < 0 && reason.empty()) {
+                reason = std::string(name(static_cast<event_t>(e))) + ": perf_event_open: " + strerror(errno);
+            }
+        }
+#else
+        reason = "perf_event_open is available only on Linux";
+#endif
+    }
+
+public:
+    ~perfCounters() {
+#ifdef __linux__
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            if (fd[e] >= 0) {
+                close(fd[e]);
+            }
+        }
+#endif
+    }
+
+    /* Prohibit copying, which would close the file descriptors twice. */
+public:
+    perfCounters(perfCounters const&) = delete;
+    perfCounters& operator=(perfCounters const&) = delete;
+
+    /*
+     * Return the name of an event.
+     *
+     * Calling parameter:
+     *
+     * e - the event
+     */
+public:
+    static char const* name(event_t const e) {
+        static char const* const names[EVENT_COUNT] =
+            { "cycles", "instructions", "branch_misses", "cache_misses", "dtlb_misses" };
+        return names[e];
+    }
+
+    /* Return true if at least one event is available. */
+public:
+    bool available() const {
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            if (fd[e] >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Return the reason why an event is unavailable, or an empty string. */
+public:
+    std::string const& error() const {
+        return reason;
+    }
+
+    /* Reset and enable every available counter. */
+public:
+    void start() {
+#ifdef __linux__
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            if (fd[e] >= 0) {
+                ioctl(fd[e], PERF_EVENT_IOC_RESET, 0);
+            }
+        }
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            if (fd[e] >= 0) {
+                ioctl(fd[e], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    /*
+     * Disable every available counter and return its count since start().
+     *
+     * return a vector of (name, count) pairs for the available events
+     */
+public:
+    std::vector< std::pair<std::string, size_t> > stop() {
+        std::vector< std::pair<std::string, size_t> > counts;
+#ifdef __linux__
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            if (fd[e] >= 0) {
+                ioctl(fd[e], PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            uint64_t value[3];  // the count, time enabled and time running
+            if (fd[e] >= 0 && read(fd[e], value, sizeof(value)) == sizeof(value)) {
+                double count = static_cast<double>(value[0]);
+                if (value[2] != 0 && value[2] < value[1]) {
+                    count *= static_cast<double>(value[1]) / static_cast<double>(value[2]);
+                }
+                counts.push_back(std::make_pair(std::string(name(static_cast<event_t>(e))),
+                                                static_cast<size_t>(count + 0.5)));
+            }
+        }
+#endif
+        return counts;
+    }
+};
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,670 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Range-sharded concurrent map that partitions the key space into N
+ * shards, each of which is an avlMap protected by its own shared mutex.
+ * Searches of a shard acquire its mutex in shared mode, and insertions
+ * and deletions acquire it in exclusive mode, so that operations upon
+ * different shards proceed in parallel.
+ *
+ * A key is routed to a shard by binary search of an immutable layout,
+ * which is a sorted vector of boundaries: shard i contains the keys k
+ * for which boundary[i-1] <= k < boundary[i]. Each layout is identified
+ * by a generation number. After an operation acquires the mutex of a
+ * shard, it verifies that the generation is unchanged and otherwise
+ * releases the mutex and routes the key again.
+ *
+ * When an insertion causes a shard to contain more than imbalance times
+ * its fair share of the keys, the map is rebalanced. Rebalancing acquires
+ * the mutex of every shard in increasing order, gathers the keys and values
+ * in sorted order via getKeys and getValues, computes new boundaries that
+ * divide the keys equally, rebuilds each shard via bulkLoad, and publishes
+ * a new layout. Because an operation holds at most one shard mutex at a
+ * time, rebalancing cannot deadlock.
+ *
+ * An operation routes a key without holding a shard mutex, so a superseded
+ * layout is reclaimed only after every operation that may be routing via
+ * that layout has finished. An operation increments the router count of
+ * the parity of the current generation while it routes, and a rebalance
+ * that publishes generation g+1 waits for the router count of generation g
+ * to drain to 0 before it deletes layout g. Hence at most two layouts exist.
+ *
+ * The batch operations group the keys by shard so that each shard mutex
+ * is acquired once per batch.
+ *
+ * NOTE that std::shared_mutex requires C++17, so compile with a test
+ * program, for example, test_shardedMap.cpp via:
+ *
+ * g++ -std=c++17 -O3 -pthread test_shardedMap.cpp
+ *
+ * The avlMap.h file describes other compilation options.
+ */
+
+#ifndef RANGE_SHARDED_AVL_MAP_H
+#define RANGE_SHARDED_AVL_MAP_H
+
+#include "avlMap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/*
+ * The shardedMap class defines the shards and the published layout
+ * of the range-sharded map.
+ */
+template <typename K, typename V>
+class shardedMap
+{
+    /* A shard is aligned to a cache line so that shard mutexes do not share lines. */
+private:
+    struct alignas(64) Shard {
+        std::shared_mutex lock;     // protects the map
+        avlMap<K, V> map;           // the keys that are routed to this shard
+    };
+
+    /* A layout routes a key to the shard whose range contains that key. */
+private:
+    struct Layout {
+        std::vector<K> boundary;    // the lowest key of shards 1 through boundary.size()
+
+        size_t route( K const& x ) const {
+            return std::upper_bound( boundary.begin(), boundary.end(), x ) - boundary.begin();
+        }
+    };
+
+private:
+    size_t n;                               // the number of shards
+    std::unique_ptr<Shard[]> shards;        // the shards
+    std::atomic<uint64_t> generation;       // the generation of the published layout
+    std::atomic<Layout const*> layouts[2];  // the layouts of the current and prior generations
+    std::atomic<size_t> routers[2];         // the number of operations that route via each layout
+    std::mutex rebalancer;                  // serializes rebalancing
+    std::atomic<size_t> count;              // the number of keys in the map
+    size_t imbalance;                       // the ratio of shard size to fair share that triggers rebalancing
+    size_t minimum;                         // the fair share below which rebalancing is not triggered
+
+public:
+    std::atomic<size_t> rebalances;         // the number of times that the map was rebalanced
+
+    /*
+     * Here is the constructor for the shardedMap class. Until the first
+     * rebalance, every key is routed to shard 0.
+     *
+     * Calling parameters:
+     *
+     * @param shardCount (IN) the number of shards
+     * @param ratio (IN) the ratio of shard size to fair share that triggers rebalancing
+     * @param floor (IN) the fair share below which rebalancing is not triggered
+     */
+public:
+    shardedMap( size_t const shardCount = 64, size_t const ratio = 2, size_t const floor = 1024 ) {
+        if ( shardCount == 0 || ratio < 2 ) {
+            std::ostringstream buffer;
+            buffer << std::endl << "shards = " << shardCount << " and imbalance = " << ratio
+                   << " require at least 1 shard and an imbalance of at least 2" << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        n = shardCount;
+        shards.reset( new Shard[n] );
+        imbalance = ratio;
+        minimum = ( floor > 0 ) ? floor : 1;
+        generation.store( 0 );
+        layouts[0].store( new Layout );
+        layouts[1].store( nullptr );
+        routers[0].store( 0 );
+        routers[1].store( 0 );
+        count.store( 0 );
+        rebalances.store( 0 );
+    }
+
+    /*
+     * Here is an alternate constructor that specifies the initial boundaries
+     * when the distribution of the keys is known in advance.
+     *
+     * Calling parameters:
+     *
+     * @param boundaries (IN) the lowest key of shards 1 through N-1, sorted in increasing order
+     * @param ratio (IN) the ratio of shard size to fair share that triggers rebalancing
+     * @param floor (IN) the fair share below which rebalancing is not triggered
+     */
+public:
+    shardedMap( std::vector<K> const& boundaries, size_t const ratio = 2, size_t const floor = 1024 )
+        : shardedMap( boundaries.size() + 1, ratio, floor ) {
+        for ( size_t i = 1; i < boundaries.size(); ++i ) {
+            if ( !( boundaries[i-1] < boundaries[i] ) ) {
+                std::ostringstream buffer;
+                buffer << std::endl << "boundaries are not unique and sorted at index " << i << std::endl;
+                throw std::runtime_error(buffer.str());
+            }
+        }
+        Layout* l = new Layout;
+        l->boundary = boundaries;
+        delete layouts[0].load();
+        layouts[0].store( l );
+    }
+
+    /* The destructor requires that no other thread accesses the map. */
+public:
+    ~shardedMap() {
+        delete layouts[ generation.load() & 1 ].load();
+    }
+
+private:
+    shardedMap( shardedMap const& );
+    shardedMap& operator=( shardedMap const& );
+
+    /* This method returns the number of keys in the map. */
+public:
+    size_t size() {
+        return count.load( std::memory_order_relaxed );
+    }
+
+    /* This method returns true if there are no keys in the map. */
+public:
+    bool empty() {
+        return ( size() == 0 );
+    }
+
+    /* This method returns the number of shards. */
+public:
+    size_t shardCount() {
+        return n;
+    }
+
+    /*
+     * This method returns the number of keys in a shard.
+     *
+     * Calling parameter:
+     *
+     * @param i (IN) the index of the shard
+     */
+public:
+    size_t shardSize( size_t const i ) {
+        std::shared_lock<std::shared_mutex> lock( shards[i].lock );
+        return shards[i].map.size();
+    }
+
+    /*
+     * This method reports the memory that the shards occupy (see
+     * memoryFootprint.h), where the array of shards is reserved. Each
+     * shard is locked in turn, so the report is not a snapshot if
+     * another thread modifies the map concurrently.
+     *
+     * @return the live, reserved, payload and overhead bytes
+     */
+public:
+    memoryFootprint memoryUsage() {
+        memoryFootprint m;
+        m.reserved += n * sizeof(Shard);
+        m.overhead += allocationSize( n * sizeof(Shard) ) - n * sizeof(Shard);
+        for ( size_t i = 0; i < n; ++i ) {
+            std::shared_lock<std::shared_mutex> lock( shards[i].lock );
+            m.add( shards[i].map.memoryUsage() );
+        }
+        return m;
+    }
+
+    /*
+     * This method increments the router count of the current generation
+     * so that the layout of that generation is not deleted until leave
+     * is called.
+     *
+     * @return the generation of the layout
+     */
+private:
+    uint64_t enter() {
+        while ( true ) {
+            uint64_t const g = generation.load( std::memory_order_seq_cst );
+            routers[g & 1].fetch_add( 1, std::memory_order_seq_cst );
+            if ( generation.load( std::memory_order_seq_cst ) == g ) {
+                return g;
+            }
+            routers[g & 1].fetch_sub( 1, std::memory_order_release );
+        }
+    }
+
+    /*
+     * This method decrements the router count that enter incremented.
+     *
+     * Calling parameter:
+     *
+     * @param g (IN) the generation that enter returned
+     */
+private:
+    void leave( uint64_t const g ) {
+        routers[g & 1].fetch_sub( 1, std::memory_order_release );
+    }
+
+    /*
+     * This method acquires the mutex of the shard that contains a key
+     * under the current layout and returns the index of that shard.
+     *
+     * Calling parameters:
+     *
+     * @param x (IN) the key
+     * @param lock (MODIFIED) an unlocked shared_lock or unique_lock
+     *
+     * @return the index of the shard whose mutex is acquired
+     */
+private:
+    template <typename L>
+    size_t acquire( K const& x, L& lock ) {
+        while ( true ) {
+            uint64_t const g = enter();
+            size_t const i = layouts[g & 1].load( std::memory_order_acquire )->route( x );
+            leave( g );
+            lock = L( shards[i].lock );
+            if ( generation.load( std::memory_order_acquire ) == g ) {
+                return i;
+            }
+            lock.unlock();
+        }
+    }
+
+    /*
+     * This method searches the map for the existence of a key.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to search for
+     *
+     * @return true if the key was found; otherwise, false
+     */
+public:
+    bool contains( K const& x ) {
+        std::shared_lock<std::shared_mutex> lock;
+        size_t const i = acquire( x, lock );
+        return shards[i].map.contains( x );
+    }
+
+    /*
+     * This method searches the map for the existence of a key and copies
+     * the associated value, because a pointer to the value would not be
+     * protected after the shard mutex is released.
+     *
+     * Calling parameters:
+     *
+     * @param x (IN) the key to search for
+     * @param y (MODIFIED) the value if the key was found
+     *
+     * @return true if the key was found; otherwise, false
+     */
+public:
+    bool find( K const& x, V& y ) {
+        std::shared_lock<std::shared_mutex> lock;
+        size_t const i = acquire( x, lock );
+        V const* const p = shards[i].map.find( x );
+        if ( p == nullptr ) {
+            return false;
+        }
+        y = *p;
+        return true;
+    }
+
+    /*
+     * This method either inserts a (key, value) pair or updates the value,
+     * and rebalances the map if the shard has become too large.
+     *
+     * Calling parameters:
+     *
+     * @param x (IN) the key to add to the map
+     * @param y (IN) the value to associate with the key
+     *
+     * @return true if update, false if insertion
+     */
+public:
+    bool insert( K const& x, V const& y ) {
+        bool update, oversize = false;
+        {
+            std::unique_lock<std::shared_mutex> lock;
+            size_t const i = acquire( x, lock );
+            update = shards[i].map.insert( x, y );
+            if ( update == false ) {
+                size_t const total = count.fetch_add( 1, std::memory_order_relaxed ) + 1;
+                oversize = isOversize( shards[i].map.size(), total );
+            }
+        }
+        if ( oversize == true ) {
+            rebalance( false );
+        }
+        return update;
+    }
+
+    /*
+     * This method removes a key from the map.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to remove from the map
+     *
+     * @return true if the key existed, false if not
+     */
+public:
+    bool erase( K const& x ) {
+        std::unique_lock<std::shared_mutex> lock;
+        size_t const i = acquire( x, lock );
+        bool const removed = shards[i].map.erase( x );
+        if ( removed == true ) {
+            count.fetch_sub( 1, std::memory_order_relaxed );
+        }
+        return removed;
+    }
+
+    /*
+     * This method applies a function to each key of a batch, grouped
+     * by shard so that each shard mutex is acquired once. If the layout
+     * changes during the batch, the keys of the remaining shards are
+     * grouped again under the new layout.
+     *
+     * Calling parameters:
+     *
+     * @param k (IN) vector of keys
+     * @param apply (IN) a function of (shard index, key index) called with the shard mutex held
+     */
+private:
+    template <typename L, typename F>
+    void forEachShard( std::vector<K> const& k, F apply ) {
+        std::vector<size_t> pending( k.size() );
+        for ( size_t j = 0; j < k.size(); ++j ) {
+            pending[j] = j;
+        }
+        std::vector<size_t> shard( k.size() ), start( n + 1 ), order, retry;
+        while ( pending.empty() == false ) {
+
+            // Group the pending keys by shard via a counting sort.
+            uint64_t const g = enter();
+            Layout const* const l = layouts[g & 1].load( std::memory_order_acquire );
+            std::fill( start.begin(), start.end(), 0 );
+            for ( size_t j = 0; j < pending.size(); ++j ) {
+                shard[pending[j]] = l->route( k[pending[j]] );
+                ++start[shard[pending[j]] + 1];
+            }
+            leave( g );
+            for ( size_t i = 0; i < n; ++i ) {
+                start[i + 1] += start[i];
+            }
+            order.resize( pending.size() );
+            std::vector<size_t> next( start.begin(), start.end() - 1 );
+            for ( size_t j = 0; j < pending.size(); ++j ) {
+                order[next[shard[pending[j]]]++] = pending[j];
+            }
+
+            // Acquire each shard mutex once, in increasing order of shard index.
+            retry.clear();
+            for ( size_t i = 0; i < n; ++i ) {
+                if ( start[i] == start[i + 1] ) {
+                    continue;
+                }
+                L lock( shards[i].lock );
+                if ( generation.load( std::memory_order_acquire ) != g ) {
+                    retry.insert( retry.end(), order.begin() + start[i], order.begin() + start[i + 1] );
+                    continue;
+                }
+                for ( size_t j = start[i]; j < start[i + 1]; ++j ) {
+                    apply( i, order[j] );
+                }
+            }
+            pending.swap( retry );
+        }
+    }
+
+    /*
+     * This method searches the map for the existence of a batch of keys.
+     *
+     * Calling parameters:
+     *
+     * @param k (IN) vector of keys to search for
+     * @param found (MODIFIED) vector that records whether each key was found
+     *
+     * @return the number of keys that were found
+     */
+public:
+    size_t contains( std::vector<K> const& k, std::vector<bool>& found ) {
+        found.assign( k.size(), false );
+        size_t hits = 0;
+        forEachShard< std::shared_lock<std::shared_mutex> >( k, [&]( size_t i, size_t j ) {
+            if ( shards[i].map.contains( k[j] ) ) {
+                found[j] = true;
+                ++hits;
+            }
+        });
+        return hits;
+    }
+
+    /*
+     * This method inserts or updates a batch of (key, value) pairs
+     * and rebalances the map if a shard has become too large.
+     *
+     * Calling parameters:
+     *
+     * @param k (IN) vector of keys to add to the map
+     * @param v (IN) vector of values that correspond to the keys
+     *
+     * @return the number of keys that were inserted instead of updated
+     */
+public:
+    size_t insert( std::vector<K> const& k, std::vector<V> const& v ) {
+        if ( k.size() != v.size() ) {
+            std::ostringstream buffer;
+            buffer << std::endl << "number of keys = " << k.size()
+                   << " differs from number of values = " << v.size() << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        size_t inserted = 0;
+        bool oversize = false;
+        forEachShard< std::unique_lock<std::shared_mutex> >( k, [&]( size_t i, size_t j ) {
+            if ( shards[i].map.insert( k[j], v[j] ) == false ) {
+                size_t const total = count.fetch_add( 1, std::memory_order_relaxed ) + 1;
+                oversize |= isOversize( shards[i].map.size(), total );
+                ++inserted;
+            }
+        });
+        if ( oversize == true ) {
+            rebalance( false );
+        }
+        return inserted;
+    }
+
+    /*
+     * This method removes a batch of keys from the map.
+     *
+     * Calling parameter:
+     *
+     * @param k (IN) vector of keys to remove from the map
+     *
+     * @return the number of keys that existed
+     */
+public:
+    size_t erase( std::vector<K> const& k ) {
+        size_t removed = 0;
+        forEachShard< std::unique_lock<std::shared_mutex> >( k, [&]( size_t i, size_t j ) {
+            if ( shards[i].map.erase( k[j] ) == true ) {
+                count.fetch_sub( 1, std::memory_order_relaxed );
+                ++removed;
+            }
+        });
+        return removed;
+    }
+
+    /*
+     * This method determines whether a shard contains more than
+     * imbalance times its fair share of the keys.
+     *
+     * Calling parameters:
+     *
+     * @param shardSize (IN) the number of keys in the shard
+     * @param total (IN) the number of keys in the map
+     */
+private:
+    bool isOversize( size_t const shardSize, size_t const total ) {
+        return ( shardSize > imbalance * std::max( total / n, minimum ) );
+    }
+
+    /*
+     * This method redistributes the keys so that each shard contains an
+     * equal number of keys. The mutex of every shard is held in exclusive
+     * mode for the duration, which is O(n) in the number of keys.
+     *
+     * Calling parameter:
+     *
+     * @param force (IN) rebalance even if no shard is too large
+     */
+public:
+    void rebalance( bool const force = true ) {
+        std::lock_guard<std::mutex> guard( rebalancer );
+        std::vector< std::unique_lock<std::shared_mutex> > locks;
+        locks.reserve( n );
+        for ( size_t i = 0; i < n; ++i ) {
+            locks.push_back( std::unique_lock<std::shared_mutex>( shards[i].lock ) );
+        }
+
+        // Another thread may already have rebalanced the map.
+        size_t total = 0;
+        bool oversize = false;
+        for ( size_t i = 0; i < n; ++i ) {
+            total += shards[i].map.size();
+        }
+        for ( size_t i = 0; i < n; ++i ) {
+            oversize |= isOversize( shards[i].map.size(), total );
+        }
+        if ( force == false && oversize == false ) {
+            return;
+        }
+
+        // The shards partition the key space in increasing order,
+        // so concatenation of their keys produces sorted keys.
+        std::vector<K> keys( total );
+        std::vector<V> values( total );
+        size_t j = 0;
+        for ( size_t i = 0; i < n; ++i ) {
+            size_t const m = shards[i].map.size();
+            std::vector<K> k( m );
+            std::vector<V> v( m );
+            shards[i].map.getKeys( k );
+            shards[i].map.getValues( v );
+            std::move( k.begin(), k.end(), keys.begin() + j );
+            std::move( v.begin(), v.end(), values.begin() + j );
+            shards[i].map.clear();
+            j += m;
+        }
+
+        // Divide the keys equally among min(n, total) shards
+        // and rebuild each shard from its range of keys.
+        size_t const m = std::max( std::min( n, total ), static_cast<size_t>(1) );
+        Layout* l = new Layout;
+        l->boundary.reserve( m - 1 );
+        size_t lo = 0;
+        for ( size_t i = 0; i < m; ++i ) {
+            size_t const hi = ( ( i + 1 ) * total ) / m;
+            if ( i + 1 < m ) {
+                l->boundary.push_back( keys[hi] );
+            }
+            std::vector<K> k( std::make_move_iterator( keys.begin() + lo ),
+                              std::make_move_iterator( keys.begin() + hi ) );
+            std::vector<V> v( std::make_move_iterator( values.begin() + lo ),
+                              std::make_move_iterator( values.begin() + hi ) );
+            shards[i].map.bulkLoad( k, v );
+            lo = hi;
+        }
+
+        // Publish the layout of generation g+1, release the shard mutexes,
+        // and delete the layout of generation g after every operation that
+        // may be routing via that layout has finished.
+        uint64_t const g = generation.load( std::memory_order_relaxed );
+        layouts[(g + 1) & 1].store( l, std::memory_order_release );
+        generation.store( g + 1, std::memory_order_seq_cst );
+        rebalances.fetch_add( 1, std::memory_order_relaxed );
+        locks.clear();
+        while ( routers[g & 1].load( std::memory_order_seq_cst ) != 0 ) {
+            std::this_thread::yield();
+        }
+        delete layouts[g & 1].exchange( nullptr, std::memory_order_relaxed );
+    }
+
+    /*
+     * This method walks the map in order and stores each key and value
+     * in vectors, while holding every shard mutex in shared mode.
+     *
+     * Calling parameters:
+     *
+     * @param k (MODIFIED) vector of the keys
+     * @param v (MODIFIED) vector of the values
+     */
+public:
+    void getKeysValues( std::vector<K>& k, std::vector<V>& v ) {
+        std::vector< std::shared_lock<std::shared_mutex> > locks;
+        locks.reserve( n );
+        size_t total = 0;
+        for ( size_t i = 0; i < n; ++i ) {
+            locks.push_back( std::shared_lock<std::shared_mutex>( shards[i].lock ) );
+            total += shards[i].map.size();
+        }
+        k.resize( total );
+        v.resize( total );
+        size_t j = 0;
+        for ( size_t i = 0; i < n; ++i ) {
+            size_t const m = shards[i].map.size();
+            std::vector<K> sk( m );
+            std::vector<V> sv( m );
+            shards[i].map.getKeys( sk );
+            shards[i].map.getValues( sv );
+            std::move( sk.begin(), sk.end(), k.begin() + j );
+            std::move( sv.begin(), sv.end(), v.begin() + j );
+            j += m;
+        }
+    }
+
+    /* This method deletes every key from the map but retains the layout. */
+public:
+    void clear() {
+        std::vector< std::unique_lock<std::shared_mutex> > locks;
+        locks.reserve( n );
+        for ( size_t i = 0; i < n; ++i ) {
+            locks.push_back( std::unique_lock<std::shared_mutex>( shards[i].lock ) );
+        }
+        for ( size_t i = 0; i < n; ++i ) {
+            shards[i].map.clear();
+        }
+        count.store( 0, std::memory_order_relaxed );
+    }
+};
+
+#endif // RANGE_SHARDED_AVL_MAP_H
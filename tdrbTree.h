@@ -54,10 +54,44 @@
  * To preallocate the freed list as a vector of red-black tree nodes, compile via:
  * 
  * g++ -std=c++11 -O3 -D PREALLOCATE test_tdrbTree.cpp
+ *
+ * By default, a node that is erased remains on the freed list until
+ * clear() is called. The freedPolicy function limits the freed list
+ * to the larger of a number of nodes and a fraction of the number of
+ * nodes in the tree, beyond which an erased node is deleted, and the
+ * shrinkToFit function deletes the freed nodes in excess of that limit.
+ * A node that occupies the arena of freedPreallocate or clone is retained
+ * on the freed list regardless of the limit until the tree is empty,
+ * whereupon shrinkToFit releases the arena.
  * 
  * To enable parent pointers, compile via:
  * 
  * g++ -std=c++11 -O3 -D PARENT test_tdrbTree.cpp
+ *
+ * To allow threads to call the insert and contains functions concurrently,
+ * compile via:
+ *
+ * g++ -std=c++11 -O3 -pthread -D LOCK_COUPLING test_tdrbTreeCoupling.cpp
+ *
+ * LOCK_COUPLING adds a spin lock to each node and to the root of the tree.
+ * Because insert restructures the tree during its descent and never
+ * retreats toward the root, a thread that inserts a key locks a node m
+ * and its children before it examines them, and unlocks each node that
+ * lies above the great-grandparent ggp of m, so that it holds at most
+ * ggp, gp, p, m and the children of m, and so that threads that insert
+ * into disjoint subtrees proceed in parallel. The lock of the root of the
+ * tree protects the root pointer until ggp exists. The contains function
+ * holds the locks of a node and its child only, because a rotation that
+ * moves a node requires the lock of that node. The erase function and
+ * the remaining functions are not safe to call concurrently with insert
+ * or contains. LOCK_COUPLING is incompatible with PARENT, because a
+ * rotation modifies the parent pointer of a node that is not locked,
+ * and with ENABLE_TREE_STATS.
+ *
+ * To count comparisons, search path lengths and rebalancing steps
+ * (see treeStats.h), compile via:
+ *
+ * g++ -std=c++11 -O3 -D ENABLE_TREE_STATS test_tdrbTree.cpp
  */
 
 #ifndef CULLEN_LAKEMPER_TDRB_TREE_H
@@ -65,9 +99,25 @@
 
 #include <iostream>
 #include <exception>
+#include <functional>
+#include <limits>
 #include <sstream>
+#include <utility>
 #include <vector>
 
+#ifdef LOCK_COUPLING
+#include <atomic>
+#include <thread>
+#endif
+
+#include "memoryFootprint.h"
+#include "nodeArena.h"
+#include "treeStats.h"
+
+#if defined(LOCK_COUPLING) && (defined(PARENT) || defined(ENABLE_TREE_STATS))
+#error "LOCK_COUPLING is incompatible with PARENT and ENABLE_TREE_STATS"
+#endif
+
 /*
  * The tdrbTree class defines the root of the top-down red-black tree
  * and provides the RED and BLACK bool constants.
@@ -80,12 +130,52 @@ private:
     static constexpr color_t RED = true;
     static constexpr color_t BLACK = false;
 
+#ifdef LOCK_COUPLING
+    /*
+     * The Latch struct is a spin lock that yields the processor while it
+     * waits, so that more threads than processors may wait efficiently.
+     * Copying a node copies an unlocked Latch.
+     */
+private:
+    struct Latch
+    {
+        std::atomic<bool> held;
+
+        Latch() : held(false) {}
+
+        Latch( Latch const& ) : held(false) {}
+
+        inline void lock() {
+            size_t spins = 0;
+            while ( held.exchange(true, std::memory_order_acquire) ) {
+                while ( held.load(std::memory_order_relaxed) ) {
+                    if ( ++spins > 64 ) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        }
+
+        inline void unlock() {
+            held.store(false, std::memory_order_release);
+        }
+    };
+
+    /* The rotation counters are incremented by concurrent insertions. */
+    typedef std::atomic<size_t> counter_t;
+#else
+    typedef size_t counter_t;
+#endif
+
     /* The Node struct defines a node in the TD RB tree. */
 private:
     struct Node
     {
         K key;
         color_t color;
+#ifdef LOCK_COUPLING
+        Latch latch;
+#endif
         Node *left, *right;
 #ifdef PARENT
         Node* parent;
@@ -116,17 +206,27 @@ public:
 
 private:
     Node* root;     // the root of the tree
+#ifdef LOCK_COUPLING
+    std::atomic<size_t> count;  // the number of nodes in the tree
+    Latch rootLatch;            // protects the root pointer
+    Latch freedLatch;           // protects the freed list
+#else
     size_t count;   // the number of nodes in the tree
+#endif
 
 #ifndef DISABLE_FREED_LIST
-    Node* freed;    // the freed list
-#ifdef PREALLOCATE
-    std::vector<Node> nodes;
-#endif
+    Node* freed;            // the freed list
+    size_t freedCount;      // the number of nodes on the freed list
+    size_t freedMax;        // the number of freed nodes to retain regardless of tree size
+    double freedFraction;   // the fraction of the tree size to retain as freed nodes
 #endif
+    nodeArena<Node> arena;  // the nodes of freedPreallocate and clone
 
 public:
-    size_t singleRotationCount, doubleRotationCount;
+    counter_t singleRotationCount, doubleRotationCount;
+#ifdef ENABLE_TREE_STATS
+    treeStats stats;    // the comparisons and histograms
+#endif
 
 public:
     tdrbTree() {
@@ -135,16 +235,150 @@ public:
         
 #ifndef DISABLE_FREED_LIST
         freed = nullptr;
+        freedCount = 0;
+        freedMax = std::numeric_limits<size_t>::max();
+        freedFraction = 0.;
 #endif
     }
     
 public:
     ~tdrbTree() {
-        if ( root != nullptr ) {
-            clear();
+        clear();
+    }
+
+    /* The tree owns its nodes, so it is not copied; call clone instead. */
+public:
+    tdrbTree(tdrbTree const&) = delete;
+
+public:
+    tdrbTree& operator=(tdrbTree const&) = delete;
+
+    /*
+     * Move a tree in O(1) time, which leaves the other tree empty.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    tdrbTree(tdrbTree&& t) noexcept : tdrbTree() {
+        swap(t);
+    }
+
+    /*
+     * Move a tree in O(1) time by exchanging it with this tree, so that
+     * the nodes of this tree are deleted when the other tree is destroyed.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    tdrbTree& operator=(tdrbTree&& t) noexcept {
+        swap(t);
+        return *this;
+    }
+
+    /*
+     * Exchange the nodes, freed list, arena and counters of two trees
+     * in O(1) time.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the other tree
+     */
+public:
+    void swap(tdrbTree& t) noexcept {
+        std::swap(root, t.root);
+        swapCounter(count, t.count);
+#ifndef DISABLE_FREED_LIST
+        std::swap(freed, t.freed);
+        std::swap(freedCount, t.freedCount);
+        std::swap(freedMax, t.freedMax);
+        std::swap(freedFraction, t.freedFraction);
+#endif
+        arena.swap(t.arena);
+        swapCounter(singleRotationCount, t.singleRotationCount);
+        swapCounter(doubleRotationCount, t.doubleRotationCount);
+#ifdef ENABLE_TREE_STATS
+        std::swap(stats, t.stats);
+#endif
+    }
+
+    /*
+     * Copy the shape, keys and colors of the tree in one linear pass
+     * that performs no comparisons or rebalancing. The nodes of the copy
+     * are allocated as one block of the arena of the copy. Under
+     * LOCK_COUPLING, clone must not run concurrently with insert.
+     *
+     * @return the copy
+     */
+public:
+    tdrbTree clone() const {
+        tdrbTree t;
+        size_t i = 0;
+        size_t const n = count;
+        t.root = cloneNode(root, t.arena.allocate(n), i);
+        t.count = n;
+        return t;
+    }
+
+    /*
+     * Copy a subtree in pre-order to consecutive nodes of a block.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param block (MODIFIED) the block of nodes
+     * @param i (MODIFIED) the index of the next unused node of the block
+     *
+     * @return the root of the copy of the subtree
+     */
+private:
+    static Node* cloneNode(Node const* const p, Node* const block, size_t& i) {
+        if (p == nullptr) {
+            return nullptr;
         }
+        Node* const q = block + i++;
+        q->key = p->key;
+        q->color = p->color;
+        q->left = cloneNode(p->left, block, i);
+        q->right = cloneNode(p->right, block, i);
+#ifdef PARENT
+        if (q->left != nullptr) {
+            q->left->parent = q;
+        }
+        if (q->right != nullptr) {
+            q->right->parent = q;
+        }
+#endif
+        return q;
     }
 
+    /*
+     * Exchange two counters, which are atomic under LOCK_COUPLING.
+     * The exchange is not atomic, so swap must not run concurrently
+     * with insert or contains.
+     *
+     * Calling parameters:
+     *
+     * @param x (MODIFIED) one counter
+     * @param y (MODIFIED) the other counter
+     */
+private:
+    static inline void swapCounter(size_t& x, size_t& y) noexcept {
+        std::swap(x, y);
+    }
+
+#ifdef LOCK_COUPLING
+private:
+    static inline void swapCounter(std::atomic<size_t>& x, std::atomic<size_t>& y) noexcept {
+        size_t const z = x.load(std::memory_order_relaxed);
+        x.store(y.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        y.store(z, std::memory_order_relaxed);
+    }
+#endif
+
     /*
      * Delete every node in the TD RB tree.  If the tree has been
      * completely deleted via prior calls to the erase function,
@@ -161,7 +395,9 @@ private:
         }
         clear(node->left);
         clear(node->right);
-        delete node;
+        if ( !inArena(node) ) {
+            delete node;
+        }
     }
     /*
      * Attempt to obtain a node from the freed list instead of
@@ -180,37 +416,105 @@ public:
 #ifndef DISABLE_FREED_LIST
 	    clearFreed();
 #endif
+        arena.release();
     }
 
     /* Delete every node from the freed list. */
     private:
     void clearFreed() {
 #ifndef DISABLE_FREED_LIST
-#ifndef PREALLOCATE
         while ( freed != nullptr ) {
             Node* next = freed->left;
-            delete freed;
+            if ( !inArena(freed) ) {
+                delete freed;
+            }
             freed = next;
         }
-#else
-        nodes.clear();
-#endif
         freed = nullptr;
+        freedCount = 0;
 #endif
     }
 
+    /*
+     * Determine whether a node occupies the arena of freedPreallocate
+     * or clone, and hence must not be deleted.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node
+     *
+     * @return true if the node occupies the arena; otherwise, false
+     */
+private:
+    inline bool inArena( Node const* const p ) {
+        return arena.contains(p);
+    }
+
     /* Report the number of nodes on the freed list. */
 public:
     size_t freedSize() {
-        size_t count = 0;
 #ifndef DISABLE_FREED_LIST
-        Node* ptr = freed;
-        while(ptr != nullptr) {
-            ++count;
-            ptr = ptr->left;
+        return freedCount;
+#else
+        return 0;
+#endif
+    }
+
+    /*
+     * Limit the number of nodes that the freed list retains to the larger
+     * of a number of nodes and a fraction of the number of nodes in the tree.
+     * The default policy retains every freed node.
+     *
+     * Calling parameters:
+     *
+     * @param maxNodes (IN) the number of nodes to retain regardless of tree size
+     * @param fraction (IN) the fraction of the tree size to retain
+     */
+public:
+    void freedPolicy( size_t const maxNodes, double const fraction ) {
+#ifndef DISABLE_FREED_LIST
+        freedMax = maxNodes;
+        freedFraction = fraction;
+#else
+        (void) maxNodes;
+        (void) fraction;
+#endif
+    }
+
+    /*
+     * Delete the nodes on the freed list in excess of the limit of
+     * freedPolicy. A node that occupies the arena is retained unless
+     * the tree is empty, in which case the arena is released.
+     */
+public:
+    void shrinkToFit() {
+#ifndef DISABLE_FREED_LIST
+        size_t const fraction = static_cast<size_t>(freedFraction * count);
+        size_t const limit = (freedMax > fraction) ? freedMax : fraction;
+        Node* p = freed;
+        freed = nullptr;
+        freedCount = 0;
+        while ( p != nullptr ) {
+            Node* next = p->left;
+            if ( inArena(p) ) {
+                if ( count != 0 ) {
+                    p->left = freed;
+                    freed = p;
+                    ++freedCount;
+                }
+            } else if ( freedCount < limit ) {
+                p->left = freed;
+                freed = p;
+                ++freedCount;
+            } else {
+                delete p;
+            }
+            p = next;
+        }
+        if ( count == 0 ) {
+            arena.release();
         }
 #endif
-        return count;
     }
 
     /*
@@ -229,19 +533,41 @@ public:
             p->left = freed;
             freed = p;
         }
+        freedCount += n;
 #else
-        nodes.resize(n);
+        Node* const block = arena.allocate(n);
         for (size_t i = 0; i < n; ++i) {
-            Node* p = &nodes[i];
+            Node* p = block + i;
             p->left = freed;
             freed = p;
         }
+        freedCount += n;
 #endif
 #endif
     }
 
     /*
-     * Prepend the freed node to the freed list via its left pointer.
+     * Report the memory that the TD RB tree occupies (see memoryFootprint.h).
+     *
+     * @return the live, freed, reserved, payload and overhead bytes
+     */
+public:
+    memoryFootprint memoryUsage() {
+        memoryFootprint m;
+        size_t const vectorSize = arena.size(), vectorCapacity = arena.capacity();
+        m.addNodes(sizeof(Node), count, freedSize(), vectorSize, vectorCapacity);
+        if (hasHeapPayload<K>::value) {
+            m.addSubtree(root, static_cast<Node*>(nullptr));
+#ifndef DISABLE_FREED_LIST
+            m.addFreed(freed, static_cast<Node*>(nullptr));
+#endif
+        }
+        return m;
+    }
+
+    /*
+     * Prepend the freed node to the freed list via its left pointer,
+     * unless the freed list has reached the limit of freedPolicy.
      *
      * Calling parameter:
      * 
@@ -250,10 +576,17 @@ public:
 public:
     inline void deleteNode( Node* q ) {
 #ifndef DISABLE_FREED_LIST
-        q->left = freed;
-        freed = q;
+        if ( freedCount < freedMax || freedCount < freedFraction * count || inArena(q) ) {
+            q->left = freed;
+            freed = q;
+            ++freedCount;
+        } else {
+            delete q;
+        }
 #else
-        delete q;
+        if ( !inArena(q) ) {
+            delete q;
+        }
 #endif
     }
 
@@ -269,15 +602,21 @@ private:
     inline Node* newNode(K const& key) {
 
 #ifndef DISABLE_FREED_LIST
-        if (freed != nullptr )
-        {
-            Node* ptr = freed;
+#ifdef LOCK_COUPLING
+        freedLatch.lock();
+#endif
+        Node* ptr = freed;
+        if (ptr != nullptr ) {
             freed = freed->left;
+            --freedCount;
+        }
+#ifdef LOCK_COUPLING
+        freedLatch.unlock();
+#endif
+        if (ptr != nullptr )
+        {
             ptr->key = key;
             ptr->color = RED;
-#ifdef ENABLE_PREFERRED_TEST
-            ptr->taille = 1;
-#endif
             ptr->left = ptr->right = nullptr;
 #ifdef PARENT
             ptr->parent = nullptr;
@@ -304,15 +643,21 @@ public:
     inline bool contains( Node* const q, K const& x) {
         
         Node* p = q;            
+        TREE_STATS(size_t length = 0;)
         while ( p != nullptr ) {                    /* iterate; don't use recursion */
+            TREE_STATS(++length;)
             if ( x < p->key ) {
+                TREE_STATS(++stats.comparisons;)
                 p = p->left;                        /* follow the left branch */
             } else if ( x > p->key ) {
+                TREE_STATS(stats.comparisons += 2;)
                 p = p->right;                       /* follow the right branch */
             } else {
+                TREE_STATS(stats.comparisons += 2; treeStats::record(stats.searchLength, length);)
                 return true;                        /* found the key, so return true */
             }
         }
+        TREE_STATS(treeStats::record(stats.searchLength, length);)
         return false;                               /* didn't find the key, so return false */
     }
     
@@ -563,7 +908,11 @@ private:
      */
 public:
     inline bool contains( K const& x ) {
+#ifdef LOCK_COUPLING
+        return containsCoupled( x );
+#else
         return contains( root, x );
+#endif
     }
     
     /*
@@ -580,8 +929,10 @@ public:
      *          which suggests that inlining it will cause code bloat that
      *          will decrease performance.
      */
+#ifndef LOCK_COUPLING
 public:
     bool insert( K const& n ) {
+        TREE_STATS(stats.steps = 0;)
 		if (root == nullptr) {
 			root = newNode(n);
 		} else {
@@ -634,16 +985,224 @@ public:
 		
 		root->color = BLACK;
 		++count;
+        TREE_STATS(treeStats::record(stats.insertPropagation, stats.steps);)
 		return true;
 	}
+#else // LOCK_COUPLING
+
+    /*
+     * The maximum number of nodes that an insertion locks, i.e.,
+     * ggp, gp, p, m and the two children of m.
+     */
+private:
+    static constexpr size_t MAX_HELD = 6;
+
+    /*
+     * Search the tree for the existence of a key
+     * and add the key as a new node if not found,
+     * via lock coupling. The descent is identical
+     * to that of the sequential insert function.
+     *
+     * Calling parameter:
+     *
+     * @param n (IN) the key to add to the tree
+     * 
+     * @return true if the key was added as a new rbNode; otherwise, false
+     */
+public:
+    bool insert( K const& n ) {
+        rootLatch.lock();
+        if (root == nullptr) {
+            root = newNode(n);
+            root->color = BLACK;
+            ++count;
+            rootLatch.unlock();
+            return true;
+        }
+
+        Node* held[MAX_HELD];   // the nodes that this thread has locked
+        size_t h = 0;           // the number of locked nodes
+        bool rootHeld = true;   // this thread has locked the root pointer
+        bool added = false;
+
+        Node* ggp = nullptr;
+        Node* gp = nullptr;
+        Node* p = nullptr;
+        Node* m = root;
+        m->latch.lock();
+        held[h++] = m;
+
+        while (true) {
+            // Enforce a BLACK root before unlocking the root pointer,
+            // because another thread may then visit the root. Then
+            // unlock each node that this step doesn't use, and lock
+            // the children of m, whose colors testChildrenColors may
+            // flip and which a rotation may relink.
+            if (rootHeld && ggp != nullptr) {
+                root->color = BLACK;
+                rootLatch.unlock();
+                rootHeld = false;
+            }
+            unlockOthers(ggp, gp, p, m, held, h);
+            lockChild(m->left, held, h);
+            lockChild(m->right, held, h);
+
+            testChildrenColors(m, p, gp, ggp);
+            int compare = compareTo(n, m->key);
+            // Don't insert the key twice.
+            if ( compare == 0 ) {
+                break;
+            }
+
+            if (m->left == nullptr && m->right == nullptr) {
+                if ( compare < 0 ) {
+                    addToLeft(m, p, gp, n);
+                } else {
+                    addToRight(m, p, gp, n);
+                }
+                added = true;
+                break;
+            }
+
+            if (m->left == nullptr) {
+                if ( compare < 0 ) {
+                    addToLeft(m, p, gp, n);
+                    added = true;
+                    break;
+                }
+            } else if (m->right == nullptr) {
+                if ( compare > 0) {
+                    addToRight(m, p, gp, n);
+                    added = true;
+                    break;
+                }
+            }
+            ggp = gp;
+            gp = p;
+            p = m;
+            if ( compare > 0 ) {
+                m = m->right;
+            } else {
+                m = m->left;
+            }
+        }
+
+        if (rootHeld) {
+            root->color = BLACK;
+            rootLatch.unlock();
+        }
+        for (size_t i = 0; i < h; ++i) {
+            held[i]->latch.unlock();
+        }
+        if (added) {
+            ++count;
+        }
+        return added;
+    }
+
+    /*
+     * Lock a child of a locked node unless this thread has locked it.
+     *
+     * Calling parameters:
+     *
+     * @param c (IN) the child or nullptr
+     * @param held (MODIFIED) the nodes that this thread has locked
+     * @param h (MODIFIED) the number of locked nodes
+     */
+private:
+    inline void lockChild(Node* const c, Node** const held, size_t& h) {
+        if (c == nullptr) {
+            return;
+        }
+        for (size_t i = 0; i < h; ++i) {
+            if (held[i] == c) {
+                return;
+            }
+        }
+        c->latch.lock();
+        held[h++] = c;
+    }
+
+    /*
+     * Unlock each locked node other than ggp, gp, p, m and the children
+     * of m. Because a rotation may make m the parent of p and gp, some
+     * of those nodes may coincide.
+     *
+     * Calling parameters:
+     *
+     * @param ggp (IN) the great-grandparent of m or nullptr
+     * @param gp (IN) the grandparent of m or nullptr
+     * @param p (IN) the parent of m or nullptr
+     * @param m (IN) the current node
+     * @param held (MODIFIED) the nodes that this thread has locked
+     * @param h (MODIFIED) the number of locked nodes
+     */
+private:
+    inline void unlockOthers(Node* const ggp, Node* const gp, Node* const p, Node* const m,
+                             Node** const held, size_t& h) {
+        size_t j = 0;
+        for (size_t i = 0; i < h; ++i) {
+            Node* const q = held[i];
+            if (q == ggp || q == gp || q == p || q == m || q == m->left || q == m->right) {
+                held[j++] = q;
+            } else {
+                q->latch.unlock();
+            }
+        }
+        h = j;
+    }
+
+    /*
+     * Search the tree for the existence of a key via lock coupling,
+     * i.e., lock a child before unlocking its parent.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to search for
+     * 
+     * @return true if the key was found; otherwise, false
+     */
+private:
+    inline bool containsCoupled( K const& x ) {
+        rootLatch.lock();
+        Node* p = root;
+        if ( p == nullptr ) {
+            rootLatch.unlock();
+            return false;
+        }
+        p->latch.lock();
+        rootLatch.unlock();
+        while ( true ) {
+            Node* q;
+            if ( x < p->key ) {
+                q = p->left;
+            } else if ( x > p->key ) {
+                q = p->right;
+            } else {
+                p->latch.unlock();
+                return true;
+            }
+            if ( q == nullptr ) {
+                p->latch.unlock();
+                return false;
+            }
+            q->latch.lock();
+            p->latch.unlock();
+            p = q;
+        }
+    }
+#endif // LOCK_COUPLING
 
 private:
     inline int compareTo(K const& k1, K const& k2) {
         if (k1 < k2) {
+            TREE_STATS(++stats.comparisons;)
             return -1;
         } else if (k1 > k2) {
+            TREE_STATS(stats.comparisons += 2;)
             return 1;
         } else {
+            TREE_STATS(stats.comparisons += 2;)
             return 0;
         }
     }
@@ -655,6 +1214,7 @@ private:
         }
 		if (m->right->color == RED && m->left->color == RED) {
             // flip colors
+            TREE_STATS(++stats.steps; ++stats.colorFlips;)
 			m->color = RED;
 			m->right->color = BLACK;
 			m->left->color = BLACK;
@@ -691,6 +1251,7 @@ private:
         m->left->parent = m;
 #endif
 		if (m->color == RED && p != nullptr) { 
+            TREE_STATS(++stats.steps;)
 			Node* x;
 			if (p->left == nullptr) {
                 x = doubleLeftRotation(p);
@@ -714,6 +1275,7 @@ private:
         m->right->parent = m;
 #endif
 		if (m->color == RED && p != nullptr) { 
+            TREE_STATS(++stats.steps;)
 			Node* x;
             if (p->right == nullptr) {
                 x = doubleRightRotation(p);
@@ -762,6 +1324,7 @@ private:
         }
         n->left->color = RED;
         ++singleRotationCount;
+        TREE_STATS(++stats.rotations;)
         return n;
     }
 #else
@@ -775,6 +1338,7 @@ private:
         }
         n->left->color = RED;
         ++singleRotationCount;
+        TREE_STATS(++stats.rotations;)
         return n;
     }
 #endif
@@ -796,6 +1360,7 @@ private:
             n->left->color = RED;
         }
         ++singleRotationCount;
+        TREE_STATS(++stats.rotations;)
         return n;
     }
 #else
@@ -809,6 +1374,7 @@ private:
             n->left->color = RED;
         }
         ++singleRotationCount;
+        TREE_STATS(++stats.rotations;)
         return n;
     }
 #endif
@@ -912,6 +1478,7 @@ private:
     // Step 2A1 - p is RED and x and its sibling each have two BLACK children.
 private:
     bool removeStep2A1(Node* x, K const& n, Node* p, Node* gp) {
+        TREE_STATS(++stats.steps; ++stats.colorFlips;)
         // Flip (complement) the colors of p and its children.
         p->color = BLACK;
         if (p->right != nullptr) {
@@ -941,6 +1508,7 @@ private:
     // Step 2A2 - x has two BLACK children and its sibling's inner child is RED.
 private:
     bool removeStep2A2(Node* x, K const& n, Node* p, Node* gp) { 
+        TREE_STATS(++stats.steps;)
         Node* z;
         if (p->right != nullptr && x->key == p->right->key) {
             // x is its parent's right child, so rotate double right about the parent.
@@ -993,6 +1561,7 @@ private:
     // Step 2A3 - x has two BLACK children and the sibling's outer child is RED.
 private:
     bool removeStep2A3(Node* x, K const& n, Node* p, Node* gp) { 
+        TREE_STATS(++stats.steps;)
         Node* z;
         if (p->right != nullptr && x->key == p->right->key) {
             // x is its parent's right child, so single right rotate about the parent.
@@ -1096,6 +1665,7 @@ private:
     // Step 2B2 - the root (x) of the subtree is BLACK.
 private:
     bool removeStep2B2(Node* x, K const& n, Node* p, Node* gp) { 
+        TREE_STATS(++stats.steps;)
         Node* b;
         if (p->right != nullptr && p->right->key == x->key) {
             // x is the parent's right child, so single rotate right about the parent.
@@ -1224,8 +1794,10 @@ public:
 		if (root == nullptr) {
             return false;
         }
+        TREE_STATS(stats.steps = 0;)
 		if (erase(root, n)) {
 			--count;
+            TREE_STATS(treeStats::record(stats.erasePropagation, stats.steps);)
 			if (root != nullptr) {
 				root->color = BLACK;
 			}
@@ -0,0 +1,2584 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Benchmark driver that runs the AVL and WAVL trees, the bottom-up, top-down,
+ * left-leaning and hybrid red-black trees, the B+ tree and std::set from a single
+ * executable. Each tree is built and destroyed under identical shuffles
+ * of the keys, generated from the same seed, and the results are printed
+ * as side-by-side tables in the format of the Figures_data files.
+ *
+ * To build the test executable, compile via:
+ *
+ * g++ -std=c++11 -O3 -o test_allTrees test_allTrees.cpp
+ *
+ * The compilation options of the tree headers, for example, -D PREALLOCATE
+ * or -D ENABLE_PREFERRED_TEST, apply to every tree that recognizes them.
+ *
+ * Usage:
+ *
+ * test_allTrees [-k K] [-i I] [-s S] [--tree T] [--insert O] [--erase O]
+ *               [--sweep] [--min N] [--max N] [-f F] [-o FILE]
+ *               [--merge CSV,CSV,...] [--figures DIR] [--host H] [--latency S]
+ *               [--perf] [--workload W] [--distribution D] [--requests R]
+ *               [--record FILE] [--replay FILE] [--memory]
+ *
+ * where the command-line options are interpreted as follows.
+ *
+ * -k The number of keys to insert into each tree
+ *
+ * -i The number of times to iterate the test
+ *
+ * -s The seed for shuffling the keys
+ *
+ * --tree A comma-separated list of the trees to test, chosen from
+ *        avl, wavl, burb, td, ll, hy, bplus and stdset (default all)
+ *
+ * --insert The insertion order, either random or inorder (default random)
+ *
+ * --erase The deletion order, either random, inorder or revorder (default random)
+ *
+ * --sweep Test each power-of-two multiple of --min keys through --max keys,
+ *         each with random insertion and deletion and with in-order
+ *         insertion and deletion, instead of -k keys
+ *
+ * --min The smallest number of keys for --sweep (default 65536)
+ *
+ * --max The largest number of keys for --sweep (default 4194304)
+ *
+ * -f The output format, either text, csv or json (default text)
+ *
+ * -o The output file (default standard output)
+ *
+ * --merge A comma-separated list of CSV files, written by -f csv, whose
+ *         results are reported with those of this run. Unless --tree is
+ *         also specified, no tree is run.
+ *
+ * --figures A directory in which to write Figure2.txt through Figure8.txt
+ *           in the format of the Figures_data files
+ *
+ * --host A description of the hardware for the headers of the figures
+ *
+ * --latency Time 1 of every S insert, contains and erase operations, where
+ *           S is a power of two, and report the p50, p90, p99, p99.9 and
+ *           p99.99 percentiles and the maximum of each in nanoseconds.
+ *           On x86-64, the time stamp counter is read and calibrated
+ *           against std::chrono::steady_clock; compile with
+ *           -D LATENCY_STEADY_CLOCK to read steady_clock instead.
+ *
+ * --perf Count cycles, instructions, branch misses, cache misses and dTLB
+ *        load misses in user space for each phase via perf_event_open, and
+ *        report each per key. Events that cannot be opened are omitted,
+ *        and if no event can be opened, as is common in containers, a
+ *        warning is printed and the test runs without counters.
+ *
+ * --workload Instead of inserting, searching for and erasing every key,
+ *            load -k records and apply a mix of requests generated by
+ *            workload.h: a, b, c, d, e or f for the YCSB core workloads,
+ *            or window to insert new records and expire the oldest
+ *
+ * --distribution The distribution of request keys, either uniform, zipfian
+ *                or hotspot (default zipfian)
+ *
+ * --requests The number of requests of the workload (default 1000000)
+ *
+ * --record Write the operations of the --workload, including the loading
+ *          of its records, to a trace file in the format of traceFile.h
+ *
+ * --replay Instead of inserting, searching for and erasing every key,
+ *          apply the operations of a trace file, for example, one
+ *          recorded from a service via traceWriter, to each empty tree.
+ *          The trace is memory-mapped and decoded as it is replayed, so
+ *          the run time includes decoding, whose time is also reported.
+ *
+ * --memory Report the memory footprint of each tree (see memoryFootprint.h)
+ *          in bytes per key when every key has been inserted, by component,
+ *          and the bytes per key that each tree retains following erasure
+ *
+ * To also report the key comparisons per operation and the histograms of
+ * the search path lengths and the rebalancing propagation distances of
+ * each tree except std::set in the text output, compile with
+ * -D ENABLE_TREE_STATS (see treeStats.h).
+ *
+ * The AP and BP columns of the figures report the AVL and bottom-up
+ * red-black trees compiled with -D ENABLE_PREFERRED_TEST, which labels
+ * them AP and BP. Because that selection occurs at compilation, the
+ * figures are regenerated from two executables, for example:
+ *
+ * g++ -std=c++11 -O3 -o test_allTrees test_allTrees.cpp
+ * g++ -std=c++11 -O3 -D ENABLE_PREFERRED_TEST -o test_allTreesP test_allTrees.cpp
+ * test_allTrees --sweep -f csv -o customary.csv
+ * test_allTreesP --sweep --tree avl,burb -f csv -o preferred.csv
+ * test_allTrees --merge customary.csv,preferred.csv --figures Figures_data
+ *
+ * If the merged results contain a tree more than once for the same
+ * number of keys and orders, the first occurrence is reported.
+ */
+
+#include "avlTree.h"
+#include "bplusTree.h"
+#include "wavlTree.h"
+#include "burbTree.h"
+#include "hyrbTree.h"
+#include "tdrbTree.h"
+#include "llrbTree.h"
+#include "latencyHistogram.h"
+#include "memoryFootprint.h"
+#include "perfCounters.h"
+#include "traceFile.h"
+#include "treeStats.h"
+#include "workload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+  * Calculate the mean and standard deviation of the elements of a vector.
+  *
+  * Calling parameter:
+  *
+  * vec - a vector
+  * 
+  * return a pair that contains the mean and standard deviation
+  */
+ template <typename T>
+std::pair<double, double> calcMeanStd(std::vector<T> const& vec) {
+  double sum = 0, sum2 = 0;
+  for (size_t i = 0; i < vec.size(); ++i) {
+    double v = static_cast<double>(vec[i]);
+    sum += v;
+    sum2 += v * v;
+  }
+double n = static_cast<double>(vec.size());
+return std::make_pair(sum / n, sqrt((n * sum2) - (sum * sum)) / n);
+}
+
+/*
+ * The stdSet class adapts std::set to the interface of the tree classes.
+ */
+template <typename K>
+class stdSet {
+private:
+    std::set<K> root;
+
+public:
+    size_t nodeSize() {
+        // A red-black node of libstdc++ comprises a color, three pointers and the key.
+        struct Node { int color; void *parent, *left, *right; K key; };
+        return sizeof(Node);
+    }
+
+public:
+    bool insert(K const& key) { return root.insert(key).second; }
+
+public:
+    bool erase(K const& key) { return root.erase(key) != 0; }
+
+public:
+    bool contains(K const& key) { return root.find(key) != root.end(); }
+
+public:
+    size_t size() { return root.size(); }
+
+public:
+    bool empty() { return root.empty(); }
+
+public:
+    void clear() { root.clear(); }
+
+public:
+    memoryFootprint memoryUsage() {
+        memoryFootprint m;
+        m.addNodes(nodeSize(), root.size(), 0, 0, 0);
+        if (hasHeapPayload<K>::value) {
+            for (typename std::set<K>::const_iterator it = root.begin(); it != root.end(); ++it) {
+                m.addPayload(*it);
+            }
+        }
+        return m;
+    }
+};
+
+/*
+ * The following functions reset and read the rotation counters, which
+ * differ among the trees. The total counts a double rotation as two
+ * rotations, in agreement with the single-tree test programs.
+ */
+template <typename K>
+void resetRotations(avlTree<K>& t) {
+    t.lli = t.lri = t.rli = t.rri = t.lle = t.lre = t.rle = t.rre = 0;
+}
+template <typename K>
+size_t insertRotations(avlTree<K>& t) {
+    return t.lli + 2*(t.lri + t.rli) + t.rri;
+}
+template <typename K>
+size_t eraseRotations(avlTree<K>& t) {
+    return t.lle + 2*(t.lre + t.rle) + t.rre;
+}
+
+template <typename K>
+void resetRotations(wavlTree<K>& t) {
+    t.lli = t.lri = t.rli = t.rri = t.lle = t.lre = t.rle = t.rre = 0;
+    t.promotions = t.demotions = 0;
+}
+template <typename K>
+size_t insertRotations(wavlTree<K>& t) {
+    return t.lli + 2*(t.lri + t.rli) + t.rri;
+}
+template <typename K>
+size_t eraseRotations(wavlTree<K>& t) {
+    return t.lle + 2*(t.lre + t.rle) + t.rre;
+}
+
+template <typename K>
+void resetRotations(burbTree<K>& t) {
+    t.rotateL = t.rotateR = 0;
+}
+template <typename K>
+size_t insertRotations(burbTree<K>& t) {
+    return t.rotateL + t.rotateR;
+}
+template <typename K>
+size_t eraseRotations(burbTree<K>& t) {
+    return t.rotateL + t.rotateR;
+}
+
+template <typename K>
+void resetRotations(tdrbTree<K>& t) {
+    t.singleRotationCount = t.doubleRotationCount = 0;
+}
+template <typename K>
+size_t insertRotations(tdrbTree<K>& t) {
+    return t.singleRotationCount;
+}
+template <typename K>
+size_t eraseRotations(tdrbTree<K>& t) {
+    return t.singleRotationCount;
+}
+
+template <typename K>
+void resetRotations(llrbTree<K>& t) {
+    t.rotateL = t.rotateR = 0;
+}
+template <typename K>
+size_t insertRotations(llrbTree<K>& t) {
+    return t.rotateL + t.rotateR;
+}
+template <typename K>
+size_t eraseRotations(llrbTree<K>& t) {
+    return t.rotateL + t.rotateR;
+}
+
+template <typename K>
+void resetRotations(hyrbTree<K>& t) {
+    t.singleRotationCount = t.doubleRotationCount = t.rotateL = t.rotateR = 0;
+}
+template <typename K>
+size_t insertRotations(hyrbTree<K>& t) {
+    return t.singleRotationCount;
+}
+template <typename K>
+size_t eraseRotations(hyrbTree<K>& t) {
+    return t.rotateL + t.rotateR;
+}
+
+/* The B+ tree performs no rotations but counts splits, merges and borrows. */
+template <typename K>
+void resetRotations(bplusTree<K>& t) {
+    t.splits = t.merges = t.borrows = 0;
+}
+template <typename K>
+size_t insertRotations(bplusTree<K>& t) {
+    return 0;
+}
+template <typename K>
+size_t eraseRotations(bplusTree<K>& t) {
+    return 0;
+}
+
+template <typename K>
+void resetRotations(stdSet<K>& t) {}
+template <typename K>
+size_t insertRotations(stdSet<K>& t) {
+    return 0;
+}
+template <typename K>
+size_t eraseRotations(stdSet<K>& t) {
+    return 0;
+}
+
+/*
+ * The following functions read the individual rotation counters of each
+ * tree by name for the CSV and JSON output.
+ */
+typedef std::vector< std::pair<std::string, size_t> > counters_t;
+
+template <typename K>
+counters_t getCounters(avlTree<K>& t) {
+    return counters_t{ {"lli", t.lli}, {"lri", t.lri}, {"rli", t.rli}, {"rri", t.rri},
+                       {"lle", t.lle}, {"lre", t.lre}, {"rle", t.rle}, {"rre", t.rre} };
+}
+template <typename K>
+counters_t getCounters(wavlTree<K>& t) {
+    return counters_t{ {"lli", t.lli}, {"lri", t.lri}, {"rli", t.rli}, {"rri", t.rri},
+                       {"lle", t.lle}, {"lre", t.lre}, {"rle", t.rle}, {"rre", t.rre},
+                       {"promotions", t.promotions}, {"demotions", t.demotions} };
+}
+template <typename K>
+counters_t getCounters(burbTree<K>& t) {
+    return counters_t{ {"rotateL", t.rotateL}, {"rotateR", t.rotateR} };
+}
+template <typename K>
+counters_t getCounters(tdrbTree<K>& t) {
+    return counters_t{ {"singleRotationCount", t.singleRotationCount},
+                       {"doubleRotationCount", t.doubleRotationCount} };
+}
+template <typename K>
+counters_t getCounters(llrbTree<K>& t) {
+    return counters_t{ {"rotateL", t.rotateL}, {"rotateR", t.rotateR} };
+}
+template <typename K>
+counters_t getCounters(hyrbTree<K>& t) {
+    return counters_t{ {"singleRotationCount", t.singleRotationCount},
+                       {"doubleRotationCount", t.doubleRotationCount},
+                       {"rotateL", t.rotateL}, {"rotateR", t.rotateR} };
+}
+template <typename K>
+counters_t getCounters(bplusTree<K>& t) {
+    return counters_t{ {"splits", t.splits}, {"merges", t.merges}, {"borrows", t.borrows} };
+}
+template <typename K>
+counters_t getCounters(stdSet<K>& t) {
+    return counters_t();
+}
+
+#ifdef ENABLE_TREE_STATS
+/*
+ * The following functions return the comparisons and histograms
+ * of treeStats.h, which std::set does not support.
+ */
+template <typename T>
+treeStats const* getStats(T& t) {
+    return &t.stats;
+}
+template <typename K>
+treeStats const* getStats(stdSet<K>& t) {
+    return nullptr;
+}
+#endif
+
+/*
+ * The following functions preallocate the freed list and check the tree,
+ * which std::set does not support.
+ */
+template <typename T>
+void preallocate(T& t, size_t n) {
+    t.freedPreallocate(n);
+}
+template <typename K>
+void preallocate(stdSet<K>& t, size_t n) {}
+
+template <typename T>
+void check(T& t) {
+    t.checkTree();
+}
+template <typename K>
+void check(stdSet<K>& t) {}
+
+/* The order in which keys are inserted or erased, and its name on the command line. */
+enum order_t { RANDOM, INORDER, REVORDER };
+char const* const orderNames[] = { "random", "inorder", "revorder" };
+
+/* The output format. */
+enum format_t { TEXT, CSV, JSON };
+
+/* The command-line options that are common to every tree. */
+struct Options {
+    size_t keys;
+    size_t iterations;
+    uint64_t seed;
+    order_t insertOrder;
+    order_t eraseOrder;
+    size_t sampling;                // time 1 of every sampling operations, or none if 0
+    latencyTimer const* timer;      // the calibrated timer if sampling is nonzero
+    perfCounters* perf;             // the hardware counters, or nullptr if not measured
+    bool memory;                    // report the memory footprint
+};
+
+/* The percentiles of the latency reports. */
+double const percentiles[] = { 50., 90., 99., 99.9, 99.99, 100. };
+char const* const percentileNames[] = { "p50", "p90", "p99", "p999", "p9999", "max" };
+size_t const percentileCount = sizeof(percentiles) / sizeof(percentiles[0]);
+
+/*
+ * The measurements for one tree, one number of keys and one pair of
+ * insertion and deletion orders, with one element per iteration.
+ */
+struct Result {
+    std::string label;
+    size_t keys;
+    order_t insertOrder, eraseOrder;
+    size_t nodeSize;
+    std::vector<double> insertTime, searchTime, eraseTime;
+    std::vector<size_t> insertRotations, eraseRotations;
+    std::vector<counters_t> insertCounters, eraseCounters;
+    std::vector<latencyHistogram> insertLatency, searchLatency, eraseLatency;  // in ticks
+    std::vector<counters_t> insertPerf, searchPerf, erasePerf;                  // hardware counters
+    double nanosPerTick;
+    std::vector<memoryFootprint> fullMemory, emptyMemory;   // following insertion and erasure
+    treeStats stats;    // accumulated over the iterations if ENABLE_TREE_STATS is defined
+};
+
+/*
+ * Under ENABLE_PREFERRED_TEST, the AVL and bottom-up red-black trees
+ * select a preferred replacement node for deletion, which Figures_data
+ * labels AP and BP to distinguish from the customary AV and BU. The
+ * WAVL and left-leaning red-black trees are likewise labeled WP and LP
+ * instead of WA and LL.
+ *
+ * Calling parameter:
+ *
+ * label - the customary label
+ *
+ * return the label for this compilation
+ */
+std::string labelOf(std::string const& label) {
+#ifdef ENABLE_PREFERRED_TEST
+    if (label == "AV") {
+        return "AP";
+    }
+    if (label == "BU") {
+        return "BP";
+    }
+    if (label == "WA") {
+        return "WP";
+    }
+    if (label == "LL") {
+        return "LP";
+    }
+#endif
+    return label;
+}
+
+/*
+ * Perform one phase of operations and return its execution time. If
+ * sampling is nonzero, also record the latency of every sampling-th
+ * operation, where sampling is a power of two, so that the overhead
+ * of reading the timer is amortized over the unsampled operations.
+ * If hardware counters are measured, also count their events, which
+ * include the sampling of latency.
+ *
+ * Calling parameters:
+ *
+ * n - the number of operations
+ * opt - the options that specify sampling and hardware counters
+ * latency - the histogram of sampled latencies in ticks (MODIFIED)
+ * perf - the hardware counters of the phase (MODIFIED)
+ * op - a function of the operation index that performs the operation
+ *
+ * return the execution time of the phase in seconds
+ */
+template <typename F>
+double runPhase(size_t n, Options const& opt, latencyHistogram& latency, counters_t& perf, F op) {
+    size_t const sampling = opt.sampling;
+    if (opt.perf != nullptr) {
+        opt.perf->start();
+    }
+    auto startTime = std::chrono::steady_clock::now();
+    if (sampling == 0) {
+        for (size_t i = 0; i < n; ++i) {
+            op(i);
+        }
+    } else {
+        size_t const mask = sampling - 1;
+        for (size_t i = 0; i < n; ++i) {
+            if ((i & mask) == 0) {
+                uint64_t const start = latencyTimer::now();
+                op(i);
+                latency.record(latencyTimer::now() - start);
+            } else {
+                op(i);
+            }
+        }
+    }
+    auto endTime = std::chrono::steady_clock::now();
+    if (opt.perf != nullptr) {
+        perf = opt.perf->stop();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    return static_cast<double>(duration.count()) / 1000000.;
+}
+
+/*
+ * Insert, search for and erase every key of a tree for each iteration,
+ * verify the tree after each phase, and record the times and rotations.
+ *
+ * Calling parameters:
+ *
+ * root - the tree
+ * label - the two-letter label of the tree
+ * opt - the command-line options
+ *
+ * return the measurements
+ */
+template <typename T>
+Result runTree(T& root, std::string const& label, Options const& opt) {
+
+    using std::endl;
+    using std::ostringstream;
+    using std::runtime_error;
+
+    Result result;
+    result.label = labelOf(label);
+    result.keys = opt.keys;
+    result.insertOrder = opt.insertOrder;
+    result.eraseOrder = opt.eraseOrder;
+    result.nodeSize = root.nodeSize();
+    result.insertCounters.resize(opt.iterations);
+    result.eraseCounters.resize(opt.iterations);
+    result.insertTime.resize(opt.iterations);
+    result.searchTime.resize(opt.iterations);
+    result.eraseTime.resize(opt.iterations);
+    result.insertRotations.resize(opt.iterations);
+    result.eraseRotations.resize(opt.iterations);
+    result.nanosPerTick = 0.;
+    if (opt.sampling != 0) {
+        result.insertLatency.resize(opt.iterations);
+        result.searchLatency.resize(opt.iterations);
+        result.eraseLatency.resize(opt.iterations);
+        result.nanosPerTick = opt.timer->nanos(1);
+    }
+    if (opt.perf != nullptr) {
+        result.insertPerf.resize(opt.iterations);
+        result.searchPerf.resize(opt.iterations);
+        result.erasePerf.resize(opt.iterations);
+    }
+    if (opt.memory) {
+        result.fullMemory.resize(opt.iterations);
+        result.emptyMemory.resize(opt.iterations);
+    }
+    latencyHistogram unused;
+    counters_t unusedPerf;
+
+    // Create two vectors of unique unsigned integers as large as keys,
+    // and shuffle them with a generator seeded identically for every tree.
+    std::vector<uint32_t> insertNumbers(opt.keys);
+    for (size_t i = 0; i < opt.keys; ++i) {
+        insertNumbers[i] = static_cast<uint32_t>(i);
+    }
+    std::vector<uint32_t> deleteNumbers(insertNumbers);
+    std::mt19937_64 g(opt.seed);
+
+    preallocate(root, opt.keys);
+
+    for (size_t it = 0; it < opt.iterations; ++it) {
+
+        // Shuffle the keys and add each key to the tree.
+        resetRotations(root);
+        if (opt.insertOrder == RANDOM) {
+            std::shuffle(insertNumbers.begin(), insertNumbers.end(), g);
+        }
+        result.insertTime[it] = runPhase(insertNumbers.size(), opt,
+            (opt.sampling != 0) ? result.insertLatency[it] : unused,
+            (opt.perf != nullptr) ? result.insertPerf[it] : unusedPerf, [&](size_t i) {
+            if ( root.insert( insertNumbers[i] ) == false) {
+                ostringstream buffer;
+                buffer << endl << label << ": key " << insertNumbers[i] << " is already in tree for insert" << endl;
+                throw runtime_error(buffer.str());
+            }
+        });
+        result.insertRotations[it] = insertRotations(root);
+        result.insertCounters[it] = getCounters(root);
+
+        // Verify the size and the validity of the tree.
+        if (root.size() != insertNumbers.size()) {
+            ostringstream buffer;
+            buffer << endl << label << ": expected size for tree = " << insertNumbers.size()
+                   << " differs from actual size = " << root.size() << endl;
+            throw runtime_error(buffer.str());
+        }
+        check(root);
+        if (opt.memory) {
+            result.fullMemory[it] = root.memoryUsage();
+        }
+
+        // Search for each key in the order of insertion.
+        result.searchTime[it] = runPhase(insertNumbers.size(), opt,
+            (opt.sampling != 0) ? result.searchLatency[it] : unused,
+            (opt.perf != nullptr) ? result.searchPerf[it] : unusedPerf, [&](size_t i) {
+            if ( root.contains( insertNumbers[i] ) == false ) {
+                ostringstream buffer;
+                buffer << endl << label << ": key " << insertNumbers[i] << " is not in tree for contains" << endl;
+                throw runtime_error(buffer.str());
+            }
+        });
+
+        // Reshuffle the keys and erase each key from the tree.
+        resetRotations(root);
+        if (opt.eraseOrder == RANDOM) {
+            std::shuffle(deleteNumbers.begin(), deleteNumbers.end(), g);
+        }
+        bool const reverse = (opt.eraseOrder == REVORDER);
+        result.eraseTime[it] = runPhase(deleteNumbers.size(), opt,
+            (opt.sampling != 0) ? result.eraseLatency[it] : unused,
+            (opt.perf != nullptr) ? result.erasePerf[it] : unusedPerf, [&](size_t j) {
+            size_t const i = reverse ? deleteNumbers.size() - 1 - j : j;
+            if ( root.erase( deleteNumbers[i] ) == false ) {
+                ostringstream buffer;
+                buffer << endl << label << ": key " << deleteNumbers[i] << " is not in tree for erase" << endl;
+                throw runtime_error(buffer.str());
+            }
+        });
+        result.eraseRotations[it] = eraseRotations(root);
+        result.eraseCounters[it] = getCounters(root);
+
+        if ( root.empty() == false ) {
+            ostringstream buffer;
+            buffer << endl << label << ": " << root.size() << " nodes remain in tree following erasure" << endl;
+            throw runtime_error(buffer.str());
+        }
+        if (opt.memory) {
+            result.emptyMemory[it] = root.memoryUsage();
+        }
+    }
+#ifdef ENABLE_TREE_STATS
+    if (getStats(root) != nullptr) {
+        result.stats = *getStats(root);
+    }
+#endif
+    root.clear();
+    return result;
+}
+
+/*
+ * Construct one tree, selected by name, and pass it and its label to a
+ * function object whose template operator() accepts any of the trees.
+ *
+ * Calling parameters:
+ *
+ * name - the name of the tree from the --tree option
+ * f - the function object (MODIFIED)
+ */
+template <typename F>
+void withNamedTree(std::string const& name, F& f) {
+    if (name == "avl") {
+        avlTree<uint32_t> root;
+        f(root, "AV");
+    } else if (name == "wavl") {
+        wavlTree<uint32_t> root;
+        f(root, "WA");
+    } else if (name == "burb") {
+#ifdef STATIC_NULL_NODE
+        burbTree<uint32_t>::Node nadanode;
+        burbTree<uint32_t>::nullnode = &nadanode;
+#endif
+        burbTree<uint32_t> root;
+        f(root, "BU");
+    } else if (name == "td") {
+        tdrbTree<uint32_t> root;
+        f(root, "TD");
+    } else if (name == "ll") {
+        llrbTree<uint32_t> root;
+        f(root, "LL");
+    } else if (name == "hy") {
+#ifdef STATIC_NULL_NODE
+        hyrbTree<uint32_t>::Node nadanode;
+        hyrbTree<uint32_t>::nullnode = &nadanode;
+#endif
+        hyrbTree<uint32_t> root;
+        f(root, "HY");
+    } else if (name == "bplus") {
+        bplusTree<uint32_t> root;
+        f(root, "BT");
+    } else if (name == "stdset") {
+        stdSet<uint32_t> root;
+        f(root, "SS");
+    } else {
+        std::ostringstream buffer;
+        buffer << std::endl << "unknown tree: " << name << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+}
+
+/* A function object that runs the insert, search and erase phases of a tree. */
+struct treeRunner {
+    Options const& opt;
+    std::vector<Result>& results;
+
+    template <typename T>
+    void operator()(T& root, std::string const& label) {
+        results.push_back(runTree(root, label, opt));
+    }
+};
+
+/*
+ * Run one tree, selected by name, and append its measurements.
+ *
+ * Calling parameters:
+ *
+ * name - the name of the tree from the --tree option
+ * opt - the command-line options
+ * results - the measurements of the trees (MODIFIED)
+ */
+void runNamedTree(std::string const& name, Options const& opt, std::vector<Result>& results) {
+    treeRunner runner = { opt, results };
+    withNamedTree(name, runner);
+}
+
+/*
+ * The operations of a workload, which are generated once and applied to every
+ * tree, or of a trace, which is decoded from its file each time it is replayed.
+ */
+struct Workload {
+    std::string mix, distribution;
+    size_t records;                         // the number of records loaded initially
+    size_t requests;                        // the number of requests of the mix
+    size_t operations;                      // the number of operations of the run phase
+    std::string trace;                      // the path of a replayed trace, otherwise empty
+    double decodeTime;                      // the time to decode the trace without a tree
+    std::vector<operation> load, run;       // the operations of the load and run phases
+    uint64_t first, live;                   // the live keys are [first, first + live) after the run
+    size_t inserts;                         // the insertions of the run, which bound its growth
+};
+
+/* The measurements of one tree for a workload. */
+struct WorkloadResult {
+    std::string label;
+    std::vector<double> loadTime, runTime;
+    std::vector<size_t> hits;                   // the operations of each run that returned true
+    size_t finalSize;                           // the size of the tree after the last run
+    std::vector<latencyHistogram> latency[OP_COUNT];    // of each run by opcode, in ticks
+    std::vector<counters_t> perf;               // the hardware counters of each run
+    double nanosPerTick;
+};
+
+/* An operation source that iterates over a vector of operations. */
+struct vectorSource {
+    std::vector<operation> const& ops;
+    size_t index;
+
+    inline bool next(operation& o) {
+        if (index == ops.size()) {
+            return false;
+        }
+        o = ops[index++];
+        return true;
+    }
+};
+
+/*
+ * Apply every operation of a source to a tree, timing every sampling-th
+ * operation by its opcode, and append the measurements of this run.
+ * Operations may legitimately fail, for example, a scan beyond the newest
+ * record, so the operations that return true are counted instead.
+ *
+ * Calling parameters:
+ *
+ * root - the tree (MODIFIED)
+ * source - the operation source, which provides bool next(operation&) (MODIFIED)
+ * opt - the command-line options
+ * result - the measurements (MODIFIED)
+ */
+template <typename T, typename S>
+void applyOperations(T& root, S& source, Options const& opt, WorkloadResult& result) {
+    size_t hits = 0;
+    if (opt.sampling != 0) {
+        for (int op = 0; op < OP_COUNT; ++op) {
+            result.latency[op].push_back(latencyHistogram());
+        }
+    }
+    if (opt.perf != nullptr) {
+        opt.perf->start();
+    }
+    auto startTime = std::chrono::steady_clock::now();
+    size_t const mask = (opt.sampling != 0) ? opt.sampling - 1 : 0;
+    operation o;
+    for (size_t i = 0; source.next(o); ++i) {
+        bool const sample = (opt.sampling != 0 && (i & mask) == 0);
+        uint64_t const start = sample ? latencyTimer::now() : 0;
+        bool hit;
+        switch (o.op) {
+        case OP_CONTAINS:
+            hit = root.contains( static_cast<uint32_t>(o.key) );
+            break;
+        case OP_INSERT:
+            hit = root.insert( static_cast<uint32_t>(o.key) );
+            break;
+        default:
+            hit = root.erase( static_cast<uint32_t>(o.key) );
+            break;
+        }
+        if (sample) {
+            result.latency[o.op].back().record(latencyTimer::now() - start);
+        }
+        hits += hit;
+    }
+    auto endTime = std::chrono::steady_clock::now();
+    if (opt.perf != nullptr) {
+        result.perf.push_back(opt.perf->stop());
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    result.runTime.push_back(static_cast<double>(duration.count()) / 1000000.);
+    result.hits.push_back(hits);
+    result.finalSize = root.size();
+}
+
+/*
+ * Load the records of a workload into a tree, apply the operations of the
+ * mix, verify the tree, and erase the live records, for each iteration.
+ *
+ * Calling parameters:
+ *
+ * root - the empty tree
+ * label - the two-letter label of the tree
+ * opt - the command-line options
+ * w - the workload
+ *
+ * return the measurements
+ */
+template <typename T>
+WorkloadResult runWorkload(T& root, std::string const& label, Options const& opt, Workload const& w) {
+
+    using std::endl;
+    using std::ostringstream;
+    using std::runtime_error;
+
+    WorkloadResult result;
+    result.label = labelOf(label);
+    result.nanosPerTick = (opt.sampling != 0) ? opt.timer->nanos(1) : 0.;
+    latencyHistogram unused;
+    counters_t unusedPerf;
+    preallocate(root, w.records + w.inserts);
+
+    for (size_t it = 0; it < opt.iterations; ++it) {
+
+        // Load the records and verify the tree.
+        result.loadTime.push_back(runPhase(w.load.size(), opt, unused, unusedPerf, [&](size_t i) {
+            if ( root.insert( static_cast<uint32_t>(w.load[i].key) ) == false) {
+                ostringstream buffer;
+                buffer << endl << label << ": key " << w.load[i].key << " is already in tree for load" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }));
+        check(root);
+
+        // Apply the operations of the mix.
+        vectorSource source = { w.run, 0 };
+        applyOperations(root, source, opt, result);
+
+        // Verify the size and the validity of the tree.
+        if (root.size() != w.live) {
+            ostringstream buffer;
+            buffer << endl << label << ": expected size for tree = " << w.live
+                   << " differs from actual size = " << root.size() << endl;
+            throw runtime_error(buffer.str());
+        }
+        check(root);
+
+        // Erase the live records, each of which must be in the tree.
+        for (uint64_t k = w.first; k < w.first + w.live; ++k) {
+            if ( root.erase( static_cast<uint32_t>(k) ) == false ) {
+                ostringstream buffer;
+                buffer << endl << label << ": key " << k << " is not in tree for erase" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+        if ( root.empty() == false ) {
+            ostringstream buffer;
+            buffer << endl << label << ": " << root.size() << " nodes remain in tree following erasure" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    root.clear();
+    return result;
+}
+
+/*
+ * Replay a trace into an empty tree and verify the tree, for each iteration.
+ * Because the live keys are unknown, the tree is cleared after each replay,
+ * and it is not preallocated, because clear() of a preallocated tree
+ * requires that the tree be empty.
+ *
+ * Calling parameters:
+ *
+ * root - the empty tree
+ * label - the two-letter label of the tree
+ * opt - the command-line options
+ * trace - the trace (MODIFIED)
+ *
+ * return the measurements
+ */
+template <typename T>
+WorkloadResult runReplay(T& root, std::string const& label, Options const& opt, traceReader& trace) {
+    WorkloadResult result;
+    result.label = labelOf(label);
+    result.nanosPerTick = (opt.sampling != 0) ? opt.timer->nanos(1) : 0.;
+    for (size_t it = 0; it < opt.iterations; ++it) {
+        trace.rewind();
+        result.loadTime.push_back(0.);
+        applyOperations(root, trace, opt, result);
+        check(root);
+        root.clear();
+    }
+    return result;
+}
+
+/* A function object that replays a trace into a tree. */
+struct replayRunner {
+    Options const& opt;
+    traceReader& trace;
+    std::vector<WorkloadResult>& results;
+
+    template <typename T>
+    void operator()(T& root, std::string const& label) {
+        results.push_back(runReplay(root, label, opt, trace));
+    }
+};
+
+/* A function object that runs a workload on a tree. */
+struct workloadRunner {
+    Options const& opt;
+    Workload const& w;
+    std::vector<WorkloadResult>& results;
+
+    template <typename T>
+    void operator()(T& root, std::string const& label) {
+        results.push_back(runWorkload(root, label, opt, w));
+    }
+};
+
+
+/*
+ * Format a time in seconds to four significant digits without
+ * a leading zero, for example, .01237, as in Figures_data.
+ *
+ * Calling parameter:
+ *
+ * t - the time
+ *
+ * return the formatted time
+ */
+std::string formatTime(double t) {
+    std::ostringstream buffer;
+    buffer << std::setprecision(4) << t;
+    std::string s = buffer.str();
+    if (s.compare(0, 2, "0.") == 0) {
+        s.erase(0, 1);
+    }
+    return s;
+}
+
+/*
+ * Find the first result for a tree, a number of keys and a pair of orders.
+ *
+ * Calling parameters:
+ *
+ * results - the measurements
+ * label - the label of the tree
+ * keys - the number of keys
+ * insertOrder - the insertion order
+ * eraseOrder - the deletion order
+ *
+ * return a pointer to the result, or nullptr if there is none
+ */
+Result const* findResult(std::vector<Result> const& results, std::string const& label,
+                         size_t keys, order_t insertOrder, order_t eraseOrder) {
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i].label == label && results[i].keys == keys
+            && results[i].insertOrder == insertOrder && results[i].eraseOrder == eraseOrder) {
+            return &results[i];
+        }
+    }
+    return nullptr;
+}
+
+/* The measurements that a table or a figure may report. */
+enum metric_t { NODE_SIZE, INSERT_ROTATIONS, ERASE_ROTATIONS, INSERT_TIME, SEARCH_TIME, ERASE_TIME };
+
+/*
+ * Format the mean of a measurement.
+ *
+ * Calling parameters:
+ *
+ * r - the result
+ * metric - the measurement
+ *
+ * return the formatted mean
+ */
+std::string formatMetric(Result const& r, metric_t metric) {
+    std::ostringstream buffer;
+    switch (metric) {
+    case NODE_SIZE:
+        buffer << r.nodeSize;
+        return buffer.str();
+    case INSERT_ROTATIONS:
+        buffer << static_cast<size_t>(calcMeanStd<size_t>(r.insertRotations).first);
+        return buffer.str();
+    case ERASE_ROTATIONS:
+        buffer << static_cast<size_t>(calcMeanStd<size_t>(r.eraseRotations).first);
+        return buffer.str();
+    case INSERT_TIME:
+        return formatTime(calcMeanStd<double>(r.insertTime).first);
+    case SEARCH_TIME:
+        return formatTime(calcMeanStd<double>(r.searchTime).first);
+    default:
+        return formatTime(calcMeanStd<double>(r.eraseTime).first);
+    }
+}
+
+/*
+ * Write one table in the format of Figures_data, with one column per
+ * column label and one row per number of keys. A missing measurement
+ * is written as a hyphen.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * comments - the lines of the header, without the leading '# '
+ * columns - the column labels, each paired with the label of a tree and a measurement
+ * results - the measurements
+ * insertOrder - the insertion order
+ * eraseOrder - the deletion order
+ */
+void writeTable(std::ostream& out,
+                std::vector<std::string> const& comments,
+                std::vector< std::pair<std::string, std::pair<std::string, metric_t> > > const& columns,
+                std::vector<Result> const& results, order_t insertOrder, order_t eraseOrder) {
+
+    // Collect in increasing order each number of keys that any column reports.
+    std::vector<size_t> keys;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i].insertOrder != insertOrder || results[i].eraseOrder != eraseOrder) {
+            continue;
+        }
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (results[i].label == columns[c].second.first) {
+                keys.push_back(results[i].keys);
+                break;
+            }
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    for (size_t i = 0; i < comments.size(); ++i) {
+        out << "# " << comments[i] << std::endl;
+    }
+    out << "N";
+    for (size_t c = 0; c < columns.size(); ++c) {
+        out << "\t" << columns[c].first;
+    }
+    out << std::endl;
+    for (size_t k = 0; k < keys.size(); ++k) {
+        out << keys[k];
+        for (size_t c = 0; c < columns.size(); ++c) {
+            Result const* r = findResult(results, columns[c].second.first, keys[k], insertOrder, eraseOrder);
+            out << "\t" << ((r != nullptr) ? formatMetric(*r, columns[c].second.second) : "-");
+        }
+        out << std::endl;
+    }
+}
+
+/*
+ * Determine whether any of the results contains latency histograms.
+ *
+ * Calling parameter:
+ *
+ * results - the measurements
+ *
+ * return true if any result contains latency histograms
+ */
+bool hasLatency(std::vector<Result> const& results) {
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (!results[i].insertLatency.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Merge the latency histograms of every iteration of one phase.
+ *
+ * Calling parameter:
+ *
+ * latency - the per-iteration histograms
+ *
+ * return the merged histogram
+ */
+latencyHistogram mergeLatency(std::vector<latencyHistogram> const& latency) {
+    latencyHistogram merged;
+    for (size_t it = 0; it < latency.size(); ++it) {
+        merged.merge(latency[it]);
+    }
+    return merged;
+}
+
+/*
+ * Write the sampled latency percentiles of one phase as a text table
+ * with one column per tree and one row per number of keys and percentile.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * title - the title of the table
+ * labels - the trees in column order
+ * results - the measurements
+ * insertOrder - the insertion order
+ * eraseOrder - the erasure order
+ * phase - the member of Result that holds the latency histograms of the phase
+ */
+void writeLatency(std::ostream& out,
+                  std::string const& title,
+                  std::vector<std::string> const& labels,
+                  std::vector<Result> const& results,
+                  order_t const insertOrder,
+                  order_t const eraseOrder,
+                  std::vector<latencyHistogram> Result::* phase) {
+
+    std::vector<size_t> keys;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i].insertOrder == insertOrder && results[i].eraseOrder == eraseOrder
+            && std::find(keys.begin(), keys.end(), results[i].keys) == keys.end()) {
+            keys.push_back(results[i].keys);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    out << "# " << title << std::endl << "N\tpct";
+    for (size_t l = 0; l < labels.size(); ++l) {
+        out << "\t" << labels[l];
+    }
+    out << std::endl;
+    for (size_t k = 0; k < keys.size(); ++k) {
+        std::vector<latencyHistogram> merged(labels.size());
+        for (size_t l = 0; l < labels.size(); ++l) {
+            Result const* r = findResult(results, labels[l], keys[k], insertOrder, eraseOrder);
+            if (r != nullptr) {
+                merged[l] = mergeLatency(r->*phase);
+            }
+        }
+        for (size_t p = 0; p < percentileCount; ++p) {
+            out << keys[k] << "\t" << percentileNames[p];
+            for (size_t l = 0; l < labels.size(); ++l) {
+                Result const* r = findResult(results, labels[l], keys[k], insertOrder, eraseOrder);
+                if (r == nullptr || merged[l].count() == 0) {
+                    out << "\t-";
+                } else {
+                    out << "\t" << static_cast<uint64_t>(merged[l].percentile(percentiles[p]) * r->nanosPerTick + 0.5);
+                }
+            }
+            out << std::endl;
+        }
+    }
+}
+
+/*
+ * Determine whether any of the results contains hardware counters.
+ *
+ * Calling parameter:
+ *
+ * results - the measurements
+ *
+ * return true if any result contains hardware counters
+ */
+bool hasPerf(std::vector<Result> const& results) {
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (!results[i].insertPerf.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Find the count of a hardware event in the counters of one iteration.
+ *
+ * Calling parameters:
+ *
+ * counters - the counters of one iteration
+ * event - the name of the event
+ * count - the count of the event (MODIFIED)
+ *
+ * return true if the event was counted
+ */
+bool findCount(counters_t const& counters, std::string const& event, size_t& count) {
+    for (size_t c = 0; c < counters.size(); ++c) {
+        if (counters[c].first == event) {
+            count = counters[c].second;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Write the hardware counters of one phase as a text table with one column
+ * per tree and one row per number of keys and event. Each entry is the mean
+ * over the iterations of the count divided by the number of operations.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * title - the title of the table
+ * labels - the trees in column order
+ * results - the measurements
+ * insertOrder - the insertion order
+ * eraseOrder - the erasure order
+ * phase - the member of Result that holds the hardware counters of the phase
+ */
+void writePerf(std::ostream& out,
+               std::string const& title,
+               std::vector<std::string> const& labels,
+               std::vector<Result> const& results,
+               order_t const insertOrder,
+               order_t const eraseOrder,
+               std::vector<counters_t> Result::* phase) {
+
+    std::vector<size_t> keys;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i].insertOrder == insertOrder && results[i].eraseOrder == eraseOrder
+            && std::find(keys.begin(), keys.end(), results[i].keys) == keys.end()) {
+            keys.push_back(results[i].keys);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    out << "# " << title << std::endl << "N\tevent";
+    for (size_t l = 0; l < labels.size(); ++l) {
+        out << "\t" << labels[l];
+    }
+    out << std::endl;
+    for (size_t k = 0; k < keys.size(); ++k) {
+        for (int e = 0; e < perfCounters::EVENT_COUNT; ++e) {
+            std::string const event = perfCounters::name(static_cast<perfCounters::event_t>(e));
+            out << keys[k] << "\t" << event;
+            for (size_t l = 0; l < labels.size(); ++l) {
+                Result const* r = findResult(results, labels[l], keys[k], insertOrder, eraseOrder);
+                double sum = 0.;
+                size_t n = 0, count;
+                if (r != nullptr) {
+                    for (size_t it = 0; it < (r->*phase).size(); ++it) {
+                        if (findCount((r->*phase)[it], event, count)) {
+                            sum += static_cast<double>(count);
+                            ++n;
+                        }
+                    }
+                }
+                if (n == 0) {
+                    out << "\t-";
+                } else {
+                    out << "\t" << std::setprecision(4) << sum / (static_cast<double>(n) * r->keys);
+                }
+            }
+            out << std::endl;
+        }
+    }
+}
+
+/* The components of a memory footprint, and their names in the output. */
+size_t memoryFootprint::* const memoryComponents[] = {
+    &memoryFootprint::live, &memoryFootprint::freed, &memoryFootprint::reserved,
+    &memoryFootprint::payload, &memoryFootprint::overhead
+};
+char const* const memoryNames[] = { "live", "freed", "reserved", "payload", "overhead" };
+size_t const memoryCount = sizeof(memoryNames) / sizeof(memoryNames[0]);
+
+/*
+ * Determine whether any of the results contains memory footprints.
+ *
+ * Calling parameter:
+ *
+ * results - the measurements
+ *
+ * return true if any result contains memory footprints
+ */
+bool hasMemory(std::vector<Result> const& results) {
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (!results[i].fullMemory.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Write the memory footprints as a text table with one column per tree and
+ * one row per number of keys and component. Each entry is the mean over the
+ * iterations of the bytes of the component divided by the number of keys,
+ * measured when every key has been inserted. The retained row reports the
+ * total bytes per key that remain following erasure of every key, which
+ * include the freed list.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * labels - the trees in column order
+ * results - the measurements
+ * insertOrder - the insertion order
+ * eraseOrder - the erasure order
+ */
+void writeMemory(std::ostream& out,
+                 std::vector<std::string> const& labels,
+                 std::vector<Result> const& results,
+                 order_t const insertOrder,
+                 order_t const eraseOrder) {
+
+    std::vector<size_t> keys;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i].insertOrder == insertOrder && results[i].eraseOrder == eraseOrder
+            && std::find(keys.begin(), keys.end(), results[i].keys) == keys.end()) {
+            keys.push_back(results[i].keys);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    out << "# memory (bytes per key)" << std::endl << "N\tcomponent";
+    for (size_t l = 0; l < labels.size(); ++l) {
+        out << "\t" << labels[l];
+    }
+    out << std::endl;
+    for (size_t k = 0; k < keys.size(); ++k) {
+        for (size_t c = 0; c <= memoryCount + 1; ++c) {
+            out << keys[k] << "\t" << ((c < memoryCount) ? memoryNames[c] : (c == memoryCount) ? "total" : "retained");
+            for (size_t l = 0; l < labels.size(); ++l) {
+                Result const* r = findResult(results, labels[l], keys[k], insertOrder, eraseOrder);
+                if (r == nullptr || r->fullMemory.empty()) {
+                    out << "\t-";
+                    continue;
+                }
+                double sum = 0.;
+                for (size_t it = 0; it < r->fullMemory.size(); ++it) {
+                    if (c < memoryCount) {
+                        sum += static_cast<double>(r->fullMemory[it].*memoryComponents[c]);
+                    } else if (c == memoryCount) {
+                        sum += static_cast<double>(r->fullMemory[it].total());
+                    } else {
+                        sum += static_cast<double>(r->emptyMemory[it].total());
+                    }
+                }
+                out << "\t" << std::setprecision(4) << sum / (static_cast<double>(r->fullMemory.size()) * r->keys);
+            }
+            out << std::endl;
+        }
+    }
+}
+
+/*
+ * Determine whether any of the results contains the statistics of treeStats.h.
+ *
+ * Calling parameter:
+ *
+ * results - the measurements
+ *
+ * return true if any result contains statistics
+ */
+bool hasStats(std::vector<Result> const& results) {
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (!results[i].stats.searchLength.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Write the comparisons per operation and the mean search length and
+ * propagation distances as a text table with one column per tree and one
+ * row per number of keys and measure, and likewise the rotations, color
+ * flips and double-black propagation steps per insertion or deletion.
+ * Then write the histogram of each length or distance as a table whose
+ * entries are the percentage of the operations of a tree that have that
+ * length or distance.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * labels - the trees in column order
+ * results - the measurements
+ * insertOrder - the insertion order
+ * eraseOrder - the erasure order
+ */
+void writeStats(std::ostream& out,
+                std::vector<std::string> const& labels,
+                std::vector<Result> const& results,
+                order_t const insertOrder,
+                order_t const eraseOrder) {
+
+    std::vector<size_t> keys;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i].insertOrder == insertOrder && results[i].eraseOrder == eraseOrder
+            && std::find(keys.begin(), keys.end(), results[i].keys) == keys.end()) {
+            keys.push_back(results[i].keys);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    std::string const io = orderNames[insertOrder];
+    std::string const eo = orderNames[eraseOrder];
+    std::pair<std::vector<size_t> treeStats::*, std::string> const histograms[] = {
+        std::make_pair(&treeStats::searchLength, std::string("search path length")),
+        std::make_pair(&treeStats::insertPropagation, io + " insert propagation distance"),
+        std::make_pair(&treeStats::erasePropagation, eo + " delete propagation distance")
+    };
+    char const* const measures[] = { "comparisons", "search", "insert", "delete" };
+    size_t const histogramCount = sizeof(histograms) / sizeof(histograms[0]);
+    std::pair<size_t treeStats::*, char const*> const writes[] = {
+        std::make_pair(&treeStats::rotations, "rotations"),
+        std::make_pair(&treeStats::colorFlips, "flips"),
+        std::make_pair(&treeStats::doubleBlackSteps, "doubleblack")
+    };
+
+    out << "# comparisons per operation and mean lengths and distances" << std::endl << "N\tmeasure";
+    for (size_t l = 0; l < labels.size(); ++l) {
+        out << "\t" << labels[l];
+    }
+    out << std::endl;
+    for (size_t k = 0; k < keys.size(); ++k) {
+        for (size_t h = 0; h <= histogramCount; ++h) {
+            out << keys[k] << "\t" << measures[h];
+            for (size_t l = 0; l < labels.size(); ++l) {
+                Result const* r = findResult(results, labels[l], keys[k], insertOrder, eraseOrder);
+                if (r == nullptr || r->stats.searchLength.empty()) {
+                    out << "\t-";
+                } else if (h == 0) {
+                    double const operations = 3. * r->keys * r->insertTime.size();
+                    out << "\t" << std::setprecision(4) << r->stats.comparisons / operations;
+                } else {
+                    out << "\t" << std::setprecision(4) << treeStats::mean(r->stats.*histograms[h - 1].first);
+                }
+            }
+            out << std::endl;
+        }
+    }
+    out << std::endl;
+
+    out << "# rebalancing per insertion or deletion" << std::endl << "N\tmeasure";
+    for (size_t l = 0; l < labels.size(); ++l) {
+        out << "\t" << labels[l];
+    }
+    out << std::endl;
+    for (size_t k = 0; k < keys.size(); ++k) {
+        for (size_t w = 0; w < sizeof(writes) / sizeof(writes[0]); ++w) {
+            out << keys[k] << "\t" << writes[w].second;
+            for (size_t l = 0; l < labels.size(); ++l) {
+                Result const* r = findResult(results, labels[l], keys[k], insertOrder, eraseOrder);
+                if (r == nullptr || r->stats.searchLength.empty()) {
+                    out << "\t-";
+                } else {
+                    double const operations = 2. * r->keys * r->insertTime.size();
+                    out << "\t" << std::setprecision(4) << r->stats.*writes[w].first / operations;
+                }
+            }
+            out << std::endl;
+        }
+    }
+    out << std::endl;
+
+    for (size_t h = 0; h < histogramCount; ++h) {
+        out << "# " << histograms[h].second << " (percent)" << std::endl << "N\tlength";
+        for (size_t l = 0; l < labels.size(); ++l) {
+            out << "\t" << labels[l];
+        }
+        out << std::endl;
+        for (size_t k = 0; k < keys.size(); ++k) {
+            size_t longest = 0;
+            for (size_t l = 0; l < labels.size(); ++l) {
+                Result const* r = findResult(results, labels[l], keys[k], insertOrder, eraseOrder);
+                if (r != nullptr) {
+                    longest = std::max(longest, (r->stats.*histograms[h].first).size());
+                }
+            }
+            for (size_t i = 0; i < longest; ++i) {
+                out << keys[k] << "\t" << i;
+                for (size_t l = 0; l < labels.size(); ++l) {
+                    Result const* r = findResult(results, labels[l], keys[k], insertOrder, eraseOrder);
+                    if (r == nullptr || r->stats.searchLength.empty()) {
+                        out << "\t-";
+                    } else {
+                        std::vector<size_t> const& histogram = r->stats.*histograms[h].first;
+                        size_t const n = treeStats::total(histogram);
+                        double const percent = (i < histogram.size() && n != 0) ? 100. * histogram[i] / n : 0.;
+                        out << "\t" << std::setprecision(4) << percent;
+                    }
+                }
+                out << std::endl;
+            }
+        }
+        out << std::endl;
+    }
+}
+
+/*
+ * Write the results as text tables, one set of tables per pair of orders,
+ * with one column per tree and one row per number of keys.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * results - the measurements
+ */
+void writeText(std::ostream& out, std::vector<Result> const& results) {
+
+    std::vector< std::pair<order_t, order_t> > orders;
+    for (size_t i = 0; i < results.size(); ++i) {
+        std::pair<order_t, order_t> const o(results[i].insertOrder, results[i].eraseOrder);
+        if (std::find(orders.begin(), orders.end(), o) == orders.end()) {
+            orders.push_back(o);
+        }
+    }
+    for (size_t o = 0; o < orders.size(); ++o) {
+        std::vector<std::string> labels;
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (results[i].insertOrder == orders[o].first && results[i].eraseOrder == orders[o].second
+                && std::find(labels.begin(), labels.end(), results[i].label) == labels.end()) {
+                labels.push_back(results[i].label);
+            }
+        }
+        std::string const io = orderNames[orders[o].first];
+        std::string const eo = orderNames[orders[o].second];
+        std::pair<metric_t, std::string> const tables[] = {
+            std::make_pair(NODE_SIZE, std::string("node size (bytes)")),
+            std::make_pair(INSERT_ROTATIONS, io + " insert rotations"),
+            std::make_pair(ERASE_ROTATIONS, eo + " delete rotations"),
+            std::make_pair(INSERT_TIME, io + " insert time (seconds)"),
+            std::make_pair(SEARCH_TIME, std::string("search time (seconds)")),
+            std::make_pair(ERASE_TIME, eo + " delete time (seconds)")
+        };
+        for (size_t t = 0; t < sizeof(tables) / sizeof(tables[0]); ++t) {
+            std::vector< std::pair<std::string, std::pair<std::string, metric_t> > > columns;
+            for (size_t l = 0; l < labels.size(); ++l) {
+                columns.push_back(std::make_pair(labels[l], std::make_pair(labels[l], tables[t].first)));
+            }
+            writeTable(out, std::vector<std::string>(1, tables[t].second), columns,
+                       results, orders[o].first, orders[o].second);
+            out << std::endl;
+        }
+        if (hasLatency(results)) {
+            std::pair<std::vector<latencyHistogram> Result::*, std::string> const phases[] = {
+                std::make_pair(&Result::insertLatency, io + " insert latency (nanoseconds)"),
+                std::make_pair(&Result::searchLatency, std::string("search latency (nanoseconds)")),
+                std::make_pair(&Result::eraseLatency, eo + " delete latency (nanoseconds)")
+            };
+            for (size_t p = 0; p < sizeof(phases) / sizeof(phases[0]); ++p) {
+                writeLatency(out, phases[p].second, labels, results,
+                             orders[o].first, orders[o].second, phases[p].first);
+                out << std::endl;
+            }
+        }
+        if (hasPerf(results)) {
+            std::pair<std::vector<counters_t> Result::*, std::string> const phases[] = {
+                std::make_pair(&Result::insertPerf, io + " insert hardware counters per key"),
+                std::make_pair(&Result::searchPerf, std::string("search hardware counters per key")),
+                std::make_pair(&Result::erasePerf, eo + " delete hardware counters per key")
+            };
+            for (size_t p = 0; p < sizeof(phases) / sizeof(phases[0]); ++p) {
+                writePerf(out, phases[p].second, labels, results,
+                          orders[o].first, orders[o].second, phases[p].first);
+                out << std::endl;
+            }
+        }
+        if (hasMemory(results)) {
+            writeMemory(out, labels, results, orders[o].first, orders[o].second);
+            out << std::endl;
+        }
+        if (hasStats(results)) {
+            writeStats(out, labels, results, orders[o].first, orders[o].second);
+        }
+    }
+}
+
+/*
+ * Write the rotation counters of one phase as name=value pairs
+ * separated by semicolons, with each name prefixed by the phase.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * phase - the phase, either insert or delete
+ * counters - the counters
+ * first - true if no pair has been written yet (MODIFIED)
+ */
+void writeCounters(std::ostream& out, char const* phase, counters_t const& counters, bool& first) {
+    for (size_t c = 0; c < counters.size(); ++c) {
+        out << (first ? "" : ";") << phase << "." << counters[c].first << "=" << counters[c].second;
+        first = false;
+    }
+}
+
+/*
+ * Write the results as CSV with one row per tree, number of keys,
+ * pair of orders and iteration.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * results - the measurements
+ */
+void writeCsv(std::ostream& out, std::vector<Result> const& results) {
+    char const* const phases[] = { "insert", "search", "delete" };
+    bool const latency = hasLatency(results);
+    bool const perf = hasPerf(results);
+    bool const memory = hasMemory(results);
+    out << "tree,keys,insert_order,erase_order,iteration,node_size,insert_time,search_time,"
+        << "delete_time,insert_rotations,delete_rotations,counters";
+    if (latency) {
+        for (size_t p = 0; p < 3; ++p) {
+            out << "," << phases[p] << "_samples";
+            for (size_t q = 0; q < percentileCount; ++q) {
+                out << "," << phases[p] << "_" << percentileNames[q] << "_ns";
+            }
+        }
+    }
+    if (perf) {
+        for (size_t p = 0; p < 3; ++p) {
+            for (int e = 0; e < perfCounters::EVENT_COUNT; ++e) {
+                out << "," << phases[p] << "_" << perfCounters::name(static_cast<perfCounters::event_t>(e));
+            }
+        }
+    }
+    if (memory) {
+        for (size_t c = 0; c < memoryCount; ++c) {
+            out << ",memory_" << memoryNames[c];
+        }
+        out << ",memory_retained";
+    }
+    out << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        Result const& r = results[i];
+        for (size_t it = 0; it < r.insertTime.size(); ++it) {
+            out << r.label << "," << r.keys << "," << orderNames[r.insertOrder] << ","
+                << orderNames[r.eraseOrder] << "," << it << "," << r.nodeSize << ","
+                << std::setprecision(9) << r.insertTime[it] << "," << r.searchTime[it] << ","
+                << r.eraseTime[it] << "," << r.insertRotations[it] << "," << r.eraseRotations[it] << ",";
+            bool first = true;
+            writeCounters(out, "insert", r.insertCounters[it], first);
+            writeCounters(out, "delete", r.eraseCounters[it], first);
+            if (latency) {
+                std::vector<latencyHistogram> const* const hists[] =
+                    { &r.insertLatency, &r.searchLatency, &r.eraseLatency };
+                for (size_t p = 0; p < 3; ++p) {
+                    bool const valid = (it < hists[p]->size());
+                    out << ",";
+                    if (valid) {
+                        out << (*hists[p])[it].count();
+                    }
+                    for (size_t q = 0; q < percentileCount; ++q) {
+                        out << ",";
+                        if (valid && (*hists[p])[it].count() != 0) {
+                            out << static_cast<uint64_t>((*hists[p])[it].percentile(percentiles[q])
+                                                         * r.nanosPerTick + 0.5);
+                        }
+                    }
+                }
+            }
+            if (perf) {
+                std::vector<counters_t> const* const counters[] =
+                    { &r.insertPerf, &r.searchPerf, &r.erasePerf };
+                for (size_t p = 0; p < 3; ++p) {
+                    for (int e = 0; e < perfCounters::EVENT_COUNT; ++e) {
+                        size_t count;
+                        out << ",";
+                        if (it < counters[p]->size()
+                            && findCount((*counters[p])[it],
+                                         perfCounters::name(static_cast<perfCounters::event_t>(e)), count)) {
+                            out << count;
+                        }
+                    }
+                }
+            }
+            if (memory) {
+                bool const valid = (it < r.fullMemory.size());
+                for (size_t c = 0; c < memoryCount; ++c) {
+                    out << ",";
+                    if (valid) {
+                        out << r.fullMemory[it].*memoryComponents[c];
+                    }
+                }
+                out << ",";
+                if (valid) {
+                    out << r.emptyMemory[it].total();
+                }
+            }
+            out << std::endl;
+        }
+    }
+}
+
+/*
+ * Write the results as a JSON array with one object per tree, number of
+ * keys and pair of orders, each of which contains an array of iterations.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * results - the measurements
+ */
+void writeJson(std::ostream& out, std::vector<Result> const& results) {
+    out << "[" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        Result const& r = results[i];
+        out << "  {\"tree\": \"" << r.label << "\", \"keys\": " << r.keys
+            << ", \"insert_order\": \"" << orderNames[r.insertOrder]
+            << "\", \"erase_order\": \"" << orderNames[r.eraseOrder]
+            << "\", \"node_size\": " << r.nodeSize << ", \"iterations\": [" << std::endl;
+        for (size_t it = 0; it < r.insertTime.size(); ++it) {
+            out << "    {\"insert_time\": " << std::setprecision(9) << r.insertTime[it]
+                << ", \"search_time\": " << r.searchTime[it]
+                << ", \"delete_time\": " << r.eraseTime[it]
+                << ", \"insert_rotations\": " << r.insertRotations[it]
+                << ", \"delete_rotations\": " << r.eraseRotations[it] << ", \"counters\": {";
+            char const* const phases[] = { "insert", "delete" };
+            counters_t const* const counters[] = { &r.insertCounters[it], &r.eraseCounters[it] };
+            bool first = true;
+            for (size_t p = 0; p < 2; ++p) {
+                for (size_t c = 0; c < counters[p]->size(); ++c) {
+                    out << (first ? "" : ", ") << "\"" << phases[p] << "." << (*counters[p])[c].first
+                        << "\": " << (*counters[p])[c].second;
+                    first = false;
+                }
+            }
+            out << "}";
+            if (it < r.insertLatency.size()) {
+                char const* const names[] = { "insert", "search", "delete" };
+                latencyHistogram const* const hists[] =
+                    { &r.insertLatency[it], &r.searchLatency[it], &r.eraseLatency[it] };
+                out << ", \"latency_ns\": {";
+                for (size_t p = 0; p < 3; ++p) {
+                    out << ((p == 0) ? "" : ", ") << "\"" << names[p] << "\": {\"samples\": " << hists[p]->count();
+                    if (hists[p]->count() != 0) {
+                        for (size_t q = 0; q < percentileCount; ++q) {
+                            out << ", \"" << percentileNames[q] << "\": "
+                                << static_cast<uint64_t>(hists[p]->percentile(percentiles[q]) * r.nanosPerTick + 0.5);
+                        }
+                    }
+                    out << "}";
+                }
+                out << "}";
+            }
+            if (it < r.insertPerf.size()) {
+                char const* const names[] = { "insert", "search", "delete" };
+                counters_t const* const counters[] = { &r.insertPerf[it], &r.searchPerf[it], &r.erasePerf[it] };
+                out << ", \"perf\": {";
+                for (size_t p = 0; p < 3; ++p) {
+                    out << ((p == 0) ? "" : ", ") << "\"" << names[p] << "\": {";
+                    for (size_t c = 0; c < counters[p]->size(); ++c) {
+                        out << ((c == 0) ? "" : ", ") << "\"" << (*counters[p])[c].first
+                            << "\": " << (*counters[p])[c].second;
+                    }
+                    out << "}";
+                }
+                out << "}";
+            }
+            if (it < r.fullMemory.size()) {
+                out << ", \"memory\": {";
+                for (size_t c = 0; c < memoryCount; ++c) {
+                    out << ((c == 0) ? "" : ", ") << "\"" << memoryNames[c] << "\": "
+                        << r.fullMemory[it].*memoryComponents[c];
+                }
+                out << ", \"retained\": " << r.emptyMemory[it].total() << "}";
+            }
+            out << "}" << ((it + 1 < r.insertTime.size()) ? "," : "") << std::endl;
+        }
+        out << "  ]}" << ((i + 1 < results.size()) ? "," : "") << std::endl;
+    }
+    out << "]" << std::endl;
+}
+
+/*
+ * Convert the name of an order to an order.
+ *
+ * Calling parameter:
+ *
+ * name - the name of the order
+ *
+ * return the order
+ */
+order_t parseOrder(std::string const& name) {
+    for (int o = RANDOM; o <= REVORDER; ++o) {
+        if (name == orderNames[o]) {
+            return static_cast<order_t>(o);
+        }
+    }
+    std::ostringstream buffer;
+    buffer << std::endl << "order = " << name << "  is not random, inorder or revorder" << std::endl;
+    throw std::runtime_error(buffer.str());
+}
+
+/*
+ * Read results from a CSV file written by writeCsv and append them,
+ * grouping consecutive rows of the same tree, number of keys and
+ * pair of orders into one result.
+ *
+ * Calling parameters:
+ *
+ * path - the path to the CSV file
+ * results - the measurements (MODIFIED)
+ */
+void readCsv(std::string const& path, std::vector<Result>& results) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::ostringstream buffer;
+        buffer << std::endl << "cannot open CSV file " << path << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+    std::string line;
+    std::getline(in, line);  // Skip the header.
+    size_t const first = results.size();
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        std::vector<std::string> f;
+        std::istringstream fields(line);
+        std::string field;
+        while (std::getline(fields, field, ',')) {
+            f.push_back(field);
+        }
+        if (f.size() < 11) {
+            std::ostringstream buffer;
+            buffer << std::endl << "malformed line in " << path << ": " << line << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        Result r;
+        r.nanosPerTick = 0.;
+        r.label = f[0];
+        r.keys = strtoull(f[1].c_str(), nullptr, 10);
+        r.insertOrder = parseOrder(f[2]);
+        r.eraseOrder = parseOrder(f[3]);
+        r.nodeSize = strtoull(f[5].c_str(), nullptr, 10);
+        if (results.size() == first || results.back().label != r.label || results.back().keys != r.keys
+            || results.back().insertOrder != r.insertOrder || results.back().eraseOrder != r.eraseOrder) {
+            results.push_back(r);
+        }
+        Result& b = results.back();
+        b.insertTime.push_back(atof(f[6].c_str()));
+        b.searchTime.push_back(atof(f[7].c_str()));
+        b.eraseTime.push_back(atof(f[8].c_str()));
+        b.insertRotations.push_back(strtoull(f[9].c_str(), nullptr, 10));
+        b.eraseRotations.push_back(strtoull(f[10].c_str(), nullptr, 10));
+        counters_t ic, ec;
+        if (f.size() > 11) {
+            std::istringstream pairs(f[11]);
+            std::string pair;
+            while (std::getline(pairs, pair, ';')) {
+                size_t const dot = pair.find('.');
+                size_t const eq = pair.find('=');
+                if (dot == std::string::npos || eq == std::string::npos) {
+                    continue;
+                }
+                counters_t& c = (pair.compare(0, dot, "insert") == 0) ? ic : ec;
+                c.push_back(std::make_pair(pair.substr(dot + 1, eq - dot - 1),
+                                           static_cast<size_t>(strtoull(pair.c_str() + eq + 1, nullptr, 10))));
+            }
+        }
+        b.insertCounters.push_back(ic);
+        b.eraseCounters.push_back(ec);
+    }
+}
+
+/*
+ * Write the results of a workload as text tables with one column per tree.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * w - the workload
+ * results - the measurements
+ */
+void writeWorkloadText(std::ostream& out, Workload const& w, std::vector<WorkloadResult> const& results) {
+
+    if (w.trace.empty()) {
+        out << "# workload " << w.mix << ", " << w.distribution << " distribution: " << w.records
+            << " records, " << w.requests << " requests, " << w.operations << " operations" << std::endl;
+    } else {
+        out << "# replay of " << w.trace << ": " << w.operations << " operations, of which decoding alone requires "
+            << formatTime(w.decodeTime) << " seconds" << std::endl;
+    }
+    out << "tree\tload time\trun time\tMops/s\thits\tsize" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        WorkloadResult const& r = results[i];
+        double const load = calcMeanStd(r.loadTime).first, run = calcMeanStd(r.runTime).first;
+        out << r.label << "\t" << (w.trace.empty() ? formatTime(load) : std::string("-")) << "\t"
+            << formatTime(run) << "\t" << std::setprecision(4)
+            << ((run > 0.) ? static_cast<double>(w.operations) / run / 1.e6 : 0.)
+            << "\t" << r.hits[0] << "\t" << r.finalSize << std::endl;
+    }
+    out << std::endl;
+
+    // Report the latency of each opcode that was sampled.
+    for (int op = 0; op < OP_COUNT; ++op) {
+        std::vector<latencyHistogram> merged(results.size());
+        uint64_t samples = 0;
+        for (size_t i = 0; i < results.size(); ++i) {
+            merged[i] = mergeLatency(results[i].latency[op]);
+            samples += merged[i].count();
+        }
+        if (samples == 0) {
+            continue;
+        }
+        out << "# " << opcodeNames[op] << " latency (nanoseconds)" << std::endl << "pct";
+        for (size_t i = 0; i < results.size(); ++i) {
+            out << "\t" << results[i].label;
+        }
+        out << std::endl;
+        for (size_t p = 0; p < percentileCount; ++p) {
+            out << percentileNames[p];
+            for (size_t i = 0; i < results.size(); ++i) {
+                if (merged[i].count() == 0) {
+                    out << "\t-";
+                } else {
+                    out << "\t" << static_cast<uint64_t>(merged[i].percentile(percentiles[p])
+                                                          * results[i].nanosPerTick + 0.5);
+                }
+            }
+            out << std::endl;
+        }
+        out << std::endl;
+    }
+
+    // Report the hardware counters per operation.
+    bool perf = false;
+    for (size_t i = 0; i < results.size(); ++i) {
+        perf |= !results[i].perf.empty();
+    }
+    if (perf) {
+        out << "# hardware counters per operation" << std::endl << "event";
+        for (size_t i = 0; i < results.size(); ++i) {
+            out << "\t" << results[i].label;
+        }
+        out << std::endl;
+        for (int e = 0; e < perfCounters::EVENT_COUNT; ++e) {
+            std::string const event = perfCounters::name(static_cast<perfCounters::event_t>(e));
+            out << event;
+            for (size_t i = 0; i < results.size(); ++i) {
+                double sum = 0.;
+                size_t n = 0, count;
+                for (size_t it = 0; it < results[i].perf.size(); ++it) {
+                    if (findCount(results[i].perf[it], event, count)) {
+                        sum += static_cast<double>(count);
+                        ++n;
+                    }
+                }
+                if (n == 0 || w.run.empty()) {
+                    out << "\t-";
+                } else {
+                    out << "\t" << std::setprecision(4) << sum / (static_cast<double>(n) * w.operations);
+                }
+            }
+            out << std::endl;
+        }
+        out << std::endl;
+    }
+}
+
+/*
+ * Write the results of a workload as CSV with one row per tree and iteration.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * w - the workload
+ * results - the measurements
+ */
+void writeWorkloadCsv(std::ostream& out, Workload const& w, std::vector<WorkloadResult> const& results) {
+    bool latency = false, perf = false;
+    for (size_t i = 0; i < results.size(); ++i) {
+        latency |= !results[i].latency[OP_CONTAINS].empty();
+        perf |= !results[i].perf.empty();
+    }
+    out << "tree,workload,distribution,records,requests,operations,iteration,load_time,run_time,hits";
+    if (latency) {
+        for (int op = 0; op < OP_COUNT; ++op) {
+            out << "," << opcodeNames[op] << "_samples";
+            for (size_t q = 0; q < percentileCount; ++q) {
+                out << "," << opcodeNames[op] << "_" << percentileNames[q] << "_ns";
+            }
+        }
+    }
+    if (perf) {
+        for (int e = 0; e < perfCounters::EVENT_COUNT; ++e) {
+            out << "," << perfCounters::name(static_cast<perfCounters::event_t>(e));
+        }
+    }
+    out << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        WorkloadResult const& r = results[i];
+        for (size_t it = 0; it < r.runTime.size(); ++it) {
+            out << r.label << "," << w.mix << "," << w.distribution << "," << w.records << ","
+                << w.requests << "," << w.operations << "," << it << "," << std::setprecision(9)
+                << r.loadTime[it] << "," << r.runTime[it] << "," << r.hits[it];
+            if (latency) {
+                for (int op = 0; op < OP_COUNT; ++op) {
+                    bool const valid = (it < r.latency[op].size());
+                    out << ",";
+                    if (valid) {
+                        out << r.latency[op][it].count();
+                    }
+                    for (size_t q = 0; q < percentileCount; ++q) {
+                        out << ",";
+                        if (valid && r.latency[op][it].count() != 0) {
+                            out << static_cast<uint64_t>(r.latency[op][it].percentile(percentiles[q])
+                                                         * r.nanosPerTick + 0.5);
+                        }
+                    }
+                }
+            }
+            if (perf) {
+                for (int e = 0; e < perfCounters::EVENT_COUNT; ++e) {
+                    size_t count;
+                    out << ",";
+                    if (it < r.perf.size()
+                        && findCount(r.perf[it], perfCounters::name(static_cast<perfCounters::event_t>(e)), count)) {
+                        out << count;
+                    }
+                }
+            }
+            out << std::endl;
+        }
+    }
+}
+
+/*
+ * Write the results of a workload as a JSON object that contains an
+ * array of trees, each of which contains an array of iterations.
+ *
+ * Calling parameters:
+ *
+ * out - the output stream
+ * w - the workload
+ * results - the measurements
+ */
+void writeWorkloadJson(std::ostream& out, Workload const& w, std::vector<WorkloadResult> const& results) {
+    out << "{\"workload\": \"" << w.mix << "\", \"distribution\": \"" << w.distribution
+        << "\", \"records\": " << w.records << ", \"requests\": " << w.requests
+        << ", \"operations\": " << w.operations;
+    if (!w.trace.empty()) {
+        out << ", \"trace\": \"" << w.trace << "\", \"decode_time\": " << std::setprecision(9) << w.decodeTime;
+    }
+    out << ", \"trees\": [" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        WorkloadResult const& r = results[i];
+        out << "  {\"tree\": \"" << r.label << "\", \"iterations\": [" << std::endl;
+        for (size_t it = 0; it < r.runTime.size(); ++it) {
+            out << "    {\"load_time\": " << std::setprecision(9) << r.loadTime[it]
+                << ", \"run_time\": " << r.runTime[it] << ", \"hits\": " << r.hits[it];
+            if (it < r.latency[OP_CONTAINS].size()) {
+                out << ", \"latency_ns\": {";
+                for (int op = 0; op < OP_COUNT; ++op) {
+                    latencyHistogram const& h = r.latency[op][it];
+                    out << ((op == 0) ? "" : ", ") << "\"" << opcodeNames[op] << "\": {\"samples\": " << h.count();
+                    if (h.count() != 0) {
+                        for (size_t q = 0; q < percentileCount; ++q) {
+                            out << ", \"" << percentileNames[q] << "\": "
+                                << static_cast<uint64_t>(h.percentile(percentiles[q]) * r.nanosPerTick + 0.5);
+                        }
+                    }
+                    out << "}";
+                }
+                out << "}";
+            }
+            if (it < r.perf.size()) {
+                out << ", \"perf\": {";
+                for (size_t c = 0; c < r.perf[it].size(); ++c) {
+                    out << ((c == 0) ? "" : ", ") << "\"" << r.perf[it][c].first << "\": " << r.perf[it][c].second;
+                }
+                out << "}";
+            }
+            out << "}" << ((it + 1 < r.runTime.size()) ? "," : "") << std::endl;
+        }
+        out << "  ]}" << ((i + 1 < results.size()) ? "," : "") << std::endl;
+    }
+    out << "]}" << std::endl;
+}
+
+/*
+ * Write Figure2.txt through Figure8.txt in the format of Figures_data.
+ * The AP and BP columns require results from a compilation with
+ * -D ENABLE_PREFERRED_TEST, for example, merged from its CSV output.
+ *
+ * Calling parameters:
+ *
+ * dir - the directory in which to write the files
+ * host - a description of the hardware for the header of each file
+ * results - the measurements
+ */
+void writeFigures(std::string const& dir, std::string const& host, std::vector<Result> const& results) {
+
+    typedef std::pair<std::string, std::pair<std::string, metric_t> > column_t;
+    struct Figure {
+        char const* file;
+        std::string title;
+        order_t order;
+        std::vector<std::string> legend;
+        std::vector<column_t> columns;
+    };
+    std::string const AV = "AV = AVL", AVC = "AV = AVL customary", AP = "AP = AVL alternative";
+    std::string const BU = "BU = bottom-up red-black", BUC = "BU = bottom-up red-black customary";
+    std::string const BP = "BP = bottom-up red-black preferred", BA = "BP = bottom-up red-black alternative";
+    std::string const TD = "TD = top-down red-black", LL = "LL = left-leaning red-black", SS = "SS = std::set";
+    auto col = [](std::string const& h, std::string const& l, metric_t m) {
+        return column_t(h, std::make_pair(l, m));
+    };
+
+    std::vector<Figure> figures = {
+        { "Figure2.txt", "Number of nodes vs. " + host + " random insert rotations data", RANDOM,
+          { AV, BU, TD, LL },
+          { col("AV", "AV", INSERT_ROTATIONS), col("BU", "BU", INSERT_ROTATIONS),
+            col("TD", "TD", INSERT_ROTATIONS), col("LL", "LL", INSERT_ROTATIONS) } },
+        { "Figure3.txt", host + " random delete rotations vs number of nodes", RANDOM,
+          { AVC, AP, BUC, BA, TD, LL },
+          { col("AV", "AV", ERASE_ROTATIONS), col("AP", "AP", ERASE_ROTATIONS),
+            col("BU", "BU", ERASE_ROTATIONS), col("BP", "BP", ERASE_ROTATIONS),
+            col("TD", "TD", ERASE_ROTATIONS), col("LL", "LL", ERASE_ROTATIONS) } },
+        { "Figure4.txt", host + " random insert time vs number of nodes", RANDOM,
+          { AV, BU, TD, LL, SS },
+          { col("AV", "AV", INSERT_TIME), col("BU", "BU", INSERT_TIME), col("TD", "TD", INSERT_TIME),
+            col("LL", "LL", INSERT_TIME), col("SS", "SS", INSERT_TIME) } },
+        { "Figure5.txt", host + " random delete time vs number of nodes", RANDOM,
+          { AVC, AP, BUC, BP, TD, LL, SS },
+          { col("AV", "AV", ERASE_TIME), col("AP", "AP", ERASE_TIME), col("BU", "BU", ERASE_TIME),
+            col("BP", "BP", ERASE_TIME), col("TD", "TD", ERASE_TIME), col("LL", "LL", ERASE_TIME),
+            col("SS", "SS", ERASE_TIME) } },
+        { "Figure6.txt", "Number of nodes vs. " + host + " in order insert time data", INORDER,
+          { AV, BU, TD, LL, SS },
+          { col("AV", "AV", INSERT_TIME), col("BU", "BU", INSERT_TIME), col("TD", "TD", INSERT_TIME),
+            col("LL", "LL", INSERT_TIME), col("SS", "SS", INSERT_TIME) } },
+        { "Figure7.txt", host + " in-order delete time vs number of nodes", INORDER,
+          { AVC, AP, BUC, BP, TD, LL, SS },
+          { col("AV", "AV", ERASE_TIME), col("AP", "AP", ERASE_TIME), col("BU", "BU", ERASE_TIME),
+            col("BP", "BP", ERASE_TIME), col("TD", "TD", ERASE_TIME), col("LL", "LL", ERASE_TIME),
+            col("SS", "SS", ERASE_TIME) } },
+        { "Figure8.txt", "Number of nodes vs. " + host + " in order insert and delete time data", INORDER,
+          { "AVI = AVL insert", "BUI = bottom-up red-black insert", "TDI = top-down red-black insert",
+            "LLI = left-leaning red-black insert", "SSI = std::set insert", "AVD = AVL customary delete",
+            "APD = AVL alternative delete", "BUD = bottom-up red-black customary delete",
+            "BPD = bottom-up red-black preferred delete", "TDD = top-down red-black",
+            "LLD = left-leaning red-black", "SSD = std::set" },
+          { col("AVI", "AV", INSERT_TIME), col("BUI", "BU", INSERT_TIME), col("TDI", "TD", INSERT_TIME),
+            col("LLI", "LL", INSERT_TIME), col("SSI", "SS", INSERT_TIME), col("AVD", "AV", ERASE_TIME),
+            col("APD", "AP", ERASE_TIME), col("BUD", "BU", ERASE_TIME), col("BPD", "BP", ERASE_TIME),
+            col("TDD", "TD", ERASE_TIME), col("LLD", "LL", ERASE_TIME), col("SSD", "SS", ERASE_TIME) } }
+    };
+
+    for (size_t f = 0; f < figures.size(); ++f) {
+        std::string const path = dir + "/" + figures[f].file;
+        std::ofstream out(path.c_str());
+        if (!out) {
+            std::ostringstream buffer;
+            buffer << std::endl << "cannot create figure file " << path << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        std::vector<std::string> comments(1, figures[f].title);
+        comments.push_back("N = number of nodes");
+        comments.insert(comments.end(), figures[f].legend.begin(), figures[f].legend.end());
+        writeTable(out, comments, figures[f].columns, results, figures[f].order, figures[f].order);
+    }
+}
+
+int main(int argc, char **argv) {
+
+    using std::cout;
+    using std::endl;
+    using std::ostringstream;
+    using std::runtime_error;
+    using std::string;
+    using std::vector;
+
+    Options opt;
+    opt.keys = 4194304;
+    opt.iterations = 1;
+    opt.seed = std::mt19937_64::default_seed;
+    opt.insertOrder = RANDOM;
+    opt.eraseOrder = RANDOM;
+    opt.sampling = 0;
+    opt.timer = nullptr;
+    opt.perf = nullptr;
+    opt.memory = false;
+    string trees = "avl,wavl,burb,td,ll,hy,bplus,stdset";
+    bool treesGiven = false, sweep = false, perf = false;
+    size_t minKeys = 65536, maxKeys = 4194304;
+    format_t format = TEXT;
+    string output, figures, merge, host = "local";
+    string mix, distribution = "zipfian", record, replay;
+    size_t requests = 1000000;
+
+    // Parse the command-line arguments.
+    for (size_t i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "--sweep")) {
+            sweep = true;
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--perf")) {
+            perf = true;
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--memory")) {
+            opt.memory = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            ostringstream buffer;
+            buffer << "\n\nmissing value for command-line argument: " << argv[i] << endl;
+            throw runtime_error(buffer.str());
+        }
+        if (0 == strcmp(argv[i], "-k") || 0 == strcmp(argv[i], "--keys")) {
+            long keys = atol(argv[++i]);
+            if (keys <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nnodes = " << keys << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            opt.keys = keys;
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-i") || 0 == strcmp(argv[i], "--iterations")) {
+            long iterations = atol(argv[++i]);
+            if (iterations <= 0) {
+                ostringstream buffer;
+                buffer << "\n\niterations = " << iterations << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            opt.iterations = iterations;
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-s") || 0 == strcmp(argv[i], "--seed")) {
+            opt.seed = strtoull(argv[++i], nullptr, 10);
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-t") || 0 == strcmp(argv[i], "--tree")) {
+            trees = argv[++i];
+            treesGiven = true;
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--insert")) {
+            opt.insertOrder = parseOrder(argv[++i]);
+            if (opt.insertOrder == REVORDER) {
+                ostringstream buffer;
+                buffer << "\n\ninsertion order = revorder  is not random or inorder" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--erase")) {
+            opt.eraseOrder = parseOrder(argv[++i]);
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--latency")) {
+            long sampling = atol(argv[++i]);
+            if (sampling <= 0 || (sampling & (sampling - 1)) != 0) {
+                ostringstream buffer;
+                buffer << "\n\nlatency sampling = " << sampling << "  is not a positive power of two" << endl;
+                throw runtime_error(buffer.str());
+            }
+            opt.sampling = sampling;
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-w") || 0 == strcmp(argv[i], "--workload")) {
+            mix = argv[++i];
+            workload::parseMix(mix);
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--distribution")) {
+            distribution = argv[++i];
+            workload::parseDistribution(distribution);
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--record")) {
+            record = argv[++i];
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--replay")) {
+            replay = argv[++i];
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--requests")) {
+            requests = strtoull(argv[++i], nullptr, 10);
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--min")) {
+            minKeys = strtoull(argv[++i], nullptr, 10);
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--max")) {
+            maxKeys = strtoull(argv[++i], nullptr, 10);
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-f") || 0 == strcmp(argv[i], "--format")) {
+            string const name = argv[++i];
+            if (name == "text") {
+                format = TEXT;
+            } else if (name == "csv") {
+                format = CSV;
+            } else if (name == "json") {
+                format = JSON;
+            } else {
+                ostringstream buffer;
+                buffer << "\n\nformat = " << name << "  is not text, csv or json" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-o") || 0 == strcmp(argv[i], "--output")) {
+            output = argv[++i];
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--figures")) {
+            figures = argv[++i];
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--merge")) {
+            merge = argv[++i];
+            continue;
+        }
+        if (0 == strcmp(argv[i], "--host")) {
+            host = argv[++i];
+            continue;
+        }
+        {
+            ostringstream buffer;
+            buffer << "\n\nillegal command-line argument: " << argv[i] << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    if (sweep && (minKeys == 0 || minKeys > maxKeys)) {
+        ostringstream buffer;
+        buffer << "\n\nsweep from " << minKeys << " to " << maxKeys << " keys is empty" << endl;
+        throw runtime_error(buffer.str());
+    }
+    bool const workloadMode = !mix.empty() || !replay.empty();
+    if (workloadMode && (sweep || !merge.empty() || !figures.empty() || (!mix.empty() && !replay.empty()))) {
+        ostringstream buffer;
+        buffer << "\n\n--workload and --replay cannot be combined with each other"
+               << " or with --sweep, --merge or --figures" << endl;
+        throw runtime_error(buffer.str());
+    }
+    if (!record.empty() && mix.empty()) {
+        ostringstream buffer;
+        buffer << "\n\n--record requires --workload" << endl;
+        throw runtime_error(buffer.str());
+    }
+
+    // Calibrate the timer once for every tree if latency is sampled.
+    std::unique_ptr<latencyTimer> timer;
+    if (opt.sampling != 0) {
+        timer.reset(new latencyTimer());
+        opt.timer = timer.get();
+    }
+
+    // Open the hardware counters, or continue without them if unavailable.
+    std::unique_ptr<perfCounters> counters;
+    if (perf) {
+        counters.reset(new perfCounters());
+        if (counters->available()) {
+            opt.perf = counters.get();
+        } else {
+            std::cerr << "hardware counters are unavailable (" << counters->error()
+                      << "), so --perf is ignored" << endl;
+        }
+    }
+
+    // Read the merged CSV files. Without --tree, merging runs no trees.
+    vector<Result> results;
+    if (!merge.empty()) {
+        std::istringstream files(merge);
+        string file;
+        while (std::getline(files, file, ',')) {
+            readCsv(file, results);
+        }
+        if (!treesGiven) {
+            trees.clear();
+        }
+    }
+
+    // Run each tree in the order listed, either for the number of keys
+    // and orders given or, for a sweep, for each power-of-two multiple
+    // of the minimum number of keys with random and in-order workloads.
+    vector<string> names;
+    {
+        std::istringstream list(trees);
+        string name;
+        while (std::getline(list, name, ',')) {
+            if (!name.empty()) {
+                names.push_back(name);
+            }
+        }
+    }
+    Workload w;
+    vector<WorkloadResult> workloadResults;
+    if (!mix.empty()) {
+        // Generate the operations once so that every tree receives the same stream.
+        workload generator(workload::parseMix(mix), workload::parseDistribution(distribution),
+                           opt.keys, opt.seed);
+        w.mix = mix;
+        w.distribution = distribution;
+        w.records = opt.keys;
+        w.requests = requests;
+        generator.load(w.load);
+        generator.generate(requests, w.run);
+        w.operations = w.run.size();
+        w.first = generator.first();
+        w.live = generator.size();
+        w.inserts = 0;
+        for (size_t i = 0; i < w.run.size(); ++i) {
+            w.inserts += (w.run[i].op == OP_INSERT);
+            if (w.run[i].key > UINT32_MAX) {
+                ostringstream buffer;
+                buffer << "\n\nworkload key " << w.run[i].key << " exceeds the 32-bit keys of the trees" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+        if (!record.empty()) {
+            traceWriter writer(record);
+            for (size_t i = 0; i < w.load.size(); ++i) {
+                writer.record(static_cast<opcode_t>(w.load[i].op), w.load[i].key);
+            }
+            for (size_t i = 0; i < w.run.size(); ++i) {
+                writer.record(static_cast<opcode_t>(w.run[i].op), w.run[i].key);
+            }
+            writer.close();
+        }
+        for (size_t n = 0; n < names.size(); ++n) {
+            workloadRunner runner = { opt, w, workloadResults };
+            withNamedTree(names[n], runner);
+        }
+    } else if (!replay.empty()) {
+        // Validate the trace and measure the time to decode it without a tree.
+        traceReader trace(replay);
+        w.mix = "replay";
+        w.distribution = "trace";
+        w.records = 0;
+        w.trace = replay;
+        w.operations = 0;
+        operation o;
+        auto startTime = std::chrono::steady_clock::now();
+        while (trace.next(o)) {
+            if (o.op >= OP_COUNT) {
+                ostringstream buffer;
+                buffer << "\n\noperation " << w.operations << " of trace " << replay << " has invalid opcode "
+                       << static_cast<int>(o.op) << " beyond the " << static_cast<int>(OP_COUNT) << " opcodes of the trees" << endl;
+                throw runtime_error(buffer.str());
+            }
+            if (o.key > UINT32_MAX) {
+                ostringstream buffer;
+                buffer << "\n\noperation " << w.operations << " of trace " << replay << " has key "
+                       << o.key << " beyond the 32-bit keys of the trees" << endl;
+                throw runtime_error(buffer.str());
+            }
+            ++w.operations;
+        }
+        auto endTime = std::chrono::steady_clock::now();
+        w.decodeTime = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000000.;
+        if (w.operations != trace.size()) {
+            ostringstream buffer;
+            buffer << "\n\ntrace " << replay << " contains " << w.operations
+                   << " operations but its header specifies " << trace.size() << endl;
+            throw runtime_error(buffer.str());
+        }
+        w.requests = w.operations;
+        for (size_t n = 0; n < names.size(); ++n) {
+            replayRunner runner = { opt, trace, workloadResults };
+            withNamedTree(names[n], runner);
+        }
+    } else if (sweep) {
+        for (size_t keys = minKeys; keys <= maxKeys; keys *= 2) {
+            order_t const orders[] = { RANDOM, INORDER };
+            for (size_t o = 0; o < 2; ++o) {
+                Options sweepOpt = opt;
+                sweepOpt.keys = keys;
+                sweepOpt.insertOrder = sweepOpt.eraseOrder = orders[o];
+                for (size_t n = 0; n < names.size(); ++n) {
+                    runNamedTree(names[n], sweepOpt, results);
+                }
+            }
+        }
+    } else {
+        for (size_t n = 0; n < names.size(); ++n) {
+            runNamedTree(names[n], opt, results);
+        }
+    }
+
+    // Every tree must agree on the outcome of a workload or a trace.
+    for (size_t i = 1; i < workloadResults.size(); ++i) {
+        if (workloadResults[i].hits != workloadResults[0].hits
+            || workloadResults[i].finalSize != workloadResults[0].finalSize) {
+            ostringstream buffer;
+            buffer << "\n\n" << workloadResults[i].label << " and " << workloadResults[0].label
+                   << " disagree on the successful operations or the final size" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Report the measurements.
+    std::ofstream file;
+    if (!output.empty()) {
+        file.open(output.c_str());
+        if (!file) {
+            ostringstream buffer;
+            buffer << "\n\ncannot create output file " << output << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    std::ostream& out = output.empty() ? cout : file;
+    if (workloadMode) {
+        if (format == CSV) {
+            writeWorkloadCsv(out, w, workloadResults);
+        } else if (format == JSON) {
+            writeWorkloadJson(out, w, workloadResults);
+        } else {
+            out << endl << "iterations = " << opt.iterations << "\tseed = " << opt.seed << endl << endl;
+            writeWorkloadText(out, w, workloadResults);
+        }
+    } else if (format == CSV) {
+        writeCsv(out, results);
+    } else if (format == JSON) {
+        writeJson(out, results);
+    } else {
+        out << endl << "iterations = " << opt.iterations << "\tseed = " << opt.seed << endl << endl;
+        writeText(out, results);
+    }
+    if (!figures.empty()) {
+        writeFigures(figures, host, results);
+    }
+
+    return 0;
+}
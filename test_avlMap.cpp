@@ -50,6 +50,7 @@
 #include <exception>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <random>
 #include <sstream>
 #include <string>
@@ -96,6 +97,7 @@ int main(int argc, char **argv) {
     // Obtain statistics for an AVL tree that has a string key.
     avlMap<string, uint32_t> stringRoot;
     size_t stringMapSize;
+    memoryFootprint stringMemory;
     double createStringTime = 0, searchStringTime = 0, deleteStringTime = 0;
      for (size_t it = 0; it < iterations; ++it) {
 
@@ -123,6 +125,22 @@ int main(int argc, char **argv) {
             throw runtime_error(buffer.str());
         }
 
+        // Verify that the memory footprint includes the characters of each
+        // key that is too long to be stored within its std::string object.
+        size_t wordBytes = 0;
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            if (heapBytes(dictionary[i]) != 0) {
+                wordBytes += dictionary[i].size() + 1;
+            }
+        }
+        stringMemory = stringRoot.memoryUsage();
+        if (stringMemory.payload < wordBytes) {
+            ostringstream buffer;
+            buffer << endl << "string tree payload = " << stringMemory.payload
+                   << " is less than the word bytes = " << wordBytes << endl;
+            throw runtime_error(buffer.str());
+        }
+
         // Search the AVL map for each key and value.
         clock_gettime(CLOCK_REALTIME, &startTime);
         for (size_t i = 0; i < dictionary.size(); ++i) {
@@ -169,6 +187,11 @@ int main(int argc, char **argv) {
             buffer << endl << stringRoot.size() << " nodes remain in string tree following erasure" << endl;
             throw runtime_error(buffer.str());
         }
+        if ( stringRoot.memoryUsage().total() != 0 ) {
+            ostringstream buffer;
+            buffer << endl << stringRoot.memoryUsage().total() << " bytes remain in string tree following erasure" << endl;
+            throw runtime_error(buffer.str());
+        }
     }
 
     // Report the string tree statistics.
@@ -176,6 +199,8 @@ int main(int argc, char **argv) {
     cout << "create string time = " << setprecision(4) << (createStringTime/(double)iterations) << " seconds" << endl;
     cout << "search string time = " << setprecision(4) << (searchStringTime/(double)iterations) << " seconds" << endl;
     cout << "delete string time = " << setprecision(4) << (deleteStringTime/(double)iterations) << " seconds" << endl;
+    cout << "string map memory = " << setprecision(4) << ((double)stringMemory.total()/(double)stringMapSize)
+         << " bytes per key (payload = " << ((double)stringMemory.payload/(double)stringMapSize) << ")" << endl;
     cout << "string insert LL = " << (stringRoot.lli/iterations) << "\tLR = " << (stringRoot.lri/iterations)
          << "\tRL = " << (stringRoot.rli/iterations) << "\tRR = " << (stringRoot.rri/iterations)
          << "\ttotal = " << ((stringRoot.lli+stringRoot.lri+stringRoot.rli+stringRoot.rri)/iterations) << endl;
@@ -183,6 +208,157 @@ int main(int argc, char **argv) {
          << "\tRL = " << (stringRoot.rle/iterations) << "\tRR = " << (stringRoot.rre/iterations)
          << "\ttotal = " << ((stringRoot.lle+stringRoot.lre+stringRoot.rle+stringRoot.rre)/iterations) << endl;
 
+    // Verify that try_emplace, insert_or_assign, emplace and the rvalue insert
+    // construct keys and values in place and return a pointer to the value.
+    {
+        avlMap<string, string> m;
+        string key = dictionary[0];
+        std::pair<string*, bool> p = m.try_emplace( std::move(key), 3, 'x' );
+        if ( p.second == false || *p.first != "xxx" || m.find( dictionary[0] ) != p.first ) {
+            ostringstream buffer;
+            buffer << endl << "try_emplace failed to add key " << dictionary[0] << endl;
+            throw runtime_error(buffer.str());
+        }
+        key = dictionary[0];
+        p = m.try_emplace( std::move(key), 5, 'y' );
+        if ( p.second == true || *p.first != "xxx" || key != dictionary[0] ) {
+            ostringstream buffer;
+            buffer << endl << "try_emplace modified present key " << dictionary[0] << endl;
+            throw runtime_error(buffer.str());
+        }
+        p = m.insert_or_assign( dictionary[0], string("zz") );
+        if ( p.second == true || *p.first != "zz" || m.size() != 1 ) {
+            ostringstream buffer;
+            buffer << endl << "insert_or_assign failed to assign key " << dictionary[0] << endl;
+            throw runtime_error(buffer.str());
+        }
+        p = m.emplace( dictionary[1].c_str(), "value" );
+        if ( p.second == false || *p.first != "value" || m.find( dictionary[1] ) != p.first ) {
+            ostringstream buffer;
+            buffer << endl << "emplace failed to add key " << dictionary[1] << endl;
+            throw runtime_error(buffer.str());
+        }
+        p = m.emplace( dictionary[1], "other" );
+        if ( p.second == true || *p.first != "value" || m.size() != 2 ) {
+            ostringstream buffer;
+            buffer << endl << "emplace modified present key " << dictionary[1] << endl;
+            throw runtime_error(buffer.str());
+        }
+        key = dictionary[2];
+        string value = "moved";
+        if ( m.insert( std::move(key), std::move(value) ) == true || *m.find( dictionary[2] ) != "moved" ) {
+            ostringstream buffer;
+            buffer << endl << "rvalue insert failed to add key " << dictionary[2] << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Verify that a map whose value cannot be copied supports insertion
+    // and deletion, which move each key and value rather than copy them.
+    {
+        avlMap<uint32_t, std::unique_ptr<uint32_t>> m;
+        for (size_t i = 0; i < numbers.size(); ++i) {
+            std::unique_ptr<uint32_t> v( new uint32_t( numbers[i] ) );
+            if ( m.try_emplace( numbers[i], std::move(v) ).second == false ) {
+                ostringstream buffer;
+                buffer << endl << "key " << numbers[i] << " is already in unique_ptr map" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+        for (size_t i = 0; i < numbers.size(); i += 2) {
+            m.erase( numbers[i] );
+        }
+        for (size_t i = 1; i < numbers.size(); i += 2) {
+            std::unique_ptr<uint32_t>* v = m.find( numbers[i] );
+            if ( v == nullptr || **v != numbers[i] ) {
+                ostringstream buffer;
+                buffer << endl << "wrong value for key " << numbers[i] << " in unique_ptr map" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+    }
+
+    // Verify that extract and insert move each (key, value) between two maps
+    // without copying, such that the address of each value is unchanged.
+    {
+        avlMap<string, uint32_t> active, expired;
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            active.insert( dictionary[i], i );
+        }
+        vector<uint32_t*> addresses(dictionary.size());
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            addresses[i] = active.find( dictionary[i] );
+        }
+        for (size_t i = 0; i < dictionary.size(); i += 2) {
+            avlMap<string, uint32_t>::node_type n = active.extract( dictionary[i] );
+            if ( n.empty() || n.key() != dictionary[i] || n.mapped() != i || &n.mapped() != addresses[i] ) {
+                ostringstream buffer;
+                buffer << endl << "extract failed for key " << dictionary[i] << endl;
+                throw runtime_error(buffer.str());
+            }
+            std::pair<uint32_t*, bool> p = expired.insert( std::move(n) );
+            if ( p.second == false || p.first != addresses[i] || !n.empty() ) {
+                ostringstream buffer;
+                buffer << endl << "insert of extracted node failed for key " << dictionary[i] << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+        if ( active.extract( dictionary[0] ) || active.size() + expired.size() != dictionary.size() ) {
+            ostringstream buffer;
+            buffer << endl << "extract of absent key " << dictionary[0] << " succeeded" << endl;
+            throw runtime_error(buffer.str());
+        }
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            avlMap<string, uint32_t>& m = ( i % 2 == 0 ) ? expired : active;
+            uint32_t* v = m.find( dictionary[i] );
+            if ( v == nullptr || *v != i || ( i % 2 == 0 && v != addresses[i] ) ) {
+                ostringstream buffer;
+                buffer << endl << "wrong value for key " << dictionary[i] << " following extract" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+        active.insert( dictionary[0], 0 );
+        avlMap<string, uint32_t>::node_type n = expired.extract( dictionary[0] );
+        if ( active.insert( std::move(n) ).second == true || n.empty() || n.key() != dictionary[0] ) {
+            ostringstream buffer;
+            buffer << endl << "insert of extracted node replaced present key " << dictionary[0] << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Verify that a clone of a map is independent of the map, and that
+    // moving and swapping a map transfer its avlNodes without copying.
+    {
+        avlMap<string, uint32_t> m;
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            m.insert( dictionary[i], i );
+        }
+        avlMap<string, uint32_t> copy( m.clone() );
+        for (size_t i = 0; i < dictionary.size(); i += 2) {
+            copy.erase( dictionary[i] );
+        }
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            uint32_t* v = m.find( dictionary[i] );
+            uint32_t* c = copy.find( dictionary[i] );
+            if ( v == nullptr || *v != i || v == c || ( i % 2 == 0 ) != ( c == nullptr )
+                 || ( c != nullptr && *c != i ) ) {
+                ostringstream buffer;
+                buffer << endl << "wrong value for key " << dictionary[i] << " following clone" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+        uint32_t* const address = copy.find( dictionary[1] );
+        avlMap<string, uint32_t> moved( std::move(copy) );
+        moved.swap( m );
+        if ( !copy.empty() || moved.size() != dictionary.size()
+             || m.size() != dictionary.size() / 2 || m.find( dictionary[1] ) != address ) {
+            ostringstream buffer;
+            buffer << endl << "move and swap of map failed" << endl;
+            throw runtime_error(buffer.str());
+        }
+        m = std::move(moved);
+    }
+
     // Obtain statisitics for an AVL map that has an integer key.
     avlMap<uint32_t, uint32_t> integerRoot;
     size_t integerMapSize;
@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * AVL map write-ahead log test program that compares the throughput
+ * of the in-memory avlMap to the throughput of the avlMapWal, and
+ * measures the time to take a checkpoint and to recover the map
+ * from the checkpoint and the log. It also verifies that recovery
+ * truncates a torn log record and a log record whose checksum fails.
+ *
+ * To build the test executable, compile via:
+ *
+ * g++ -std=c++11 -O3 -o test_avlMapWal test_avlMapWal.cpp
+ *
+ * The avlMapWal.h file describes the log and checkpoint.
+ *
+ * Usage:
+ *
+ * test_avlMapWal [-k K] [-i I] [-g G] [-f F]
+ *
+ * where the command-line options are interpreted as follows.
+ *
+ * -k The number of keys to insert into the AVL map
+ *
+ * -i The number of times to iterate the test
+ *
+ * -g The number of operations per group commit
+ *
+ * -f The prefix of the log and checkpoint file names
+ */
+
+#include "avlMapWal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+  * Calculate the mean and standard deviation of the elements of a vector.
+  *
+  * Calling parameter:
+  *
+  * vec - a vector
+  *
+  * return a pair that contains the mean and standard deviation
+  */
+ template <typename T>
+std::pair<double, double> calcMeanStd(std::vector<T> const& vec) {
+  double sum = 0, sum2 = 0;
+  for (size_t i = 0; i < vec.size(); ++i) {
+    double v = static_cast<double>(vec[i]);
+    sum += v;
+    sum2 += v * v;
+  }
+double n = static_cast<double>(vec.size());
+return std::make_pair(sum / n, sqrt((n * sum2) - (sum * sum)) / n);
+}
+
+/*
+ * Return the seconds elapsed since a start time.
+ *
+ * Calling parameter:
+ *
+ * startTime - the start time
+ *
+ * return the elapsed time in seconds
+ */
+double elapsed(std::chrono::steady_clock::time_point const& startTime) {
+    auto endTime = std::chrono::steady_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    return static_cast<double>(duration.count()) / 1000000.;
+}
+
+/*
+ * Return the size of a file.
+ *
+ * Calling parameter:
+ *
+ * path - the file name
+ *
+ * return the size in bytes, or 0 if the file does not exist
+ */
+size_t fileSize(std::string const& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return 0;
+    }
+    return static_cast<size_t>(st.st_size);
+}
+
+int main(int argc, char **argv) {
+
+    using std::cout;
+    using std::endl;
+    using std::ostringstream;
+    using std::runtime_error;
+    using std::setprecision;
+    using std::shuffle;
+    using std::string;
+    using std::vector;
+
+    int iterations = 1;
+    int keys = 4194304;
+    int group = 1024;
+    string path = "avlMapWal";
+
+    // Parse the command-line arguments.
+    for (size_t i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "-k") || 0 == strcmp(argv[i], "--keys")) {
+            keys = atol(argv[++i]);
+            if (keys <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nnodes = " << keys << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-i") || 0 == strcmp(argv[i], "--iterations")) {
+            iterations = atol(argv[++i]);
+            if (iterations <= 0) {
+                ostringstream buffer;
+                buffer << "\n\niterations = " << iterations << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-g") || 0 == strcmp(argv[i], "--group")) {
+            group = atol(argv[++i]);
+            if (group <= 0) {
+                ostringstream buffer;
+                buffer << "\n\ngroup = " << group << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-f") || 0 == strcmp(argv[i], "--file")) {
+            path = argv[++i];
+            continue;
+        }
+        {
+            ostringstream buffer;
+            buffer << "\n\nillegal command-line argument: " << argv[i] << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Create vectors to store the execution times for each iteration.
+    vector<double> memInsertTime(iterations), memDeleteTime(iterations);
+    vector<double> walInsertTime(iterations), walDeleteTime(iterations);
+    vector<double> checkpointTime(iterations), recoverTime(iterations);
+    vector<size_t> syncs(iterations);
+
+    // Create two vectors of unique unsigned integers as large as keys.
+    // Only the first half of the delete vector is erased so that
+    // recovery replays erasures on top of a non-empty checkpoint.
+    vector<uint32_t> insertNumbers(keys);
+    for (size_t i = 0; i < keys; ++i) {
+        insertNumbers[i] = i;
+    }
+    vector<uint32_t> deleteNumbers(insertNumbers);
+    size_t const deletions = keys / 2;
+
+    // Prepare to shuffle the vector of integers.
+    std::mt19937_64 g(std::mt19937_64::default_seed);
+
+    string const walFile = path + ".wal";
+    string const ckptFile = path + ".ckpt";
+
+    for (size_t it = 0; it < iterations; ++it) {
+
+        shuffle(insertNumbers.begin(), insertNumbers.end(), g);
+        shuffle(deleteNumbers.begin(), deleteNumbers.end(), g);
+
+        // Insert into and erase from an in-memory AVL map.
+        {
+            avlMap<uint32_t, uint32_t> map;
+            auto startTime = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < insertNumbers.size(); ++i) {
+                if ( map.insert( insertNumbers[i], ~insertNumbers[i] ) == true ) {
+                    ostringstream buffer;
+                    buffer << endl << "key " << insertNumbers[i] << " is already in map for insert" << endl;
+                    throw runtime_error(buffer.str());
+                }
+            }
+            memInsertTime[it] = elapsed(startTime);
+
+            startTime = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < deletions; ++i) {
+                if ( map.erase( deleteNumbers[i] ) == false ) {
+                    ostringstream buffer;
+                    buffer << endl << "key " << deleteNumbers[i] << " is not in map for erase" << endl;
+                    throw runtime_error(buffer.str());
+                }
+            }
+            memDeleteTime[it] = elapsed(startTime);
+        }
+
+        // Insert into and erase from a logged AVL map, taking a
+        // checkpoint after insertion and committing after erasure.
+        remove(walFile.c_str());
+        remove(ckptFile.c_str());
+        {
+            avlMapWal<uint32_t, uint32_t> map(path, group);
+            auto startTime = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < insertNumbers.size(); ++i) {
+                if ( map.insert( insertNumbers[i], ~insertNumbers[i] ) == true ) {
+                    ostringstream buffer;
+                    buffer << endl << "key " << insertNumbers[i] << " is already in logged map for insert" << endl;
+                    throw runtime_error(buffer.str());
+                }
+            }
+            map.sync();
+            walInsertTime[it] = elapsed(startTime);
+
+            startTime = std::chrono::steady_clock::now();
+            map.checkpoint();
+            checkpointTime[it] = elapsed(startTime);
+
+            startTime = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < deletions; ++i) {
+                if ( map.erase( deleteNumbers[i] ) == false ) {
+                    ostringstream buffer;
+                    buffer << endl << "key " << deleteNumbers[i] << " is not in logged map for erase" << endl;
+                    throw runtime_error(buffer.str());
+                }
+            }
+            map.sync();
+            walDeleteTime[it] = elapsed(startTime);
+            syncs[it] = map.syncs;
+        }
+
+        // Recover the map from the checkpoint and the log.
+        {
+            auto startTime = std::chrono::steady_clock::now();
+            avlMapWal<uint32_t, uint32_t> map(path, group);
+            recoverTime[it] = elapsed(startTime);
+
+            // Verify that the recovered map contains the expected keys and values.
+            if (map.size() != keys - deletions || map.replayed != deletions) {
+                ostringstream buffer;
+                buffer << endl << "recovered map size = " << map.size() << " and replayed operations = "
+                       << map.replayed << " differ from expected size = " << (keys - deletions)
+                       << " and expected replayed operations = " << deletions << endl;
+                throw runtime_error(buffer.str());
+            }
+            for (size_t i = 0; i < deleteNumbers.size(); ++i) {
+                uint32_t const* val = map.find( deleteNumbers[i] );
+                if (i < deletions && val != nullptr) {
+                    ostringstream buffer;
+                    buffer << endl << "erased key " << deleteNumbers[i] << " is in recovered map" << endl;
+                    throw runtime_error(buffer.str());
+                }
+                if (i >= deletions && (val == nullptr || *val != ~deleteNumbers[i])) {
+                    ostringstream buffer;
+                    buffer << endl << "key " << deleteNumbers[i] << " is missing or has the wrong value in recovered map" << endl;
+                    throw runtime_error(buffer.str());
+                }
+            }
+        }
+    }
+
+    // Tear the last record of a group-committed log, recover the map, and
+    // verify that the torn insertion is absent, that the log is truncated
+    // to the last whole record, and that a later insertion survives recovery.
+    remove(walFile.c_str());
+    remove(ckptFile.c_str());
+    uint32_t const torn = 8;
+    {
+        avlMapWal<uint32_t, uint32_t> map(path, torn / 2);
+        for (uint32_t i = 0; i < torn; ++i) {
+            map.insert( i, ~i );
+        }
+    }
+    size_t const record = fileSize(walFile) / torn;
+    if (truncate(walFile.c_str(), torn * record - record / 2) != 0) {
+        throw runtime_error("\n\nunable to truncate " + walFile + "\n");
+    }
+    {
+        avlMapWal<uint32_t, uint32_t> map(path, torn / 2);
+        if (map.size() != torn - 1 || map.replayed != torn - 1 || map.contains( torn - 1 )) {
+            ostringstream buffer;
+            buffer << endl << "recovered map size = " << map.size() << " and replayed operations = "
+                   << map.replayed << " following a torn record differ from expected = " << (torn - 1) << endl;
+            throw runtime_error(buffer.str());
+        }
+        if (fileSize(walFile) != (torn - 1) * record) {
+            ostringstream buffer;
+            buffer << endl << "log size = " << fileSize(walFile) << " following a torn record  != expected size = "
+                   << ((torn - 1) * record) << endl;
+            throw runtime_error(buffer.str());
+        }
+        map.insert( torn, ~torn );
+    }
+    {
+        avlMapWal<uint32_t, uint32_t> map(path, torn / 2);
+        uint32_t const* val = map.find( torn );
+        if (map.size() != torn || val == nullptr || *val != ~torn) {
+            ostringstream buffer;
+            buffer << endl << "key " << torn << " inserted after a torn record is missing from recovered map" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Flip a byte of the payload of the last record, recover the map, and
+    // verify that the checksum rejects the record and that it is truncated.
+    {
+        FILE* f = fopen(walFile.c_str(), "r+b");
+        if (f == nullptr || fseek(f, -1, SEEK_END) != 0) {
+            throw runtime_error("\n\nunable to open " + walFile + "\n");
+        }
+        int const c = fgetc(f);
+        fseek(f, -1, SEEK_END);
+        fputc(c ^ 0xff, f);
+        fclose(f);
+    }
+    {
+        avlMapWal<uint32_t, uint32_t> map(path, torn / 2);
+        if (map.size() != torn - 1 || map.contains( torn ) || fileSize(walFile) != (torn - 1) * record) {
+            ostringstream buffer;
+            buffer << endl << "record with a corrupt checksum was replayed or not truncated: map size = "
+                   << map.size() << "  log size = " << fileSize(walFile) << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    remove(walFile.c_str());
+    remove(ckptFile.c_str());
+
+    // Report statistics including means and standard deviations.
+    cout << endl << "number of keys in map = " << keys << "\tkeys erased = " << deletions
+         << "\tgroup commit = " << group << "\titerations = " << iterations << endl << endl;
+
+    auto timePair = calcMeanStd<double>(memInsertTime);
+    auto walPair = calcMeanStd<double>(walInsertTime);
+    cout << "memory insert time = " << setprecision(4) << timePair.first
+         << "\tstd dev = " << timePair.second << " seconds" << endl;
+    cout << "logged insert time = " << setprecision(4) << walPair.first
+         << "\tstd dev = " << walPair.second << " seconds"
+         << "\tratio = " << (walPair.first / timePair.first) << endl;
+
+    timePair = calcMeanStd<double>(memDeleteTime);
+    walPair = calcMeanStd<double>(walDeleteTime);
+    cout << "memory delete time = " << setprecision(4) << timePair.first
+         << "\tstd dev = " << timePair.second << " seconds" << endl;
+    cout << "logged delete time = " << setprecision(4) << walPair.first
+         << "\tstd dev = " << walPair.second << " seconds"
+         << "\tratio = " << (walPair.first / timePair.first) << endl << endl;
+
+    timePair = calcMeanStd<double>(checkpointTime);
+    cout << "checkpoint time = " << setprecision(4) << timePair.first
+         << "\tstd dev = " << timePair.second << " seconds" << endl;
+
+    timePair = calcMeanStd<double>(recoverTime);
+    cout << "recover time = " << setprecision(4) << timePair.first
+         << "\tstd dev = " << timePair.second << " seconds" << endl;
+
+    timePair = calcMeanStd<size_t>(syncs);
+    cout << "group commits = " << static_cast<size_t>(timePair.first)
+         << "\tstd dev = " << static_cast<size_t>(timePair.second) << endl << endl;
+
+    return 0;
+}
@@ -286,6 +286,65 @@ int main(int argc, char **argv) {
 #endif
     }
 
+    // Limit the freed list to a quarter of the keys and release the excess.
+#ifndef DISABLE_FREED_LIST
+    root.freedPolicy( static_cast<size_t>(keys) / 4, 0. );
+    root.shrinkToFit();
+    if ( root.freedSize() > static_cast<size_t>(keys) / 4 ) {
+        ostringstream buffer;
+        buffer << endl << "freed list size following shrink = " << root.freedSize()
+               << "  > limit = " << static_cast<size_t>(keys) / 4 << endl;
+        throw runtime_error(buffer.str());
+    }
+#endif
+
+    // Preallocate again, which adds a block of nodes to the arena and
+    // leaves in place the freed nodes that remain from the prior block.
+    root.freedPreallocate( keys );
+
+    // Clone the tree, verify that the clone is independent of the tree,
+    // and move and swap the clone, each of which requires O(1) time.
+    for (size_t i = 0; i < insertNumbers.size(); ++i) {
+        root.insert( insertNumbers[i] );
+    }
+    avlTree<uint32_t> copy( root.clone() );
+    copy.checkTree();
+    if ( copy.size() != root.size() ) {
+        ostringstream buffer;
+        buffer << endl << "clone size = " << copy.size()
+               << "  != tree size = " << root.size() << endl;
+        throw runtime_error(buffer.str());
+    }
+    for (size_t i = 0; i < deleteNumbers.size(); i += 2) {
+        if ( copy.erase( deleteNumbers[i] ) == false ) {
+            ostringstream buffer;
+            buffer << endl << "key " << deleteNumbers[i] << " is not in clone for erase" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    copy.checkTree();
+    for (size_t i = 0; i < deleteNumbers.size(); ++i) {
+        if ( root.contains( deleteNumbers[i] ) == false
+             || copy.contains( deleteNumbers[i] ) != (i % 2 != 0) ) {
+            ostringstream buffer;
+            buffer << endl << "key " << deleteNumbers[i] << " is incorrect following erase from clone" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    avlTree<uint32_t> moved( std::move(copy) );
+    moved.swap( root );
+    if ( copy.empty() == false || moved.size() != insertNumbers.size()
+         || root.size() != insertNumbers.size() / 2 ) {
+        ostringstream buffer;
+        buffer << endl << "sizes following move and swap = " << copy.size()
+               << ", " << moved.size() << ", " << root.size() << endl;
+        throw runtime_error(buffer.str());
+    }
+    root.checkTree();
+    moved.checkTree();
+    root = std::move(moved);
+    root.clear();
+
     // Report statistics including means and standard deviations.
     cout << endl << "node size = " << root.nodeSize()
          << " bytes\tnumber of keys in tree = " << treeSize
@@ -303,6 +303,139 @@ int main(int argc, char **argv) {
 #endif
     }
 
+#if !defined(INSERT_DELETE_ONLY) && !defined(OPTIMISTIC_READS)
+    // Move the even keys to a second tree via extract and insert, which
+    // allocate no nodes except to replace a node of the preallocated
+    // vector, and then move them back.
+    {
+        burbTree<int> expired;
+        for (size_t i = 0; i < insertNumbers.size(); ++i) {
+            root.insert( insertNumbers[i] );
+        }
+        size_t const freedCount = root.freedSize();
+        for (size_t i = 0; i < insertNumbers.size(); i += 2) {
+            burbTree<int>::node_type n = root.extract( insertNumbers[i] );
+            if ( n.empty() || n.key() != insertNumbers[i] ) {
+                ostringstream buffer;
+                buffer << endl << "extract failed for key " << insertNumbers[i] << endl;
+                throw runtime_error(buffer.str());
+            }
+            if ( expired.insert( std::move(n) ) == false || !n.empty() ) {
+                ostringstream buffer;
+                buffer << endl << "insert of extracted node failed for key " << insertNumbers[i] << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+        size_t const moved = ( insertNumbers.size() + 1 ) / 2;
+#if !defined(DISABLE_FREED_LIST) && defined(PREALLOCATE)
+        size_t const expectedFreed = freedCount + moved;
+#else
+        size_t const expectedFreed = freedCount;
+#endif
+        if ( expired.size() != moved || root.size() != insertNumbers.size() - moved
+             || root.freedSize() != expectedFreed || expired.freedSize() != 0 ) {
+            ostringstream buffer;
+            buffer << endl << "tree sizes = " << root.size() << " and " << expired.size()
+                   << " or freed list sizes = " << root.freedSize() << " and " << expired.freedSize()
+                   << " following extract are incorrect" << endl;
+            throw runtime_error(buffer.str());
+        }
+        root.checkTree();
+        expired.checkTree();
+        for (size_t i = 0; i < insertNumbers.size(); ++i) {
+            if ( ( i % 2 == 0 ) != expired.contains( insertNumbers[i] )
+                 || ( i % 2 == 0 ) == root.contains( insertNumbers[i] ) ) {
+                ostringstream buffer;
+                buffer << endl << "key " << insertNumbers[i] << " is in the wrong tree following extract" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+        if ( root.extract( insertNumbers[0] ) ) {
+            ostringstream buffer;
+            buffer << endl << "extract of absent key " << insertNumbers[0] << " succeeded" << endl;
+            throw runtime_error(buffer.str());
+        }
+
+        // Return the even keys to the first tree, and verify that
+        // a node whose key is present is retained by its node_type.
+        root.insert( insertNumbers[0] );
+        burbTree<int>::node_type n = expired.extract( insertNumbers[0] );
+        if ( root.insert( std::move(n) ) == true || n.empty() ) {
+            ostringstream buffer;
+            buffer << endl << "insert of extracted node succeeded for present key " << insertNumbers[0] << endl;
+            throw runtime_error(buffer.str());
+        }
+        for (size_t i = 2; i < insertNumbers.size(); i += 2) {
+            root.insert( expired.extract( insertNumbers[i] ) );
+        }
+        if ( !expired.empty() || root.size() != insertNumbers.size() ) {
+            ostringstream buffer;
+            buffer << endl << expired.size() << " nodes remain in tree following extract" << endl;
+            throw runtime_error(buffer.str());
+        }
+        root.checkTree();
+        for (size_t i = 0; i < insertNumbers.size(); ++i) {
+            root.erase( insertNumbers[i] );
+        }
+        expired.clear();
+    }
+#endif
+
+    // Limit the freed list to a quarter of the keys and release the excess.
+#ifndef DISABLE_FREED_LIST
+    root.freedPolicy( static_cast<size_t>(keys) / 4, 0. );
+    root.shrinkToFit();
+    if ( root.freedSize() > static_cast<size_t>(keys) / 4 ) {
+        ostringstream buffer;
+        buffer << endl << "freed list size following shrink = " << root.freedSize()
+               << "  > limit = " << static_cast<size_t>(keys) / 4 << endl;
+        throw runtime_error(buffer.str());
+    }
+#endif
+
+    // Clone the tree, verify that the clone is independent of the tree,
+    // and move and swap the clone, each of which requires O(1) time.
+    for (size_t i = 0; i < insertNumbers.size(); ++i) {
+        root.insert( insertNumbers[i] );
+    }
+    burbTree<int> copy( root.clone() );
+    copy.checkTree();
+    if ( copy.size() != root.size() ) {
+        ostringstream buffer;
+        buffer << endl << "clone size = " << copy.size()
+               << "  != tree size = " << root.size() << endl;
+        throw runtime_error(buffer.str());
+    }
+    for (size_t i = 0; i < deleteNumbers.size(); i += 2) {
+        if ( copy.erase( deleteNumbers[i] ) == false ) {
+            ostringstream buffer;
+            buffer << endl << "key " << deleteNumbers[i] << " is not in clone for erase" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    copy.checkTree();
+    for (size_t i = 0; i < deleteNumbers.size(); ++i) {
+        if ( root.contains( deleteNumbers[i] ) == false
+             || copy.contains( deleteNumbers[i] ) != (i % 2 != 0) ) {
+            ostringstream buffer;
+            buffer << endl << "key " << deleteNumbers[i] << " is incorrect following erase from clone" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    burbTree<int> moved( std::move(copy) );
+    moved.swap( root );
+    if ( copy.empty() == false || moved.size() != insertNumbers.size()
+         || root.size() != insertNumbers.size() / 2 ) {
+        ostringstream buffer;
+        buffer << endl << "sizes following move and swap = " << copy.size()
+               << ", " << moved.size() << ", " << root.size() << endl;
+        throw runtime_error(buffer.str());
+    }
+    root.checkTree();
+    moved.checkTree();
+    root = std::move(moved);
+    root.clear();
+
     // Report statistics including means and standard deviations.
     cout << endl << "node size = " << root.nodeSize()
          << " bytes\tnumber of keys in tree = " << treeSize
@@ -0,0 +1,423 @@
+/*
+ * Modifications Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Bottom-up red-black tree stress test program for OPTIMISTIC_READS,
+ * wherein reader threads call the contains function without a lock
+ * while writer threads insert and erase keys.
+ *
+ * The keys are the integers 0 through 4*K-1. A key that is a multiple
+ * of 4 is inserted before the test and is never erased, so a reader
+ * must always find it. A key that is congruent to 2 modulo 4 is never
+ * inserted, so a reader must never find it. The odd keys are divided
+ * among the writer threads, each of which inserts and erases its keys
+ * at random and so rotates and reuses nodes throughout the tree.
+ *
+ * Before the test, one writer inserts every key that is congruent to 3
+ * modulo 4 and then erases and reinserts those keys at random, while
+ * the readers search for the permanent keys on either side of the key
+ * that is being erased. Erasure of a node that has two children copies
+ * the key of its successor or predecessor, which is such a permanent
+ * key, into the node, so a reader must find that key while it moves.
+ *
+ * To build the test executable, compile via:
+ *
+ * g++ -std=c++11 -O3 -pthread -o test_burbTreeOptimistic test_burbTreeOptimistic.cpp
+ *
+ * The burbTree.h file describes other compilation options.
+ *
+ * Usage:
+ *
+ * test_burbTreeOptimistic [-k K] [-t T] [-w W] [-d D] [-i I]
+ *
+ * where the command-line options are interpreted as follows.
+ *
+ * -k The number of permanent keys in the BURB tree
+ *
+ * -t The number of reader threads
+ *
+ * -w The number of writer threads
+ *
+ * -d The duration of each iteration in seconds
+ *
+ * -i The number of times to iterate the test
+ */
+
+#ifndef OPTIMISTIC_READS
+#define OPTIMISTIC_READS
+#endif
+
+#include "burbTree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+  * Calculate the mean and standard deviation of the elements of a vector.
+  *
+  * Calling parameter:
+  *
+  * vec - a vector
+  * 
+  * return a pair that contains the mean and standard deviation
+  */
+ template <typename T>
+std::pair<double, double> calcMeanStd(std::vector<T> const& vec) {
+  double sum = 0, sum2 = 0;
+  for (size_t i = 0; i < vec.size(); ++i) {
+    double v = static_cast<double>(vec[i]);
+    sum += v;
+    sum2 += v * v;
+  }
+double n = static_cast<double>(vec.size());
+return std::make_pair(sum / n, sqrt((n * sum2) - (sum * sum)) / n);
+}
+
+int main(int argc, char **argv) {
+    
+    using std::cout;
+    using std::endl;
+    using std::ostringstream;
+    using std::runtime_error;
+    using std::setprecision;
+    using std::string;
+    using std::vector;
+
+    int iterations = 1;
+    int keys = 1048576;
+    int readers = 4;
+    int writers = 1;
+    double seconds = 2.;
+
+    // Parse the command-line arguments.
+    for (size_t i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "-k") || 0 == strcmp(argv[i], "--keys")) {
+            keys = atol(argv[++i]);
+            if (keys <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nnodes = " << keys << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-t") || 0 == strcmp(argv[i], "--threads")) {
+            readers = atol(argv[++i]);
+            if (readers <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nreader threads = " << readers << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-w") || 0 == strcmp(argv[i], "--writers")) {
+            writers = atol(argv[++i]);
+            if (writers <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nwriter threads = " << writers << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-d") || 0 == strcmp(argv[i], "--duration")) {
+            seconds = atof(argv[++i]);
+            if (seconds <= 0.) {
+                ostringstream buffer;
+                buffer << "\n\nduration = " << seconds << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-i") || 0 == strcmp(argv[i], "--iterations")) {
+            iterations = atol(argv[++i]);
+            if (iterations <= 0) {
+                ostringstream buffer;
+                buffer << "\n\niterations = " << iterations << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        {
+            ostringstream buffer;
+            buffer << "\n\nillegal command-line argument: " << argv[i] << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Create vectors to store the throughput and retries for each iteration.
+    vector<double> readRate(iterations), writeRate(iterations), retryRate(iterations);
+
+    // Create a BURB tree that has integer keys, initialize
+    // its static nullnode field if STATIC_NULL_NODE is defined,
+    // and preallocate its freed list for the permanent keys
+    // and for the odd keys.
+#ifdef STATIC_NULL_NODE
+    burbTree<uint32_t>::Node nadanode;
+    burbTree<uint32_t>::nullnode = &nadanode;
+#endif
+
+    burbTree<uint32_t> root;
+    root.freedPreallocate( 3 * static_cast<size_t>(keys) );
+
+    // Insert the permanent keys in random order.
+    uint32_t const range = 4 * static_cast<uint32_t>(keys);
+    vector<uint32_t> permanent(keys);
+    for (size_t i = 0; i < keys; ++i) {
+        permanent[i] = 4 * i;
+    }
+    std::mt19937_64 g(std::mt19937_64::default_seed);
+    std::shuffle(permanent.begin(), permanent.end(), g);
+    for (size_t i = 0; i < permanent.size(); ++i) {
+        root.insert( permanent[i] );
+    }
+
+    // Erase nodes whose successor or predecessor is a permanent key while
+    // the readers search for that key. The writer announces each key that
+    // it erases so that the readers search for its neighbors.
+    {
+        vector<uint32_t> adjacent;
+        for (uint32_t key = 3; key < range; key += 4) {
+            adjacent.push_back(key);
+            root.insert(key);
+        }
+        std::atomic<bool> stop(false);
+        std::atomic<uint32_t> target(adjacent[0]);
+        std::atomic<size_t> errors(0);
+        vector<std::thread> threads;
+        for (size_t t = 0; t < readers; ++t) {
+            threads.push_back(std::thread([&]() {
+                size_t wrong = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    uint32_t const key = target.load(std::memory_order_relaxed);
+                    if (!root.contains(key - 3)) {
+                        ++wrong;
+                    }
+                    if (key + 1 < range && !root.contains(key + 1)) {
+                        ++wrong;
+                    }
+                }
+                errors += wrong;
+            }));
+        }
+        threads.push_back(std::thread([&]() {
+            std::mt19937_64 r(std::mt19937_64::default_seed + 7);
+            size_t wrong = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                uint32_t const key = adjacent[r() % adjacent.size()];
+                target.store(key, std::memory_order_relaxed);
+                if (root.erase(key) == false || root.insert(key) == false) {
+                    ++wrong;
+                }
+            }
+            errors += wrong;
+        }));
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (size_t t = 0; t < threads.size(); ++t) {
+            threads[t].join();
+        }
+        if (errors != 0) {
+            ostringstream buffer;
+            buffer << endl << errors << " incorrect results while erasing nodes that have two children" << endl;
+            throw runtime_error(buffer.str());
+        }
+        for (size_t i = 0; i < adjacent.size(); ++i) {
+            root.erase(adjacent[i]);
+        }
+        root.checkTree();
+    }
+
+    // Each writer thread records which of its odd keys are in the tree.
+    vector< vector<bool> > present(writers, vector<bool>(range / (2 * writers) + 1, false));
+
+    for (size_t it = 0; it < iterations; ++it) {
+
+        std::atomic<bool> stop(false);
+        std::atomic<size_t> reads(0), writes(0), errors(0);
+        root.retries = 0;
+
+        // Each reader searches for random keys and verifies the permanent
+        // keys and the absent keys. The result for an odd key is unknown.
+        vector<std::thread> threads;
+        for (size_t t = 0; t < readers; ++t) {
+            threads.push_back(std::thread([&, t]() {
+                std::mt19937_64 r(std::mt19937_64::default_seed + 1 + t + it * readers);
+                size_t count = 0, wrong = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    uint32_t const key = static_cast<uint32_t>(r() % range);
+                    bool const found = root.contains(key);
+                    if ((key & 3) == 0 && !found) {
+                        ++wrong;
+                    } else if ((key & 3) == 2 && found) {
+                        ++wrong;
+                    }
+                    ++count;
+                }
+                reads += count;
+                errors += wrong;
+            }));
+        }
+
+        // Writer w owns the odd keys 2*(w + j*writers) + 1 and toggles them.
+        for (size_t w = 0; w < writers; ++w) {
+            threads.push_back(std::thread([&, w]() {
+                std::mt19937_64 r(std::mt19937_64::default_seed + 1000003 * (w + 1) + it);
+                vector<bool>& mine = present[w];
+                size_t count = 0, wrong = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    size_t const j = r() % mine.size();
+                    uint64_t const key = 2 * (w + j * writers) + 1;
+                    if (key >= range) {
+                        continue;
+                    }
+                    if (mine[j]) {
+                        if (root.erase(static_cast<uint32_t>(key)) == false) {
+                            ++wrong;
+                        }
+                    } else {
+                        if (root.insert(static_cast<uint32_t>(key)) == false) {
+                            ++wrong;
+                        }
+                    }
+                    mine[j] = !mine[j];
+                    ++count;
+                }
+                writes += count;
+                errors += wrong;
+            }));
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (size_t t = 0; t < threads.size(); ++t) {
+            threads[t].join();
+        }
+        auto endTime = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+        double elapsed = static_cast<double>(duration.count()) / 1000000.;
+
+        if (errors != 0) {
+            ostringstream buffer;
+            buffer << endl << errors << " incorrect results in iteration " << it << endl;
+            throw runtime_error(buffer.str());
+        }
+
+        // Verify the tree and the writers' odd keys now that the threads have stopped.
+        root.checkTree();
+        size_t expected = keys;
+        for (size_t w = 0; w < writers; ++w) {
+            for (size_t j = 0; j < present[w].size(); ++j) {
+                uint64_t const key = 2 * (w + j * writers) + 1;
+                if (key < range) {
+                    if (root.contains(static_cast<uint32_t>(key)) != present[w][j]) {
+                        ostringstream buffer;
+                        buffer << endl << "key " << key << " has incorrect presence in tree" << endl;
+                        throw runtime_error(buffer.str());
+                    }
+                    expected += present[w][j];
+                }
+            }
+        }
+        if (root.size() != expected) {
+            ostringstream buffer;
+            buffer << endl << "expected size for tree = " << expected
+                   << " differs from actual size = " << root.size() << endl;
+            throw runtime_error(buffer.str());
+        }
+
+        // Verify a clone of the tree, which is safe now that the threads have stopped.
+        burbTree<uint32_t> copy( root.clone() );
+        copy.checkTree();
+        if (copy.size() != expected) {
+            ostringstream buffer;
+            buffer << endl << "expected size for clone = " << expected
+                   << " differs from actual size = " << copy.size() << endl;
+            throw runtime_error(buffer.str());
+        }
+
+        readRate[it] = static_cast<double>(reads) / elapsed;
+        writeRate[it] = static_cast<double>(writes) / elapsed;
+        retryRate[it] = static_cast<double>(root.retries) / static_cast<double>(reads);
+    }
+
+    // Report statistics including means and standard deviations.
+    cout << endl << "node size = " << root.nodeSize()
+         << " bytes\tpermanent keys = " << keys
+         << "\treaders = " << readers << "\twriters = " << writers
+         << "\titerations = " << iterations << endl << endl;
+
+    auto ratePair = calcMeanStd<double>(readRate);
+    cout << "reads = " << setprecision(4) << ratePair.first
+         << "\tstd dev = " << ratePair.second << " per second" << endl;
+
+    ratePair = calcMeanStd<double>(writeRate);
+    cout << "writes = " << setprecision(4) << ratePair.first
+         << "\tstd dev = " << ratePair.second << " per second" << endl;
+
+    ratePair = calcMeanStd<double>(retryRate);
+    cout << "retries per read = " << setprecision(4) << ratePair.first
+         << "\tstd dev = " << ratePair.second << endl << endl;
+
+    // Erase every key, which under PREALLOCATE is required before clear.
+    for (size_t i = 0; i < permanent.size(); ++i) {
+        root.erase( permanent[i] );
+    }
+    for (size_t w = 0; w < writers; ++w) {
+        for (size_t j = 0; j < present[w].size(); ++j) {
+            if (present[w][j]) {
+                root.erase( static_cast<uint32_t>(2 * (w + j * writers) + 1) );
+            }
+        }
+    }
+    if ( root.empty() == false ) {
+        ostringstream buffer;
+        buffer << endl << root.size() << " nodes remain in tree following erasure" << endl;
+        throw runtime_error(buffer.str());
+    }
+
+    // Clear the BURB tree.
+    root.clear();
+
+    return 0;
+}
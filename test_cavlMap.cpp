@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Concurrent AVL map test program that measures the aggregate read
+ * throughput of 1, 2, 4, ... reader threads while one writer thread
+ * erases and reinserts keys at a fixed rate, and compares that
+ * throughput to an avlMap protected by a mutex.
+ *
+ * To build the test executable, compile via:
+ *
+ * g++ -std=c++11 -O3 -pthread -o test_cavlMap test_cavlMap.cpp
+ *
+ * The cavlMap.h file describes compilation options.
+ *
+ * Usage:
+ *
+ * test_cavlMap [-k K] [-t T] [-d D] [-w W]
+ *
+ * where the command-line options are interpreted as follows.
+ *
+ * -k The number of keys to insert into the map
+ *
+ * -t The maximum number of reader threads
+ *
+ * -d The duration of each measurement in seconds
+ *
+ * -w The number of writes per second
+ */
+
+#include "avlMap.h"
+#include "cavlMap.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/*
+ * Run reader threads and one writer thread for a fixed duration.
+ *
+ * Calling parameters:
+ *
+ * threads - the number of reader threads
+ * seconds - the duration of the measurement
+ * writes - the number of writes per second
+ * read - a function that searches for a key and returns false if the value is wrong
+ * write - a function that erases and reinserts a key
+ *
+ * return the number of reads per second
+ */
+template <typename R, typename W>
+double runReaders(size_t threads, double seconds, size_t writes, uint32_t keys, R read, W write) {
+
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> reads(0);
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < threads; ++t) {
+        readers.push_back(std::thread([&, t]() {
+            std::mt19937_64 g(std::mt19937_64::default_seed + t);
+            size_t n = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (size_t i = 0; i < 256; ++i) {
+                    if (!read(t, static_cast<uint32_t>(g() % keys))) {
+                        errors.fetch_add(1);
+                    }
+                }
+                n += 256;
+            }
+            reads.fetch_add(n);
+        }));
+    }
+    std::thread writer([&]() {
+        std::mt19937_64 g(std::mt19937_64::default_seed);
+        auto const period = std::chrono::nanoseconds(static_cast<int64_t>(1.0e9 / writes));
+        auto next = std::chrono::steady_clock::now();
+        while (!stop.load(std::memory_order_relaxed)) {
+            write(static_cast<uint32_t>(g() % keys));
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    });
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true);
+    for (size_t t = 0; t < threads; ++t) {
+        readers[t].join();
+    }
+    writer.join();
+    auto endTime = std::chrono::steady_clock::now();
+
+    if (errors.load() != 0) {
+        std::ostringstream buffer;
+        buffer << std::endl << errors.load() << " reads returned a wrong value" << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+    return static_cast<double>(reads.load()) / std::chrono::duration<double>(endTime - startTime).count();
+}
+
+int main(int argc, char **argv) {
+
+    using std::cout;
+    using std::endl;
+    using std::ostringstream;
+    using std::runtime_error;
+    using std::setprecision;
+    using std::setw;
+    using std::string;
+    using std::vector;
+
+    int keys = 1048576;
+    int maxThreads = 8;
+    double seconds = 1;
+    int writes = 500;
+
+    // Parse the command-line arguments.
+    for (size_t i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "-k") || 0 == strcmp(argv[i], "--keys")) {
+            keys = atol(argv[++i]);
+            if (keys <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nnodes = " << keys << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-t") || 0 == strcmp(argv[i], "--threads")) {
+            maxThreads = atol(argv[++i]);
+            if (maxThreads <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nthreads = " << maxThreads << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-d") || 0 == strcmp(argv[i], "--duration")) {
+            seconds = atof(argv[++i]);
+            if (seconds <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nduration = " << seconds << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-w") || 0 == strcmp(argv[i], "--writes")) {
+            writes = atol(argv[++i]);
+            if (writes <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nwrites = " << writes << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        {
+            ostringstream buffer;
+            buffer << "\n\nillegal command-line argument: " << argv[i] << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Build both maps, whose value for each key is the complement of the key.
+    cavlMap<uint32_t, uint32_t> concurrentMap;
+    avlMap<uint32_t, uint32_t> lockedMap;
+    std::mutex lock;
+    for (uint32_t i = 0; i < keys; ++i) {
+        concurrentMap.insert(i, ~i);
+        lockedMap.insert(i, ~i);
+    }
+    concurrentMap.checkTree();
+
+    cout << endl << "node size = " << concurrentMap.nodeSize()
+         << " bytes\tnumber of keys in map = " << concurrentMap.size()
+         << "\twrites per second = " << writes
+         << "\tduration = " << seconds << " seconds" << endl << endl;
+    cout << "threads\tcavlMap reads/s\tper thread\tlocked avlMap reads/s\tper thread" << endl;
+
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+
+        // Each reader thread occupies a reader slot of the concurrent map.
+        vector<cavlMap<uint32_t, uint32_t>::Reader*> readers(threads);
+        for (size_t t = 0; t < threads; ++t) {
+            readers[t] = new cavlMap<uint32_t, uint32_t>::Reader(concurrentMap);
+        }
+        double concurrentRate = runReaders(threads, seconds, writes, keys,
+            [&](size_t t, uint32_t k) {
+                uint32_t v;
+                return !readers[t]->find(k, v) || v == ~k;
+            },
+            [&](uint32_t k) {
+                concurrentMap.erase(k);
+                concurrentMap.insert(k, ~k);
+            });
+        for (size_t t = 0; t < threads; ++t) {
+            delete readers[t];
+        }
+
+        double lockedRate = runReaders(threads, seconds, writes, keys,
+            [&](size_t t, uint32_t k) {
+                std::lock_guard<std::mutex> guard(lock);
+                uint32_t const* v = lockedMap.find(k);
+                return v == nullptr || *v == ~k;
+            },
+            [&](uint32_t k) {
+                std::lock_guard<std::mutex> guard(lock);
+                lockedMap.erase(k);
+                lockedMap.insert(k, ~k);
+            });
+
+        cout << threads << "\t" << setprecision(4) << concurrentRate << "\t" << (concurrentRate / threads)
+             << "\t" << lockedRate << "\t" << (lockedRate / threads) << endl;
+    }
+
+    // Verify that the concurrent map is intact after the writes.
+    concurrentMap.reclaim();
+    concurrentMap.checkTree();
+    if (concurrentMap.size() != keys) {
+        ostringstream buffer;
+        buffer << endl << "concurrent map size = " << concurrentMap.size()
+               << " differs from number of keys = " << keys << endl;
+        throw runtime_error(buffer.str());
+    }
+    cout << endl << "copied nodes = " << concurrentMap.copies
+         << "\treclaimed nodes = " << concurrentMap.reclaimed << endl << endl;
+
+    return 0;
+}
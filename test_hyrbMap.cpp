@@ -0,0 +1,378 @@
+/*
+ * Modifications Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Hybrid top-down bottom-up red-black map test program that
+ * measures the same operations as test_avlMap.cpp so that the
+ * hybrid red-black map may be compared to the AVL map.
+ * 
+ * To build the test executable, compile via: g++ -std=c++11 -O3 test_hyrbMap.cpp
+ *
+ * The hyrbMap.h file describes other compilation options.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+#include "hyrbMap.h"
+
+// A basic test
+int main(int argc, char **argv) {
+    
+    using std::cout;
+    using std::endl;
+    using std::ostringstream;
+    using std::runtime_error;
+    using std::setprecision;
+    using std::shuffle;
+    using std::string;
+    using std::vector;
+
+    struct timespec startTime, endTime;
+    size_t iterations = 100;
+
+    // Read the words file into a dictionary. 
+    vector<string> dictionary;
+    char buf[512];
+    FILE *f = fopen("words.txt", "r");
+    while (fgets(buf, sizeof buf, f)) {
+        size_t len = strlen(buf);
+        buf[len-1] = '\0';
+        dictionary.push_back(string(buf));
+    }
+    fclose(f);
+
+    // Create a vector of unique unsigned integers as large as the number of words.
+    vector<uint32_t> numbers;
+    for (size_t i = 0; i < dictionary.size(); ++i) {
+        numbers.push_back(i);
+    }
+
+    // Prepare to shuffle the dictionary.
+    std::mt19937_64 g(std::mt19937_64::default_seed);
+
+    // Initialize the static nullnode field before calling the hyrbMap
+    // constructor if STATIC_NULL_NODE is defined (see test_hyrbTree.cpp).
+#ifdef STATIC_NULL_NODE
+    hyrbMap<string, uint32_t>::Node nadaStringNode;
+    hyrbMap<string, uint32_t>::nullnode = &nadaStringNode;
+    hyrbMap<uint32_t, uint32_t>::Node nadaIntegerNode;
+    hyrbMap<uint32_t, uint32_t>::nullnode = &nadaIntegerNode;
+#endif
+
+    // Obtain statistics for a hybrid red-black map that has a string key.
+    hyrbMap<string, uint32_t> stringRoot;
+    size_t stringMapSize;
+    memoryFootprint stringMemory;
+    double createStringTime = 0, searchStringTime = 0, deleteStringTime = 0;
+    for (size_t it = 0; it < iterations; ++it) {
+
+        // Shuffle the dictionary and add each word to the map.
+        shuffle(dictionary.begin(), dictionary.end(), g);
+        clock_gettime(CLOCK_REALTIME, &startTime);
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            if ( stringRoot.insert( dictionary[i], i ) == true ) {
+                ostringstream buffer;
+                buffer << endl << "key " << dictionary[i] << " is already in string map" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+
+        clock_gettime(CLOCK_REALTIME, &endTime);
+        createStringTime += (endTime.tv_sec - startTime.tv_sec) +
+        1.0e-9 * ((double)(endTime.tv_nsec - startTime.tv_nsec));
+
+        // Verify that the correct number of nodes were added to the map.
+        stringMapSize = stringRoot.size();
+        if (stringMapSize != dictionary.size()) {
+            ostringstream buffer;
+            buffer << endl << "expected size for string map = " << stringMapSize
+                   << " differs from actual size = " << dictionary.size() << endl;
+            throw runtime_error(buffer.str());
+        }
+        stringRoot.checkTree();
+
+        // Verify that the memory footprint includes the characters of each
+        // key that is too long to be stored within its std::string object.
+        size_t wordBytes = 0;
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            if (heapBytes(dictionary[i]) != 0) {
+                wordBytes += dictionary[i].size() + 1;
+            }
+        }
+        stringMemory = stringRoot.memoryUsage();
+        if (stringMemory.payload < wordBytes) {
+            ostringstream buffer;
+            buffer << endl << "string map payload = " << stringMemory.payload
+                   << " is less than the word bytes = " << wordBytes << endl;
+            throw runtime_error(buffer.str());
+        }
+
+        // Search the map for each key and value.
+        clock_gettime(CLOCK_REALTIME, &startTime);
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            if ( stringRoot.contains( dictionary[i] ) == false ) {
+                ostringstream buffer;
+                buffer << endl << "key " << dictionary[i] << " is not in string map for contains" << endl;
+                throw runtime_error(buffer.str());
+            }
+            uint32_t const* val = stringRoot.find( dictionary[i] );
+            if (val == nullptr) {
+                ostringstream buffer;
+                buffer << endl << "key " << dictionary[i] << " is not in string map for find" << endl;
+                throw runtime_error(buffer.str());
+            } else if (*val != i) {
+                ostringstream buffer;
+                buffer << endl << "wrong value = " << (*val) << " for string key "
+                       << dictionary[i] << " expected value = " << i << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+
+        clock_gettime(CLOCK_REALTIME, &endTime);
+        searchStringTime += (endTime.tv_sec - startTime.tv_sec) +
+        1.0e-9 * ((double)(endTime.tv_nsec - startTime.tv_nsec));
+
+        // Update the value of each key and verify that the size is unchanged.
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            if ( stringRoot.insert( dictionary[i], i + 1 ) == false ) {
+                ostringstream buffer;
+                buffer << endl << "key " << dictionary[i] << " is not in string map for update" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+        if (stringRoot.size() != dictionary.size()) {
+            ostringstream buffer;
+            buffer << endl << "size for string map = " << stringRoot.size()
+                   << " following update differs from " << dictionary.size() << endl;
+            throw runtime_error(buffer.str());
+        }
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            uint32_t const* val = stringRoot.find( dictionary[i] );
+            if (val == nullptr || *val != i + 1) {
+                ostringstream buffer;
+                buffer << endl << "wrong value following update for string key " << dictionary[i] << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+
+        // Shuffle the dictionary and delete each word from the map.
+        shuffle(dictionary.begin(), dictionary.end(), g);
+        clock_gettime(CLOCK_REALTIME, &startTime);
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            if ( stringRoot.erase( dictionary[i] ) == false ) {
+                ostringstream buffer;
+                buffer << endl << "string key " << dictionary[i] << " is not in map for erase" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+
+        clock_gettime(CLOCK_REALTIME, &endTime);
+        deleteStringTime += (endTime.tv_sec - startTime.tv_sec) +
+        1.0e-9 * ((double)(endTime.tv_nsec - startTime.tv_nsec));
+
+        // Verify that the map is empty and that each node is on the freed list.
+        if ( stringRoot.empty() == false ) {
+            ostringstream buffer;
+            buffer << endl << stringRoot.size() << " nodes remain in string map following erasure" << endl;
+            throw runtime_error(buffer.str());
+        }
+        if ( stringRoot.memoryUsage().live != 0 ) {
+            ostringstream buffer;
+            buffer << endl << stringRoot.memoryUsage().live << " live bytes remain in string map following erasure" << endl;
+            throw runtime_error(buffer.str());
+        }
+#ifndef DISABLE_FREED_LIST
+        if ( stringRoot.freedSize() != dictionary.size() ) {
+            ostringstream buffer;
+            buffer << endl << "freed list size following erasure = " << stringRoot.freedSize()
+                   << "  !=  number of words = " << dictionary.size() << endl;
+            throw runtime_error(buffer.str());
+        }
+#endif
+    }
+
+    // Report the string map statistics.
+    cout << "number of words in string map = " << stringMapSize << endl;
+    cout << "create string time = " << setprecision(4) << (createStringTime/(double)iterations) << " seconds" << endl;
+    cout << "search string time = " << setprecision(4) << (searchStringTime/(double)iterations) << " seconds" << endl;
+    cout << "delete string time = " << setprecision(4) << (deleteStringTime/(double)iterations) << " seconds" << endl;
+    cout << "string map memory = " << setprecision(4) << ((double)stringMemory.total()/(double)stringMapSize)
+         << " bytes per key (payload = " << ((double)stringMemory.payload/(double)stringMapSize) << ")" << endl;
+    cout << "string insert single = " << (stringRoot.singleRotationCount/iterations)
+         << "\tdouble = " << (stringRoot.doubleRotationCount/iterations) << endl;
+    cout << "string erase  left = " << (stringRoot.rotateL/iterations) << "\tright = " << (stringRoot.rotateR/iterations)
+         << "\ttotal = " << ((stringRoot.rotateL+stringRoot.rotateR)/iterations) << endl;
+
+    // Delete the nodes of the freed list.
+    stringRoot.clear();
+
+    // Obtain statisitics for a hybrid red-black map that has an integer key.
+    hyrbMap<uint32_t, uint32_t> integerRoot;
+    size_t integerMapSize;
+    double createIntegerTime = 0, searchIntegerTime = 0, deleteIntegerTime = 0;
+    for (size_t it = 0; it < iterations; ++it) {
+
+        // Shuffle the integers and add each integer to the map.
+        shuffle(numbers.begin(), numbers.end(), g);
+        clock_gettime(CLOCK_REALTIME, &startTime);
+        for (size_t i = 0; i < numbers.size(); i++) {
+            if ( integerRoot.insert( numbers[i], i ) == true) {
+                ostringstream buffer;
+                buffer << endl << "key " << numbers[i] << " is already in integer map" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+
+        clock_gettime(CLOCK_REALTIME, &endTime);
+        createIntegerTime += (endTime.tv_sec - startTime.tv_sec) +
+        1.0e-9 * ((double)(endTime.tv_nsec - startTime.tv_nsec));
+
+        // Verify that the correct number of nodes were added to the map.
+        integerMapSize = integerRoot.size();
+        if (integerMapSize != numbers.size()) {
+            ostringstream buffer;
+            buffer << endl << "expected size for integer map = " << integerMapSize
+                   << " differs from actual size = " << numbers.size() << endl;
+            throw runtime_error(buffer.str());
+        }
+        integerRoot.checkTree();
+
+        // Search for each integer in the map.
+        clock_gettime(CLOCK_REALTIME, &startTime);
+        for (size_t i = 0; i < numbers.size(); i++) {
+            if ( integerRoot.contains( numbers[i] ) == false ) {
+                ostringstream buffer;
+                buffer << endl << "key " << numbers[i] << " is not in integer map for contains" << endl;
+                throw runtime_error(buffer.str());
+            }
+            uint32_t const* val = integerRoot.find( numbers[i] );
+            if (val == nullptr) {
+                ostringstream buffer;
+                buffer << endl << "key " << numbers[i] << " is not in integer map for find" << endl;
+                throw runtime_error(buffer.str());
+            } else if (*val != i) {
+                ostringstream buffer;
+                buffer << endl << "wrong value = " << (*val) << " for integer key "
+                       << numbers[i] << " expected value = " << i << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+
+        clock_gettime(CLOCK_REALTIME, &endTime);
+        searchIntegerTime += (endTime.tv_sec - startTime.tv_sec) +
+        1.0e-9 * ((double)(endTime.tv_nsec - startTime.tv_nsec));
+
+        // Shuffle the integers and delete each integer from the map.
+        shuffle(numbers.begin(), numbers.end(), g);
+        clock_gettime(CLOCK_REALTIME, &startTime);
+        for (size_t i = 0; i < numbers.size(); i++) {
+            if ( integerRoot.erase( numbers[i] ) == false ) {
+                ostringstream buffer;
+                buffer << endl << "integer key " << numbers[i] << " is not in map for erase" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+
+        clock_gettime(CLOCK_REALTIME, &endTime);
+        deleteIntegerTime += (endTime.tv_sec - startTime.tv_sec) +
+        1.0e-9 * ((double)(endTime.tv_nsec - startTime.tv_nsec));
+
+        // Verify that the map is empty.
+        if ( integerRoot.empty() == false ) {
+            ostringstream buffer;
+            buffer << endl << integerRoot.size() << " nodes remain in integer map following erasure" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Report the integer statistics.
+    cout << "number of words in integer map = " << integerMapSize << endl;
+    cout << "create integer time = " << setprecision(4) << (createIntegerTime/(double)iterations) << " seconds" << endl;
+    cout << "search integer time = " << setprecision(4) << (searchIntegerTime/(double)iterations) << " seconds" << endl;
+    cout << "delete integer time = " << setprecision(4) << (deleteIntegerTime/(double)iterations) << " seconds" << endl;
+    cout << "integer insert single = " << (integerRoot.singleRotationCount/iterations)
+         << "\tdouble = " << (integerRoot.doubleRotationCount/iterations) << endl;
+    cout << "integer erase  left = " << (integerRoot.rotateL/iterations) << "\tright = " << (integerRoot.rotateR/iterations)
+         << "\ttotal = " << ((integerRoot.rotateL+integerRoot.rotateR)/iterations) << endl;
+
+    // Clone the map, verify that the clone is independent of the map,
+    // and move and swap the clone, each of which requires O(1) time.
+    for (size_t i = 0; i < numbers.size(); i++) {
+        integerRoot.insert( numbers[i], i );
+    }
+    hyrbMap<uint32_t, uint32_t> integerCopy( integerRoot.clone() );
+    integerCopy.checkTree();
+    for (size_t i = 0; i < numbers.size(); i += 2) {
+        if ( integerCopy.erase( numbers[i] ) == false ) {
+            ostringstream buffer;
+            buffer << endl << "integer key " << numbers[i] << " is not in clone for erase" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    integerCopy.checkTree();
+    for (size_t i = 0; i < numbers.size(); i++) {
+        uint32_t const* val = integerRoot.find( numbers[i] );
+        uint32_t const* copyVal = integerCopy.find( numbers[i] );
+        if ( val == nullptr || *val != i
+             || (i % 2 == 0 && copyVal != nullptr) || (i % 2 != 0 && (copyVal == nullptr || *copyVal != i)) ) {
+            ostringstream buffer;
+            buffer << endl << "integer key " << numbers[i] << " is incorrect following erase from clone" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    hyrbMap<uint32_t, uint32_t> integerMoved( std::move(integerCopy) );
+    integerMoved.swap( integerRoot );
+    if ( integerCopy.empty() == false || integerMoved.size() != numbers.size()
+         || integerRoot.size() != numbers.size() / 2 ) {
+        ostringstream buffer;
+        buffer << endl << "integer map sizes following move and swap = " << integerCopy.size()
+               << ", " << integerMoved.size() << ", " << integerRoot.size() << endl;
+        throw runtime_error(buffer.str());
+    }
+    integerRoot.checkTree();
+    integerRoot = std::move(integerMoved);
+
+    // Delete the nodes of the freed list.
+    integerRoot.clear();
+
+    return 0;
+}
@@ -282,6 +282,117 @@ int main(int argc, char **argv) {
 #endif
     }
 
+#ifndef INSERT_DELETE_ONLY
+    // Add each key to the LLRB tree and then remove the keys via popMin and
+    // popMax in alternating batches of increasing size, verifying that each
+    // batch contains the smallest or largest remaining keys in order.
+    shuffle(insertNumbers.begin(), insertNumbers.end(), g);
+    for (size_t i = 0; i < insertNumbers.size(); ++i) {
+        root.insert( insertNumbers[i] );
+    }
+    {
+        uint32_t lo = 0, hi = keys; // the remaining keys are in [lo, hi)
+        vector<uint32_t> popped;
+        for (size_t batch = 1, i = 0; !root.empty(); batch += batch / 2 + 1, ++i) {
+            popped.clear();
+            size_t const expected = ( batch < hi - lo ) ? batch : hi - lo;
+            size_t const removed = ( i % 2 == 0 ) ? root.popMin( batch, popped ) : root.popMax( batch, popped );
+            if ( removed != expected || popped.size() != expected ) {
+                ostringstream buffer;
+                buffer << endl << "keys removed = " << removed << "  != expected = " << expected << endl;
+                throw runtime_error(buffer.str());
+            }
+            for (size_t j = 0; j < popped.size(); ++j) {
+                uint32_t const key = ( i % 2 == 0 ) ? lo + j : hi - 1 - j;
+                if ( popped[j] != key ) {
+                    ostringstream buffer;
+                    buffer << endl << "popped key = " << popped[j] << "  != expected key = " << key << endl;
+                    throw runtime_error(buffer.str());
+                }
+            }
+            if ( i % 2 == 0 ) {
+                lo += expected;
+            } else {
+                hi -= expected;
+            }
+            if ( root.size() != hi - lo ) {
+                ostringstream buffer;
+                buffer << endl << "tree size following pop = " << root.size()
+                       << "  != expected size = " << hi - lo << endl;
+                throw runtime_error(buffer.str());
+            }
+            if ( !root.empty() ) {
+                root.checkTree();
+                if ( *root.min() != lo || *root.max() != hi - 1 ) {
+                    ostringstream buffer;
+                    buffer << endl << "minimum = " << *root.min() << " and maximum = " << *root.max()
+                           << " following pop differ from expected " << lo << " and " << hi - 1 << endl;
+                    throw runtime_error(buffer.str());
+                }
+            } else if ( root.min() != nullptr || root.max() != nullptr ) {
+                ostringstream buffer;
+                buffer << endl << "minimum or maximum is not nullptr for an empty tree" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+    }
+#endif
+
+    // Limit the freed list to a quarter of the keys and release the excess.
+#ifndef DISABLE_FREED_LIST
+    root.freedPolicy( static_cast<size_t>(keys) / 4, 0. );
+    root.shrinkToFit();
+    if ( root.freedSize() > static_cast<size_t>(keys) / 4 ) {
+        ostringstream buffer;
+        buffer << endl << "freed list size following shrink = " << root.freedSize()
+               << "  > limit = " << static_cast<size_t>(keys) / 4 << endl;
+        throw runtime_error(buffer.str());
+    }
+#endif
+
+    // Clone the tree, verify that the clone is independent of the tree,
+    // and move and swap the clone, each of which requires O(1) time.
+    for (size_t i = 0; i < insertNumbers.size(); ++i) {
+        root.insert( insertNumbers[i] );
+    }
+    llrbTree<uint32_t> copy( root.clone() );
+    copy.checkTree();
+    if ( copy.size() != root.size() ) {
+        ostringstream buffer;
+        buffer << endl << "clone size = " << copy.size()
+               << "  != tree size = " << root.size() << endl;
+        throw runtime_error(buffer.str());
+    }
+    for (size_t i = 0; i < deleteNumbers.size(); i += 2) {
+        if ( copy.erase( deleteNumbers[i] ) == false ) {
+            ostringstream buffer;
+            buffer << endl << "key " << deleteNumbers[i] << " is not in clone for erase" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    copy.checkTree();
+    for (size_t i = 0; i < deleteNumbers.size(); ++i) {
+        if ( root.contains( deleteNumbers[i] ) == false
+             || copy.contains( deleteNumbers[i] ) != (i % 2 != 0) ) {
+            ostringstream buffer;
+            buffer << endl << "key " << deleteNumbers[i] << " is incorrect following erase from clone" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    llrbTree<uint32_t> moved( std::move(copy) );
+    moved.swap( root );
+    if ( copy.empty() == false || moved.size() != insertNumbers.size()
+         || root.size() != insertNumbers.size() / 2 ) {
+        ostringstream buffer;
+        buffer << endl << "sizes following move and swap = " << copy.size()
+               << ", " << moved.size() << ", " << root.size() << endl;
+        throw runtime_error(buffer.str());
+    }
+    root.checkTree();
+    moved.checkTree();
+    root = std::move(moved);
+    root.clear();
+
     // Report statistics including means and standard deviations.
     cout << endl << "node size = " << root.nodeSize()
          << " bytes\tnumber of keys in tree = " << treeSize
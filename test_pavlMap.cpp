@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Persistent AVL map test program that measures insertion and search
+ * without snapshots and deletion while a snapshot of the full map is
+ * held, and verifies that the snapshot is unaffected by the deletions.
+ *
+ * To build the test executable, compile via:
+ *
+ * g++ -std=c++11 -O3 -o test_pavlMap test_pavlMap.cpp
+ *
+ * The pavlMap.h file describes compilation options.
+ *
+ * Usage:
+ *
+ * test_pavlMap [-k K] [-i I] [-s S]
+ *
+ * where the command-line options are interpreted as follows.
+ *
+ * -k The number of keys to insert into the persistent AVL map
+ *
+ * -i The number of times to iterate the test
+ *
+ * -s The number of deletions between additional snapshots (0 for none)
+ */
+
+#include "pavlMap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+  * Calculate the mean and standard deviation of the elements of a vector.
+  *
+  * Calling parameter:
+  *
+  * vec - a vector
+  *
+  * return a pair that contains the mean and standard deviation
+  */
+ template <typename T>
+std::pair<double, double> calcMeanStd(std::vector<T> const& vec) {
+  double sum = 0, sum2 = 0;
+  for (size_t i = 0; i < vec.size(); ++i) {
+    double v = static_cast<double>(vec[i]);
+    sum += v;
+    sum2 += v * v;
+  }
+double n = static_cast<double>(vec.size());
+return std::make_pair(sum / n, sqrt((n * sum2) - (sum * sum)) / n);
+}
+
+/*
+ * Return the seconds elapsed since a start time.
+ *
+ * Calling parameter:
+ *
+ * startTime - the start time
+ *
+ * return the elapsed time in seconds
+ */
+double elapsed(std::chrono::steady_clock::time_point const& startTime) {
+    auto endTime = std::chrono::steady_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    return static_cast<double>(duration.count()) / 1000000.;
+}
+
+int main(int argc, char **argv) {
+
+    using std::cout;
+    using std::endl;
+    using std::ostringstream;
+    using std::runtime_error;
+    using std::setprecision;
+    using std::shuffle;
+    using std::string;
+    using std::vector;
+
+    int iterations = 1;
+    int keys = 4194304;
+    int interval = 0;
+
+    // Parse the command-line arguments.
+    for (size_t i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "-k") || 0 == strcmp(argv[i], "--keys")) {
+            keys = atol(argv[++i]);
+            if (keys <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nnodes = " << keys << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-i") || 0 == strcmp(argv[i], "--iterations")) {
+            iterations = atol(argv[++i]);
+            if (iterations <= 0) {
+                ostringstream buffer;
+                buffer << "\n\niterations = " << iterations << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-s") || 0 == strcmp(argv[i], "--snapshot")) {
+            interval = atol(argv[++i]);
+            if (interval < 0) {
+                ostringstream buffer;
+                buffer << "\n\nsnapshot interval = " << interval << "  < 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        {
+            ostringstream buffer;
+            buffer << "\n\nillegal command-line argument: " << argv[i] << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Create vectors to store the execution times and copies for each iteration.
+    vector<double> insertTime(iterations), searchTime(iterations), deleteTime(iterations);
+    vector<double> snapshotTime(iterations), releaseTime(iterations);
+    vector<size_t> insertCopies(iterations), deleteCopies(iterations);
+
+    // Create two vectors of unique unsigned integers as large as keys.
+    vector<uint32_t> insertNumbers(keys);
+    for (size_t i = 0; i < keys; ++i) {
+        insertNumbers[i] = i;
+    }
+    vector<uint32_t> deleteNumbers(insertNumbers);
+
+    // Prepare to shuffle the vector of integers.
+    std::mt19937_64 g(std::mt19937_64::default_seed);
+
+    // Build and test the persistent AVL map.
+    pavlMap<uint32_t, uint32_t> root;
+    size_t treeSize;
+    for (size_t it = 0; it < iterations; ++it) {
+
+        // Shuffle the keys and insert each key into the map. No snapshot
+        // shares the map, so each node is modified in place.
+        shuffle(insertNumbers.begin(), insertNumbers.end(), g);
+        root.copies = 0;
+        auto startTime = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < insertNumbers.size(); ++i) {
+            if ( root.insert( insertNumbers[i], ~insertNumbers[i] ) == true) {
+                ostringstream buffer;
+                buffer << endl << "key " << insertNumbers[i] << " is already in map for insert" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+        auto endTime = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+        insertTime[it] = static_cast<double>(duration.count()) / 1000000.;
+        insertCopies[it] = root.copies;
+
+        // Verify that the correct number of keys were added to the map.
+        treeSize = root.size();
+        if (treeSize != insertNumbers.size()) {
+            ostringstream buffer;
+            buffer << endl << "expected size for map = " << treeSize
+                   << " differs from actual size = " << insertNumbers.size() << endl;
+            throw runtime_error(buffer.str());
+        }
+
+        // Check the map.
+        root.checkTree();
+
+        // Search the map for each key.
+        startTime = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < insertNumbers.size(); ++i) {
+            if ( root.contains( insertNumbers[i] ) == false ) {
+                ostringstream buffer;
+                buffer << endl << "key " << insertNumbers[i] << " is not in map for contains" << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+        endTime = std::chrono::steady_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+        searchTime[it] = static_cast<double>(duration.count()) / 1000000.;
+
+        // Take a snapshot of the full map, and then delete each key from
+        // the map while taking an additional snapshot every interval
+        // deletions. Each deletion copies the shared nodes of its path.
+        shuffle(deleteNumbers.begin(), deleteNumbers.end(), g);
+        root.copies = 0;
+        startTime = std::chrono::steady_clock::now();
+        {
+            pavlMap<uint32_t, uint32_t> full = root.snapshot();
+            pavlMap<uint32_t, uint32_t> recent;
+            for (size_t i = 0; i < deleteNumbers.size(); ++i) {
+                if ( root.erase( deleteNumbers[i] ) == false ) {
+                    ostringstream buffer;
+                    buffer << endl << "key " << deleteNumbers[i] << " is not in map for erase" << endl;
+                    throw runtime_error(buffer.str());
+                }
+                if ( interval != 0 && (i + 1) % interval == 0 ) {
+                    recent = root;
+                }
+            }
+            endTime = std::chrono::steady_clock::now();
+            duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+            deleteTime[it] = static_cast<double>(duration.count()) / 1000000.;
+            deleteCopies[it] = root.copies;
+
+            // Verify that the map is empty and that the snapshot is unchanged.
+            if ( root.empty() == false ) {
+                ostringstream buffer;
+                buffer << endl << root.size() << " keys remain in map following erasure" << endl;
+                throw runtime_error(buffer.str());
+            }
+            if ( full.size() != insertNumbers.size() ) {
+                ostringstream buffer;
+                buffer << endl << "snapshot size = " << full.size() << " differs from number of keys = "
+                       << insertNumbers.size() << endl;
+                throw runtime_error(buffer.str());
+            }
+            full.checkTree();
+            startTime = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < insertNumbers.size(); ++i) {
+                uint32_t const* val = full.find( insertNumbers[i] );
+                if ( val == nullptr || *val != ~insertNumbers[i] ) {
+                    ostringstream buffer;
+                    buffer << endl << "key " << insertNumbers[i] << " is missing or has the wrong value in snapshot" << endl;
+                    throw runtime_error(buffer.str());
+                }
+            }
+            endTime = std::chrono::steady_clock::now();
+            duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+            snapshotTime[it] = static_cast<double>(duration.count()) / 1000000.;
+
+            // Release the snapshots upon exit from this scope.
+            startTime = std::chrono::steady_clock::now();
+        }
+        endTime = std::chrono::steady_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+        releaseTime[it] = static_cast<double>(duration.count()) / 1000000.;
+    }
+
+    // Report statistics including means and standard deviations.
+    cout << endl << "node size = " << root.nodeSize()
+         << " bytes\tnumber of keys in map = " << treeSize
+         << "\tsnapshot interval = " << interval
+         << "\titerations = " << iterations << endl << endl;
+
+    auto timePair = calcMeanStd<double>(insertTime);
+    cout << "insert time = " << setprecision(4) << timePair.first
+         << "\tstd dev = " << timePair.second << " seconds" << endl;
+
+    timePair = calcMeanStd<double>(searchTime);
+    cout << "search time = " << setprecision(4) << timePair.first
+         << "\tstd dev = " << timePair.second << " seconds" << endl;
+
+    timePair = calcMeanStd<double>(deleteTime);
+    cout << "delete time = " << setprecision(4) << timePair.first
+         << "\tstd dev = " << timePair.second << " seconds" << endl;
+
+    timePair = calcMeanStd<double>(snapshotTime);
+    cout << "snapshot search time = " << setprecision(4) << timePair.first
+         << "\tstd dev = " << timePair.second << " seconds" << endl;
+
+    timePair = calcMeanStd<double>(releaseTime);
+    cout << "snapshot release time = " << setprecision(4) << timePair.first
+         << "\tstd dev = " << timePair.second << " seconds" << endl << endl;
+
+    timePair = calcMeanStd<size_t>(insertCopies);
+    cout << "insert copies = " << static_cast<size_t>(timePair.first)
+         << "\tstd dev = " << static_cast<size_t>(timePair.second) << endl;
+
+    timePair = calcMeanStd<size_t>(deleteCopies);
+    cout << "delete copies = " << static_cast<size_t>(timePair.first)
+         << "\tstd dev = " << static_cast<size_t>(timePair.second)
+         << "\tper deletion = " << setprecision(4) << (timePair.first / keys) << endl << endl;
+
+    // Clear the map.
+    root.clear();
+
+    return 0;
+}
@@ -0,0 +1,422 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Range-sharded map test program that verifies single-key and batch
+ * operations and rebalancing, and then measures the aggregate throughput
+ * of 1, 2, 4, ... threads that each perform a mix of searches, insertions
+ * and deletions, and compares that throughput to an avlMap protected by
+ * one global mutex.
+ *
+ * To build the test executable, NOTE that C++17 is required and compile via:
+ *
+ * g++ -std=c++17 -O3 -pthread -o test_shardedMap test_shardedMap.cpp
+ *
+ * The shardedMap.h file describes compilation options.
+ *
+ * Usage:
+ *
+ * test_shardedMap [-k K] [-s S] [-t T] [-d D] [-r R]
+ *
+ * where the command-line options are interpreted as follows.
+ *
+ * -k The number of keys to insert into the map
+ *
+ * -s The number of shards
+ *
+ * -t The maximum number of threads
+ *
+ * -d The duration of each measurement in seconds
+ *
+ * -r The percentage of operations that are searches
+ */
+
+#include "avlMap.h"
+#include "shardedMap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/*
+ * Run threads that perform a mix of operations for a fixed duration.
+ *
+ * Calling parameters:
+ *
+ * threads - the number of threads
+ * seconds - the duration of the measurement
+ * keys - the range of keys
+ * readPercent - the percentage of operations that are searches
+ * read - a function that searches for a key and returns false if the value is wrong
+ * write - a function that inserts a key if the boolean is true and otherwise erases it
+ *
+ * return the number of operations per second
+ */
+template <typename R, typename W>
+double runThreads(size_t threads, double seconds, uint32_t keys, uint32_t readPercent, R read, W write) {
+
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> operations(0);
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&, t]() {
+            std::mt19937_64 g(std::mt19937_64::default_seed + t);
+            size_t n = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (size_t i = 0; i < 256; ++i) {
+                    uint64_t const r = g();
+                    uint32_t const k = static_cast<uint32_t>(r % keys);
+                    if ((r >> 32) % 100 < readPercent) {
+                        if (!read(k)) {
+                            errors.fetch_add(1);
+                        }
+                    } else {
+                        write(k, ((r >> 40) & 1) != 0);
+                    }
+                }
+                n += 256;
+            }
+            operations.fetch_add(n);
+        }));
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true);
+    for (size_t t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    auto endTime = std::chrono::steady_clock::now();
+
+    if (errors.load() != 0) {
+        std::ostringstream buffer;
+        buffer << std::endl << errors.load() << " reads returned a wrong value" << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+    return static_cast<double>(operations.load()) / std::chrono::duration<double>(endTime - startTime).count();
+}
+
+int main(int argc, char **argv) {
+
+    using std::cout;
+    using std::endl;
+    using std::ostringstream;
+    using std::runtime_error;
+    using std::setprecision;
+    using std::shuffle;
+    using std::string;
+    using std::vector;
+
+    int keys = 1048576;
+    int shards = 64;
+    int maxThreads = 8;
+    double seconds = 1;
+    int readPercent = 90;
+
+    // Parse the command-line arguments.
+    for (size_t i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "-k") || 0 == strcmp(argv[i], "--keys")) {
+            keys = atol(argv[++i]);
+            if (keys <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nnodes = " << keys << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-s") || 0 == strcmp(argv[i], "--shards")) {
+            shards = atol(argv[++i]);
+            if (shards <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nshards = " << shards << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-t") || 0 == strcmp(argv[i], "--threads")) {
+            maxThreads = atol(argv[++i]);
+            if (maxThreads <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nthreads = " << maxThreads << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-d") || 0 == strcmp(argv[i], "--duration")) {
+            seconds = atof(argv[++i]);
+            if (seconds <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nduration = " << seconds << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-r") || 0 == strcmp(argv[i], "--reads")) {
+            readPercent = atol(argv[++i]);
+            if (readPercent < 0 || readPercent > 100) {
+                ostringstream buffer;
+                buffer << "\n\nread percentage = " << readPercent << "  not in [0, 100]" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        {
+            ostringstream buffer;
+            buffer << "\n\nillegal command-line argument: " << argv[i] << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Create a vector of unique unsigned integers, shuffled, whose value
+    // in each map is the complement of the key.
+    vector<uint32_t> insertNumbers(keys), insertValues(keys);
+    for (size_t i = 0; i < keys; ++i) {
+        insertNumbers[i] = i;
+    }
+    std::mt19937_64 g(std::mt19937_64::default_seed);
+    shuffle(insertNumbers.begin(), insertNumbers.end(), g);
+    for (size_t i = 0; i < keys; ++i) {
+        insertValues[i] = ~insertNumbers[i];
+    }
+
+    // Insert the keys one at a time into a map that has a single initial
+    // shard, which rebalances the map as it grows.
+    shardedMap<uint32_t, uint32_t> singleMap(shards);
+    for (size_t i = 0; i < keys; ++i) {
+        if (singleMap.insert(insertNumbers[i], insertValues[i]) == true) {
+            ostringstream buffer;
+            buffer << endl << "key " << insertNumbers[i] << " is already in map for insert" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Compare single and batch insertion into maps whose boundaries
+    // divide the range of keys equally and hence require no rebalancing.
+    vector<uint32_t> boundaries(shards - 1);
+    for (size_t i = 1; i < shards; ++i) {
+        boundaries[i - 1] = static_cast<uint32_t>((i * static_cast<uint64_t>(keys)) / shards);
+    }
+    shardedMap<uint32_t, uint32_t> rangeMap(boundaries);
+    auto startTime = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys; ++i) {
+        rangeMap.insert(insertNumbers[i], insertValues[i]);
+    }
+    auto endTime = std::chrono::steady_clock::now();
+    double singleTime = std::chrono::duration<double>(endTime - startTime).count();
+
+    shardedMap<uint32_t, uint32_t> batchMap(boundaries);
+    startTime = std::chrono::steady_clock::now();
+    if (batchMap.insert(insertNumbers, insertValues) != keys) {
+        ostringstream buffer;
+        buffer << endl << "batch insert did not insert " << keys << " keys" << endl;
+        throw runtime_error(buffer.str());
+    }
+    endTime = std::chrono::steady_clock::now();
+    double batchTime = std::chrono::duration<double>(endTime - startTime).count();
+
+    // Verify the contents of both maps in sorted order.
+    vector<uint32_t> k, v;
+    for (int m = 0; m < 3; ++m) {
+        shardedMap<uint32_t, uint32_t>& map = (m == 0) ? singleMap : (m == 1) ? rangeMap : batchMap;
+        map.getKeysValues(k, v);
+        if (map.size() != keys || k.size() != keys) {
+            ostringstream buffer;
+            buffer << endl << "map size = " << map.size() << " and walked size = " << k.size()
+                   << " differ from number of keys = " << keys << endl;
+            throw runtime_error(buffer.str());
+        }
+        for (size_t i = 0; i < keys; ++i) {
+            if (k[i] != i || v[i] != ~k[i]) {
+                ostringstream buffer;
+                buffer << endl << "key " << k[i] << " or its value is wrong at index " << i << endl;
+                throw runtime_error(buffer.str());
+            }
+        }
+    }
+
+    // Report the distribution of the keys among the shards.
+    size_t smallest = keys, largest = 0;
+    for (size_t i = 0; i < singleMap.shardCount(); ++i) {
+        smallest = std::min(smallest, singleMap.shardSize(i));
+        largest = std::max(largest, singleMap.shardSize(i));
+    }
+    cout << endl << "number of keys in map = " << keys << "\tshards = " << shards
+         << "\trebalances = " << singleMap.rebalances
+         << "\tsmallest shard = " << smallest << "\tlargest shard = " << largest << endl << endl;
+    cout << "single insert time = " << setprecision(4) << singleTime
+         << "\tbatch insert time = " << batchTime << " seconds" << endl;
+
+    // Search for half of the keys and for as many absent keys as one batch.
+    vector<uint32_t> searchNumbers(keys);
+    for (size_t i = 0; i < keys; ++i) {
+        searchNumbers[i] = static_cast<uint32_t>(i * 2);
+    }
+    vector<bool> found;
+    startTime = std::chrono::steady_clock::now();
+    size_t hits = batchMap.contains(searchNumbers, found);
+    endTime = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys; ++i) {
+        if (found[i] != (searchNumbers[i] < keys)) {
+            ostringstream buffer;
+            buffer << endl << "key " << searchNumbers[i] << " has wrong result for batch contains" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    if (hits != (keys + 1) / 2) {
+        ostringstream buffer;
+        buffer << endl << "batch contains found " << hits << " keys instead of " << (keys + 1) / 2 << endl;
+        throw runtime_error(buffer.str());
+    }
+    cout << "batch search time = " << setprecision(4)
+         << std::chrono::duration<double>(endTime - startTime).count() << " seconds" << endl << endl;
+
+    // Erase the first half of the keys as a batch and the second half singly.
+    vector<uint32_t> firstHalf(insertNumbers.begin(), insertNumbers.begin() + keys / 2);
+    if (batchMap.erase(firstHalf) != firstHalf.size()) {
+        ostringstream buffer;
+        buffer << endl << "batch erase did not erase " << firstHalf.size() << " keys" << endl;
+        throw runtime_error(buffer.str());
+    }
+    for (size_t i = keys / 2; i < keys; ++i) {
+        if (batchMap.erase(insertNumbers[i]) == false) {
+            ostringstream buffer;
+            buffer << endl << "key " << insertNumbers[i] << " is not in map for erase" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    if (batchMap.empty() == false) {
+        ostringstream buffer;
+        buffer << endl << batchMap.size() << " keys remain in map following erasure" << endl;
+        throw runtime_error(buffer.str());
+    }
+
+    // Measure the throughput of the sharded map and a globally locked avlMap.
+    avlMap<uint32_t, uint32_t> lockedMap;
+    std::mutex lock;
+    for (uint32_t i = 0; i < keys; ++i) {
+        lockedMap.insert(i, ~i);
+    }
+    cout << "read percentage = " << readPercent << "\tduration = " << seconds << " seconds" << endl << endl;
+    cout << "threads\tshardedMap ops/s\tper thread\tlocked avlMap ops/s\tper thread" << endl;
+
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+
+        double shardedRate = runThreads(threads, seconds, keys, readPercent,
+            [&](uint32_t k) {
+                uint32_t v;
+                return !singleMap.find(k, v) || v == ~k;
+            },
+            [&](uint32_t k, bool add) {
+                if (add) {
+                    singleMap.insert(k, ~k);
+                } else {
+                    singleMap.erase(k);
+                }
+            });
+
+        double lockedRate = runThreads(threads, seconds, keys, readPercent,
+            [&](uint32_t k) {
+                std::lock_guard<std::mutex> guard(lock);
+                uint32_t const* v = lockedMap.find(k);
+                return v == nullptr || *v == ~k;
+            },
+            [&](uint32_t k, bool add) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (add) {
+                    lockedMap.insert(k, ~k);
+                } else {
+                    lockedMap.erase(k);
+                }
+            });
+
+        cout << threads << "\t" << setprecision(4) << shardedRate << "\t" << (shardedRate / threads)
+             << "\t" << lockedRate << "\t" << (lockedRate / threads) << endl;
+    }
+
+    // Force rebalancing repeatedly while threads search and modify the map,
+    // so that superseded layouts are reclaimed while operations route keys.
+    size_t const before = singleMap.rebalances;
+    {
+        std::atomic<bool> stop(false);
+        std::thread rebalancer([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                singleMap.rebalance();
+            }
+        });
+        runThreads(maxThreads, seconds, keys, readPercent,
+            [&](uint32_t k) {
+                uint32_t v;
+                return !singleMap.find(k, v) || v == ~k;
+            },
+            [&](uint32_t k, bool add) {
+                if (add) {
+                    singleMap.insert(k, ~k);
+                } else {
+                    singleMap.erase(k);
+                }
+            });
+        stop.store(true);
+        rebalancer.join();
+    }
+    cout << endl << "forced rebalances = " << (singleMap.rebalances - before) << endl;
+
+    // Verify that the sharded map is sorted and that its size is consistent.
+    singleMap.getKeysValues(k, v);
+    if (k.size() != singleMap.size()) {
+        ostringstream buffer;
+        buffer << endl << "sharded map size = " << singleMap.size()
+               << " differs from walked size = " << k.size() << endl;
+        throw runtime_error(buffer.str());
+    }
+    for (size_t i = 1; i < k.size(); ++i) {
+        if (!(k[i-1] < k[i]) || v[i] != ~k[i]) {
+            ostringstream buffer;
+            buffer << endl << "key " << k[i] << " is out of order or has a wrong value" << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+    cout << endl << "rebalances = " << singleMap.rebalances << endl << endl;
+
+    return 0;
+}
@@ -0,0 +1,310 @@
+/*
+ * Modifications Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Top-down red-black tree scaling test program for LOCK_COUPLING,
+ * which measures the aggregate insertion and search throughput of
+ * 1, 2, 4, ... threads that insert keys into one tree via lock coupling
+ * and then search for them, and compares the insertion throughput to
+ * that of the same tree whose insert function is protected by a mutex.
+ *
+ * The keys are the integers 0 through K-1 in random order and are
+ * divided equally among the threads. If -r is specified, each thread
+ * instead inserts a contiguous range of the keys in random order, so
+ * that the threads insert into disjoint regions of the tree.
+ *
+ * To build the test executable, compile via:
+ *
+ * g++ -std=c++11 -O3 -pthread -o test_tdrbTreeCoupling test_tdrbTreeCoupling.cpp
+ *
+ * The tdrbTree.h file describes other compilation options.
+ *
+ * Usage:
+ *
+ * test_tdrbTreeCoupling [-k K] [-t T] [-i I] [-r]
+ *
+ * where the command-line options are interpreted as follows.
+ *
+ * -k The number of keys to insert into the TD RB tree
+ *
+ * -t The maximum number of threads
+ *
+ * -i The number of times to iterate the test for each number of threads
+ *
+ * -r Insert a contiguous range of keys per thread
+ */
+
+#ifndef LOCK_COUPLING
+#define LOCK_COUPLING
+#endif
+
+#include "tdrbTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+  * Calculate the mean and standard deviation of the elements of a vector.
+  *
+  * Calling parameter:
+  *
+  * vec - a vector
+  * 
+  * return a pair that contains the mean and standard deviation
+  */
+ template <typename T>
+std::pair<double, double> calcMeanStd(std::vector<T> const& vec) {
+  double sum = 0, sum2 = 0;
+  for (size_t i = 0; i < vec.size(); ++i) {
+    double v = static_cast<double>(vec[i]);
+    sum += v;
+    sum2 += v * v;
+  }
+double n = static_cast<double>(vec.size());
+return std::make_pair(sum / n, sqrt((n * sum2) - (sum * sum)) / n);
+}
+
+/*
+ * Run one thread per slice of the keys and return the elapsed time.
+ *
+ * Calling parameters:
+ *
+ * threads - the number of threads
+ * keys - the keys, divided into one slice per thread
+ * op - a function that performs an operation upon a key and returns false if it fails
+ *
+ * return the elapsed time in seconds
+ */
+template <typename O>
+double runThreads(size_t threads, std::vector<uint32_t> const& keys, O op) {
+
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> workers;
+    auto startTime = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&, t]() {
+            size_t const begin = t * keys.size() / threads;
+            size_t const end = (t + 1) * keys.size() / threads;
+            size_t wrong = 0;
+            for (size_t i = begin; i < end; ++i) {
+                if (!op(keys[i])) {
+                    ++wrong;
+                }
+            }
+            errors += wrong;
+        }));
+    }
+    for (size_t t = 0; t < threads; ++t) {
+        workers[t].join();
+    }
+    auto endTime = std::chrono::steady_clock::now();
+
+    if (errors != 0) {
+        std::ostringstream buffer;
+        buffer << std::endl << errors << " failed operations with " << threads << " threads" << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    return static_cast<double>(duration.count()) / 1000000.;
+}
+
+/*
+ * Verify a tree after the threads have inserted every key.
+ *
+ * Calling parameters:
+ *
+ * root - the tree
+ * keys - the keys
+ */
+void verifyTree(tdrbTree<uint32_t>& root, std::vector<uint32_t> const& keys) {
+    root.checkTree();
+    if (root.size() != keys.size()) {
+        std::ostringstream buffer;
+        buffer << std::endl << "expected size for tree = " << keys.size()
+               << " differs from actual size = " << root.size() << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+    std::vector<uint32_t> v(root.size());
+    root.getKeys(v);
+    for (size_t i = 0; i < v.size(); ++i) {
+        if (v[i] != i) {
+            std::ostringstream buffer;
+            buffer << std::endl << "key at position " << i << " = " << v[i] << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    
+    using std::cout;
+    using std::endl;
+    using std::ostringstream;
+    using std::runtime_error;
+    using std::setprecision;
+    using std::vector;
+
+    int iterations = 1;
+    int keys = 1048576;
+    int maxThreads = 64;
+    bool regions = false;
+
+    // Parse the command-line arguments.
+    for (size_t i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "-k") || 0 == strcmp(argv[i], "--keys")) {
+            keys = atol(argv[++i]);
+            if (keys <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nnodes = " << keys << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-t") || 0 == strcmp(argv[i], "--threads")) {
+            maxThreads = atol(argv[++i]);
+            if (maxThreads <= 0) {
+                ostringstream buffer;
+                buffer << "\n\nthreads = " << maxThreads << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-i") || 0 == strcmp(argv[i], "--iterations")) {
+            iterations = atol(argv[++i]);
+            if (iterations <= 0) {
+                ostringstream buffer;
+                buffer << "\n\niterations = " << iterations << "  <= 0" << endl;
+                throw runtime_error(buffer.str());
+            }
+            continue;
+        }
+        if (0 == strcmp(argv[i], "-r") || 0 == strcmp(argv[i], "--regions")) {
+            regions = true;
+            continue;
+        }
+        {
+            ostringstream buffer;
+            buffer << "\n\nillegal command-line argument: " << argv[i] << endl;
+            throw runtime_error(buffer.str());
+        }
+    }
+
+    // Shuffle the keys, or shuffle each of the contiguous ranges of keys
+    // when the number of threads is known.
+    vector<uint32_t> ordered(keys), shuffled(keys);
+    for (size_t i = 0; i < keys; ++i) {
+        ordered[i] = static_cast<uint32_t>(i);
+    }
+    std::mt19937_64 g(std::mt19937_64::default_seed);
+
+    // Preallocate the freed list, to which erasure returns the nodes
+    // after each measurement.
+    tdrbTree<uint32_t> root;
+    root.freedPreallocate(keys);
+    cout << endl << "node size = " << root.nodeSize()
+         << " bytes\tkeys = " << keys
+         << "\titerations = " << iterations
+         << "\tkeys per thread = " << (regions ? "contiguous" : "random") << endl << endl;
+    cout << "threads\tcoupled inserts/s\tstd dev\tper thread\tcoupled searches/s\tstd dev"
+         << "\tlocked inserts/s\tstd dev\tper thread" << endl;
+
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+
+        vector<double> coupledInsert(iterations), coupledSearch(iterations), lockedInsert(iterations);
+        for (size_t it = 0; it < iterations; ++it) {
+
+            shuffled = ordered;
+            if (regions) {
+                for (size_t t = 0; t < threads; ++t) {
+                    std::shuffle(shuffled.begin() + t * keys / threads,
+                                 shuffled.begin() + (t + 1) * keys / threads, g);
+                }
+            } else {
+                std::shuffle(shuffled.begin(), shuffled.end(), g);
+            }
+
+            // Insert and search for the keys via lock coupling, verify the
+            // tree and its clone, then erase the keys.
+            double elapsed = runThreads(threads, shuffled,
+                [&](uint32_t k) { return root.insert(k); });
+            coupledInsert[it] = keys / elapsed;
+            elapsed = runThreads(threads, shuffled,
+                [&](uint32_t k) { return root.contains(k); });
+            coupledSearch[it] = keys / elapsed;
+            verifyTree(root, ordered);
+            tdrbTree<uint32_t> copy( root.clone() );
+            verifyTree(copy, ordered);
+            for (size_t i = 0; i < shuffled.size(); ++i) {
+                root.erase(shuffled[i]);
+            }
+
+            // Insert the keys via a mutex that serializes the threads.
+            std::mutex lock;
+            elapsed = runThreads(threads, shuffled,
+                [&](uint32_t k) {
+                    std::lock_guard<std::mutex> guard(lock);
+                    return root.insert(k);
+                });
+            lockedInsert[it] = keys / elapsed;
+            verifyTree(root, ordered);
+            for (size_t i = 0; i < shuffled.size(); ++i) {
+                root.erase(shuffled[i]);
+            }
+        }
+
+        auto ci = calcMeanStd<double>(coupledInsert);
+        auto cs = calcMeanStd<double>(coupledSearch);
+        auto li = calcMeanStd<double>(lockedInsert);
+        cout << threads << "\t" << setprecision(4) << ci.first << "\t" << ci.second << "\t" << (ci.first / threads)
+             << "\t" << cs.first << "\t" << cs.second
+             << "\t" << li.first << "\t" << li.second << "\t" << (li.first / threads) << endl;
+    }
+    cout << endl;
+
+    // Clear the TD RB tree.
+    root.clear();
+
+    return 0;
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Compact binary traces of contains, insert and erase operations, which
+ * are recorded by a service via traceWriter and replayed by the benchmark
+ * driver via traceReader.
+ *
+ * A trace comprises a 16-byte header, which contains the 8-byte magic
+ * number "TREETRC1" and the number of operations as a little-endian 64-bit
+ * integer, followed by one variable-length record per operation. Each record
+ * encodes the opcode and the difference between its key and the key of the
+ * previous record (or 0 for the first record), zigzag-encoded so that small
+ * negative differences are also small. The first byte of a record holds the
+ * opcode in bits 0-1, the low 5 bits of the zigzag difference in bits 2-6 and
+ * a continuation flag in bit 7; each subsequent byte holds 7 more bits and a
+ * continuation flag. Hence, an operation whose key is within 16 of the key of
+ * the previous operation requires 1 byte, and within 2048 requires 2 bytes.
+ *
+ * The traceReader memory-maps the trace and decodes one record at a time,
+ * so that a trace of hundreds of millions of operations is streamed from
+ * the page cache instead of being loaded into memory. Memory mapping
+ * requires a POSIX operating system.
+ */
+
+#ifndef TREE_TRACE_FILE_H
+#define TREE_TRACE_FILE_H
+
+#include "workload.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TREE_TRACE_MAGIC "TREETRC1"
+#define TREE_TRACE_HEADER_SIZE 16
+
+/*
+ * The traceWriter class appends operations to a trace file. The number of
+ * operations is written to the header by close(), so the header of a trace
+ * whose writer was not closed disagrees with the number of its records.
+ */
+class traceWriter
+{
+private:
+    FILE* file;
+    std::string path;
+    uint64_t count;         // the number of operations written
+    uint64_t previous;      // the key of the previous operation
+
+public:
+    /*
+     * Calling parameter:
+     *
+     * p - the path of the trace file, which is created or truncated
+     */
+    traceWriter(std::string const& p) : path(p), count(0), previous(0) {
+        file = fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            std::ostringstream buffer;
+            buffer << std::endl << "cannot create trace file " << path << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        setvbuf(file, nullptr, _IOFBF, 1 << 20);
+        unsigned char header[TREE_TRACE_HEADER_SIZE] = {};
+        memcpy(header, TREE_TRACE_MAGIC, 8);
+        if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+            fail("write");
+        }
+    }
+
+public:
+    ~traceWriter() {
+        if (file != nullptr) {
+            fclose(file);
+        }
+    }
+
+    /* Prohibit copying, which would close the file twice. */
+public:
+    traceWriter(traceWriter const&) = delete;
+    traceWriter& operator=(traceWriter const&) = delete;
+
+    /*
+     * Append an operation.
+     *
+     * Calling parameters:
+     *
+     * op - the opcode
+     * key - the key
+     */
+public:
+    void record(opcode_t const op, uint64_t const key) {
+        int64_t const delta = static_cast<int64_t>(key - previous);
+        uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+        unsigned char bytes[10];
+        size_t n = 0;
+        bytes[n] = static_cast<unsigned char>(op | ((zigzag & 0x1f) << 2));
+        zigzag >>= 5;
+        while (zigzag != 0) {
+            bytes[n++] |= 0x80;
+            bytes[n] = static_cast<unsigned char>(zigzag & 0x7f);
+            zigzag >>= 7;
+        }
+        if (fwrite(bytes, 1, n + 1, file) != n + 1) {
+            fail("write");
+        }
+        previous = key;
+        ++count;
+    }
+
+    /* Write the number of operations to the header and close the file. */
+public:
+    void close() {
+        unsigned char bytes[8];
+        for (int i = 0; i < 8; ++i) {
+            bytes[i] = static_cast<unsigned char>(count >> (8 * i));
+        }
+        if (fseek(file, 8, SEEK_SET) != 0 || fwrite(bytes, 1, 8, file) != 8) {
+            fail("finish");
+        }
+        int const status = fclose(file);
+        file = nullptr;
+        if (status != 0) {
+            fail("close");
+        }
+    }
+
+private:
+    void fail(char const* const what) {
+        std::ostringstream buffer;
+        buffer << std::endl << "cannot " << what << " trace file " << path << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+};
+
+/*
+ * The traceReader class memory-maps a trace file and decodes its operations
+ * in order. Call rewind() to replay the trace again.
+ */
+class traceReader
+{
+private:
+    unsigned char const* base;      // the start of the mapping
+    unsigned char const* end;       // the end of the mapping
+    unsigned char const* cursor;    // the next record
+    size_t length;                  // the length of the mapping
+    uint64_t count;                 // the number of operations from the header
+    uint64_t previous;              // the key of the previous operation
+    std::string path;
+
+public:
+    /*
+     * Calling parameter:
+     *
+     * p - the path of the trace file
+     */
+    traceReader(std::string const& p) : base(nullptr), length(0), path(p) {
+        int const fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            fail("cannot open trace file ");
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < TREE_TRACE_HEADER_SIZE) {
+            ::close(fd);
+            fail("missing header in trace file ");
+        }
+        length = static_cast<size_t>(st.st_size);
+        void* const map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            fail("cannot map trace file ");
+        }
+        base = static_cast<unsigned char const*>(map);
+        end = base + length;
+        madvise(map, length, MADV_SEQUENTIAL);
+        if (memcmp(base, TREE_TRACE_MAGIC, 8) != 0) {
+            munmap(map, length);
+            base = nullptr;
+            fail("bad magic number in trace file ");
+        }
+        count = 0;
+        for (int i = 0; i < 8; ++i) {
+            count |= static_cast<uint64_t>(base[8 + i]) << (8 * i);
+        }
+        rewind();
+    }
+
+public:
+    ~traceReader() {
+        if (base != nullptr) {
+            munmap(const_cast<unsigned char*>(base), length);
+        }
+    }
+
+    /* Prohibit copying, which would unmap the file twice. */
+public:
+    traceReader(traceReader const&) = delete;
+    traceReader& operator=(traceReader const&) = delete;
+
+    /* Return the number of operations in the trace. */
+public:
+    uint64_t size() const {
+        return count;
+    }
+
+    /* Return to the first operation. */
+public:
+    void rewind() {
+        cursor = base + TREE_TRACE_HEADER_SIZE;
+        previous = 0;
+    }
+
+    /*
+     * Decode the next operation.
+     *
+     * Calling parameter:
+     *
+     * o - the operation (MODIFIED)
+     *
+     * return false at the end of the trace
+     */
+public:
+    inline bool next(operation& o) {
+        if (cursor == end) {
+            return false;
+        }
+        unsigned char b = *cursor++;
+        o.op = b & 0x3;
+        uint64_t zigzag = (b >> 2) & 0x1f;
+        int shift = 5;
+        while (b & 0x80) {
+            if (cursor == end || shift > 63) {
+                fail("truncated record in trace file ");
+            }
+            b = *cursor++;
+            zigzag |= static_cast<uint64_t>(b & 0x7f) << shift;
+            shift += 7;
+        }
+        previous += (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+        o.key = previous;
+        return true;
+    }
+
+private:
+    void fail(char const* const what) {
+        std::ostringstream buffer;
+        buffer << std::endl << what << path << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+};
+
+
+#endif // TREE_TRACE_FILE_H
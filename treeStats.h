@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Instrumentation that is shared by the AVL and red-black trees, which
+ * counts key comparisons, the lengths of search paths, the distance that
+ * rebalancing propagates per insertion or deletion, and the rotations,
+ * color flips and double-black propagation steps of rebalancing.
+ *
+ * The instrumentation is compiled only if ENABLE_TREE_STATS is defined,
+ * for example, via:
+ *
+ * g++ -std=c++11 -O3 -D ENABLE_TREE_STATS test_allTrees.cpp
+ *
+ * Otherwise, the TREE_STATS macro discards its argument, the trees contain
+ * no treeStats member, and no instrumentation code is generated.
+ *
+ * A comparison is an evaluation of <, > or == between two keys, so a search
+ * that descends to the left requires one comparison and a search that
+ * descends to the right, or finds the key, requires two comparisons. The
+ * erase function of the left-leaning red-black tree also tests == at each
+ * level that it descends to the right. The B+ tree evaluates < once per
+ * step of the binary search within each node that it visits, and once more
+ * to test whether a leaf contains the key.
+ *
+ * The length of a search path is the number of nodes that contains()
+ * visits, including the node that contains the key, if found.
+ *
+ * The distance of propagation is the number of rebalancing steps that an
+ * insertion or deletion performs, where a step is one ancestor whose balance
+ * is updated by the AVL tree, one ancestor whose rank is changed, or at which
+ * a rotation occurs, in the WAVL tree, one iteration of the repair loop of the
+ * bottom-up red-black tree, one level of the descent at which the top-down
+ * or hybrid red-black tree recolors or rotates, or one level of the ascent
+ * at which the left-leaning red-black tree recolors or rotates, or one split,
+ * merge or borrow of a node of the B+ tree, which performs no rotations. An
+ * operation that fails, because the key is present for insertion or absent
+ * for deletion, records no distance.
+ *
+ * The rebalancing counters are defined identically for every tree, so that
+ * the writes performed by rebalancing may be compared among the trees
+ * regardless of the tree-specific rotation counters, for example, lli or
+ * singleRotationCount, which remain available without ENABLE_TREE_STATS.
+ * A single rotation counts as one rotation and a double rotation counts as
+ * two rotations. A color flip is the exchange of color between a node and
+ * both of its children, i.e., the split or merge of a 2-3-4 node, which the
+ * left-leaning red-black tree performs via flipColors, the top-down and
+ * hybrid red-black trees perform during descent, and the bottom-up and
+ * hybrid red-black trees perform when an uncle is RED during insertion or
+ * a sibling and its children are BLACK during deletion. A double-black
+ * propagation step occurs when deletion from the bottom-up or hybrid
+ * red-black tree moves DOUBLE_BLACK from a node to its BLACK parent. The
+ * AVL and WAVL trees perform no color flips and no double-black propagation
+ * steps.
+ */
+
+#ifndef TREE_STATISTICS_H
+#define TREE_STATISTICS_H
+
+#include <cstddef>
+#include <vector>
+
+#ifdef ENABLE_TREE_STATS
+#define TREE_STATS(...) __VA_ARGS__
+#else
+#define TREE_STATS(...)
+#endif
+
+/*
+ * The treeStats class accumulates the comparisons and histograms of one
+ * tree. Each histogram is indexed by length or distance.
+ */
+class treeStats
+{
+public:
+    size_t comparisons;                     // the key comparisons of every operation
+    std::vector<size_t> searchLength;       // the histogram of search path lengths
+    std::vector<size_t> insertPropagation;  // the histogram of insertion propagation distances
+    std::vector<size_t> erasePropagation;   // the histogram of deletion propagation distances
+    size_t steps;                           // the rebalancing steps of the current operation
+    size_t rotations;                       // the rotations, counting a double rotation as two
+    size_t colorFlips;                      // the color flips of a node and its children
+    size_t doubleBlackSteps;                // the moves of DOUBLE_BLACK to a parent
+
+public:
+    treeStats() {
+        reset();
+    }
+
+    /* Discard the accumulated statistics. */
+public:
+    void reset() {
+        comparisons = steps = rotations = colorFlips = doubleBlackSteps = 0;
+        searchLength.clear();
+        insertPropagation.clear();
+        erasePropagation.clear();
+    }
+
+    /*
+     * Increment one entry of a histogram.
+     *
+     * Calling parameters:
+     *
+     * @param histogram (MODIFIED) the histogram
+     * @param index (IN) the length or distance
+     */
+public:
+    static inline void record(std::vector<size_t>& histogram, size_t const index) {
+        if (index >= histogram.size()) {
+            histogram.resize(index + 1, 0);
+        }
+        ++histogram[index];
+    }
+
+    /*
+     * Calculate the mean of a histogram.
+     *
+     * Calling parameter:
+     *
+     * @param histogram (IN) the histogram
+     *
+     * @return the mean length or distance, or 0 if the histogram is empty
+     */
+public:
+    static double mean(std::vector<size_t> const& histogram) {
+        double sum = 0., n = 0.;
+        for (size_t i = 0; i < histogram.size(); ++i) {
+            sum += static_cast<double>(i) * histogram[i];
+            n += histogram[i];
+        }
+        return (n == 0.) ? 0. : sum / n;
+    }
+
+    /*
+     * Return the number of entries of a histogram.
+     *
+     * Calling parameter:
+     *
+     * @param histogram (IN) the histogram
+     */
+public:
+    static size_t total(std::vector<size_t> const& histogram) {
+        size_t n = 0;
+        for (size_t i = 0; i < histogram.size(); ++i) {
+            n += histogram[i];
+        }
+        return n;
+    }
+};
+
+#endif // TREE_STATISTICS_H
@@ -0,0 +1,1213 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Weak AVL (WAVL) tree-building functions after the rank-balanced
+ * trees of Haeupler, Sen and Tarjan, "Rank-Balanced Trees," ACM
+ * Transactions on Algorithms 11(4), 2015, implemented recursively
+ * in the manner of avlTree.h so that the two trees may be compared.
+ *
+ * Each node stores a rank instead of a balance, and a missing child
+ * has rank -1. The rank difference of a child is the rank of its
+ * parent minus its rank, and every rank difference is 1 or 2, and
+ * every leaf has rank 0. Insertion promotes ranks and rotates exactly
+ * as an AVL tree does, so a tree built only by insertion is an AVL
+ * tree. Deletion demotes ranks and performs at most one single or
+ * double rotation, and the number of rank changes per deletion is
+ * O(1) amortized, whereas AVL deletion may rotate at every level.
+ *
+ * Compile with a test program, for example, test_wavlTree.cpp via:
+ * 
+ * g++ -std=c++11 -O3 test_wavlTree.cpp
+ * 
+ * To enable selection of a preferred replacment node
+ * when a 2-child node is deleted, compile via:
+ * 
+ * g++ -std=c++11 -O3 -D ENABLE_PREFERRED_TEST test_wavlTree.cpp
+ *
+ * To disable the freed list that avoids re-use of new and delete, compile via:
+ * 
+ * g++ -std=c++11 -O3 -D DISABLE_FREED_LIST test_wavlTree.cpp
+ * 
+ * To preallocate the freed list as a vector of wavl tree nodes, compile via:
+ * 
+ * g++ -std=c++11 -O3 -D PREALLOCATE test_wavlTree.cpp
+ *
+ * By default, a node that is erased remains on the freed list until
+ * clear() is called. The freedPolicy function limits the freed list
+ * to the larger of a number of nodes and a fraction of the number of
+ * nodes in the tree, beyond which an erased node is deleted, and the
+ * shrinkToFit function deletes the freed nodes in excess of that limit.
+ * A node that occupies the arena of freedPreallocate or clone is retained
+ * on the freed list regardless of the limit until the tree is empty,
+ * whereupon shrinkToFit releases the arena.
+ *
+ * To count comparisons, search path lengths and rebalancing steps
+ * (see treeStats.h), compile via:
+ *
+ * g++ -std=c++11 -O3 -D ENABLE_TREE_STATS test_wavlTree.cpp
+ */
+
+#ifndef HAEUPLER_SEN_TARJAN_WAVL_TREE_RECURSE_H
+#define HAEUPLER_SEN_TARJAN_WAVL_TREE_RECURSE_H
+
+#include <cstdint>
+#include <iostream>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "memoryFootprint.h"
+#include "nodeArena.h"
+#include "treeStats.h"
+
+/*
+ * The wavlTree class defines the root of the WAVL tree and stores the
+ * lli, lri, rli, rri, lle, lre, rle, and rre rotation counters, which
+ * are defined as for avlTree, the promotion and demotion counters,
+ * and the h, a, and r boolean variables.
+ */
+template <typename K>
+class wavlTree
+{
+private:
+    typedef int8_t rank_t;
+
+private:
+    struct Node {
+        K key;          // the key stored in this node
+        rank_t rank;    // the rank, which is 0 for a leaf
+        Node *left, *right;
+
+        Node( K const& x ) {
+            rank = 0;  // a new node is a leaf
+            key = x;
+            left = right = nullptr;
+        }
+
+        Node() {
+            rank = 0;  // a new node is a leaf
+            left = right = nullptr;
+        }
+    };
+
+public:
+    size_t nodeSize() {
+        return sizeof(Node);
+    }
+
+private:
+    Node* root;     // the root of the tree
+    size_t count;   // the number of nodes in the tree
+    bool h, a, r;   // record modification of the tree
+
+#ifndef DISABLE_FREED_LIST
+    Node* freed;            // the freed list
+    size_t freedCount;      // the number of nodes on the freed list
+    size_t freedMax;        // the number of freed nodes to retain regardless of tree size
+    double freedFraction;   // the fraction of the tree size to retain as freed nodes
+#endif
+    nodeArena<Node> arena;  // the nodes of freedPreallocate and clone
+
+public:
+    size_t lle, lre, rle, rre, lli, lri, rli, rri;  // the rotation counters
+    size_t promotions, demotions;                   // the rank changes
+#ifdef ENABLE_TREE_STATS
+    treeStats stats;                                // the comparisons and histograms
+#endif
+
+public:
+    wavlTree() {
+        root = nullptr;
+        lle = lre = rle = rre = lli = lri = rli = rri = count = 0;
+        promotions = demotions = 0;
+        h = a = r = false;
+#ifndef DISABLE_FREED_LIST
+        freed = nullptr;
+        freedCount = 0;
+        freedMax = std::numeric_limits<size_t>::max();
+        freedFraction = 0.;
+#endif
+    }
+
+public:
+    ~wavlTree() {
+        clear();
+    }
+
+    /* The tree owns its nodes, so it is not copied; call clone instead. */
+public:
+    wavlTree(wavlTree const&) = delete;
+
+public:
+    wavlTree& operator=(wavlTree const&) = delete;
+
+    /*
+     * Move a tree in O(1) time, which leaves the other tree empty.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    wavlTree(wavlTree&& t) noexcept : wavlTree() {
+        swap(t);
+    }
+
+    /*
+     * Move a tree in O(1) time by exchanging it with this tree, so that
+     * the nodes of this tree are deleted when the other tree is destroyed.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the tree to move
+     */
+public:
+    wavlTree& operator=(wavlTree&& t) noexcept {
+        swap(t);
+        return *this;
+    }
+
+    /*
+     * Exchange the nodes, freed list, arena and counters of two trees
+     * in O(1) time.
+     *
+     * Calling parameter:
+     *
+     * @param t (MODIFIED) the other tree
+     */
+public:
+    void swap(wavlTree& t) noexcept {
+        std::swap(root, t.root);
+        std::swap(count, t.count);
+#ifndef DISABLE_FREED_LIST
+        std::swap(freed, t.freed);
+        std::swap(freedCount, t.freedCount);
+        std::swap(freedMax, t.freedMax);
+        std::swap(freedFraction, t.freedFraction);
+#endif
+        arena.swap(t.arena);
+        std::swap(lle, t.lle);
+        std::swap(lre, t.lre);
+        std::swap(rle, t.rle);
+        std::swap(rre, t.rre);
+        std::swap(lli, t.lli);
+        std::swap(lri, t.lri);
+        std::swap(rli, t.rli);
+        std::swap(rri, t.rri);
+        std::swap(promotions, t.promotions);
+        std::swap(demotions, t.demotions);
+#ifdef ENABLE_TREE_STATS
+        std::swap(stats, t.stats);
+#endif
+    }
+
+    /*
+     * Copy the shape, keys and ranks of the tree in one linear pass
+     * that performs no comparisons or rebalancing. The nodes of the copy
+     * are allocated as one block of the arena of the copy.
+     *
+     * @return the copy
+     */
+public:
+    wavlTree clone() const {
+        wavlTree t;
+        size_t i = 0;
+        t.root = cloneNode(root, t.arena.allocate(count), i);
+        t.count = count;
+        return t;
+    }
+
+    /*
+     * Copy a subtree in pre-order to consecutive nodes of a block.
+     *
+     * Calling parameters:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param block (MODIFIED) the block of nodes
+     * @param i (MODIFIED) the index of the next unused node of the block
+     *
+     * @return the root of the copy of the subtree
+     */
+private:
+    static Node* cloneNode(Node const* const p, Node* const block, size_t& i) {
+        if (p == nullptr) {
+            return nullptr;
+        }
+        Node* const q = block + i++;
+        q->key = p->key;
+        q->rank = p->rank;
+        q->left = cloneNode(p->left, block, i);
+        q->right = cloneNode(p->right, block, i);
+        return q;
+    }
+
+    /*
+     * Delete every node in the WAVL tree.  If the tree has been
+     * completely deleted via prior calls to the erase function,
+     * this function will do nothing.
+     * 
+     * Calling parameter:
+     * 
+     * @param p (IN) the root of the subtree at this level of recursion
+     */
+public:
+    void clear(Node* const p) {
+        if (p == nullptr) {
+            return;
+        }
+        clear(p->left);
+        clear(p->right);
+        if ( !inArena(p) ) {
+            delete p;
+        }
+    }
+
+    /* Delete every node in the WAVL tree and on the freed list. */
+public:
+    void clear() {
+        clear(root);
+        root = nullptr;
+        count = 0;
+#ifndef DISABLE_FREED_LIST
+        clearFreed();
+#endif
+        arena.release();
+    }
+
+    /* Delete every node from the freed list. */
+private:
+    void clearFreed() {
+#ifndef DISABLE_FREED_LIST
+        while ( freed != nullptr ) {
+            Node* next = freed->left;
+            if ( !inArena(freed) ) {
+                delete freed;
+            }
+            freed = next;
+        }
+        freed = nullptr;
+        freedCount = 0;
+#endif
+    }
+
+    /*
+     * Determine whether a node occupies the arena of freedPreallocate
+     * or clone, and hence must not be deleted.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node
+     *
+     * @return true if the node occupies the arena; otherwise, false
+     */
+private:
+    inline bool inArena( Node const* const p ) {
+        return arena.contains(p);
+    }
+
+    /*
+     * Attempt to obtain a node from the freed list instead of
+     * creating a new node.
+     * 
+     * Calling parameter:
+     * 
+     * @param x (IN) the key to store in the node
+     * 
+     * @return a pointer to the node
+     */ 
+private:
+    inline Node* newNode( K const& x ) {
+
+#ifndef DISABLE_FREED_LIST
+        if (freed != nullptr )
+        {
+            Node* p = freed;
+            freed = freed->left;
+            --freedCount;
+            p->rank = 0;  // a new node is a leaf
+            p->key = x;
+            p->left = p->right = nullptr;
+            return p;
+        } else
+#endif
+        {
+            return new Node( x );
+        }
+    }
+
+    /*
+     * Prepend a node to the freed list instead of deleting it,
+     * unless the freed list has reached the limit of freedPolicy.
+     *
+     * Calling parameter:
+     *
+     * @param q (IN) pointer to the node
+     */
+private:
+    inline void deleteNode( Node* q ) {
+#ifndef DISABLE_FREED_LIST
+        if ( freedCount < freedMax || freedCount < freedFraction * count || inArena(q) ) {
+            q->left = freed;
+            freed = q;
+            ++freedCount;
+        } else {
+            delete q;
+        }
+#else
+        if ( !inArena(q) ) {
+            delete q;
+        }
+#endif
+    }
+    
+    /* Report the number of nodes on the freed list. */
+public:
+    size_t freedSize() {
+#ifndef DISABLE_FREED_LIST
+        return freedCount;
+#else
+        return 0;
+#endif
+    }
+
+    /*
+     * Limit the number of nodes that the freed list retains to the larger
+     * of a number of nodes and a fraction of the number of nodes in the tree.
+     * The default policy retains every freed node.
+     *
+     * Calling parameters:
+     *
+     * @param maxNodes (IN) the number of nodes to retain regardless of tree size
+     * @param fraction (IN) the fraction of the tree size to retain
+     */
+public:
+    void freedPolicy( size_t const maxNodes, double const fraction ) {
+#ifndef DISABLE_FREED_LIST
+        freedMax = maxNodes;
+        freedFraction = fraction;
+#else
+        (void) maxNodes;
+        (void) fraction;
+#endif
+    }
+
+    /*
+     * Delete the nodes on the freed list in excess of the limit of
+     * freedPolicy. A node that occupies the arena is retained unless
+     * the tree is empty, in which case the arena is released.
+     */
+public:
+    void shrinkToFit() {
+#ifndef DISABLE_FREED_LIST
+        size_t const fraction = static_cast<size_t>(freedFraction * count);
+        size_t const limit = (freedMax > fraction) ? freedMax : fraction;
+        Node* p = freed;
+        freed = nullptr;
+        freedCount = 0;
+        while ( p != nullptr ) {
+            Node* next = p->left;
+            if ( inArena(p) ) {
+                if ( count != 0 ) {
+                    p->left = freed;
+                    freed = p;
+                    ++freedCount;
+                }
+            } else if ( freedCount < limit ) {
+                p->left = freed;
+                freed = p;
+                ++freedCount;
+            } else {
+                delete p;
+            }
+            p = next;
+        }
+        if ( count == 0 ) {
+            arena.release();
+        }
+#endif
+    }
+
+    /*
+     * Prepend the specified number of nodes to the freed list.
+     *
+     * Calling parameters:
+     *
+     * @param n (IN) the number of nodes to prepend
+     */
+public:
+    void freedPreallocate( size_t const n ) {
+#ifndef DISABLE_FREED_LIST
+#ifndef PREALLOCATE
+       for (size_t i = 0; i < n; ++i) {
+            Node* p = new Node();
+            p->left = freed;
+            freed = p;
+        }
+        freedCount += n;
+#else
+        Node* const block = arena.allocate(n);
+        for (size_t i = 0; i < n; ++i) {
+            Node* p = block + i;
+            p->left = freed;
+            freed = p;
+        }
+        freedCount += n;
+#endif
+#endif
+    }
+
+    /*
+     * Report the memory that the WAVL tree occupies (see memoryFootprint.h).
+     *
+     * @return the live, freed, reserved, payload and overhead bytes
+     */
+public:
+    memoryFootprint memoryUsage() {
+        memoryFootprint m;
+        size_t const vectorSize = arena.size(), vectorCapacity = arena.capacity();
+        m.addNodes(sizeof(Node), count, freedSize(), vectorSize, vectorCapacity);
+        if (hasHeapPayload<K>::value) {
+            m.addSubtree(root, static_cast<Node*>(nullptr));
+#ifndef DISABLE_FREED_LIST
+            m.addFreed(freed, static_cast<Node*>(nullptr));
+#endif
+        }
+        return m;
+    }
+
+
+    /* Return the number of nodes in the WAVL tree. */
+public:
+    size_t size() {
+        return count;
+    }
+
+    /* Return true if there are no nodes in the WAVL tree. */
+public:
+    bool empty() {
+        return ( count == 0 );
+    }
+
+    /*
+     * Return the rank of a node, where a missing node has rank -1.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) pointer to the node, or nullptr
+     *
+     * @return the rank
+     */
+private:
+    static inline int rankOf( Node const* const p ) {
+        return ( p == nullptr ) ? -1 : p->rank;
+    }
+
+    /*
+     * Search the tree for the existence of a key.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to search for
+     * 
+     * @return true if the key was found; otherwise, false
+     */
+public:
+    inline bool contains( K const& x ) {
+        return contains(root, x);
+    }
+
+   /* Search the tree for the existence of a key.
+    *
+    * Calling parameters:
+    *
+    * @param p (IN) the root of the subtree at this level of recursion
+    * @param x (IN) the key to search for
+    * 
+    * @return true if the key was found; otherwise, false
+    */
+private:
+    inline bool contains( Node* const p, K const& x) {
+
+        Node* q = p;
+        TREE_STATS(size_t length = 0;)
+        while ( q != nullptr ) {                    // iterate; don't use recursion
+            TREE_STATS(++length;)
+            if ( x < q->key ) {
+                TREE_STATS(++stats.comparisons;)
+                q = q->left;                        // follow the left branch
+            } else if ( x > q->key ) {
+                TREE_STATS(stats.comparisons += 2;)
+                q = q->right;                       // follow the right branch
+            } else {
+                TREE_STATS(stats.comparisons += 2; treeStats::record(stats.searchLength, length);)
+                return true;                        // found the key, so return true
+            }
+        }
+        TREE_STATS(treeStats::record(stats.searchLength, length);)
+        return false;                               // didn't find the key, so return false
+    }
+
+    /*
+     * Search the tree for the existence of a key.
+     * If the key is not found, it is is added to
+     * the tree as a new node. If the key is found,
+     * it is ignored. Then the tree is rebalanced
+     * if necessary.
+     *
+     * Calling parameter:
+     *
+     * @param x (IN) the key to add to the tree
+     * 
+     * @return true if the key was added as a new node; otherwise, false
+     */
+public:
+    inline bool insert( K const& x ) {
+        h = false, a = true;
+        TREE_STATS(stats.steps = 0;)
+        if ( root != nullptr ) {
+            root = insert( root, x );
+            if ( a == true ) {
+                ++count;
+            }
+        } else {
+            root = newNode( x );
+            ++count;
+        }
+        TREE_STATS(if ( a == true ) treeStats::record(stats.insertPropagation, stats.steps);)
+        return a;
+    }
+
+    /*
+     * Removes a node from the tree. Then the tree
+     * is rebalanced if necessary.
+     * 
+     * Calling parameter:
+     * 
+     * @param x (IN) the key to remove from the tree
+     * 
+     * @return true if the key was removed from the tree; otherwise, false
+     */
+public:
+    inline bool erase( K const& x ) {
+        h = false, r = false;
+        TREE_STATS(stats.steps = 0;)
+        if ( root != nullptr ) {
+            root = erase( root, x );
+            if ( r == true ) {
+                --count;
+            }
+        }
+        TREE_STATS(if ( r == true ) treeStats::record(stats.erasePropagation, stats.steps);)
+        return r;
+    }
+
+    /*
+     * Rebalance following insertion into, or promotion of, the left
+     * subtree, whose root may now have a rank difference of 0.
+     * 
+     * Calling parameter:
+     * 
+     * @param p (IN) the root of the subtree at this level of recursion
+     * 
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceInsertLeft( Node* p ) {
+        Node* p1 = p->left;
+        if ( p1->rank < p->rank ) {                     // rank difference is 1, so balance restored
+            h = false;
+            return p;
+        }
+        TREE_STATS(++stats.steps;)
+        if ( p->rank - rankOf( p->right ) == 1 ) {      // 0,1 node, so promote and continue
+            ++p->rank;
+            ++promotions;
+        } else if ( p1->rank - rankOf( p1->right ) == 2 ) {  // single LL rotation
+            lli++;
+            TREE_STATS(++stats.rotations;)
+            p->left = p1->right;
+            p1->right = p;
+            --p->rank;
+            ++demotions;
+            p = p1;
+            h = false;
+        } else {                                        // double LR rotation
+            lri++;
+            TREE_STATS(stats.rotations += 2;)
+            Node* p2 = p1->right;
+            p1->right = p2->left;
+            p2->left = p1;
+            p->left = p2->right;
+            p2->right = p;
+            ++p2->rank;
+            --p1->rank;
+            --p->rank;
+            ++promotions;
+            demotions += 2;
+            p = p2;
+            h = false;
+        }
+        return p;
+    }
+
+    /*
+     * Rebalance following insertion into, or promotion of, the right
+     * subtree, whose root may now have a rank difference of 0.
+     * 
+     * Calling parameter:
+     * 
+     * @param p (IN) the root of the subtree at this level of recursion
+     * 
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceInsertRight( Node* p ) {
+        Node* p1 = p->right;
+        if ( p1->rank < p->rank ) {                     // rank difference is 1, so balance restored
+            h = false;
+            return p;
+        }
+        TREE_STATS(++stats.steps;)
+        if ( p->rank - rankOf( p->left ) == 1 ) {       // 1,0 node, so promote and continue
+            ++p->rank;
+            ++promotions;
+        } else if ( p1->rank - rankOf( p1->left ) == 2 ) {  // single RR rotation
+            rri++;
+            TREE_STATS(++stats.rotations;)
+            p->right = p1->left;
+            p1->left = p;
+            --p->rank;
+            ++demotions;
+            p = p1;
+            h = false;
+        } else {                                        // double RL rotation
+            rli++;
+            TREE_STATS(stats.rotations += 2;)
+            Node* p2 = p1->left;
+            p1->left = p2->right;
+            p2->right = p1;
+            p->right = p2->left;
+            p2->left = p;
+            ++p2->rank;
+            --p1->rank;
+            --p->rank;
+            ++promotions;
+            demotions += 2;
+            p = p2;
+            h = false;
+        }
+        return p;
+    }
+
+    /*
+     * Search the tree for the existence of a key.
+     * If the key is not found, it is is added to
+     * the tree as a new node. If the key is found,
+     * it is ignored. Then the tree is rebalanced
+     * if necessary.
+     *
+     * Calling parameter:
+     *
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param x (IN) the key to add to the tree
+     * 
+     * @return the root of the rebalanced subtree
+     */
+private:
+    Node* insert( Node* p,  K const& x ) {
+
+        if ( x < p->key ) {                         // search the left branch?
+            TREE_STATS(++stats.comparisons;)
+            if ( p->left != nullptr ) {
+                p->left = insert( p->left, x );
+            } else {
+                p->left = newNode( x );
+                h = true;
+                a = true;
+            }
+            if ( h ) {                              // left rank difference may be 0
+                p = balanceInsertLeft( p );
+            }
+        } else if ( x > p->key ) {                  // search the right branch?
+            TREE_STATS(stats.comparisons += 2;)
+            if ( p->right != nullptr ) {
+                p->right = insert( p->right, x );
+            } else {
+                p->right = newNode( x );
+                h = true;
+                a = true;
+            }
+            if ( h ) {                              // right rank difference may be 0
+                p = balanceInsertRight( p );
+            }
+        } else {
+            // The key is already in the tree.
+            // For a tree, don't insert the key twice.
+            // For a map, overwrite the value.
+            TREE_STATS(stats.comparisons += 2;)
+            h = false;
+            a = false;
+        }
+
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Rebalance following a decrease in the rank of the left subtree,
+     * whose root may now have a rank difference of 3, or following which
+     * p may be a leaf whose rank is 1.
+     * 
+     * Calling parameter:
+     * 
+     * @param p (IN) the root of the subtree at this level of recursion
+     * 
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceEraseLeft( Node* p ) {
+
+        Node* p1 = p->right;
+        if ( p->rank - rankOf( p->left ) < 3
+             && ( p->rank == 0 || p->left != nullptr || p1 != nullptr ) ) {
+            h = false;                                  // balance restored
+            return p;
+        }
+        TREE_STATS(++stats.steps;)
+        if ( p1 == nullptr || p->rank - p1->rank == 2 ) {  // 2,2 leaf or 3,2 node, so demote
+            --p->rank;
+            ++demotions;
+        } else if ( p1->rank - rankOf( p1->left ) == 2
+                    && p1->rank - rankOf( p1->right ) == 2 ) {  // 3,1 node with 2,2 sibling
+            --p->rank;
+            --p1->rank;
+            demotions += 2;
+        } else if ( p1->rank - rankOf( p1->right ) == 1 ) {  // single RR rotation
+            rre++;
+            TREE_STATS(++stats.rotations;)
+            p->right = p1->left;
+            p1->left = p;
+            ++p1->rank;
+            --p->rank;
+            ++promotions;
+            ++demotions;
+            if ( p->left == nullptr && p->right == nullptr ) {
+                --p->rank;                              // a leaf has rank 0
+                ++demotions;
+            }
+            p = p1;
+            h = false;
+        } else {                                        // double RL rotation
+            rle++;
+            TREE_STATS(stats.rotations += 2;)
+            Node* p2 = p1->left;
+            p1->left = p2->right;
+            p2->right = p1;
+            p->right = p2->left;
+            p2->left = p;
+            p2->rank += 2;
+            --p1->rank;
+            p->rank -= 2;
+            promotions += 2;
+            demotions += 3;
+            p = p2;
+            h = false;
+        }
+        return p; // the root of the rebalanced subtree
+    }
+
+    /*
+     * Rebalance following a decrease in the rank of the right subtree,
+     * whose root may now have a rank difference of 3, or following which
+     * p may be a leaf whose rank is 1.
+     * 
+     * Calling parameter:
+     * 
+     * @param p (IN) the root of the subtree at this level of recursion
+     * 
+     * @return the root of the rebalanced subtree
+     */
+private:
+    inline Node* balanceEraseRight( Node* p ) {
+
+        Node* p1 = p->left;
+        if ( p->rank - rankOf( p->right ) < 3
+             && ( p->rank == 0 || p->right != nullptr || p1 != nullptr ) ) {
+            h = false;                                  // balance restored
+            return p;
+        }
+        TREE_STATS(++stats.steps;)
+        if ( p1 == nullptr || p->rank - p1->rank == 2 ) {  // 2,2 leaf or 2,3 node, so demote
+            --p->rank;
+            ++demotions;
+        } else if ( p1->rank - rankOf( p1->left ) == 2
+                    && p1->rank - rankOf( p1->right ) == 2 ) {  // 1,3 node with 2,2 sibling
+            --p->rank;
+            --p1->rank;
+            demotions += 2;
+        } else if ( p1->rank - rankOf( p1->left ) == 1 ) {  // single LL rotation
+            lle++;
+            TREE_STATS(++stats.rotations;)
+            p->left = p1->right;
+            p1->right = p;
+            ++p1->rank;
+            --p->rank;
+            ++promotions;
+            ++demotions;
+            if ( p->left == nullptr && p->right == nullptr ) {
+                --p->rank;                              // a leaf has rank 0
+                ++demotions;
+            }
+            p = p1;
+            h = false;
+        } else {                                        // double LR rotation
+            lre++;
+            TREE_STATS(stats.rotations += 2;)
+            Node* p2 = p1->right;
+            p1->right = p2->left;
+            p2->left = p1;
+            p->left = p2->right;
+            p2->right = p;
+            p2->rank += 2;
+            --p1->rank;
+            p->rank -= 2;
+            promotions += 2;
+            demotions += 3;
+            p = p2;
+            h = false;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Replace the node to be deleted with the leftmost node of
+     * the right subtree after copying the key from that leftmost
+     * node to the key of the node to be deleted. Then redefine
+     * the node to be deleted as that leftmost node and replace
+     * that leftmost node with its right child. Then rebalance
+     * the right subtree if necessary.
+     * 
+     * Calling parameters:
+     * 
+     * @param p (IN) the root of the right subtree at this level of recursion
+     * @param q (MODIFIED) the node to be deleted
+     * 
+     * @return the root of the rebalanced subtree
+     */
+private:
+    Node* eraseLeft( Node* p, Node*& q ) {
+
+        if ( p->left != nullptr ) {
+            p->left = eraseLeft( p->left, q );
+            if ( h ) {
+                p = balanceEraseLeft( p );
+            }
+        } else {
+            q->key = p->key;                // copy node contents from p to q
+            q = p;                          // redefine q as node to be deleted
+            p = p->right;                   // replace node with right branch
+            h = true;                       // the rank has decreased
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Replace the node to be deleted with the rightmost node of
+     * the left subtree after copying the key from that rightmost
+     * node to the key of the node to be deleted. Then redefine
+     * the node to be deleted as that rightmost node and replace
+     * that rightmost node with its left child. Then rebalance
+     * the left subtree if necessary.
+     * 
+     * Calling parameters:
+     * 
+     * @param p (IN) the root of the left subtree at this level of recursion
+     * @param q (MODIFIED) the node to be deleted
+     * 
+     * @return the root of the rebalanced left subtree
+     */
+private:
+    Node* eraseRight( Node* p, Node*& q ) {
+
+        if ( p->right != nullptr ) {
+            p->right = eraseRight( p->right, q );
+            if ( h ) {
+                p = balanceEraseRight( p );
+            }
+        } else {
+            q->key = p->key;                // copy node contents from p to q
+            q = p;                          // redefine q as node to be deleted 
+            p = p->left;                    // replace node with left branch
+            h = true;                       // the rank has decreased
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Remove a node from the tree. Then the tree is rebalanced
+     * if necessary.
+     * 
+     * Calling parameters:
+     * 
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param x (IN) the key to remove from the tree
+     * 
+     * @return the root of the rebalanced subtree
+     */
+private:
+    Node* erase( Node* p, K const& x ) {
+
+        if ( x < p->key ) {                     // search left branch?
+            TREE_STATS(++stats.comparisons;)
+            if ( p->left != nullptr ) {
+                p->left = erase( p->left, x );
+                if ( h ) {
+                    p = balanceEraseLeft( p );
+                }
+            } else {
+                h = false;                      // key is not in the tree
+                r = false;
+            }
+        } else if ( x > p->key ) {              // search right branch?
+            TREE_STATS(stats.comparisons += 2;)
+            if ( p->right != nullptr ) {
+                p->right = erase( p->right, x );
+                if ( h ) {
+                    p = balanceEraseRight( p );
+                }
+            } else {
+                h = false;                      // key is not in the tree
+                r = false;
+            }
+        } else {                                // x == key, so...
+            TREE_STATS(stats.comparisons += 2;)
+            Node* q = p;                        // ...select this node for removal
+            if ( p->right == nullptr ) {        // if one branch is nullptr...
+                p = p->left;
+                h = true;
+            } else if ( p->left == nullptr ) {  // ...replace with the other one
+                p = p->right;
+                h = true;
+            } else {                            // otherwise find a node to remove
+                // The node has two children, so replace it
+                // either by the leftmost node of the right subtree
+                // or by the rightmost node of the left subtree.
+                // Select the preferred replacement node from the
+                // subtree of higher rank.
+#ifdef ENABLE_PREFERRED_TEST
+                if ( p->left->rank >= p->right->rank )  // left or neither subtree is higher
+                {
+                    p->left = eraseRight( p->left, q );  // redefine the node to be removed
+                    if ( h ) {
+                        p = balanceEraseLeft( p );
+                    }
+                }
+                else                            // right subtree is higher
+#endif
+                {
+                    p->right = eraseLeft( p->right, q );  // redefine the node to be removed
+                    if ( h ) {
+                        p = balanceEraseRight( p );
+                    }
+                }
+            }
+            deleteNode(q);
+            r = true;
+        }
+        return p;  // the root of the rebalanced subtree
+    }
+
+    /*
+     * Check the WAVL tree for correctness, i.e.,
+     * (1) correct sorted order of keys
+     * (2) the rank difference of each child is 1 or 2
+     * (3) the rank of each leaf is 0
+     * 
+     * Calling parameters:
+     * 
+     * @param node (IN) the root of the subtree at this level of recursion
+     */
+private:
+    void checkTree( Node* const node ) {
+
+        // Check for correct key order.
+        if ( node->left != nullptr && node->left->key >= node->key ) {
+            std::ostringstream buffer;
+            buffer << std::endl << std::endl << "node ";
+            streamNode(node, buffer);
+            buffer << " left child ";
+            streamNode(node->left, buffer);
+            buffer << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        if ( node->right != nullptr && node->right->key <= node->key ) {
+            std::ostringstream buffer;
+            buffer << std::endl << std::endl << "node ";
+            streamNode(node, buffer);
+            buffer << " right child ";
+            streamNode(node->right, buffer);
+            buffer << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+
+        // Check for correct rank differences.
+        int const dl = node->rank - rankOf( node->left );
+        int const dr = node->rank - rankOf( node->right );
+        if ( dl < 1 || dl > 2 || dr < 1 || dr > 2 ) {
+            std::ostringstream buffer;
+            buffer << std::endl << std::endl << "node ";
+            streamNode(node, buffer);
+            buffer << " has rank differences " << dl << "," << dr << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+        if ( node->left == nullptr && node->right == nullptr && node->rank != 0 ) {
+            std::ostringstream buffer;
+            buffer << std::endl << std::endl << "leaf node ";
+            streamNode(node, buffer);
+            buffer << " has rank = " << static_cast<int>(node->rank) << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+
+        // Descend to the leaves of each subtree.
+        if ( node->left != nullptr ) {
+            checkTree( node->left );
+        }
+        if ( node->right != nullptr ) {
+            checkTree( node->right );
+        }
+    }
+
+    /*
+     * Check the WAVL tree for correctness.
+     */
+public:
+    void checkTree() {
+
+        if (root == nullptr) {
+            return;
+        }
+        checkTree(root);
+    }
+
+private:
+    void streamNode(Node* const node, std::ostringstream& buffer) {
+        if (node != nullptr) {
+            buffer << node->key;
+        }
+    }
+
+private:
+    void printNode( Node* const node ) {
+        if (node != nullptr) {
+            std::cout << node->key;
+        }
+    }
+
+    /*
+     * Print the keys stored in the tree, where the key of
+     * the root of the tree is at the left and the keys of
+     * the leaf nodes are at the right.
+     * 
+     * Calling parameters:
+     * 
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param d (MODIFIED) the depth in the tree
+     */
+private:
+    void printTree( Node* const p, int d ) {
+        if ( p->right != nullptr ) {
+            printTree( p->right, d+1 );
+        }
+
+        for ( int i = 0; i < d; ++i ) {
+            std::cout << "    ";
+        }
+        printNode(p);
+        std::cout << std::endl;
+
+        if ( p->left != nullptr ) {
+            printTree( p->left, d+1 );
+        }
+    }
+
+    /*
+     * Print the keys stored in the tree, where the keys of
+     * the root of the tree is at the left and the keys of
+     * the leaf nodes are at the right.
+     */
+public:
+    void printTree() {
+        if ( root != nullptr ) {
+            printTree( root, 0 );
+        }
+    }
+
+    /*
+     * Walk the tree in order and store each key in a vector.
+     *
+     * Calling parameters:
+     * 
+     * @param p (IN) the root of the subtree at this level of recursion
+     * @param v (MODIFIED) vector of the keys
+     * @param i (MODIFIED) index to the next unoccupied vector element
+     */       
+public:
+    void getKeys( Node* const p, std::vector<K>& v, size_t& i ) {
+
+        if ( p->left != nullptr ) {
+            getKeys( p->left, v, i );
+        }
+        v[i++] = p->key;
+        if ( p->right != nullptr ) {
+            getKeys( p->right, v, i );
+        }
+    }
+
+    /*
+     * Walk the tree in order and store each key in a vector.
+     *
+     * Calling parameter:
+     * 
+     * @param v (MODIFIED) vector of the keys
+     */
+public:
+    void getKeys( std::vector<K>& v ) {
+        if ( root != nullptr ) {
+            size_t i = 0;
+            getKeys( root, v, i );
+        }
+    }
+};
+
+#endif // HAEUPLER_SEN_TARJAN_WAVL_TREE_RECURSE_H
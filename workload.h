@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2024 Russell A. Brown
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Workload generator for the benchmark driver, which produces streams of
+ * contains, insert and erase operations that resemble production traffic
+ * instead of inserting, searching for and erasing every key once.
+ *
+ * The key of each record is its record number, so that records are
+ * inserted in increasing order of key as in a time-ordered index. The
+ * key of a request is chosen from the existing records according to a
+ * uniform, Zipfian or hotspot distribution. The Zipfian distribution is
+ * the scrambled Zipfian distribution of YCSB (Cooper et al., "Benchmarking
+ * Cloud Serving Systems with YCSB", SoCC 2010), with a constant of 0.99,
+ * whose popular records are scattered throughout the key space, and the
+ * hotspot distribution directs 80% of requests to the first 20% of keys.
+ *
+ * The mixes follow the YCSB core workloads. Because the trees are sets of
+ * keys without values, an update or a read-modify-write that replaces the
+ * value of a record is performed as an erase and an insert of its key,
+ * and a scan is performed as a contains of each consecutive key, because
+ * the trees do not provide iterators.
+ *
+ * A  50% read, 50% update
+ * B  95% read, 5% update
+ * C  100% read
+ * D  95% read, 5% insert, where reads favor the latest records
+ * E  95% scan of 1 to 100 keys, 5% insert
+ * F  50% read, 50% read-modify-write
+ *
+ * The sliding-window mix inserts a new record and expires the oldest record,
+ * so that the tree holds a constant number of the most recent records.
+ */
+
+#ifndef WORKLOAD_GENERATOR_H
+#define WORKLOAD_GENERATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* A primitive operation on a tree. */
+enum opcode_t : uint8_t { OP_CONTAINS, OP_INSERT, OP_ERASE, OP_COUNT };
+
+char const* const opcodeNames[OP_COUNT] = { "contains", "insert", "erase" };
+
+struct operation {
+    uint8_t op;     // an opcode_t
+    uint64_t key;
+};
+
+/*
+ * The zipfianGenerator class generates ranks in [0, n) where rank 0 is the
+ * most popular, via the algorithm of Gray et al., "Quickly Generating
+ * Billion-Record Synthetic Databases", SIGMOD 1994, as implemented by YCSB.
+ * The number of items may grow, in which case zeta is extended incrementally.
+ */
+class zipfianGenerator
+{
+private:
+    double theta, alpha, zeta2, zetan, eta;
+    uint64_t items;
+
+public:
+    zipfianGenerator(uint64_t const n, double const constant = 0.99) :
+        theta(constant), alpha(1. / (1. - constant)), zeta2(1. + std::pow(0.5, constant)),
+        zetan(0.), items(0) {
+        grow(n);
+    }
+
+    /*
+     * Increase the number of items.
+     *
+     * Calling parameter:
+     *
+     * n - the new number of items, which must not be less than the current number
+     */
+public:
+    void grow(uint64_t const n) {
+        for (uint64_t i = items; i < n; ++i) {
+            zetan += 1. / std::pow(static_cast<double>(i + 1), theta);
+        }
+        items = n;
+        eta = (1. - std::pow(2. / static_cast<double>(items), 1. - theta)) / (1. - zeta2 / zetan);
+    }
+
+    /*
+     * Generate a rank.
+     *
+     * Calling parameter:
+     *
+     * g - a random number generator (MODIFIED)
+     *
+     * return a rank in [0, n)
+     */
+public:
+    template <typename G>
+    uint64_t next(G& g) {
+        double const u = std::uniform_real_distribution<double>(0., 1.)(g);
+        double const uz = u * zetan;
+        if (uz < 1.) {
+            return 0;
+        }
+        if (uz < zeta2) {
+            return 1;
+        }
+        uint64_t const rank =
+            static_cast<uint64_t>(static_cast<double>(items) * std::pow(eta * u - eta + 1., alpha));
+        return std::min(rank, items - 1);
+    }
+};
+
+/*
+ * The workload class generates the operations that load the initial records
+ * and then the operations of a mix, with every random choice drawn from a
+ * generator seeded by the caller so that every tree receives the same stream.
+ */
+class workload
+{
+public:
+    enum mix_t { YCSB_A, YCSB_B, YCSB_C, YCSB_D, YCSB_E, YCSB_F, SLIDING_WINDOW, MIX_COUNT };
+    enum distribution_t { UNIFORM, ZIPFIAN, HOTSPOT, DISTRIBUTION_COUNT };
+
+    static char const* mixName(mix_t const m) {
+        static char const* const names[MIX_COUNT] = { "a", "b", "c", "d", "e", "f", "window" };
+        return names[m];
+    }
+
+    static char const* distributionName(distribution_t const d) {
+        static char const* const names[DISTRIBUTION_COUNT] = { "uniform", "zipfian", "hotspot" };
+        return names[d];
+    }
+
+private:
+    static constexpr double HOT_KEYS = 0.2;         // the fraction of keys that are hot
+    static constexpr double HOT_REQUESTS = 0.8;     // the fraction of requests to hot keys
+    static constexpr uint64_t MAX_SCAN = 100;       // the maximum length of a scan
+
+private:
+    mix_t mix;
+    distribution_t distribution;
+    uint64_t records;       // the number of records loaded initially
+    uint64_t oldest;        // the key of the oldest live record
+    uint64_t next;          // the key of the next record to insert
+    std::mt19937_64 g;
+    zipfianGenerator zipf;
+
+public:
+    /*
+     * Calling parameters:
+     *
+     * m - the mix of operations
+     * d - the distribution of request keys, which mixes D and window ignore
+     * n - the number of records loaded initially, which is the window size for the window mix
+     * seed - the seed of the random number generator
+     */
+    workload(mix_t const m, distribution_t const d, uint64_t const n, uint64_t const seed) :
+        mix(m), distribution(d), records(n), oldest(0), next(0), g(seed), zipf(std::max<uint64_t>(n, 1)) {
+        if (n == 0) {
+            std::ostringstream buffer;
+            buffer << std::endl << "workload requires at least one record" << std::endl;
+            throw std::runtime_error(buffer.str());
+        }
+    }
+
+    /*
+     * Parse the name of a mix or distribution.
+     *
+     * Calling parameter:
+     *
+     * name - the name
+     *
+     * return the mix or distribution
+     */
+public:
+    static mix_t parseMix(std::string const& name) {
+        for (int m = 0; m < MIX_COUNT; ++m) {
+            if (name == mixName(static_cast<mix_t>(m))) {
+                return static_cast<mix_t>(m);
+            }
+        }
+        std::ostringstream buffer;
+        buffer << std::endl << "workload = " << name << "  is not a, b, c, d, e, f or window" << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+
+public:
+    static distribution_t parseDistribution(std::string const& name) {
+        for (int d = 0; d < DISTRIBUTION_COUNT; ++d) {
+            if (name == distributionName(static_cast<distribution_t>(d))) {
+                return static_cast<distribution_t>(d);
+            }
+        }
+        std::ostringstream buffer;
+        buffer << std::endl << "distribution = " << name << "  is not uniform, zipfian or hotspot" << std::endl;
+        throw std::runtime_error(buffer.str());
+    }
+
+    /*
+     * Generate the insertions of the initial records in random order.
+     *
+     * Calling parameter:
+     *
+     * ops - the operations (MODIFIED)
+     */
+public:
+    void load(std::vector<operation>& ops) {
+        std::vector<uint64_t> keys(records);
+        for (uint64_t i = 0; i < records; ++i) {
+            keys[i] = i;
+        }
+        std::shuffle(keys.begin(), keys.end(), g);
+        for (uint64_t i = 0; i < records; ++i) {
+            operation const o = { OP_INSERT, keys[i] };
+            ops.push_back(o);
+        }
+        oldest = 0;
+        next = records;
+    }
+
+    /*
+     * Generate the primitive operations of a number of requests of the mix.
+     *
+     * Calling parameters:
+     *
+     * requests - the number of requests
+     * ops - the operations (MODIFIED)
+     */
+public:
+    void generate(uint64_t const requests, std::vector<operation>& ops) {
+        std::uniform_real_distribution<double> percent(0., 100.);
+        for (uint64_t r = 0; r < requests; ++r) {
+            double const p = percent(g);
+            switch (mix) {
+            case YCSB_A:
+                (p < 50.) ? read(ops) : update(ops);
+                break;
+            case YCSB_B:
+                (p < 95.) ? read(ops) : update(ops);
+                break;
+            case YCSB_C:
+                read(ops);
+                break;
+            case YCSB_D:
+                if (p < 95.) {
+                    // Read the latest records most often.
+                    push(ops, OP_CONTAINS, next - 1 - zipf.next(g));
+                } else {
+                    insert(ops);
+                }
+                break;
+            case YCSB_E:
+                (p < 95.) ? scan(ops) : insert(ops);
+                break;
+            case YCSB_F:
+                if (p < 50.) {
+                    read(ops);
+                } else {
+                    uint64_t const key = choose();
+                    push(ops, OP_CONTAINS, key);
+                    push(ops, OP_ERASE, key);
+                    push(ops, OP_INSERT, key);
+                }
+                break;
+            default:
+                push(ops, OP_INSERT, next++);
+                push(ops, OP_ERASE, oldest++);
+                break;
+            }
+        }
+    }
+
+    /* Return the number of live records, which is the expected size of the tree. */
+public:
+    uint64_t size() const {
+        return next - oldest;
+    }
+
+    /* Return the key of the oldest live record; the live keys are [first(), first() + size()). */
+public:
+    uint64_t first() const {
+        return oldest;
+    }
+
+private:
+    void push(std::vector<operation>& ops, opcode_t const op, uint64_t const key) {
+        operation const o = { static_cast<uint8_t>(op), key };
+        ops.push_back(o);
+    }
+
+    /* Choose the key of an existing record according to the distribution. */
+private:
+    uint64_t choose() {
+        uint64_t const n = next - oldest;
+        switch (distribution) {
+        case UNIFORM:
+            return oldest + std::uniform_int_distribution<uint64_t>(0, n - 1)(g);
+        case ZIPFIAN:
+            // Scramble the rank via the FNV-1a hash so that popular keys are scattered.
+            {
+                uint64_t const rank = zipf.next(g);
+                uint64_t hash = 0xcbf29ce484222325ULL;
+                for (int i = 0; i < 8; ++i) {
+                    hash ^= (rank >> (8 * i)) & 0xff;
+                    hash *= 0x100000001b3ULL;
+                }
+                return oldest + hash % n;
+            }
+        default:
+            {
+                uint64_t const hot = std::max<uint64_t>(static_cast<uint64_t>(HOT_KEYS * n), 1);
+                if (hot == n || std::uniform_real_distribution<double>(0., 1.)(g) < HOT_REQUESTS) {
+                    return oldest + std::uniform_int_distribution<uint64_t>(0, hot - 1)(g);
+                }
+                return oldest + std::uniform_int_distribution<uint64_t>(hot, n - 1)(g);
+            }
+        }
+    }
+
+private:
+    void read(std::vector<operation>& ops) {
+        push(ops, OP_CONTAINS, choose());
+    }
+
+private:
+    void update(std::vector<operation>& ops) {
+        uint64_t const key = choose();
+        push(ops, OP_ERASE, key);
+        push(ops, OP_INSERT, key);
+    }
+
+private:
+    void insert(std::vector<operation>& ops) {
+        push(ops, OP_INSERT, next++);
+        zipf.grow(next - oldest);
+    }
+
+    /* Scan consecutive keys, some of which may not exist beyond the newest record. */
+private:
+    void scan(std::vector<operation>& ops) {
+        uint64_t const start = choose();
+        uint64_t const length = std::uniform_int_distribution<uint64_t>(1, MAX_SCAN)(g);
+        for (uint64_t k = start; k < start + length; ++k) {
+            push(ops, OP_CONTAINS, k);
+        }
+    }
+};
+
+#endif // WORKLOAD_GENERATOR_H